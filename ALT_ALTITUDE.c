@@ -0,0 +1,216 @@
+/***************************************************************************
+*  $MCI Módulo de implementação: ALT Altitude barométrica e velocidade vertical
+*
+*  Arquivo gerado:              ALT_ALTITUDE.c
+*  Letras identificadoras:      ALT
+*
+*
+*  Projeto: SAE AeroDesign Brasil 2014
+*  Gestor:  Alessandro Soares da Silva Junior
+*  Autores: Alessandro Soares da Silva Junior
+*
+*
+***************************************************************************/
+
+#ifndef _STRING
+#define _STRING
+#include <string.h>
+#endif
+
+#ifndef _MATH
+#define _MATH
+#include <math.h>
+#endif
+
+#define ALT_ALTITUDE_OWN
+#include "ALT_ALTITUDE.h"
+#undef ALT_ALTITUDE_OWN
+
+/* Atmosfera padrão: h = ( 1 - ( p / p0 ) ^ EXPOENTE ) / FATOR */
+
+#define ALT_EXPOENTE     ( 1.0 / 5.25588 )
+#define ALT_FATOR        2.25577e-5
+#define ALT_DT_MAX_US    500000ULL          /* Intervalo que reinicia o alfa-beta */
+
+/*****  Código das funções exportadas pelo módulo  *****/
+
+/***************************************************************************
+*
+*  Função: ALT  &Configuração padrão
+*  ****/
+
+	void ALT_ConfigPadrao( ALT_tpConfig * pConfig )
+	{
+		pConfig->pressaoNivelMar = 1013.25f ;
+		pConfig->tauAlturaS      = 0.2f ;
+		pConfig->tauReferenciaS  = 10.0f ;
+	}
+
+/***************************************************************************
+*
+*  Função: ALT  &Iniciar estimador
+*  ****/
+
+	ALT_tpCondRet ALT_Iniciar( ALT_tpEstimador * pEstimador , const ALT_tpConfig * pConfig )
+	{
+		double passo = ( ALT_PRESSAO_MAX - ALT_PRESSAO_MIN ) / ALT_TAM_TABELA ;
+		unsigned i ;
+
+		if ( ! ( pConfig->pressaoNivelMar > 0.0f ) || ! ( pConfig->tauAlturaS > 0.0f ) ||
+		     ! ( pConfig->tauReferenciaS > 0.0f ) )
+		{
+			return ALT_CondRetConfig ;
+		}
+
+		memset( pEstimador , 0 , sizeof( *pEstimador ) ) ;
+
+		pEstimador->config       = *pConfig ;
+		pEstimador->inversoPasso = ( float ) ( 1.0 / passo ) ;
+
+		for ( i = 0 ; i <= ALT_TAM_TABELA ; i++ )
+		{
+			double p = ALT_PRESSAO_MIN + passo * i ;
+
+			pEstimador->tabela[ i ] = ( float ) ( ( 1.0 - pow( p / pConfig->pressaoNivelMar , ALT_EXPOENTE ) ) / ALT_FATOR ) ;
+		}
+
+		return ALT_CondRetOK ;
+	}
+
+/***************************************************************************
+*
+*  Função: ALT  &Converter pressão em altitude
+*  ****/
+
+	ALT_tpCondRet ALT_AltitudeBaro( const ALT_tpEstimador * pEstimador , float pressao , float * pAltitude )
+	{
+		float    x = ( pressao - ALT_PRESSAO_MIN ) * pEstimador->inversoPasso ;
+		unsigned i ;
+
+		/* Também recusa NaN */
+
+		if ( ! ( x >= 0.0f ) || ! ( x <= ( float ) ALT_TAM_TABELA ) )
+		{
+			return ALT_CondRetFaixa ;
+		}
+
+		i = ( unsigned ) x ;
+
+		if ( i == ALT_TAM_TABELA )
+		{
+			i-- ;
+		}
+
+		*pAltitude = pEstimador->tabela[ i ] + ( x - ( float ) i ) * ( pEstimador->tabela[ i + 1 ] - pEstimador->tabela[ i ] ) ;
+
+		return ALT_CondRetOK ;
+	}
+
+/***************************************************************************
+*
+*  Função: ALT  &Acrescentar pressão
+*  ****/
+
+	ALT_tpCondRet ALT_AcrescentarPressao( ALT_tpEstimador * pEstimador , uint64_t timestamp , float pressao )
+	{
+		ALT_tpEstimativa * pEst = &pEstimador->estimativa ;
+		float altitude , medida , dt , alfa , beta , erro ;
+
+		if ( pEstimador->iniciado && timestamp <= pEstimador->ultimaPressao )
+		{
+			return ALT_CondRetOK ;
+		}
+
+		if ( ALT_AltitudeBaro( pEstimador , pressao , &altitude ) != ALT_CondRetOK )
+		{
+			return ALT_CondRetFaixa ;
+		}
+
+		if ( ! pEstimador->iniciado )
+		{
+			pEstimador->referencia = altitude ;
+		}
+
+		medida = altitude - pEstimador->referencia ;
+
+		pEst->altitudeBaro = altitude  ;
+		pEst->timestamp    = timestamp ;
+
+		if ( ! pEstimador->iniciado || timestamp - pEstimador->ultimaPressao > ALT_DT_MAX_US )
+		{
+			pEstimador->iniciado      = 1         ;
+			pEstimador->ultimaPressao = timestamp ;
+			pEst->altura              = medida    ;
+			pEst->velocidade          = 0.0f      ;
+
+			return ALT_CondRetOK ;
+		}
+
+		dt = ( float ) ( timestamp - pEstimador->ultimaPressao ) * 1e-6f ;
+		pEstimador->ultimaPressao = timestamp ;
+
+		/* Alfa-beta com amortecimento crítico (polo duplo do erro em
+		   sqrt( 1 - alfa )); ganhos pelo dt real */
+
+		alfa = dt / ( pEstimador->config.tauAlturaS + dt ) ;
+		beta = 1.0f - sqrtf( 1.0f - alfa ) ;
+		beta = beta * beta ;
+
+		pEst->altura     += pEst->velocidade * dt ;
+		erro              = medida - pEst->altura ;
+		pEst->altura     += alfa * erro ;
+		pEst->velocidade += beta / dt * erro ;
+
+		return ALT_CondRetOK ;
+	}
+
+/***************************************************************************
+*
+*  Função: ALT  &Acrescentar altura de referência
+*  ****/
+
+	void ALT_AcrescentarAltura( ALT_tpEstimador * pEstimador , uint64_t timestamp , float altura )
+	{
+		ALT_tpEstimativa * pEst = &pEstimador->estimativa ;
+		float alvo , ganho , delta ;
+
+		if ( ! pEstimador->iniciado || timestamp <= pEstimador->ultimaReferencia )
+		{
+			return ;
+		}
+
+		alvo = pEst->altitudeBaro - altura ;
+
+		if ( ! pEst->referenciaZ )
+		{
+			ganho = 1.0f ;
+			pEst->referenciaZ = 1 ;
+		}
+		else
+		{
+			float dt = ( float ) ( timestamp - pEstimador->ultimaReferencia ) * 1e-6f ;
+
+			ganho = dt / ( pEstimador->config.tauReferenciaS + dt ) ;
+		}
+
+		pEstimador->ultimaReferencia = timestamp ;
+
+		/* A altura acompanha a referência sem passar pelo alfa-beta, que
+		   tomaria o degrau por velocidade */
+
+		delta                   = ganho * ( alvo - pEstimador->referencia ) ;
+		pEstimador->referencia += delta ;
+		pEst->altura           -= delta ;
+	}
+
+/***************************************************************************
+*
+*  Função: ALT  &Obter estimativa
+*  ****/
+
+	int ALT_ObterEstimativa( const ALT_tpEstimador * pEstimador , ALT_tpEstimativa * pEstimativa )
+	{
+		*pEstimativa = pEstimador->estimativa ;
+
+		return pEstimador->iniciado ;
+	}
@@ -0,0 +1,202 @@
+#ifndef ALT_ALTITUDE
+#define ALT_ALTITUDE
+
+/**************************************************************************************************************************
+*$MCD Módulo de definição
+*	  Nome : 	                Altitude barométrica e velocidade vertical
+*	  Proprietário :         	Equipe AeroRio
+*	  Projeto :		            SAE AeroDesign Brasil 2014
+*	  Gestor :	 	            Alessandro Soares da Silva Junior
+* 	  Arquivo : 	            ALT_ALTITUDE.H
+*	  Letras Identificadoras : 	ALT
+*	  Autor : 	                Alessandro Soares da Silva Junior
+*
+*$ED Descrição do módulo
+*	Altura e razão de subida a partir da pressão do barômetro, que chega muito mais depressa que o z do
+*   vehicle_local_position, fundida com esse z quando ele existe.
+*
+*   A conversão pressão -> altitude da atmosfera padrão é feita por uma tabela de ALT_TAM_TABELA intervalos entre
+*   ALT_PRESSAO_MIN e ALT_PRESSAO_MAX mbar, calculada em ALT_Iniciar, com interpolação linear (erro menor que 3 cm
+*   em toda a faixa): nenhum powf por amostra.
+*
+*   Cada pressão nova passa por um filtro alfa-beta (posição e velocidade) com constante de tempo tauAlturaS, que
+*   dá a altura e a razão de subida. Cada z novo corrige devagar (tauReferenciaS) a referência da altitude
+*   barométrica, de modo que a altura segue o z em baixa frequência e o barômetro em alta: um filtro
+*   complementar. Sem z, a altura é relativa à primeira pressão. O custo por amostra é constante.
+*
+*   Alturas e velocidades são positivas para cima (altura = -z do NED).
+*
+***************************************************************************************************************************/
+
+#include <stdint.h>
+
+/***** Declarações exportadas pelo módulo *****/
+
+#define ALT_TAM_TABELA   512        /* Intervalos da tabela pressão -> altitude */
+#define ALT_PRESSAO_MIN  250.0f     /* mbar (cerca de 10 km)                    */
+#define ALT_PRESSAO_MAX  1100.0f    /* mbar (abaixo do nível do mar)            */
+
+/***********************************************************************
+*
+*  $TC Tipo de dados: ALT Condições de retorno
+*
+***********************************************************************/
+
+   typedef enum {
+
+         ALT_CondRetOK            ,
+              /* Executou corretamente                               */
+         ALT_CondRetConfig        ,
+              /* Pressão de referência ou constante de tempo inválida */
+         ALT_CondRetFaixa         ,
+              /* Pressão fora da tabela; amostra ignorada            */
+
+} ALT_tpCondRet ;
+
+/***********************************************************************
+*
+*  $TC Tipo de dados: ALT Configuração
+*
+***********************************************************************/
+
+   typedef struct {
+
+         float pressaoNivelMar ;
+              /* mbar; 1013,25 na atmosfera padrão                   */
+         float tauAlturaS      ;
+              /* Constante de tempo do alfa-beta sobre o barômetro   */
+         float tauReferenciaS  ;
+              /* Constante de tempo da correção pelo z               */
+
+} ALT_tpConfig ;
+
+/***********************************************************************
+*
+*  $TC Tipo de dados: ALT Estimativa
+*
+***********************************************************************/
+
+   typedef struct {
+
+         uint64_t timestamp      ;
+              /* Origem da última pressão usada                      */
+         float    altitudeBaro   ;
+              /* Altitude padrão da última pressão, em m              */
+         float    altura         ;
+              /* m, para cima, em relação à referência               */
+         float    velocidade     ;
+              /* Razão de subida, em m/s                             */
+         int      referenciaZ    ;
+              /* 1 se a referência já foi corrigida pelo z; 0 se é    */
+              /* a primeira pressão                                  */
+
+} ALT_tpEstimativa ;
+
+/***********************************************************************
+*
+*  $TC Tipo de dados: ALT Estimador
+*
+*  $ED Descrição do tipo
+*     Tabela e estado do filtro. Os campos são internos ao módulo; o
+*     tipo é exportado para que o chamador o aloque.
+*
+***********************************************************************/
+
+   typedef struct {
+
+         ALT_tpConfig     config                         ;
+         float            tabela[ ALT_TAM_TABELA + 1 ]   ;
+         float            inversoPasso                   ;
+              /* Intervalos por mbar                                */
+
+         int              iniciado                       ;
+         uint64_t         ultimaPressao                  ;
+         uint64_t         ultimaReferencia               ;
+         float            referencia                     ;
+              /* Altitude barométrica da altura zero                */
+
+         ALT_tpEstimativa estimativa                     ;
+
+} ALT_tpEstimador ;
+
+/***********************************************************************
+*
+*  $FC Função: ALT  &Configuração padrão
+*
+*  $ED Descrição da função
+*     Atmosfera padrão, alfa-beta de 0,2 s e correção pelo z de 10 s.
+*
+***********************************************************************/
+
+void ALT_ConfigPadrao( ALT_tpConfig * pConfig ) ;
+
+/***********************************************************************
+*
+*  $FC Função: ALT  &Iniciar estimador
+*
+*  $ED Descrição da função
+*     Calcula a tabela e zera o estado.
+*
+*  $FV Valor retornado
+*     ALT_CondRetOK ou ALT_CondRetConfig.
+*
+***********************************************************************/
+
+ALT_tpCondRet ALT_Iniciar( ALT_tpEstimador * pEstimador , const ALT_tpConfig * pConfig ) ;
+
+/***********************************************************************
+*
+*  $FC Função: ALT  &Converter pressão em altitude
+*
+*  $ED Descrição da função
+*     Altitude padrão (m) da pressão (mbar), pela tabela.
+*
+*  $FV Valor retornado
+*     ALT_CondRetOK ou ALT_CondRetFaixa.
+*
+***********************************************************************/
+
+ALT_tpCondRet ALT_AltitudeBaro( const ALT_tpEstimador * pEstimador , float pressao , float * pAltitude ) ;
+
+/***********************************************************************
+*
+*  $FC Função: ALT  &Acrescentar pressão
+*
+*  $ED Descrição da função
+*     Avança o alfa-beta com uma pressão nova. Pressões com a mesma
+*     origem da anterior são ignoradas; um intervalo maior que 0,5 s
+*     reinicia o filtro na medida.
+*
+*  $FV Valor retornado
+*     ALT_CondRetOK ou ALT_CondRetFaixa.
+*
+***********************************************************************/
+
+ALT_tpCondRet ALT_AcrescentarPressao( ALT_tpEstimador * pEstimador , uint64_t timestamp , float pressao ) ;
+
+/***********************************************************************
+*
+*  $FC Função: ALT  &Acrescentar altura de referência
+*
+*  $ED Descrição da função
+*     Corrige a referência barométrica com uma altura (m, para cima)
+*     de outra fonte, tipicamente -z do vehicle_local_position. A
+*     primeira alinha a referência de uma vez. Ignorada enquanto não
+*     houver pressão.
+*
+***********************************************************************/
+
+void ALT_AcrescentarAltura( ALT_tpEstimador * pEstimador , uint64_t timestamp , float altura ) ;
+
+/***********************************************************************
+*
+*  $FC Função: ALT  &Obter estimativa
+*
+*  $FV Valor retornado
+*     1 se já houve alguma pressão, senão 0.
+*
+***********************************************************************/
+
+int ALT_ObterEstimativa( const ALT_tpEstimador * pEstimador , ALT_tpEstimativa * pEstimativa ) ;
+
+#endif
@@ -0,0 +1,411 @@
+/***************************************************************************
+*  $MCI Módulo de implementação: AVS Avisos de mudança por limiar e faixa morta
+*
+*  Arquivo gerado:              AVS_AVISOS.c
+*  Letras identificadoras:      AVS
+*
+*
+*  Projeto: SAE AeroDesign Brasil 2014
+*  Gestor:  Alessandro Soares da Silva Junior
+*  Autores: Alessandro Soares da Silva Junior
+*
+*
+***************************************************************************/
+
+#ifndef _STRING
+#define _STRING
+#include <string.h>
+#endif
+
+#ifndef _MATH
+#define _MATH
+#include <math.h>
+#endif
+
+#ifndef _TIME
+#define _TIME
+#include <time.h>
+#endif
+
+#ifndef _ERRNO
+#define _ERRNO
+#include <errno.h>
+#endif
+
+#define AVS_AVISOS_OWN
+#include "AVS_AVISOS.h"
+#undef AVS_AVISOS_OWN
+
+#define AVS_TODAS_USADAS  0xFFFFFFFFu
+
+/***** Protótipos das funções encapuladas no módulo *****/
+
+	static void varrerCanal       ( AVS_tpConjunto * pConj , unsigned canal , float valor ) ;
+	static void disparar          ( AVS_tpConjunto * pConj , int e , float valor )          ;
+	static void recalcularCanal   ( AVS_tpConjunto * pConj , unsigned canal )               ;
+
+/*****  Código das funções exportadas pelo módulo  *****/
+
+/***************************************************************************
+*
+*  Função: AVS  &Iniciar conjunto
+*  ****/
+
+	AVS_tpCondRet AVS_Iniciar( AVS_tpConjunto * pConj )
+	{
+		unsigned i ;
+
+		memset( pConj , 0 , sizeof( *pConj ) ) ;
+
+		if ( pthread_mutex_init( &pConj->trava , NULL ) != 0 )
+		{
+			return AVS_CondRetConfig ;
+		}
+
+		for ( i = 0 ; i < AVS_MAX_CANAIS ; i++ )
+		{
+			pConj->inferior[ i ] = -INFINITY ;
+			pConj->superior[ i ] =  INFINITY ;
+			pConj->primeira[ i ] = -1 ;
+		}
+
+		for ( i = 0 ; i < AVS_MAX_CONDICOES ; i++ )
+		{
+			pConj->entrada[ i ].proxima = ( i + 1 < AVS_MAX_CONDICOES ) ? ( int ) i + 1 : -1 ;
+		}
+
+		pConj->livre = 0 ;
+
+		return AVS_CondRetOK ;
+	}
+
+/***************************************************************************
+*
+*  Função: AVS  &Terminar conjunto
+*  ****/
+
+	void AVS_Terminar( AVS_tpConjunto * pConj )
+	{
+		pthread_mutex_destroy( &pConj->trava ) ;
+	}
+
+/***************************************************************************
+*
+*  Função: AVS  &Iniciar assinante
+*  ****/
+
+	AVS_tpCondRet AVS_IniciarAssinante( AVS_tpAssinante * pAss )
+	{
+		memset( pAss , 0 , sizeof( *pAss ) ) ;
+
+		if ( sem_init( &pAss->sinal , 0 , 0 ) != 0 )
+		{
+			return AVS_CondRetConfig ;
+		}
+
+		return AVS_CondRetOK ;
+	}
+
+/***************************************************************************
+*
+*  Função: AVS  &Vigiar canal
+*  ****/
+
+	AVS_tpCondRet AVS_Vigiar( AVS_tpConjunto * pConj , AVS_tpAssinante * pAss ,
+	                          const AVS_tpCondicao * pCondicao , unsigned * pBit )
+	{
+		unsigned canal = pCondicao->canal ;
+		unsigned bit ;
+		int      e ;
+
+		if ( canal >= AVS_MAX_CANAIS || ! ( pCondicao->faixa >= 0.0f ) || isinf( pCondicao->faixa ) ||
+		     ( pCondicao->tipo != AVS_TipoFaixa && pCondicao->tipo != AVS_TipoLimiar ) ||
+		     ( pCondicao->tipo == AVS_TipoLimiar && ! isfinite( pCondicao->limite ) ) )
+		{
+			return AVS_CondRetConfig ;
+		}
+
+		pthread_mutex_lock( &pConj->trava ) ;
+
+		if ( pAss->usadas == AVS_TODAS_USADAS || pConj->livre < 0 )
+		{
+			pthread_mutex_unlock( &pConj->trava ) ;
+			return AVS_CondRetCheio ;
+		}
+
+		bit = ( unsigned ) __builtin_ctz( ~pAss->usadas ) ;
+		e   = pConj->livre ;
+
+		pConj->livre                   = pConj->entrada[ e ].proxima ;
+		pConj->entrada[ e ].condicao   = *pCondicao ;
+		pConj->entrada[ e ].pAssinante = pAss ;
+		pConj->entrada[ e ].bit        = bit ;
+		pConj->entrada[ e ].acima      = 0 ;
+
+		/* Intervalo vazio: dispara na primeira amostra */
+
+		pConj->entrada[ e ].inferior   =  INFINITY ;
+		pConj->entrada[ e ].superior   = -INFINITY ;
+
+		pConj->entrada[ e ].proxima    = pConj->primeira[ canal ] ;
+		pConj->primeira[ canal ]       = e ;
+
+		pAss->usadas |= 1u << bit ;
+		pConj->estatisticas.condicoes ++ ;
+
+		recalcularCanal( pConj , canal ) ;
+
+		pthread_mutex_unlock( &pConj->trava ) ;
+
+		if ( pBit != NULL )
+		{
+			*pBit = bit ;
+		}
+
+		return AVS_CondRetOK ;
+	}
+
+/***************************************************************************
+*
+*  Função: AVS  &Remover assinante
+*  ****/
+
+	void AVS_RemoverAssinante( AVS_tpConjunto * pConj , AVS_tpAssinante * pAss )
+	{
+		unsigned canal ;
+		int *    pLigacao ;
+		int      e ;
+
+		pthread_mutex_lock( &pConj->trava ) ;
+
+		for ( canal = 0 ; canal < AVS_MAX_CANAIS ; canal++ )
+		{
+			pLigacao = &pConj->primeira[ canal ] ;
+
+			while ( ( e = *pLigacao ) >= 0 )
+			{
+				if ( pConj->entrada[ e ].pAssinante == pAss )
+				{
+					*pLigacao                     = pConj->entrada[ e ].proxima ;
+					pConj->entrada[ e ].pAssinante = NULL ;
+					pConj->entrada[ e ].proxima    = pConj->livre ;
+					pConj->livre                   = e ;
+					pConj->estatisticas.condicoes -- ;
+				}
+				else
+				{
+					pLigacao = &pConj->entrada[ e ].proxima ;
+				}
+			}
+
+			recalcularCanal( pConj , canal ) ;
+		}
+
+		pthread_mutex_unlock( &pConj->trava ) ;
+
+		pAss->usadas = 0 ;
+		sem_destroy( &pAss->sinal ) ;
+	}
+
+/***************************************************************************
+*
+*  Função: AVS  &Aguardar disparos
+*
+*  O semáforo recebe um post por vez que a máscara sai de zero, e a troca
+*  abaixo é o que a zera: cada espera bem-sucedida encontra a máscara
+*  com algum bit.
+*  ****/
+
+	AVS_tpCondRet AVS_Aguardar( AVS_tpAssinante * pAss , unsigned prazoMs , uint32_t * pDisparadas )
+	{
+		struct timespec limite ;
+		int ret ;
+
+		if ( prazoMs == 0 )
+		{
+			ret = sem_trywait( &pAss->sinal ) ;
+		}
+		else
+		{
+			clock_gettime( CLOCK_REALTIME , &limite ) ;
+
+			limite.tv_sec  += prazoMs / 1000 ;
+			limite.tv_nsec += ( long ) ( prazoMs % 1000 ) * 1000000L ;
+
+			if ( limite.tv_nsec >= 1000000000L )
+			{
+				limite.tv_sec  ++ ;
+				limite.tv_nsec -= 1000000000L ;
+			}
+
+			while ( ( ret = sem_timedwait( &pAss->sinal , &limite ) ) != 0 && errno == EINTR )
+			{
+			}
+		}
+
+		if ( ret != 0 )
+		{
+			*pDisparadas = 0 ;
+			return AVS_CondRetPrazo ;
+		}
+
+		*pDisparadas = __atomic_exchange_n( &pAss->disparadas , 0 , __ATOMIC_ACQUIRE ) ;
+
+		return AVS_CondRetOK ;
+	}
+
+/***************************************************************************
+*
+*  Função: AVS  &Valor do último disparo
+*  ****/
+
+	float AVS_ValorDisparo( const AVS_tpAssinante * pAss , unsigned bit )
+	{
+		float valor ;
+
+		if ( bit >= AVS_CONDICOES_POR_ASSINANTE )
+		{
+			return NAN ;
+		}
+
+		__atomic_load( &pAss->valor[ bit ] , &valor , __ATOMIC_RELAXED ) ;
+
+		return valor ;
+	}
+
+/***************************************************************************
+*
+*  Função: AVS  &Avaliar amostra
+*
+*  Caminho comum sem trava: a interseção de um canal só muda sob a trava
+*  e é lida inteira a cada amostra. Uma condição registrada no meio de
+*  uma avaliação entra na seguinte.
+*  ****/
+
+	void AVS_Avaliar( AVS_tpConjunto * pConj , const float * valor , unsigned mascara )
+	{
+		float inferior , superior ;
+		unsigned canal ;
+
+		__atomic_store_n( &pConj->estatisticas.avaliacoes , pConj->estatisticas.avaliacoes + 1 , __ATOMIC_RELAXED ) ;
+
+		mascara &= ( 1u << AVS_MAX_CANAIS ) - 1 ;
+
+		while ( mascara != 0 )
+		{
+			canal    = ( unsigned ) __builtin_ctz( mascara ) ;
+			mascara &= mascara - 1 ;
+
+			__atomic_load( &pConj->inferior[ canal ] , &inferior , __ATOMIC_RELAXED ) ;
+			__atomic_load( &pConj->superior[ canal ] , &superior , __ATOMIC_RELAXED ) ;
+
+			if ( valor[ canal ] < inferior || valor[ canal ] > superior )
+			{
+				varrerCanal( pConj , canal , valor[ canal ] ) ;
+			}
+		}
+	}
+
+/***************************************************************************
+*
+*  Função: AVS  &Obter estatísticas
+*  ****/
+
+	void AVS_ObterEstatisticas( AVS_tpConjunto * pConj , AVS_tpEstatisticas * pEst )
+	{
+		pthread_mutex_lock( &pConj->trava ) ;
+
+		*pEst            = pConj->estatisticas ;
+		pEst->avaliacoes = __atomic_load_n( &pConj->estatisticas.avaliacoes , __ATOMIC_RELAXED ) ;
+
+		pthread_mutex_unlock( &pConj->trava ) ;
+	}
+
+/*****  Código das funções encapsuladas no módulo  *****/
+
+	/***************************************************************************
+	*
+	*  Função: AVS  & Percorrer as condições de um canal
+	*  ****/
+
+	static void varrerCanal( AVS_tpConjunto * pConj , unsigned canal , float valor )
+	{
+		int e ;
+
+		pthread_mutex_lock( &pConj->trava ) ;
+
+		pConj->estatisticas.varreduras ++ ;
+
+		for ( e = pConj->primeira[ canal ] ; e >= 0 ; e = pConj->entrada[ e ].proxima )
+		{
+			if ( valor < pConj->entrada[ e ].inferior || valor > pConj->entrada[ e ].superior )
+			{
+				disparar( pConj , e , valor ) ;
+			}
+		}
+
+		recalcularCanal( pConj , canal ) ;
+
+		pthread_mutex_unlock( &pConj->trava ) ;
+	}
+
+	/***************************************************************************
+	*
+	*  Função: AVS  & Disparar uma condição e armar o próximo intervalo
+	*  ****/
+
+	static void disparar( AVS_tpConjunto * pConj , int e , float valor )
+	{
+		AVS_tpAssinante * pAss = pConj->entrada[ e ].pAssinante ;
+		const AVS_tpCondicao * pCond = &pConj->entrada[ e ].condicao ;
+		unsigned bit = pConj->entrada[ e ].bit ;
+
+		if ( pCond->tipo == AVS_TipoFaixa )
+		{
+			pConj->entrada[ e ].inferior = valor - pCond->faixa ;
+			pConj->entrada[ e ].superior = valor + pCond->faixa ;
+		}
+		else
+		{
+			pConj->entrada[ e ].acima = valor > pCond->limite ;
+
+			pConj->entrada[ e ].inferior = pConj->entrada[ e ].acima ? pCond->limite - pCond->faixa : -INFINITY ;
+			pConj->entrada[ e ].superior = pConj->entrada[ e ].acima ? INFINITY : pCond->limite ;
+		}
+
+		pConj->estatisticas.disparos ++ ;
+
+		__atomic_store( &pAss->valor[ bit ] , &valor , __ATOMIC_RELAXED ) ;
+
+		if ( __atomic_fetch_or( &pAss->disparadas , 1u << bit , __ATOMIC_ACQ_REL ) == 0 )
+		{
+			sem_post( &pAss->sinal ) ;
+		}
+	}
+
+	/***************************************************************************
+	*
+	*  Função: AVS  & Interseção dos intervalos de um canal
+	*  ****/
+
+	static void recalcularCanal( AVS_tpConjunto * pConj , unsigned canal )
+	{
+		float inferior = -INFINITY , superior = INFINITY ;
+		int   e ;
+
+		for ( e = pConj->primeira[ canal ] ; e >= 0 ; e = pConj->entrada[ e ].proxima )
+		{
+			if ( pConj->entrada[ e ].inferior > inferior )
+			{
+				inferior = pConj->entrada[ e ].inferior ;
+			}
+
+			if ( pConj->entrada[ e ].superior < superior )
+			{
+				superior = pConj->entrada[ e ].superior ;
+			}
+		}
+
+		__atomic_store( &pConj->inferior[ canal ] , &inferior , __ATOMIC_RELAXED ) ;
+		__atomic_store( &pConj->superior[ canal ] , &superior , __ATOMIC_RELAXED ) ;
+	}
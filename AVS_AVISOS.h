@@ -0,0 +1,285 @@
+#ifndef AVS_AVISOS
+#define AVS_AVISOS
+
+/**************************************************************************************************************************
+*$MCD Módulo de definição
+*	  Nome : 	                Avisos de mudança por limiar e faixa morta
+*	  Proprietário :         	Equipe AeroRio
+*	  Projeto :		            SAE AeroDesign Brasil 2014
+*	  Gestor :	 	            Alessandro Soares da Silva Junior
+* 	  Arquivo : 	            AVS_AVISOS.H
+*	  Letras Identificadoras : 	AVS
+*	  Autor : 	                Alessandro Soares da Silva Junior
+*
+*$ED Descrição do módulo
+*	Acorda um consumidor só quando um canal (com o LER, um LER_tpCampo) muda de modo significativo, em vez de ele
+*   ler todos os getters a cada amostra para descobrir.
+*
+*   Cada assinante registra até AVS_CONDICOES_POR_ASSINANTE condições; cada condição tem um bit na máscara de
+*   disparos do assinante e é de um de dois tipos:
+*
+*   	faixa morta : dispara quando o canal se afasta mais que 'faixa' do valor do último disparo
+*   	limiar      : dispara quando o canal passa acima de 'limite' e de novo quando volta abaixo de
+*   	              'limite' - 'faixa' (histerese)
+*
+*   Toda condição dispara na primeira amostra que recebe, o que entrega ao assinante o valor inicial.
+*
+*   Em qualquer dos tipos, a condição guarda o intervalo [inferior, superior] fora do qual dispara. Para cada canal,
+*   o conjunto guarda a interseção dos intervalos das suas condições: AVS_Avaliar faz uma comparação por canal e só
+*   percorre as condições de um canal quando o valor sai da interseção. Com centenas de condições, o custo por
+*   amostra continua o de uma; o que cresce é o custo dos disparos.
+*
+*   O assinante espera por um semáforo POSIX (disponível no NuttX e no Linux), sinalizado uma vez a cada vez que a
+*   sua máscara de disparos deixa de ser vazia; AVS_Aguardar devolve e zera a máscara.
+*
+***************************************************************************************************************************/
+
+#include <stdint.h>
+#include <pthread.h>
+#include <semaphore.h>
+
+/***** Declarações exportadas pelo módulo *****/
+
+#ifndef AVS_MAX_CONDICOES
+#define AVS_MAX_CONDICOES            256      /* Condições de um conjunto (todos os assinantes) */
+#endif
+
+#define AVS_MAX_CANAIS               16
+#define AVS_CONDICOES_POR_ASSINANTE  32       /* Bits da máscara de disparos                    */
+
+/***********************************************************************
+*
+*  $TC Tipo de dados: AVS Condições de retorno
+*
+***********************************************************************/
+
+   typedef enum {
+
+         AVS_CondRetOK            ,
+              /* Executou corretamente                               */
+         AVS_CondRetConfig        ,
+              /* Canal, tipo ou faixa inválido                       */
+         AVS_CondRetCheio         ,
+              /* Sem espaço no conjunto ou no assinante              */
+         AVS_CondRetPrazo         ,
+              /* Nenhum disparo dentro do prazo                      */
+
+} AVS_tpCondRet ;
+
+/***********************************************************************
+*
+*  $TC Tipo de dados: AVS Tipo de condição
+*
+***********************************************************************/
+
+   typedef enum {
+
+         AVS_TipoFaixa            ,
+              /* Faixa morta em torno do último disparo              */
+         AVS_TipoLimiar           ,
+              /* Cruzamento de um limite, com histerese              */
+
+} AVS_tpTipo ;
+
+/***********************************************************************
+*
+*  $TC Tipo de dados: AVS Condição
+*
+***********************************************************************/
+
+   typedef struct {
+
+         unsigned   canal   ;
+              /* Com o LER, o LER_tpCampo                            */
+         AVS_tpTipo tipo    ;
+         float      limite  ;
+              /* Só em AVS_TipoLimiar                                */
+         float      faixa   ;
+              /* Faixa morta, ou histerese do limiar (>= 0)          */
+
+} AVS_tpCondicao ;
+
+/***********************************************************************
+*
+*  $TC Tipo de dados: AVS Assinante
+*
+*  $ED Descrição do tipo
+*     Os campos são internos ao módulo; o tipo é exportado para que o
+*     chamador o aloque.
+*
+***********************************************************************/
+
+   typedef struct {
+
+         sem_t      sinal                                      ;
+         uint32_t   disparadas                                 ;
+              /* Máscara ainda não entregue por AVS_Aguardar         */
+         uint32_t   usadas                                     ;
+              /* Bits com condição registrada                        */
+         float      valor[ AVS_CONDICOES_POR_ASSINANTE ]       ;
+              /* Valor do último disparo de cada condição            */
+
+} AVS_tpAssinante ;
+
+/***********************************************************************
+*
+*  $TC Tipo de dados: AVS Estatísticas
+*
+***********************************************************************/
+
+   typedef struct {
+
+         uint32_t   avaliacoes    ;
+              /* Chamadas de AVS_Avaliar                             */
+         uint32_t   varreduras    ;
+              /* Canais cujas condições foram percorridas            */
+         uint32_t   disparos      ;
+         uint32_t   condicoes     ;
+              /* Registradas no momento                              */
+
+} AVS_tpEstatisticas ;
+
+/***********************************************************************
+*
+*  $TC Tipo de dados: AVS Conjunto de condições
+*
+*  $ED Descrição do tipo
+*     Os campos são internos ao módulo; o tipo é exportado para que o
+*     chamador o aloque.
+*
+***********************************************************************/
+
+   typedef struct AVS_conjunto {
+
+         pthread_mutex_t  trava                                 ;
+              /* Registro, remoção e varredura dos disparos          */
+         float            inferior[ AVS_MAX_CANAIS ]            ;
+         float            superior[ AVS_MAX_CANAIS ]            ;
+              /* Interseção dos intervalos das condições do canal    */
+         int              primeira[ AVS_MAX_CANAIS ]            ;
+              /* Lista das condições de cada canal (-1 = vazia)      */
+         int              livre                                 ;
+
+         struct {
+               AVS_tpCondicao    condicao                       ;
+               float             inferior , superior            ;
+               int               acima                          ;
+               AVS_tpAssinante * pAssinante                     ;
+               unsigned          bit                            ;
+               int               proxima                        ;
+         } entrada[ AVS_MAX_CONDICOES ]                         ;
+
+         AVS_tpEstatisticas estatisticas                        ;
+
+} AVS_tpConjunto ;
+
+/***********************************************************************
+*
+*  $FC Função: AVS  &Iniciar conjunto
+*
+*  $FV Valor retornado
+*     AVS_CondRetOK ou AVS_CondRetConfig se a trava não pôde ser criada.
+*
+***********************************************************************/
+
+AVS_tpCondRet AVS_Iniciar( AVS_tpConjunto * pConj ) ;
+
+/***********************************************************************
+*
+*  $FC Função: AVS  &Terminar conjunto
+*
+*  $ED Descrição da função
+*     Os assinantes devem ter sido removidos antes.
+*
+***********************************************************************/
+
+void AVS_Terminar( AVS_tpConjunto * pConj ) ;
+
+/***********************************************************************
+*
+*  $FC Função: AVS  &Iniciar assinante
+*
+***********************************************************************/
+
+AVS_tpCondRet AVS_IniciarAssinante( AVS_tpAssinante * pAss ) ;
+
+/***********************************************************************
+*
+*  $FC Função: AVS  &Vigiar canal
+*
+*  $ED Descrição da função
+*     Registra uma condição para o assinante. Vale a partir da próxima
+*     chamada de AVS_Avaliar.
+*
+*  $EP Parâmetros
+*    pBit  - Recebe o bit da condição na máscara de disparos, ou NULL
+*
+*  $FV Valor retornado
+*     AVS_CondRetOK, AVS_CondRetConfig ou AVS_CondRetCheio.
+*
+***********************************************************************/
+
+AVS_tpCondRet AVS_Vigiar( AVS_tpConjunto * pConj , AVS_tpAssinante * pAss ,
+                          const AVS_tpCondicao * pCondicao , unsigned * pBit ) ;
+
+/***********************************************************************
+*
+*  $FC Função: AVS  &Remover assinante
+*
+*  $ED Descrição da função
+*     Retira todas as condições do assinante e destrói o semáforo.
+*     Depois do retorno, AVS_Avaliar não toca mais no assinante.
+*
+***********************************************************************/
+
+void AVS_RemoverAssinante( AVS_tpConjunto * pConj , AVS_tpAssinante * pAss ) ;
+
+/***********************************************************************
+*
+*  $FC Função: AVS  &Aguardar disparos
+*
+*  $EP Parâmetros
+*    prazoMs      - Espera máxima; 0 = só verifica
+*    pDisparadas  - Recebe a máscara dos disparos desde a última entrega
+*
+*  $FV Valor retornado
+*     AVS_CondRetOK ou AVS_CondRetPrazo.
+*
+***********************************************************************/
+
+AVS_tpCondRet AVS_Aguardar( AVS_tpAssinante * pAss , unsigned prazoMs , uint32_t * pDisparadas ) ;
+
+/***********************************************************************
+*
+*  $FC Função: AVS  &Valor do último disparo
+*
+***********************************************************************/
+
+float AVS_ValorDisparo( const AVS_tpAssinante * pAss , unsigned bit ) ;
+
+/***********************************************************************
+*
+*  $FC Função: AVS  &Avaliar amostra
+*
+*  $ED Descrição da função
+*     Uma passada pela amostra: uma comparação por canal de 'mascara';
+*     as condições de um canal só são percorridas quando o valor sai da
+*     interseção. NaN não dispara. Um único produtor.
+*
+*  $EP Parâmetros
+*    valor    - Um valor por canal
+*    mascara  - Canais com valor novo (bit = canal)
+*
+***********************************************************************/
+
+void AVS_Avaliar( AVS_tpConjunto * pConj , const float * valor , unsigned mascara ) ;
+
+/***********************************************************************
+*
+*  $FC Função: AVS  &Obter estatísticas
+*
+***********************************************************************/
+
+void AVS_ObterEstatisticas( AVS_tpConjunto * pConj , AVS_tpEstatisticas * pEst ) ;
+
+#endif
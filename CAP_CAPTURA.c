@@ -0,0 +1,346 @@
+/***************************************************************************
+*  $MCI Módulo de implementação: CAP Captura em taxa plena do sensor_combined
+*
+*  Arquivo gerado:              CAP_CAPTURA.c
+*  Letras identificadoras:      CAP
+*
+*
+*  Projeto: SAE AeroDesign Brasil 2014
+*  Gestor:  Alessandro Soares da Silva Junior
+*  Autores: Alessandro Soares da Silva Junior
+*
+*
+***************************************************************************/
+
+#ifndef _STDLIB
+#define _STDLIB
+#include <stdlib.h>
+#endif
+
+#ifndef _STRING
+#define _STRING
+#include <string.h>
+#endif
+
+#ifndef _UORB
+#define _UORB
+#include <uORB/uORB.h>
+#endif
+
+#ifndef _DRIVERS
+#define _DRIVERS
+#include <drivers/drv_hrt.h>
+#endif
+
+#ifndef _SENSOR
+#define _SENSOR
+#include <uORB/topics/sensor_combined.h>
+#endif
+
+#ifndef _POLL
+#define _POLL
+#include <poll.h>
+#endif
+
+#ifndef _PTHREAD
+#define _PTHREAD
+#include <pthread.h>
+#endif
+
+#define CAP_CAPTURA_OWN
+#include "CAP_CAPTURA.h"
+#undef CAP_CAPTURA_OWN
+
+#include "FLT_FILTROS.h"
+#include "HST_HISTORICO.h"
+
+#define CAP_CANAIS  6                          /* acel[3] e giro[3]                         */
+
+/***********************************************************************
+*
+*  $TC Tipo de dados: CAP - Captura
+*
+***********************************************************************/
+
+typedef struct CAP_captura {
+	int              sensor_fd     ;
+	int              prazoPollMs   ;
+	pthread_t        thread        ;
+	volatile int     threadAtiva   ;
+
+	HST_tpAnel       anel[CAP_NumFluxos] ;   /* Elementos dentro da área da captura       */
+
+	unsigned         fator         ;
+	unsigned         fase          ;           /* Amostras desde a última decimada          */
+	FLT_tpCanal      antiAlias[CAP_CANAIS] ;
+	hrt_abstime      periodoUs     ;           /* Período nominal do sensor                 */
+	hrt_abstime      ultimaOrigem  ;
+
+	CAP_tpContadores contadores    ;           /* Escritos só pela thread de captura        */
+} CAP_captura ;
+
+#define INCREMENTAR( x )  __atomic_store_n( &( x ) , ( x ) + 1 , __ATOMIC_RELAXED )
+
+/***** Protótipos das funções encapuladas no módulo *****/
+
+	static void *   capturaContinua  ( void *arg )                                           ;
+	static void     decimar          ( CAP_captura *pCap , const CAP_tpAmostra *pAmostra )   ;
+
+/*****  Código das funções exportadas pelo módulo  *****/
+
+/***************************************************************************
+*
+*  Função: CAP  &Configuração padrão
+*  ****/
+
+	void CAP_ConfigPadrao( CAP_tpConfig * pConfig )
+	{
+		pConfig->capacidade[ CAP_FluxoBruto ]    = 4096   ;
+		pConfig->capacidade[ CAP_FluxoDecimado ] = 1024   ;
+		pConfig->fator                           = 5      ;
+		pConfig->taxaHz                          = 250.0f ;
+		pConfig->prazoPollMs                     = 100    ;
+	}
+
+/***************************************************************************
+*
+*  Função: CAP  &Iniciar captura
+*  ****/
+
+	CAP_tpCondRet CAP_Iniciar( CAP_tpCaptura * ppCaptura , const CAP_tpConfig * pConfig )
+	{
+		CAP_captura *  pCap ;
+		CAP_tpConfig   padrao ;
+		FLT_tpConfig   filtro ;
+		unsigned       tam[ CAP_NumFluxos ] ;
+		unsigned char *area ;
+		size_t         cabecalho ;
+		int            f , c ;
+
+		*ppCaptura = NULL ;
+
+		if ( pConfig == NULL )
+		{
+			CAP_ConfigPadrao( &padrao ) ;
+			pConfig = &padrao ;
+		}
+
+		if ( pConfig->fator == 0 || ! ( pConfig->taxaHz > 0.0f ) )
+		{
+			return CAP_CondRetError ;
+		}
+
+		/* Uma única alocação: a captura seguida dos dois anéis */
+
+		cabecalho = ( sizeof( CAP_captura ) + sizeof( uint64_t ) - 1 ) & ~( sizeof( uint64_t ) - 1 ) ;
+
+		for ( f = 0 ; f < CAP_NumFluxos ; f++ )
+		{
+			tam[ f ] = HST_CapacidadeAnel( pConfig->capacidade[ f ] ) ;
+		}
+
+		area = ( unsigned char * ) calloc( 1 , cabecalho + ( tam[ 0 ] + tam[ 1 ] ) * sizeof( CAP_tpAmostra ) ) ;
+
+		if ( area == NULL )
+		{
+			return CAP_CondRetError ;
+		}
+
+		pCap = ( CAP_captura * ) area ;
+
+		HST_IniciarAnel( &pCap->anel[ CAP_FluxoBruto ] , area + cabecalho , tam[ 0 ] , sizeof( CAP_tpAmostra ) ) ;
+		HST_IniciarAnel( &pCap->anel[ CAP_FluxoDecimado ] , area + cabecalho + tam[ 0 ] * sizeof( CAP_tpAmostra ) ,
+		                 tam[ 1 ] , sizeof( CAP_tpAmostra ) ) ;
+
+		/* Anti-aliasing: Butterworth de 4ª ordem = biquads com q 0,5412 e 1,3066 */
+
+		memset( &filtro , 0 , sizeof( filtro ) ) ;
+
+		if ( pConfig->fator > 1 )
+		{
+			filtro.taxaHz                = pConfig->taxaHz ;
+			filtro.numEstagios           = 2 ;
+			filtro.estagio[ 0 ].tipo     = FLT_PassaBaixa ;
+			filtro.estagio[ 0 ].freqHz   = 0.4f * pConfig->taxaHz / pConfig->fator ;
+			filtro.estagio[ 0 ].q        = 0.5412f ;
+			filtro.estagio[ 1 ]          = filtro.estagio[ 0 ] ;
+			filtro.estagio[ 1 ].q        = 1.3066f ;
+		}
+
+		for ( c = 0 ; c < CAP_CANAIS ; c++ )
+		{
+			FLT_IniciarCanal( &pCap->antiAlias[ c ] , &filtro ) ;
+		}
+
+		pCap->fator       = pConfig->fator ;
+		pCap->periodoUs   = ( hrt_abstime ) ( 1e6f / pConfig->taxaHz ) ;
+		pCap->prazoPollMs = pConfig->prazoPollMs ;
+
+		pCap->sensor_fd = orb_subscribe( ORB_ID( sensor_combined ) ) ;
+
+		if ( pCap->sensor_fd < 0 )
+		{
+			free( area ) ;
+			return CAP_CondRetError ;
+		}
+
+		orb_set_interval( pCap->sensor_fd , 0 ) ;
+
+		pCap->threadAtiva = 1 ;
+
+		if ( pthread_create( &pCap->thread , NULL , capturaContinua , pCap ) != 0 )
+		{
+			orb_unsubscribe( pCap->sensor_fd ) ;
+			free( area ) ;
+			return CAP_CondRetError ;
+		}
+
+		*ppCaptura = pCap ;
+
+		return CAP_CondRetOK ;
+	}
+
+/***************************************************************************
+*
+*  Função: CAP  &Terminar captura
+*  ****/
+
+	void CAP_Terminar( CAP_tpCaptura pCaptura )
+	{
+		if ( pCaptura == NULL )
+		{
+			return ;
+		}
+
+		pCaptura->threadAtiva = 0 ;
+		pthread_join( pCaptura->thread , NULL ) ;
+
+		orb_unsubscribe( pCaptura->sensor_fd ) ;
+
+		free( pCaptura ) ;
+	}
+
+/***************************************************************************
+*
+*  Função: CAP  &Ler amostras de um fluxo
+*  ****/
+
+	CAP_tpCondRet CAP_Ler( CAP_tpCaptura pCaptura , CAP_tpFluxo fluxo , uint32_t * pCursor ,
+	                       CAP_tpAmostra * pDestino , unsigned max , unsigned * pNum , uint32_t * pPerdidas )
+	{
+		if ( HST_LerAnel( &pCaptura->anel[ fluxo ] , pCursor , pDestino , max , pNum , pPerdidas ) != HST_CondRetOK )
+		{
+			return CAP_CondRetVazio ;
+		}
+
+		return CAP_CondRetOK ;
+	}
+
+/***************************************************************************
+*
+*  Função: CAP  &Obter contadores
+*  ****/
+
+	void CAP_ObterContadores( CAP_tpCaptura pCaptura , CAP_tpContadores * pContadores )
+	{
+		CAP_tpContadores * pOrigem = &pCaptura->contadores ;
+		int f ;
+
+		for ( f = 0 ; f < CAP_NumFluxos ; f++ )
+		{
+			pContadores->amostras[ f ] = __atomic_load_n( &pOrigem->amostras[ f ] , __ATOMIC_RELAXED ) ;
+		}
+
+		pContadores->repetidas       = __atomic_load_n( &pOrigem->repetidas       , __ATOMIC_RELAXED ) ;
+		pContadores->lacunas         = __atomic_load_n( &pOrigem->lacunas         , __ATOMIC_RELAXED ) ;
+		pContadores->prazosEsgotados = __atomic_load_n( &pOrigem->prazosEsgotados , __ATOMIC_RELAXED ) ;
+	}
+
+/*****  Código das funções encapsuladas no módulo  *****/
+
+	/***************************************************************************
+	*
+	*  Função: CAP  & Thread de captura
+	*
+	*  Único leitor da assinatura e único produtor dos anéis.
+	*  ****/
+
+	static void * capturaContinua( void *arg )
+	{
+		CAP_captura * pCap = ( CAP_captura * ) arg ;
+		struct pollfd fds ;
+
+		fds.fd     = pCap->sensor_fd ;
+		fds.events = POLLIN ;
+
+		while ( pCap->threadAtiva )
+		{
+			struct sensor_combined_s raw ;
+			CAP_tpAmostra amostra ;
+			int ret = poll( &fds , 1 , pCap->prazoPollMs ) ;
+
+			if ( ret <= 0 || ! ( fds.revents & POLLIN ) )
+			{
+				INCREMENTAR( pCap->contadores.prazosEsgotados ) ;
+				continue ;
+			}
+
+			orb_copy( ORB_ID( sensor_combined ) , pCap->sensor_fd , &raw ) ;
+
+			if ( raw.timestamp == pCap->ultimaOrigem )
+			{
+				INCREMENTAR( pCap->contadores.repetidas ) ;
+				continue ;
+			}
+
+			if ( pCap->ultimaOrigem != 0 && raw.timestamp - pCap->ultimaOrigem > pCap->periodoUs + pCap->periodoUs / 2 )
+			{
+				INCREMENTAR( pCap->contadores.lacunas ) ;
+			}
+
+			pCap->ultimaOrigem = raw.timestamp ;
+
+			amostra.timestamp = raw.timestamp ;
+			memcpy( amostra.acel , raw.accelerometer_m_s2 , sizeof( amostra.acel ) ) ;
+			memcpy( amostra.giro , raw.gyro_rad_s         , sizeof( amostra.giro ) ) ;
+
+			HST_InserirAnel( &pCap->anel[ CAP_FluxoBruto ] , &amostra ) ;
+			INCREMENTAR( pCap->contadores.amostras[ CAP_FluxoBruto ] ) ;
+
+			decimar( pCap , &amostra ) ;
+		}
+
+		return NULL ;
+	}
+
+	/***************************************************************************
+	*
+	*  Função: CAP  & Filtrar em taxa plena e guardar uma a cada 'fator'
+	*
+	*  O anti-aliasing roda em toda amostra (o estado do IIR depende
+	*  delas); só a inserção é decimada.
+	*  ****/
+
+	static void decimar( CAP_captura *pCap , const CAP_tpAmostra *pAmostra )
+	{
+		CAP_tpAmostra saida ;
+		int i ;
+
+		saida.timestamp = pAmostra->timestamp ;
+
+		for ( i = 0 ; i < 3 ; i++ )
+		{
+			saida.acel[ i ] = FLT_Filtrar( &pCap->antiAlias[ i ]     , pAmostra->acel[ i ] ) ;
+			saida.giro[ i ] = FLT_Filtrar( &pCap->antiAlias[ 3 + i ] , pAmostra->giro[ i ] ) ;
+		}
+
+		if ( ++pCap->fase < pCap->fator )
+		{
+			return ;
+		}
+
+		pCap->fase = 0 ;
+
+		HST_InserirAnel( &pCap->anel[ CAP_FluxoDecimado ] , &saida ) ;
+		INCREMENTAR( pCap->contadores.amostras[ CAP_FluxoDecimado ] ) ;
+	}
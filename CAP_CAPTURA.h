@@ -0,0 +1,203 @@
+#ifndef CAP_CAPTURA
+#define CAP_CAPTURA
+
+/**************************************************************************************************************************
+*$MCD Módulo de definição
+*	  Nome : 	                Captura em taxa plena do sensor_combined
+*	  Proprietário :         	Equipe AeroRio
+*	  Projeto :		            SAE AeroDesign Brasil 2014
+*	  Gestor :	 	            Alessandro Soares da Silva Junior
+* 	  Arquivo : 	            CAP_CAPTURA.H
+*	  Letras Identificadoras : 	CAP
+*	  Autor : 	                Alessandro Soares da Silva Junior
+*
+*$ED Descrição do módulo
+*	Consome todas as publicações do sensor_combined (aceleração e giro), para análise estrutural e de vibração, sem
+*   passar pelo intervalo das assinaturas do LER. A captura tem assinatura e thread próprias, de modo que o poll set
+*   e o ciclo de aquisição dos contextos LER não são afetados.
+*
+*   Cada amostra nova entra em dois anéis, alocados juntos numa única área em CAP_Iniciar:
+*
+*   	bruto      todas as amostras, na taxa do sensor
+*   	decimado   uma a cada 'fator' amostras, depois de um passa-baixa anti-aliasing de 4ª ordem (dois biquads
+*   	           Butterworth do módulo FLT) com corte em 80% da nova frequência de Nyquist
+*
+*   Há um único produtor (a thread da captura) e qualquer número de leitores, sem travas, no anel do HST: cada leitor
+*   guarda o seu cursor (número de sequência da próxima amostra) e CAP_Ler copia as amostras e confere que o
+*   produtor não as sobrescreveu durante a cópia. Um leitor que atrasa mais do que o anel perde as mais antigas.
+*
+*   O passa-baixa atrasa o fluxo decimado em relação ao bruto (cerca de 1,3 / corte segundos, em baixa frequência);
+*   o timestamp de uma amostra decimada é o da amostra bruta em que ela foi tomada.
+*
+***************************************************************************************************************************/
+
+#include <stdint.h>
+
+/***** Declarações exportadas pelo módulo *****/
+
+/* Tipo referência para uma captura */
+
+typedef struct CAP_captura * CAP_tpCaptura ;
+
+/***********************************************************************
+*
+*  $TC Tipo de dados: CAP Condições de retorno
+*
+***********************************************************************/
+
+   typedef enum {
+
+         CAP_CondRetOK            ,
+              /* Executou corretamente                               */
+         CAP_CondRetError         ,
+              /* Configuração inválida, falta de memória ou uORB     */
+         CAP_CondRetVazio         ,
+              /* Não há amostras novas para o cursor                 */
+
+} CAP_tpCondRet ;
+
+/***********************************************************************
+*
+*  $TC Tipo de dados: CAP Fluxo de amostras
+*
+***********************************************************************/
+
+   typedef enum {
+
+         CAP_FluxoBruto       ,      /* Taxa plena do sensor           */
+         CAP_FluxoDecimado    ,      /* Taxa do sensor / fator         */
+         CAP_NumFluxos
+
+} CAP_tpFluxo ;
+
+/***********************************************************************
+*
+*  $TC Tipo de dados: CAP Amostra
+*
+***********************************************************************/
+
+   typedef struct {
+
+         uint64_t timestamp  ;
+              /* timestamp do sensor_combined (giro), em µs      */
+         float    acel[ 3 ]  ;
+              /* accelerometer_m_s2                              */
+         float    giro[ 3 ]  ;
+              /* gyro_rad_s                                      */
+
+} CAP_tpAmostra ;
+
+/***********************************************************************
+*
+*  $TC Tipo de dados: CAP Configuração
+*
+***********************************************************************/
+
+   typedef struct {
+
+         unsigned capacidade[ CAP_NumFluxos ] ;
+              /* Amostras de cada anel; arredondado para potência de 2 */
+         unsigned fator                       ;
+              /* Decimação (1 = fluxo decimado igual ao bruto)          */
+         float    taxaHz                      ;
+              /* Taxa nominal do sensor_combined, para o anti-aliasing  */
+         int      prazoPollMs                 ;
+              /* Espera máxima do poll da thread de captura             */
+
+} CAP_tpConfig ;
+
+/***********************************************************************
+*
+*  $TC Tipo de dados: CAP Contadores
+*
+***********************************************************************/
+
+   typedef struct {
+
+         uint32_t amostras[ CAP_NumFluxos ] ;
+              /* Amostras inseridas em cada anel                  */
+         uint32_t repetidas                 ;
+              /* Cópias sem timestamp novo                        */
+         uint32_t lacunas                   ;
+              /* Intervalos maiores que 1,5 período nominal: o    */
+              /* uORB guarda só a última publicação               */
+         uint32_t prazosEsgotados           ;
+
+} CAP_tpContadores ;
+
+/***********************************************************************
+*
+*  $FC Função: CAP  &Configuração padrão
+*
+*  $ED Descrição da função
+*     Anéis de 4096 e 1024 amostras, sensor a 250 Hz decimado por 5
+*     (50 Hz) e poll de 100 ms.
+*
+***********************************************************************/
+
+void CAP_ConfigPadrao( CAP_tpConfig * pConfig ) ;
+
+/***********************************************************************
+*
+*  $FC Função: CAP  &Iniciar captura
+*
+*  $ED Descrição da função
+*     Aloca os anéis, calcula o anti-aliasing, assina o sensor_combined
+*     sem intervalo e dispara a thread de captura. Nenhuma memória é
+*     alocada depois disso.
+*
+*  $EP Parâmetros
+*    ppCaptura  - Recebe a captura (NULL em caso de erro)
+*    pConfig    - NULL equivale a CAP_ConfigPadrao
+*
+*  $FV Valor retornado
+*     CAP_CondRetOK ou CAP_CondRetError.
+*
+***********************************************************************/
+
+CAP_tpCondRet CAP_Iniciar( CAP_tpCaptura * ppCaptura , const CAP_tpConfig * pConfig ) ;
+
+/***********************************************************************
+*
+*  $FC Função: CAP  &Terminar captura
+*
+*  $ED Descrição da função
+*     Para a thread, cancela a assinatura e libera a área. Nenhum leitor
+*     pode estar usando a captura.
+*
+***********************************************************************/
+
+void CAP_Terminar( CAP_tpCaptura pCaptura ) ;
+
+/***********************************************************************
+*
+*  $FC Função: CAP  &Ler amostras de um fluxo
+*
+*  $ED Descrição da função
+*     Copia as amostras a partir do cursor e o avança. Se o cursor
+*     ficou para trás do anel, começa pela amostra mais antiga ainda
+*     válida e informa quantas foram perdidas.
+*
+*  $EP Parâmetros
+*    pCursor     - Sequência da próxima amostra; 0 na primeira leitura
+*    pDestino    - Vetor com espaço para 'max' amostras
+*    pNum        - Recebe o número de amostras copiadas
+*    pPerdidas   - Recebe as amostras puladas (pode ser NULL)
+*
+*  $FV Valor retornado
+*     CAP_CondRetOK ou CAP_CondRetVazio.
+*
+***********************************************************************/
+
+CAP_tpCondRet CAP_Ler( CAP_tpCaptura pCaptura , CAP_tpFluxo fluxo , uint32_t * pCursor ,
+                       CAP_tpAmostra * pDestino , unsigned max , unsigned * pNum , uint32_t * pPerdidas ) ;
+
+/***********************************************************************
+*
+*  $FC Função: CAP  &Obter contadores
+*
+***********************************************************************/
+
+void CAP_ObterContadores( CAP_tpCaptura pCaptura , CAP_tpContadores * pContadores ) ;
+
+#endif
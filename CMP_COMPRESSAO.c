@@ -0,0 +1,406 @@
+/***************************************************************************
+*  $MCI Módulo de implementação: CMP Compressão de amostras do registro de voo
+*
+*  Arquivo gerado:              CMP_COMPRESSAO.c
+*  Letras identificadoras:      CMP
+*
+*
+*  Projeto: SAE AeroDesign Brasil 2014
+*  Gestor:  Alessandro Soares da Silva Junior
+*  Autores: Alessandro Soares da Silva Junior
+*
+*
+***************************************************************************/
+
+#ifndef _STRING
+#define _STRING
+#include <string.h>
+#endif
+
+#ifndef _MATH
+#define _MATH
+#include <math.h>
+#endif
+
+#define CMP_COMPRESSAO_OWN
+#include "CMP_COMPRESSAO.h"
+#undef CMP_COMPRESSAO_OWN
+
+/***** Protótipos das funções encapuladas no módulo *****/
+
+	static unsigned  escreverVarint  ( unsigned char * p , uint64_t valor )                              ;
+	static int       lerVarint       ( const unsigned char ** pp , const unsigned char * fim , uint64_t * pValor ) ;
+	static int32_t   quantizar       ( float valor , float escala )                                      ;
+
+/*****  Código das funções exportadas pelo módulo  *****/
+
+/***************************************************************************
+*
+*  Função: CMP  &Configuração padrão
+*  ****/
+
+	void CMP_ConfigPadrao( CMP_tpConfig * pConfig )
+	{
+		pConfig->resolucao[ LER_CampoPressao    ] = 0.01f  ;
+		pConfig->resolucao[ LER_CampoPitchSpeed ] = 0.01f  ;
+		pConfig->resolucao[ LER_CampoRollSpeed  ] = 0.01f  ;
+		pConfig->resolucao[ LER_CampoYawSpeed   ] = 0.01f  ;
+		pConfig->resolucao[ LER_CampoPitch      ] = 0.01f  ;
+		pConfig->resolucao[ LER_CampoRoll       ] = 0.01f  ;
+		pConfig->resolucao[ LER_CampoYaw        ] = 0.01f  ;
+		pConfig->resolucao[ LER_CampoAx         ] = 0.001f ;
+		pConfig->resolucao[ LER_CampoAy         ] = 0.001f ;
+		pConfig->resolucao[ LER_CampoAz         ] = 0.001f ;
+		pConfig->resolucao[ LER_CampoAltura     ] = 0.01f  ;
+	}
+
+/***************************************************************************
+*
+*  Função: CMP  &Iniciar bloco
+*  ****/
+
+	void CMP_IniciarBloco( CMP_tpCodificador * pCod , const CMP_tpConfig * pConfig ,
+	                       unsigned char * bloco , unsigned capacidade , uint64_t primeiraAmostra )
+	{
+		int i ;
+
+		pCod->bloco           = bloco             ;
+		pCod->capacidade      = capacidade        ;
+		pCod->usado           = CMP_TAM_CABECALHO ;
+		pCod->numAmostras     = 0                 ;
+		pCod->primeiraAmostra = primeiraAmostra   ;
+		pCod->tsAnterior      = 0                 ;
+
+		for ( i = 0 ; i < LER_NumCampos ; i++ )
+		{
+			pCod->anterior[ i ] = 0 ;
+			pCod->escala[ i ]   = 1.0f / pConfig->resolucao[ i ] ;
+		}
+
+		memset( pCod->origemAnterior , 0 , sizeof( pCod->origemAnterior ) ) ;
+	}
+
+/***************************************************************************
+*
+*  Função: CMP  &Acrescentar amostra
+*  ****/
+
+	CMP_tpCondRet CMP_Acrescentar( CMP_tpCodificador * pCod , const LER_tpAmostra * pAmostra )
+	{
+		unsigned char tmp[ CMP_MAX_BYTES_AMOSTRA ] ;
+		int32_t q[ LER_NumCampos ] ;
+		uint32_t mudaram = 0 ;
+		unsigned n ;
+		int i ;
+
+		/* Codifica fora do bloco: se não couber, o codificador fica intacto */
+
+		n  = escreverVarint( tmp , pAmostra->timestamp - pCod->tsAnterior ) ;
+		n += escreverVarint( tmp + n , ( uint64_t ) ( pAmostra->validos | ( pAmostra->novos << LER_NumGrupos ) ) ) ;
+
+		for ( i = 0 ; i < LER_NumCampos ; i++ )
+		{
+			int64_t delta ;
+
+			q[ i ] = quantizar( pAmostra->valor[ i ] , pCod->escala[ i ] ) ;
+			delta  = ( int64_t ) q[ i ] - pCod->anterior[ i ] ;
+
+			n += escreverVarint( tmp + n , ( ( uint64_t ) delta << 1 ) ^ ( uint64_t ) ( delta >> 63 ) ) ;
+		}
+
+		/* Origens: só as que mudaram desde a amostra anterior do bloco,
+		   como distância ao timestamp (em geral menos que um período) */
+
+		for ( i = 0 ; i < LER_NumGrupos ; i++ )
+		{
+			if ( pCod->numAmostras == 0 || pAmostra->origem[ i ] != pCod->origemAnterior[ i ] )
+			{
+				mudaram |= LER_MASCARA_GRUPO( i ) ;
+			}
+		}
+
+		n += escreverVarint( tmp + n , mudaram ) ;
+
+		for ( i = 0 ; i < LER_NumGrupos ; i++ )
+		{
+			if ( mudaram & LER_MASCARA_GRUPO( i ) )
+			{
+				int64_t idade = ( int64_t ) ( pAmostra->timestamp - pAmostra->origem[ i ] ) ;
+
+				n += escreverVarint( tmp + n , ( ( uint64_t ) idade << 1 ) ^ ( uint64_t ) ( idade >> 63 ) ) ;
+			}
+		}
+
+		if ( pCod->usado + n > pCod->capacidade || pCod->numAmostras == 0xFFFFu )
+		{
+			return CMP_CondRetCheio ;
+		}
+
+		memcpy( pCod->bloco + pCod->usado , tmp , n ) ;
+		memcpy( pCod->anterior , q , sizeof( q ) ) ;
+		memcpy( pCod->origemAnterior , pAmostra->origem , sizeof( pCod->origemAnterior ) ) ;
+
+		if ( pCod->numAmostras == 0 )
+		{
+			memcpy( pCod->bloco + 16 , &pAmostra->timestamp , 8 ) ;
+		}
+
+		pCod->usado      += n ;
+		pCod->tsAnterior  = pAmostra->timestamp ;
+		pCod->numAmostras ++ ;
+
+		return CMP_CondRetOK ;
+	}
+
+/***************************************************************************
+*
+*  Função: CMP  &Fechar bloco
+*  ****/
+
+	unsigned CMP_FecharBloco( CMP_tpCodificador * pCod )
+	{
+		uint16_t num    = ( uint16_t ) pCod->numAmostras ;
+		uint16_t usado  = ( uint16_t ) pCod->usado ;
+		uint32_t opcoes = CMP_OPCAO_ORIGENS ;
+
+		memcpy( pCod->bloco     , &num                   , 2 ) ;
+		memcpy( pCod->bloco + 2 , &usado                 , 2 ) ;
+		memcpy( pCod->bloco + 4 , &opcoes                , 4 ) ;
+		memcpy( pCod->bloco + 8 , &pCod->primeiraAmostra , 8 ) ;
+
+		if ( pCod->numAmostras == 0 )
+		{
+			memset( pCod->bloco + 16 , 0 , 8 ) ;
+		}
+
+		memset( pCod->bloco + pCod->usado , 0 , pCod->capacidade - pCod->usado ) ;
+
+		return pCod->usado ;
+	}
+
+/***************************************************************************
+*
+*  Função: CMP  &Número de amostras no bloco em construção
+*  ****/
+
+	unsigned CMP_NumAmostras( const CMP_tpCodificador * pCod )
+	{
+		return pCod->numAmostras ;
+	}
+
+/***************************************************************************
+*
+*  Função: CMP  &Ler cabeçalho de um bloco
+*  ****/
+
+	CMP_tpCondRet CMP_LerCabecalho( const unsigned char * bloco , unsigned tam ,
+	                                unsigned * pNum , uint64_t * pPrimeira , uint64_t * pTs )
+	{
+		uint16_t num , usado ;
+
+		if ( tam < CMP_TAM_CABECALHO )
+		{
+			return CMP_CondRetCorrompido ;
+		}
+
+		memcpy( &num      , bloco      , 2 ) ;
+		memcpy( &usado    , bloco + 2  , 2 ) ;
+		memcpy( pPrimeira , bloco + 8  , 8 ) ;
+		memcpy( pTs       , bloco + 16 , 8 ) ;
+
+		if ( usado < CMP_TAM_CABECALHO || usado > tam ||
+		     ( unsigned ) num * CMP_MIN_BYTES_AMOSTRA > ( unsigned ) usado - CMP_TAM_CABECALHO )
+		{
+			return CMP_CondRetCorrompido ;
+		}
+
+		*pNum = num ;
+
+		return CMP_CondRetOK ;
+	}
+
+/***************************************************************************
+*
+*  Função: CMP  &Decodificar bloco
+*  ****/
+
+	CMP_tpCondRet CMP_DecodificarBloco( const CMP_tpConfig * pConfig , const unsigned char * bloco , unsigned tam ,
+	                                    LER_tpAmostra * pDestino , unsigned capacidade , unsigned * pNum )
+	{
+		const unsigned char * p , * fim ;
+		int32_t  anterior[ LER_NumCampos ] = { 0 } ;
+		uint64_t origem[ LER_NumGrupos ] = { 0 } ;
+		uint64_t ts = 0 , primeira , tsPrimeira ;
+		unsigned num , usado , k ;
+		uint16_t usado16 ;
+		uint32_t opcoes ;
+		int i ;
+
+		*pNum = 0 ;
+
+		if ( CMP_LerCabecalho( bloco , tam , &num , &primeira , &tsPrimeira ) != CMP_CondRetOK || num > capacidade )
+		{
+			return CMP_CondRetCorrompido ;
+		}
+
+		memcpy( &usado16 , bloco + 2 , 2 ) ;
+		memcpy( &opcoes  , bloco + 4 , 4 ) ;
+		usado = usado16 ;
+
+		p   = bloco + CMP_TAM_CABECALHO ;
+		fim = bloco + usado ;
+
+		for ( k = 0 ; k < num ; k++ )
+		{
+			LER_tpAmostra * pAmostra = &pDestino[ k ] ;
+			uint32_t mudaram ;
+			uint64_t v ;
+
+			if ( ! lerVarint( &p , fim , &v ) )
+			{
+				return CMP_CondRetCorrompido ;
+			}
+
+			ts += v ;
+			pAmostra->timestamp = ts ;
+
+			if ( ! lerVarint( &p , fim , &v ) )
+			{
+				return CMP_CondRetCorrompido ;
+			}
+
+			pAmostra->validos = ( uint32_t ) v & LER_TODOS_GRUPOS ;
+			pAmostra->novos   = ( uint32_t ) ( v >> LER_NumGrupos ) & LER_TODOS_GRUPOS ;
+
+			for ( i = 0 ; i < LER_NumCampos ; i++ )
+			{
+				if ( ! lerVarint( &p , fim , &v ) )
+				{
+					return CMP_CondRetCorrompido ;
+				}
+
+				anterior[ i ] = ( int32_t ) ( anterior[ i ] + ( int64_t ) ( ( v >> 1 ) ^ ( ~( v & 1 ) + 1 ) ) ) ;
+				pAmostra->valor[ i ] = ( float ) anterior[ i ] * pConfig->resolucao[ i ] ;
+			}
+
+			if ( ! ( opcoes & CMP_OPCAO_ORIGENS ) )
+			{
+				for ( i = 0 ; i < LER_NumGrupos ; i++ )
+				{
+					pAmostra->origem[ i ] = ts ;
+				}
+
+				continue ;
+			}
+
+			if ( ! lerVarint( &p , fim , &v ) || ( v & ~( uint64_t ) LER_TODOS_GRUPOS ) != 0 )
+			{
+				return CMP_CondRetCorrompido ;
+			}
+
+			mudaram = ( uint32_t ) v ;
+
+			for ( i = 0 ; i < LER_NumGrupos ; i++ )
+			{
+				if ( mudaram & LER_MASCARA_GRUPO( i ) )
+				{
+					if ( ! lerVarint( &p , fim , &v ) )
+					{
+						return CMP_CondRetCorrompido ;
+					}
+
+					origem[ i ] = ts - ( uint64_t ) ( ( v >> 1 ) ^ ( ~( v & 1 ) + 1 ) ) ;
+				}
+
+				pAmostra->origem[ i ] = origem[ i ] ;
+			}
+		}
+
+		if ( p != fim || ( num > 0 && pDestino[ 0 ].timestamp != tsPrimeira ) )
+		{
+			return CMP_CondRetCorrompido ;
+		}
+
+		*pNum = num ;
+
+		return CMP_CondRetOK ;
+	}
+
+/*****  Código das funções encapsuladas no módulo  *****/
+
+	/***************************************************************************
+	*
+	*  Função: CMP  & Escrever varint (LEB128); retorna os bytes escritos
+	*  ****/
+
+	static unsigned escreverVarint( unsigned char * p , uint64_t valor )
+	{
+		unsigned n = 0 ;
+
+		while ( valor >= 0x80 )
+		{
+			p[ n++ ] = ( unsigned char ) ( valor | 0x80 ) ;
+			valor >>= 7 ;
+		}
+
+		p[ n++ ] = ( unsigned char ) valor ;
+
+		return n ;
+	}
+
+	/***************************************************************************
+	*
+	*  Função: CMP  & Ler varint sem passar de 'fim'; retorna 0 se inválido
+	*  ****/
+
+	static int lerVarint( const unsigned char ** pp , const unsigned char * fim , uint64_t * pValor )
+	{
+		const unsigned char * p = *pp ;
+		uint64_t valor = 0 ;
+		unsigned desloc = 0 ;
+
+		while ( p < fim && desloc < 64 )
+		{
+			unsigned char b = *p++ ;
+
+			valor |= ( uint64_t ) ( b & 0x7F ) << desloc ;
+
+			if ( ( b & 0x80 ) == 0 )
+			{
+				*pp     = p     ;
+				*pValor = valor ;
+				return 1 ;
+			}
+
+			desloc += 7 ;
+		}
+
+		return 0 ;
+	}
+
+	/***************************************************************************
+	*
+	*  Função: CMP  & Quantizar com saturação (NaN vira zero)
+	*  ****/
+
+	static int32_t quantizar( float valor , float escala )
+	{
+		float x = valor * escala ;
+
+		if ( x != x )
+		{
+			return 0 ;
+		}
+
+		if ( x >= 2147483520.0f )
+		{
+			return INT32_MAX ;
+		}
+
+		if ( x <= -2147483520.0f )
+		{
+			return INT32_MIN ;
+		}
+
+		return ( int32_t ) lrintf( x ) ;
+	}
@@ -0,0 +1,206 @@
+#ifndef CMP_COMPRESSAO
+#define CMP_COMPRESSAO
+
+/**************************************************************************************************************************
+*$MCD Módulo de definição
+*	  Nome : 	                Compressão de amostras do registro de voo
+*	  Proprietário :         	Equipe AeroRio
+*	  Projeto :		            SAE AeroDesign Brasil 2014
+*	  Gestor :	 	            Alessandro Soares da Silva Junior
+* 	  Arquivo : 	            CMP_COMPRESSAO.H
+*	  Letras Identificadoras : 	CMP
+*	  Autor : 	                Alessandro Soares da Silva Junior
+*
+*$ED Descrição do módulo
+*	Codifica sequências de LER_tpAmostra em blocos compactos e independentes: cada bloco pode ser decodificado
+*   sozinho, de modo que um bloco corrompido no cartão só perde as suas amostras e a leitura pode começar em
+*   qualquer bloco.
+*
+*   Cada campo é quantizado com a resolução configurada (valor = inteiro * resolução) e gravado como a diferença
+*   para a amostra anterior do mesmo bloco, em zigzag + varint (LEB128). Parâmetros que variam devagar, como a
+*   pressão e a altura, ocupam 1 byte por amostra. O timestamp é gravado como diferença em µs, também em varint.
+*
+*   Formato do bloco (little-endian):
+*
+*   	cabeçalho  24 bytes   amostras (u16), bytes usados (u16), opções (u32), número da primeira amostra
+*   	                      no registro (u64), timestamp da primeira amostra (u64)
+*   	amostras              varint(Δtimestamp), varint(válidos | novos << LER_NumGrupos),
+*   	                      LER_NumCampos x varint(zigzag(Δcampo quantizado)),
+*   	                      com CMP_OPCAO_ORIGENS: varint(grupos cuja origem mudou) e, para cada um deles,
+*   	                      varint(zigzag(timestamp - origem))
+*
+*   A primeira amostra do bloco usa diferenças contra zero, e a origem de todos os grupos conta como mudada.
+*   Blocos sem CMP_OPCAO_ORIGENS (gravados antes dela) são lidos com a origem de todos os grupos igual ao
+*   timestamp da amostra.
+*
+***************************************************************************************************************************/
+
+#include "LER_PARAMETROS.h"
+
+/***** Declarações exportadas pelo módulo *****/
+
+#define CMP_TAM_CABECALHO      24
+#define CMP_OPCAO_ORIGENS      0x1u                             /* Opção: origem de cada grupo      */
+#define CMP_MAX_BYTES_AMOSTRA  ( 10 + 2 + 5 * LER_NumCampos + 1 + 10 * LER_NumGrupos )
+                                                                /* Pior caso de uma amostra         */
+#define CMP_MIN_BYTES_AMOSTRA  ( 2 + LER_NumCampos )            /* Melhor caso, sem origens         */
+
+/* Número máximo de amostras num bloco de 'tam' bytes */
+
+#define CMP_MAX_AMOSTRAS( tam )  ( ( ( tam ) - CMP_TAM_CABECALHO ) / CMP_MIN_BYTES_AMOSTRA )
+
+/***********************************************************************
+*
+*  $TC Tipo de dados: CMP Condições de retorno
+*
+***********************************************************************/
+
+   typedef enum {
+
+         CMP_CondRetOK            ,
+              /* Executou corretamente                               */
+         CMP_CondRetCheio         ,
+              /* A amostra não cabe no bloco; nada foi alterado      */
+         CMP_CondRetCorrompido    ,
+              /* O bloco não pôde ser decodificado                   */
+
+} CMP_tpCondRet ;
+
+/***********************************************************************
+*
+*  $TC Tipo de dados: CMP Configuração
+*
+*  $ED Descrição do tipo
+*     Resolução de quantização de cada campo, na unidade do campo. O
+*     erro após decodificar é no máximo metade da resolução. Valores
+*     cujo quociente não cabe em 32 bits são saturados.
+*
+***********************************************************************/
+
+   typedef struct {
+
+         float resolucao[ LER_NumCampos ] ;
+
+} CMP_tpConfig ;
+
+/***********************************************************************
+*
+*  $TC Tipo de dados: CMP Codificador de um bloco
+*
+*  $ED Descrição do tipo
+*     Estado do bloco em construção. Os campos são internos ao módulo;
+*     o tipo é exportado apenas para que o chamador possa alocá-lo.
+*
+***********************************************************************/
+
+   typedef struct {
+
+         unsigned char * bloco                       ;
+         unsigned        capacidade                  ;
+         unsigned        usado                       ;
+         unsigned        numAmostras                 ;
+         uint64_t        primeiraAmostra             ;
+         uint64_t        tsAnterior                  ;
+         int32_t         anterior[ LER_NumCampos ]   ;
+         uint64_t        origemAnterior[ LER_NumGrupos ] ;
+         float           escala[ LER_NumCampos ]     ;
+              /* 1 / resolução                                   */
+
+} CMP_tpCodificador ;
+
+/***********************************************************************
+*
+*  $FC Função: CMP  &Configuração padrão
+*
+*  $ED Descrição da função
+*     0,01 mbar, 0,01 º/s, 0,01 º, 0,001 m/s² e 1 cm.
+*
+***********************************************************************/
+
+void CMP_ConfigPadrao( CMP_tpConfig * pConfig ) ;
+
+/***********************************************************************
+*
+*  $FC Função: CMP  &Iniciar bloco
+*
+*  $EP Parâmetros
+*    bloco            - Memória do bloco
+*    capacidade       - Tamanho do bloco em bytes (até 65535)
+*    primeiraAmostra  - Número, no registro, da primeira amostra do bloco
+*
+***********************************************************************/
+
+void CMP_IniciarBloco( CMP_tpCodificador * pCod , const CMP_tpConfig * pConfig ,
+                       unsigned char * bloco , unsigned capacidade , uint64_t primeiraAmostra ) ;
+
+/***********************************************************************
+*
+*  $FC Função: CMP  &Acrescentar amostra
+*
+*  $FV Valor retornado
+*     CMP_CondRetOK ou CMP_CondRetCheio (fechar o bloco e iniciar outro).
+*
+***********************************************************************/
+
+CMP_tpCondRet CMP_Acrescentar( CMP_tpCodificador * pCod , const LER_tpAmostra * pAmostra ) ;
+
+/***********************************************************************
+*
+*  $FC Função: CMP  &Fechar bloco
+*
+*  $ED Descrição da função
+*     Escreve o cabeçalho e zera o restante do bloco.
+*
+*  $FV Valor retornado
+*     Bytes usados pelo bloco, cabeçalho incluído.
+*
+***********************************************************************/
+
+unsigned CMP_FecharBloco( CMP_tpCodificador * pCod ) ;
+
+/***********************************************************************
+*
+*  $FC Função: CMP  &Número de amostras no bloco em construção
+*
+***********************************************************************/
+
+unsigned CMP_NumAmostras( const CMP_tpCodificador * pCod ) ;
+
+/***********************************************************************
+*
+*  $FC Função: CMP  &Ler cabeçalho de um bloco
+*
+*  $EP Parâmetros
+*    pNum       - Recebe o número de amostras
+*    pPrimeira  - Recebe o número da primeira amostra no registro
+*    pTs        - Recebe o timestamp da primeira amostra
+*
+*  $FV Valor retornado
+*     CMP_CondRetOK ou CMP_CondRetCorrompido.
+*
+***********************************************************************/
+
+CMP_tpCondRet CMP_LerCabecalho( const unsigned char * bloco , unsigned tam ,
+                                unsigned * pNum , uint64_t * pPrimeira , uint64_t * pTs ) ;
+
+/***********************************************************************
+*
+*  $FC Função: CMP  &Decodificar bloco
+*
+*  $EP Parâmetros
+*    bloco       - Bloco fechado por CMP_FecharBloco
+*    tam         - Bytes disponíveis em 'bloco'
+*    pDestino    - Vetor para as amostras
+*    capacidade  - Tamanho de pDestino (CMP_MAX_AMOSTRAS( tam ) sempre
+*                  basta)
+*    pNum        - Recebe o número de amostras decodificadas
+*
+*  $FV Valor retornado
+*     CMP_CondRetOK ou CMP_CondRetCorrompido.
+*
+***********************************************************************/
+
+CMP_tpCondRet CMP_DecodificarBloco( const CMP_tpConfig * pConfig , const unsigned char * bloco , unsigned tam ,
+                                    LER_tpAmostra * pDestino , unsigned capacidade , unsigned * pNum ) ;
+
+#endif
@@ -0,0 +1,419 @@
+/***************************************************************************
+*  $MCI Módulo de implementação: ESP Espectro de vibração do acelerômetro
+*
+*  Arquivo gerado:              ESP_ESPECTRO.c
+*  Letras identificadoras:      ESP
+*
+*
+*  Projeto: SAE AeroDesign Brasil 2014
+*  Gestor:  Alessandro Soares da Silva Junior
+*  Autores: Alessandro Soares da Silva Junior
+*
+*
+***************************************************************************/
+
+#ifndef _STRING
+#define _STRING
+#include <string.h>
+#endif
+
+#ifndef _MATH
+#define _MATH
+#include <math.h>
+#endif
+
+#define ESP_ESPECTRO_OWN
+#include "ESP_ESPECTRO.h"
+#undef ESP_ESPECTRO_OWN
+
+#define ESP_PI  3.14159265358979323846
+
+/***** Protótipos das funções encapuladas no módulo *****/
+
+	static void  processarJanela  ( ESP_tpAnalisador * pAnalisador )                              ;
+	static void  carregarEixo     ( ESP_tpAnalisador * pAnalisador , int eixo , float * destino ) ;
+	static void  publicar         ( ESP_tpAnalisador * pAnalisador )                              ;
+	static void  buscarPicos      ( const float * psd , float resolucao , ESP_tpPico * pPicos )    ;
+
+/*****  Código das funções exportadas pelo módulo  *****/
+
+/***************************************************************************
+*
+*  Função: ESP  &Configuração padrão
+*  ****/
+
+	void ESP_ConfigPadrao( ESP_tpConfig * pConfig )
+	{
+		static const float bandas[ 4 ][ 2 ] = { { 1.0f , 10.0f } , { 10.0f , 30.0f } , { 30.0f , 60.0f } , { 60.0f , 125.0f } } ;
+
+		memset( pConfig , 0 , sizeof( *pConfig ) ) ;
+
+		pConfig->taxaHz       = 250.0f ;
+		pConfig->janelasMedia = 8 ;
+		pConfig->numBandas    = 4 ;
+
+		memcpy( pConfig->bandaHz , bandas , sizeof( bandas ) ) ;
+	}
+
+/***************************************************************************
+*
+*  Função: ESP  &Iniciar analisador
+*  ****/
+
+	ESP_tpCondRet ESP_Iniciar( ESP_tpAnalisador * pAnalisador , const ESP_tpConfig * pConfig )
+	{
+		double somaQ = 0.0 ;
+		unsigned i , b ;
+
+		if ( ! ( pConfig->taxaHz > 0.0f ) || pConfig->janelasMedia == 0 || pConfig->numBandas > ESP_MAX_BANDAS )
+		{
+			return ESP_CondRetConfig ;
+		}
+
+		for ( b = 0 ; b < pConfig->numBandas ; b++ )
+		{
+			if ( ! ( pConfig->bandaHz[ b ][ 0 ] >= 0.0f ) || ! ( pConfig->bandaHz[ b ][ 1 ] > pConfig->bandaHz[ b ][ 0 ] ) )
+			{
+				return ESP_CondRetConfig ;
+			}
+		}
+
+		memset( pAnalisador , 0 , sizeof( *pAnalisador ) ) ;
+
+		pAnalisador->config = *pConfig ;
+
+		/* Hann periódica, adequada à sobreposição de 50% */
+
+		for ( i = 0 ; i < ESP_TAM_JANELA ; i++ )
+		{
+			double w = 0.5 - 0.5 * cos( 2.0 * ESP_PI * i / ESP_TAM_JANELA ) ;
+			unsigned r = 0 , k ;
+
+			pAnalisador->hann[ i ] = ( float ) w ;
+			somaQ += w * w ;
+
+			for ( k = 0 ; k < ESP_LOG2_JANELA ; k++ )
+			{
+				r |= ( ( i >> k ) & 1u ) << ( ESP_LOG2_JANELA - 1 - k ) ;
+			}
+
+			pAnalisador->inverso[ i ] = ( uint16_t ) r ;
+		}
+
+		for ( i = 0 ; i < ESP_TAM_JANELA / 2 ; i++ )
+		{
+			pAnalisador->cosseno[ i ] = ( float ) cos( 2.0 * ESP_PI * i / ESP_TAM_JANELA ) ;
+			pAnalisador->seno[ i ]    = ( float ) sin( 2.0 * ESP_PI * i / ESP_TAM_JANELA ) ;
+		}
+
+		pAnalisador->escala = ( float ) ( 2.0 / ( pConfig->taxaHz * somaQ ) ) ;
+
+		pAnalisador->resultado.resolucaoHz = pConfig->taxaHz / ESP_TAM_JANELA ;
+
+		return ESP_CondRetOK ;
+	}
+
+/***************************************************************************
+*
+*  Função: ESP  &Acrescentar amostra
+*  ****/
+
+	int ESP_Acrescentar( ESP_tpAnalisador * pAnalisador , uint64_t timestamp , const float acel[ ESP_NUM_EIXOS ] )
+	{
+		unsigned pos = pAnalisador->posicao ;
+		int e ;
+
+		for ( e = 0 ; e < ESP_NUM_EIXOS ; e++ )
+		{
+			pAnalisador->recentes[ e ][ pos ] = acel[ e ] ;
+		}
+
+		pAnalisador->posicao  = ( pos + 1 ) & ( ESP_TAM_JANELA - 1 ) ;
+		pAnalisador->ultimoTs = timestamp ;
+		pAnalisador->desdeJanela ++ ;
+
+		if ( pAnalisador->total < ESP_TAM_JANELA )
+		{
+			pAnalisador->total ++ ;
+		}
+
+		if ( pAnalisador->total < ESP_TAM_JANELA || pAnalisador->desdeJanela < ESP_TAM_JANELA / 2 )
+		{
+			return 0 ;
+		}
+
+		pAnalisador->desdeJanela = 0 ;
+
+		processarJanela( pAnalisador ) ;
+
+		if ( pAnalisador->janelas < pAnalisador->config.janelasMedia )
+		{
+			return 0 ;
+		}
+
+		publicar( pAnalisador ) ;
+
+		return 1 ;
+	}
+
+/***************************************************************************
+*
+*  Função: ESP  &Marcar descontinuidade
+*  ****/
+
+	void ESP_Descontinuidade( ESP_tpAnalisador * pAnalisador )
+	{
+		pAnalisador->total       = 0 ;
+		pAnalisador->desdeJanela = 0 ;
+	}
+
+/***************************************************************************
+*
+*  Função: ESP  &Obter resultado
+*  ****/
+
+	ESP_tpCondRet ESP_ObterResultado( const ESP_tpAnalisador * pAnalisador , ESP_tpResultado * pResultado )
+	{
+		if ( pAnalisador->resultado.numResultado == 0 )
+		{
+			return ESP_CondRetVazio ;
+		}
+
+		*pResultado = pAnalisador->resultado ;
+
+		return ESP_CondRetOK ;
+	}
+
+/***************************************************************************
+*
+*  Função: ESP  &Transformar
+*  ****/
+
+	void ESP_Transformar( const ESP_tpAnalisador * pAnalisador , float * re , float * im )
+	{
+		unsigned i , tam ;
+
+		for ( i = 0 ; i < ESP_TAM_JANELA ; i++ )
+		{
+			unsigned j = pAnalisador->inverso[ i ] ;
+
+			if ( i < j )
+			{
+				float t ;
+
+				t = re[ i ] ; re[ i ] = re[ j ] ; re[ j ] = t ;
+				t = im[ i ] ; im[ i ] = im[ j ] ; im[ j ] = t ;
+			}
+		}
+
+		/* Borboletas radix-2 com decimação no tempo; W = cos - i sen */
+
+		for ( tam = 2 ; tam <= ESP_TAM_JANELA ; tam <<= 1 )
+		{
+			unsigned meio  = tam / 2 ;
+			unsigned passo = ESP_TAM_JANELA / tam ;
+			unsigned ini , k ;
+
+			for ( ini = 0 ; ini < ESP_TAM_JANELA ; ini += tam )
+			{
+				for ( k = 0 ; k < meio ; k++ )
+				{
+					float wr = pAnalisador->cosseno[ k * passo ] ;
+					float wi = pAnalisador->seno[ k * passo ] ;
+					unsigned a = ini + k ;
+					unsigned b = a + meio ;
+					float tr = wr * re[ b ] + wi * im[ b ] ;
+					float ti = wr * im[ b ] - wi * re[ b ] ;
+
+					re[ b ]  = re[ a ] - tr ;
+					im[ b ]  = im[ a ] - ti ;
+					re[ a ] += tr ;
+					im[ a ] += ti ;
+				}
+			}
+		}
+	}
+
+/*****  Código das funções encapsuladas no módulo  *****/
+
+	/***************************************************************************
+	*
+	*  Função: ESP  & Transformar a janela mais recente e somar ao Welch
+	*
+	*  Com Z = FFT( x + i·y ), X[k] = ( Z[k] + conj Z[N-k] ) / 2 e
+	*  Y[k] = ( Z[k] - conj Z[N-k] ) / 2i: dois eixos pelo preço de um.
+	*  ****/
+
+	static void processarJanela( ESP_tpAnalisador * pAnalisador )
+	{
+		float * re = pAnalisador->re ;
+		float * im = pAnalisador->im ;
+		unsigned k ;
+
+		carregarEixo( pAnalisador , 0 , re ) ;
+		carregarEixo( pAnalisador , 1 , im ) ;
+
+		ESP_Transformar( pAnalisador , re , im ) ;
+
+		for ( k = 0 ; k < ESP_NUM_RAIAS ; k++ )
+		{
+			unsigned n  = ( ESP_TAM_JANELA - k ) & ( ESP_TAM_JANELA - 1 ) ;
+			float    xr = re[ k ] + re[ n ] ;
+			float    xi = im[ k ] - im[ n ] ;
+			float    yr = im[ k ] + im[ n ] ;
+			float    yi = re[ k ] - re[ n ] ;
+
+			pAnalisador->soma[ 0 ][ k ] += 0.25f * ( xr * xr + xi * xi ) ;
+			pAnalisador->soma[ 1 ][ k ] += 0.25f * ( yr * yr + yi * yi ) ;
+		}
+
+		carregarEixo( pAnalisador , 2 , re ) ;
+		memset( im , 0 , sizeof( pAnalisador->im ) ) ;
+
+		ESP_Transformar( pAnalisador , re , im ) ;
+
+		for ( k = 0 ; k < ESP_NUM_RAIAS ; k++ )
+		{
+			pAnalisador->soma[ 2 ][ k ] += re[ k ] * re[ k ] + im[ k ] * im[ k ] ;
+		}
+
+		pAnalisador->janelas ++ ;
+	}
+
+	/***************************************************************************
+	*
+	*  Função: ESP  & Copiar um eixo em ordem, sem a média e com Hann
+	*  ****/
+
+	static void carregarEixo( ESP_tpAnalisador * pAnalisador , int eixo , float * destino )
+	{
+		const float * v = pAnalisador->recentes[ eixo ] ;
+		unsigned inicio = pAnalisador->posicao ;   /* A mais antiga */
+		float media = 0.0f ;
+		unsigned i ;
+
+		for ( i = 0 ; i < ESP_TAM_JANELA ; i++ )
+		{
+			media += v[ i ] ;
+		}
+
+		media *= 1.0f / ESP_TAM_JANELA ;
+
+		for ( i = 0 ; i < ESP_TAM_JANELA ; i++ )
+		{
+			destino[ i ] = ( v[ ( inicio + i ) & ( ESP_TAM_JANELA - 1 ) ] - media ) * pAnalisador->hann[ i ] ;
+		}
+	}
+
+	/***************************************************************************
+	*
+	*  Função: ESP  & Publicar a média de Welch e recomeçar a soma
+	*
+	*  As raias 0 e N/2 não têm par no espectro bilateral e entram com
+	*  metade da escala.
+	*  ****/
+
+	static void publicar( ESP_tpAnalisador * pAnalisador )
+	{
+		ESP_tpResultado * pRes = &pAnalisador->resultado ;
+		const ESP_tpConfig * pCfg = &pAnalisador->config ;
+		float fator = pAnalisador->escala / pAnalisador->janelas ;
+		float df    = pRes->resolucaoHz ;
+		int e ;
+
+		for ( e = 0 ; e < ESP_NUM_EIXOS ; e++ )
+		{
+			float * psd = pRes->psd[ e ] ;
+			double total = 0.0 ;
+			unsigned k , b ;
+
+			for ( k = 0 ; k < ESP_NUM_RAIAS ; k++ )
+			{
+				psd[ k ] = pAnalisador->soma[ e ][ k ] * fator ;
+			}
+
+			psd[ 0 ]                 *= 0.5f ;
+			psd[ ESP_NUM_RAIAS - 1 ] *= 0.5f ;
+
+			for ( k = 0 ; k < ESP_NUM_RAIAS ; k++ )
+			{
+				total += psd[ k ] ;
+			}
+
+			pRes->rms[ e ] = ( float ) sqrt( total * df ) ;
+
+			for ( b = 0 ; b < pCfg->numBandas ; b++ )
+			{
+				double energia = 0.0 ;
+
+				for ( k = 0 ; k < ESP_NUM_RAIAS ; k++ )
+				{
+					float f = k * df ;
+
+					if ( f >= pCfg->bandaHz[ b ][ 0 ] && f < pCfg->bandaHz[ b ][ 1 ] )
+					{
+						energia += psd[ k ] ;
+					}
+				}
+
+				pRes->energiaBanda[ e ][ b ] = ( float ) ( energia * df ) ;
+			}
+
+			buscarPicos( psd , df , pRes->pico[ e ] ) ;
+		}
+
+		pRes->timestamp = pAnalisador->ultimoTs ;
+		pRes->numResultado ++ ;
+
+		memset( pAnalisador->soma , 0 , sizeof( pAnalisador->soma ) ) ;
+		pAnalisador->janelas = 0 ;
+	}
+
+	/***************************************************************************
+	*
+	*  Função: ESP  & Os ESP_MAX_PICOS maiores máximos locais
+	*
+	*  A frequência é refinada por uma parábola sobre o logaritmo das três
+	*  raias em torno do máximo (exata para o lóbulo gaussiano).
+	*  ****/
+
+	static void buscarPicos( const float * psd , float resolucao , ESP_tpPico * pPicos )
+	{
+		unsigned k ;
+		int p ;
+
+		memset( pPicos , 0 , ESP_MAX_PICOS * sizeof( ESP_tpPico ) ) ;
+
+		for ( k = 1 ; k < ESP_NUM_RAIAS - 1 ; k++ )
+		{
+			float a = psd[ k - 1 ] , b = psd[ k ] , c = psd[ k + 1 ] ;
+			float desloc = 0.0f ;
+
+			if ( ! ( b > a && b >= c ) || b <= pPicos[ ESP_MAX_PICOS - 1 ].densidade )
+			{
+				continue ;
+			}
+
+			if ( a > 0.0f && c > 0.0f )
+			{
+				float la = logf( a ) , lb = logf( b ) , lc = logf( c ) ;
+				float den = la - 2.0f * lb + lc ;
+
+				if ( den < 0.0f )
+				{
+					desloc = 0.5f * ( la - lc ) / den ;
+					desloc = desloc > 0.5f ? 0.5f : ( desloc < -0.5f ? -0.5f : desloc ) ;
+				}
+			}
+
+			/* Inserção ordenada */
+
+			for ( p = ESP_MAX_PICOS - 1 ; p > 0 && pPicos[ p - 1 ].densidade < b ; p-- )
+			{
+				pPicos[ p ] = pPicos[ p - 1 ] ;
+			}
+
+			pPicos[ p ].freqHz    = ( k + desloc ) * resolucao ;
+			pPicos[ p ].densidade = b ;
+		}
+	}
@@ -0,0 +1,223 @@
+#ifndef ESP_ESPECTRO
+#define ESP_ESPECTRO
+
+/**************************************************************************************************************************
+*$MCD Módulo de definição
+*	  Nome : 	                Espectro de vibração do acelerômetro
+*	  Proprietário :         	Equipe AeroRio
+*	  Projeto :		            SAE AeroDesign Brasil 2014
+*	  Gestor :	 	            Alessandro Soares da Silva Junior
+* 	  Arquivo : 	            ESP_ESPECTRO.H
+*	  Letras Identificadoras : 	ESP
+*	  Autor : 	                Alessandro Soares da Silva Junior
+*
+*$ED Descrição do módulo
+*	Densidade espectral de potência (método de Welch) dos três eixos do acelerômetro, para localizar vibrações de
+*   hélice, motor e fixação de servos.
+*
+*   As amostras entram uma a uma (ESP_Acrescentar). A cada ESP_TAM_JANELA / 2 amostras (sobreposição de 50%) a
+*   janela mais recente tem a média retirada, é multiplicada pela janela de Hann e transformada por uma FFT radix-2
+*   no próprio lugar; ax e ay vão juntos numa FFT complexa (ax + i·ay) e az em outra. Depois de 'janelasMedia'
+*   janelas a média é publicada como resultado, com os picos e a energia de cada banda, e a soma recomeça.
+*
+*   Tabelas de Hann, fatores de rotação e inversão de bits são calculadas em ESP_Iniciar. O analisador é um tipo
+*   exportado para que o chamador o aloque; o módulo nunca usa o heap.
+*
+***************************************************************************************************************************/
+
+#include <stdint.h>
+
+/***** Declarações exportadas pelo módulo *****/
+
+#define ESP_LOG2_JANELA  8
+#define ESP_TAM_JANELA   ( 1 << ESP_LOG2_JANELA )     /* Amostras por janela             */
+#define ESP_NUM_RAIAS    ( ESP_TAM_JANELA / 2 + 1 )   /* Raias do espectro unilateral    */
+#define ESP_MAX_PICOS    4
+#define ESP_MAX_BANDAS   8
+#define ESP_NUM_EIXOS    3
+
+/***********************************************************************
+*
+*  $TC Tipo de dados: ESP Condições de retorno
+*
+***********************************************************************/
+
+   typedef enum {
+
+         ESP_CondRetOK            ,
+              /* Executou corretamente                               */
+         ESP_CondRetConfig        ,
+              /* Taxa, média ou banda inválida                       */
+         ESP_CondRetVazio         ,
+              /* Ainda não há resultado publicado                    */
+
+} ESP_tpCondRet ;
+
+/***********************************************************************
+*
+*  $TC Tipo de dados: ESP Configuração
+*
+***********************************************************************/
+
+   typedef struct {
+
+         float    taxaHz                          ;
+              /* Taxa das amostras de ESP_Acrescentar              */
+         unsigned janelasMedia                    ;
+              /* Janelas somadas em cada resultado (>= 1)          */
+         unsigned numBandas                       ;
+         float    bandaHz[ ESP_MAX_BANDAS ][ 2 ]  ;
+              /* [inferior, superior) de cada banda, em Hz         */
+
+} ESP_tpConfig ;
+
+/***********************************************************************
+*
+*  $TC Tipo de dados: ESP Pico do espectro
+*
+***********************************************************************/
+
+   typedef struct {
+
+         float freqHz    ;
+              /* Interpolada entre as raias vizinhas              */
+         float densidade ;
+              /* PSD na raia do pico, em (m/s²)²/Hz; 0 = sem pico */
+
+} ESP_tpPico ;
+
+/***********************************************************************
+*
+*  $TC Tipo de dados: ESP Resultado
+*
+***********************************************************************/
+
+   typedef struct {
+
+         uint64_t   timestamp                                   ;
+              /* Última amostra da última janela da média          */
+         uint32_t   numResultado                                ;
+              /* Conta os resultados publicados (1, 2, ...)        */
+         float      resolucaoHz                                 ;
+         float      psd[ ESP_NUM_EIXOS ][ ESP_NUM_RAIAS ]       ;
+              /* (m/s²)²/Hz, unilateral                            */
+         ESP_tpPico pico[ ESP_NUM_EIXOS ][ ESP_MAX_PICOS ]      ;
+              /* Em ordem decrescente de densidade                 */
+         float      energiaBanda[ ESP_NUM_EIXOS ][ ESP_MAX_BANDAS ] ;
+              /* Variância dentro de cada banda, em (m/s²)²        */
+         float      rms[ ESP_NUM_EIXOS ]                        ;
+              /* Sem a média (DC), em m/s²                         */
+
+} ESP_tpResultado ;
+
+/***********************************************************************
+*
+*  $TC Tipo de dados: ESP Analisador
+*
+*  $ED Descrição do tipo
+*     Tabelas, amostras recentes e soma de Welch. Os campos são internos
+*     ao módulo.
+*
+***********************************************************************/
+
+   typedef struct {
+
+         ESP_tpConfig    config                                   ;
+         float           hann[ ESP_TAM_JANELA ]                   ;
+         float           cosseno[ ESP_TAM_JANELA / 2 ]            ;
+         float           seno[ ESP_TAM_JANELA / 2 ]               ;
+         uint16_t        inverso[ ESP_TAM_JANELA ]                ;
+         float           escala                                   ;
+              /* 2 / ( taxa * soma( hann² ) )                       */
+
+         float           recentes[ ESP_NUM_EIXOS ][ ESP_TAM_JANELA ] ;
+         unsigned        posicao                                  ;
+         unsigned        total                                    ;
+         unsigned        desdeJanela                              ;
+         uint64_t        ultimoTs                                 ;
+
+         float           re[ ESP_TAM_JANELA ]                     ;
+         float           im[ ESP_TAM_JANELA ]                     ;
+         float           soma[ ESP_NUM_EIXOS ][ ESP_NUM_RAIAS ]   ;
+         unsigned        janelas                                  ;
+
+         ESP_tpResultado resultado                                ;
+
+} ESP_tpAnalisador ;
+
+/***********************************************************************
+*
+*  $FC Função: ESP  &Configuração padrão
+*
+*  $ED Descrição da função
+*     250 Hz, 8 janelas por resultado (um resultado a cada 1024
+*     amostras, cerca de 4 s) e as bandas 1-10, 10-30, 30-60 e
+*     60-125 Hz.
+*
+***********************************************************************/
+
+void ESP_ConfigPadrao( ESP_tpConfig * pConfig ) ;
+
+/***********************************************************************
+*
+*  $FC Função: ESP  &Iniciar analisador
+*
+*  $FV Valor retornado
+*     ESP_CondRetOK ou ESP_CondRetConfig.
+*
+***********************************************************************/
+
+ESP_tpCondRet ESP_Iniciar( ESP_tpAnalisador * pAnalisador , const ESP_tpConfig * pConfig ) ;
+
+/***********************************************************************
+*
+*  $FC Função: ESP  &Acrescentar amostra
+*
+*  $ED Descrição da função
+*     Guarda a amostra e, quando completa meia janela, processa a
+*     janela mais recente.
+*
+*  $FV Valor retornado
+*     1 se um novo resultado foi publicado nesta chamada, senão 0.
+*
+***********************************************************************/
+
+int ESP_Acrescentar( ESP_tpAnalisador * pAnalisador , uint64_t timestamp , const float acel[ ESP_NUM_EIXOS ] ) ;
+
+/***********************************************************************
+*
+*  $FC Função: ESP  &Marcar descontinuidade
+*
+*  $ED Descrição da função
+*     Descarta as amostras recentes, para que nenhuma janela atravesse
+*     um trecho perdido. A soma de Welch e o último resultado ficam.
+*
+***********************************************************************/
+
+void ESP_Descontinuidade( ESP_tpAnalisador * pAnalisador ) ;
+
+/***********************************************************************
+*
+*  $FC Função: ESP  &Obter resultado
+*
+*  $FV Valor retornado
+*     ESP_CondRetOK ou ESP_CondRetVazio se nenhum resultado foi
+*     publicado ainda.
+*
+***********************************************************************/
+
+ESP_tpCondRet ESP_ObterResultado( const ESP_tpAnalisador * pAnalisador , ESP_tpResultado * pResultado ) ;
+
+/***********************************************************************
+*
+*  $FC Função: ESP  &Transformar
+*
+*  $ED Descrição da função
+*     FFT complexa no próprio lugar de ESP_TAM_JANELA pontos, com as
+*     tabelas do analisador. Exportada para a medição de desempenho.
+*
+***********************************************************************/
+
+void ESP_Transformar( const ESP_tpAnalisador * pAnalisador , float * re , float * im ) ;
+
+#endif
@@ -0,0 +1,296 @@
+/***************************************************************************
+*  $MCI Módulo de implementação: FLT Filtros digitais por canal
+*
+*  Arquivo gerado:              FLT_FILTROS.c
+*  Letras identificadoras:      FLT
+*
+*
+*  Projeto: SAE AeroDesign Brasil 2014
+*  Gestor:  Alessandro Soares da Silva Junior
+*  Autores: Alessandro Soares da Silva Junior
+*
+*
+***************************************************************************/
+
+#ifndef _STRING
+#define _STRING
+#include <string.h>
+#endif
+
+#ifndef _MATH
+#define _MATH
+#include <math.h>
+#endif
+
+#define FLT_FILTROS_OWN
+#include "FLT_FILTROS.h"
+#undef FLT_FILTROS_OWN
+
+#define FLT_PI  3.14159265358979323846
+
+/***** Protótipos das funções encapuladas no módulo *****/
+
+	static void   calcularBiquad   ( FLT_tpBiquad * pBiquad , const FLT_tpEstagioConfig * pEstagio , float taxaHz ) ;
+	static float  regimeBiquad     ( FLT_tpBiquad * pBiquad , float x )            ;
+	static float  passoMedia       ( FLT_tpCanal * pCanal , float x )              ;
+
+/*****  Código das funções exportadas pelo módulo  *****/
+
+/***************************************************************************
+*
+*  Função: FLT  &Iniciar canal
+*  ****/
+
+	FLT_tpCondRet FLT_IniciarCanal( FLT_tpCanal * pCanal , const FLT_tpConfig * pConfig )
+	{
+		unsigned medias = 0 ;
+		unsigned i ;
+
+		memset( pCanal , 0 , sizeof( *pCanal ) ) ;
+
+		if ( pConfig == NULL || pConfig->numEstagios == 0 )
+		{
+			return FLT_CondRetOK ;
+		}
+
+		if ( pConfig->numEstagios > FLT_MAX_ESTAGIOS || ! ( pConfig->taxaHz > 0.0f ) )
+		{
+			return FLT_CondRetConfig ;
+		}
+
+		/* Valida tudo antes de ativar o canal */
+
+		for ( i = 0 ; i < pConfig->numEstagios ; i++ )
+		{
+			const FLT_tpEstagioConfig * pEstagio = &pConfig->estagio[ i ] ;
+
+			switch ( pEstagio->tipo )
+			{
+				case FLT_PassaBaixa :
+				case FLT_Notch :
+
+					if ( ! ( pEstagio->freqHz > 0.0f ) || pEstagio->freqHz >= 0.5f * pConfig->taxaHz ||
+					     ! ( pEstagio->q > 0.0f ) )
+					{
+						return FLT_CondRetConfig ;
+					}
+					break ;
+
+				case FLT_MediaMovel :
+
+					if ( pEstagio->janela == 0 || pEstagio->janela > FLT_MAX_MEDIA || ++medias > 1 )
+					{
+						return FLT_CondRetConfig ;
+					}
+					break ;
+
+				default :
+
+					return FLT_CondRetConfig ;
+			}
+		}
+
+		for ( i = 0 ; i < pConfig->numEstagios ; i++ )
+		{
+			const FLT_tpEstagioConfig * pEstagio = &pConfig->estagio[ i ] ;
+
+			pCanal->estagio[ i ].tipo = pEstagio->tipo ;
+
+			if ( pEstagio->tipo == FLT_MediaMovel )
+			{
+				pCanal->janela        = pEstagio->janela ;
+				pCanal->inversoJanela = 1.0f / ( float ) pEstagio->janela ;
+			}
+			else
+			{
+				calcularBiquad( &pCanal->estagio[ i ] , pEstagio , pConfig->taxaHz ) ;
+			}
+		}
+
+		pCanal->numEstagios = pConfig->numEstagios ;
+
+		return FLT_CondRetOK ;
+	}
+
+/***************************************************************************
+*
+*  Função: FLT  &Canal ativo
+*  ****/
+
+	int FLT_Ativo( const FLT_tpCanal * pCanal )
+	{
+		return pCanal->numEstagios != 0 ;
+	}
+
+/***************************************************************************
+*
+*  Função: FLT  &Reiniciar canal
+*  ****/
+
+	void FLT_Reiniciar( FLT_tpCanal * pCanal , float valor )
+	{
+		unsigned i ;
+
+		for ( i = 0 ; i < pCanal->numEstagios ; i++ )
+		{
+			if ( pCanal->estagio[ i ].tipo == FLT_MediaMovel )
+			{
+				unsigned k ;
+
+				for ( k = 0 ; k < pCanal->janela ; k++ )
+				{
+					pCanal->amostras[ k ] = valor ;
+				}
+
+				pCanal->soma     = valor * ( float ) pCanal->janela ;
+				pCanal->somaNova = 0.0f ;
+				pCanal->posicao  = 0 ;
+			}
+			else
+			{
+				valor = regimeBiquad( &pCanal->estagio[ i ] , valor ) ;
+			}
+		}
+
+		pCanal->saida    = valor ;
+		pCanal->iniciado = 1 ;
+	}
+
+/***************************************************************************
+*
+*  Função: FLT  &Filtrar amostra
+*  ****/
+
+	float FLT_Filtrar( FLT_tpCanal * pCanal , float x )
+	{
+		unsigned i ;
+
+		if ( pCanal->numEstagios == 0 )
+		{
+			return x ;
+		}
+
+		if ( ! pCanal->iniciado )
+		{
+			FLT_Reiniciar( pCanal , x ) ;
+		}
+
+		for ( i = 0 ; i < pCanal->numEstagios ; i++ )
+		{
+			FLT_tpBiquad * b = &pCanal->estagio[ i ] ;
+
+			if ( b->tipo == FLT_MediaMovel )
+			{
+				x = passoMedia( pCanal , x ) ;
+			}
+			else
+			{
+				/* Forma direta II transposta */
+
+				float y = b->b0 * x + b->z1 ;
+
+				b->z1 = b->b1 * x - b->a1 * y + b->z2 ;
+				b->z2 = b->b2 * x - b->a2 * y ;
+
+				x = y ;
+			}
+		}
+
+		pCanal->saida = x ;
+
+		return x ;
+	}
+
+/***************************************************************************
+*
+*  Função: FLT  &Última saída
+*  ****/
+
+	float FLT_UltimaSaida( const FLT_tpCanal * pCanal )
+	{
+		return pCanal->saida ;
+	}
+
+/*****  Código das funções encapsuladas no módulo  *****/
+
+	/***************************************************************************
+	*
+	*  Função: FLT  & Calcular os coeficientes de um biquad
+	*
+	*  Fórmulas do "Audio EQ Cookbook" (R. Bristow-Johnson), calculadas em
+	*  double e normalizadas por a0.
+	*  ****/
+
+	static void calcularBiquad( FLT_tpBiquad * pBiquad , const FLT_tpEstagioConfig * pEstagio , float taxaHz )
+	{
+		double w0    = 2.0 * FLT_PI * pEstagio->freqHz / taxaHz ;
+		double cosW0 = cos( w0 ) ;
+		double alfa  = sin( w0 ) / ( 2.0 * pEstagio->q ) ;
+		double a0    = 1.0 + alfa ;
+		double b0 , b1 , b2 ;
+
+		if ( pEstagio->tipo == FLT_PassaBaixa )
+		{
+			b0 = ( 1.0 - cosW0 ) / 2.0 ;
+			b1 =   1.0 - cosW0 ;
+			b2 = ( 1.0 - cosW0 ) / 2.0 ;
+		}
+		else
+		{
+			b0 =  1.0 ;
+			b1 = -2.0 * cosW0 ;
+			b2 =  1.0 ;
+		}
+
+		pBiquad->b0 = ( float ) ( b0 / a0 ) ;
+		pBiquad->b1 = ( float ) ( b1 / a0 ) ;
+		pBiquad->b2 = ( float ) ( b2 / a0 ) ;
+		pBiquad->a1 = ( float ) ( -2.0 * cosW0 / a0 ) ;
+		pBiquad->a2 = ( float ) ( ( 1.0 - alfa ) / a0 ) ;
+		pBiquad->z1 = 0.0f ;
+		pBiquad->z2 = 0.0f ;
+	}
+
+	/***************************************************************************
+	*
+	*  Função: FLT  & Levar um biquad ao regime para entrada constante x
+	*
+	*  Retorna a saída em regime (x vezes o ganho DC, 1 nos dois tipos).
+	*  ****/
+
+	static float regimeBiquad( FLT_tpBiquad * pBiquad , float x )
+	{
+		float ganho = ( pBiquad->b0 + pBiquad->b1 + pBiquad->b2 ) / ( 1.0f + pBiquad->a1 + pBiquad->a2 ) ;
+		float y     = ganho * x ;
+
+		pBiquad->z2 = pBiquad->b2 * x - pBiquad->a2 * y ;
+		pBiquad->z1 = pBiquad->b1 * x - pBiquad->a1 * y + pBiquad->z2 ;
+
+		return y ;
+	}
+
+	/***************************************************************************
+	*
+	*  Função: FLT  & Um passo da média móvel
+	*
+	*  A soma corrente acumula erro de arredondamento; a cada volta da
+	*  janela ela é trocada pela soma exata das últimas 'janela' amostras,
+	*  acumulada em paralelo. O custo por amostra continua fixo.
+	*  ****/
+
+	static float passoMedia( FLT_tpCanal * pCanal , float x )
+	{
+		pCanal->soma     += x - pCanal->amostras[ pCanal->posicao ] ;
+		pCanal->somaNova += x ;
+
+		pCanal->amostras[ pCanal->posicao ] = x ;
+
+		if ( ++pCanal->posicao == pCanal->janela )
+		{
+			pCanal->posicao  = 0 ;
+			pCanal->soma     = pCanal->somaNova ;
+			pCanal->somaNova = 0.0f ;
+		}
+
+		return pCanal->soma * pCanal->inversoJanela ;
+	}
@@ -0,0 +1,185 @@
+#ifndef FLT_FILTROS
+#define FLT_FILTROS
+
+/**************************************************************************************************************************
+*$MCD Módulo de definição
+*	  Nome : 	                Filtros digitais por canal
+*	  Proprietário :         	Equipe AeroRio
+*	  Projeto :		            SAE AeroDesign Brasil 2014
+*	  Gestor :	 	            Alessandro Soares da Silva Junior
+* 	  Arquivo : 	            FLT_FILTROS.H
+*	  Letras Identificadoras : 	FLT
+*	  Autor : 	                Alessandro Soares da Silva Junior
+*
+*$ED Descrição do módulo
+*	Cadeia de até FLT_MAX_ESTAGIOS estágios aplicada amostra a amostra a um canal (um eixo do acelerômetro, do giro,
+*   a pressão...): passa-baixa biquad de 2ª ordem, notch biquad e média móvel.
+*
+*   Os coeficientes (fórmulas de R. Bristow-Johnson) são calculados uma vez em FLT_IniciarCanal; cada amostra custa
+*   um número fixo de operações, sem alocação nem laço dependente de dados. Os biquads usam a forma direta II
+*   transposta. A primeira amostra leva o estado ao regime permanente para aquele valor, evitando o transitório de
+*   partir do zero (por exemplo, a gravidade em az).
+*
+***************************************************************************************************************************/
+
+/***** Declarações exportadas pelo módulo *****/
+
+#define FLT_MAX_ESTAGIOS  4
+#define FLT_MAX_MEDIA     16      /* Janela máxima da média móvel (uma por canal) */
+
+/***********************************************************************
+*
+*  $TC Tipo de dados: FLT Condições de retorno
+*
+***********************************************************************/
+
+   typedef enum {
+
+         FLT_CondRetOK            ,
+              /* Executou corretamente                               */
+         FLT_CondRetConfig        ,
+              /* Frequência acima de Nyquist, janela inválida, etc.  */
+
+} FLT_tpCondRet ;
+
+/***********************************************************************
+*
+*  $TC Tipo de dados: FLT Tipo de estágio
+*
+***********************************************************************/
+
+   typedef enum {
+
+         FLT_PassaBaixa       ,      /* Butterworth com q = 0,7071     */
+         FLT_Notch            ,      /* Rejeita freqHz; q = freq/banda */
+         FLT_MediaMovel       ,      /* Média das últimas 'janela'     */
+
+} FLT_tpTipo ;
+
+/***********************************************************************
+*
+*  $TC Tipo de dados: FLT Configuração de um estágio
+*
+***********************************************************************/
+
+   typedef struct {
+
+         FLT_tpTipo tipo    ;
+         float      freqHz  ;
+              /* Corte (passa-baixa) ou centro (notch)           */
+         float      q       ;
+              /* Fator de qualidade dos biquads (> 0)            */
+         unsigned   janela  ;
+              /* Amostras da média móvel (1..FLT_MAX_MEDIA)      */
+
+} FLT_tpEstagioConfig ;
+
+/***********************************************************************
+*
+*  $TC Tipo de dados: FLT Configuração de um canal
+*
+***********************************************************************/
+
+   typedef struct {
+
+         float               taxaHz                       ;
+              /* Taxa das amostras que entram no canal            */
+         unsigned            numEstagios                  ;
+              /* 0 = canal sem filtro                             */
+         FLT_tpEstagioConfig estagio[ FLT_MAX_ESTAGIOS ]  ;
+
+} FLT_tpConfig ;
+
+/***********************************************************************
+*
+*  $TC Tipo de dados: FLT Canal
+*
+*  $ED Descrição do tipo
+*     Coeficientes e estado de um canal. Exportado para que o chamador
+*     o aloque (estático ou dentro de outra estrutura); os campos são
+*     internos ao módulo.
+*
+***********************************************************************/
+
+   typedef struct {
+
+         FLT_tpTipo tipo ;
+         float      b0 , b1 , b2 , a1 , a2 ;
+         float      z1 , z2 ;
+
+} FLT_tpBiquad ;
+
+   typedef struct {
+
+         unsigned     numEstagios                 ;
+         FLT_tpBiquad estagio[ FLT_MAX_ESTAGIOS ] ;
+         unsigned     janela                      ;
+         float        inversoJanela               ;
+         unsigned     posicao                     ;
+         float        soma                        ;
+         float        somaNova                    ;
+         float        amostras[ FLT_MAX_MEDIA ]   ;
+         int          iniciado                    ;
+         float        saida                       ;
+
+} FLT_tpCanal ;
+
+/***********************************************************************
+*
+*  $FC Função: FLT  &Iniciar canal
+*
+*  $ED Descrição da função
+*     Calcula os coeficientes e zera o estado. Com numEstagios zero o
+*     canal fica inativo e FLT_Filtrar devolve a própria entrada.
+*
+*  $FV Valor retornado
+*     FLT_CondRetOK ou FLT_CondRetConfig (o canal fica inativo).
+*
+***********************************************************************/
+
+FLT_tpCondRet FLT_IniciarCanal( FLT_tpCanal * pCanal , const FLT_tpConfig * pConfig ) ;
+
+/***********************************************************************
+*
+*  $FC Função: FLT  &Canal ativo
+*
+***********************************************************************/
+
+int FLT_Ativo( const FLT_tpCanal * pCanal ) ;
+
+/***********************************************************************
+*
+*  $FC Função: FLT  &Reiniciar canal
+*
+*  $ED Descrição da função
+*     Leva o estado ao regime permanente para a entrada constante
+*     'valor' (mesmo efeito da primeira amostra).
+*
+***********************************************************************/
+
+void FLT_Reiniciar( FLT_tpCanal * pCanal , float valor ) ;
+
+/***********************************************************************
+*
+*  $FC Função: FLT  &Filtrar amostra
+*
+*  $FV Valor retornado
+*     A saída do último estágio.
+*
+***********************************************************************/
+
+float FLT_Filtrar( FLT_tpCanal * pCanal , float x ) ;
+
+/***********************************************************************
+*
+*  $FC Função: FLT  &Última saída
+*
+*  $ED Descrição da função
+*     Saída da última chamada de FLT_Filtrar, para repetir o valor sem
+*     avançar o filtro quando a amostra de entrada não é nova.
+*
+***********************************************************************/
+
+float FLT_UltimaSaida( const FLT_tpCanal * pCanal ) ;
+
+#endif
@@ -0,0 +1,396 @@
+/***************************************************************************
+*  $MCI Módulo de implementação: HST Histórico de amostras
+*
+*  Arquivo gerado:              HST_HISTORICO.c
+*  Letras identificadoras:      HST
+*
+*
+*  Projeto: SAE AeroDesign Brasil 2014
+*  Gestor:  Alessandro Soares da Silva Junior
+*  Autores: Alessandro Soares da Silva Junior
+*
+*
+***************************************************************************/
+
+#ifndef _STDLIB
+#define _STDLIB
+#include <stdlib.h>
+#endif
+
+#ifndef _STRING
+#define _STRING
+#include <string.h>
+#endif
+
+#define HST_HISTORICO_OWN
+#include "HST_HISTORICO.h"
+#undef HST_HISTORICO_OWN
+
+/***********************************************************************
+*
+*  $TC Tipo de dados: HST - Histórico
+*
+*  $ED Descrição do tipo
+*     Um anel de LER_tpAmostra; ver HST_tpAnel.
+*
+***********************************************************************/
+
+typedef struct HST_historico {
+	HST_tpAnel      anel       ;
+} HST_historico ;
+
+#define AMOSTRA( pHist , seq )  ( ( const LER_tpAmostra * ) ( pHist )->anel.elementos + ( ( seq ) & ( pHist )->anel.mascara ) )
+
+/***** Protótipos das funções encapuladas no módulo *****/
+
+	static unsigned disponiveisAnel ( const HST_tpAnel * pAnel , unsigned cabeca )                       ;
+	static int      anelValido      ( HST_tpAnel * pAnel , unsigned inicio )                             ;
+	static void     montarJanela    ( const HST_historico * pHist , unsigned inicio , unsigned fim ,
+	                                  HST_tpJanela * pJanela )                                           ;
+
+/*****  Código das funções exportadas pelo módulo  *****/
+
+/***************************************************************************
+*
+*  Função: HST  &Criar histórico
+*  ****/
+
+	HST_tpHistorico HST_Criar( unsigned capacidade )
+	{
+		HST_historico * pHist ;
+		LER_tpAmostra * amostras ;
+		unsigned tam = HST_CapacidadeAnel( capacidade ) ;
+
+		pHist = ( HST_historico * ) malloc( sizeof( HST_historico ) ) ;
+
+		if ( pHist == NULL )
+		{
+			return NULL ;
+		}
+
+		amostras = ( LER_tpAmostra * ) calloc( tam , sizeof( LER_tpAmostra ) ) ;
+
+		if ( amostras == NULL )
+		{
+			free( pHist ) ;
+			return NULL ;
+		}
+
+		HST_IniciarAnel( &pHist->anel , amostras , tam , sizeof( LER_tpAmostra ) ) ;
+
+		return pHist ;
+	}
+
+/***************************************************************************
+*
+*  Função: HST  &Destruir histórico
+*  ****/
+
+	void HST_Destruir( HST_tpHistorico pHist )
+	{
+		if ( pHist == NULL )
+		{
+			return ;
+		}
+
+		free( pHist->anel.elementos ) ;
+		free( pHist ) ;
+	}
+
+/***************************************************************************
+*
+*  Função: HST  &Inserir amostra
+*  ****/
+
+	void HST_Inserir( HST_tpHistorico pHist , const LER_tpAmostra * pAmostra )
+	{
+		HST_InserirAnel( &pHist->anel , pAmostra ) ;
+	}
+
+/***************************************************************************
+*
+*  Função: HST  &Obter últimas amostras
+*  ****/
+
+	HST_tpCondRet HST_ObterUltimas( HST_tpHistorico pHist , unsigned n , HST_tpJanela * pJanela )
+	{
+		unsigned cabeca = __atomic_load_n( &pHist->anel.cabeca , __ATOMIC_ACQUIRE ) ;
+		unsigned disponiveis = disponiveisAnel( &pHist->anel , cabeca ) ;
+
+		if ( n > disponiveis )
+		{
+			n = disponiveis ;
+		}
+
+		if ( n == 0 )
+		{
+			return HST_CondRetVazio ;
+		}
+
+		montarJanela( pHist , cabeca - n , cabeca , pJanela ) ;
+
+		return HST_CondRetOK ;
+	}
+
+/***************************************************************************
+*
+*  Função: HST  &Obter amostras desde um instante
+*  ****/
+
+	HST_tpCondRet HST_ObterDesde( HST_tpHistorico pHist , uint64_t desde , HST_tpJanela * pJanela )
+	{
+		unsigned cabeca = __atomic_load_n( &pHist->anel.cabeca , __ATOMIC_ACQUIRE ) ;
+		unsigned disponiveis = disponiveisAnel( &pHist->anel , cabeca ) ;
+		unsigned baixo , alto ;
+
+		if ( disponiveis == 0 )
+		{
+			return HST_CondRetVazio ;
+		}
+
+		/* Busca binária da primeira amostra com timestamp > desde. Uma
+		   leitura corrompida pelo produtor só desloca o resultado, e a
+		   janela é recusada depois por HST_JanelaValida. */
+
+		baixo = cabeca - disponiveis ;
+		alto  = cabeca ;
+
+		while ( baixo != alto )
+		{
+			unsigned meio = baixo + ( alto - baixo ) / 2 ;
+
+			if ( AMOSTRA( pHist , meio )->timestamp > desde )
+			{
+				alto = meio ;
+			}
+			else
+			{
+				baixo = meio + 1 ;
+			}
+		}
+
+		if ( baixo == cabeca )
+		{
+			return HST_CondRetVazio ;
+		}
+
+		montarJanela( pHist , baixo , cabeca , pJanela ) ;
+
+		return HST_CondRetOK ;
+	}
+
+/***************************************************************************
+*
+*  Função: HST  &Validar janela
+*  ****/
+
+	HST_tpCondRet HST_JanelaValida( HST_tpHistorico pHist , const HST_tpJanela * pJanela )
+	{
+		return anelValido( &pHist->anel , pJanela->inicio ) ? HST_CondRetOK : HST_CondRetSobrescrito ;
+	}
+
+/***************************************************************************
+*
+*  Função: HST  &Copiar janela
+*  ****/
+
+	HST_tpCondRet HST_CopiarJanela( HST_tpHistorico pHist , const HST_tpJanela * pJanela , LER_tpAmostra * pDestino )
+	{
+		memcpy( pDestino , pJanela->trecho[ 0 ] , pJanela->tamanho[ 0 ] * sizeof( LER_tpAmostra ) ) ;
+
+		if ( pJanela->tamanho[ 1 ] > 0 )
+		{
+			memcpy( pDestino + pJanela->tamanho[ 0 ] , pJanela->trecho[ 1 ] ,
+			        pJanela->tamanho[ 1 ] * sizeof( LER_tpAmostra ) ) ;
+		}
+
+		return HST_JanelaValida( pHist , pJanela ) ;
+	}
+
+/***************************************************************************
+*
+*  Função: HST  &Capacidade de anel
+*  ****/
+
+	unsigned HST_CapacidadeAnel( unsigned capacidade )
+	{
+		unsigned tam = 2 ;                        /* Uma posição é sempre a do produtor */
+
+		while ( tam < capacidade )
+		{
+			tam <<= 1 ;
+		}
+
+		return tam ;
+	}
+
+/***************************************************************************
+*
+*  Função: HST  &Iniciar anel
+*  ****/
+
+	void HST_IniciarAnel( HST_tpAnel * pAnel , void * pElementos , unsigned capacidade , size_t tamElemento )
+	{
+		pAnel->elementos   = ( unsigned char * ) pElementos ;
+		pAnel->tamElemento = tamElemento ;
+		pAnel->mascara     = capacidade - 1 ;
+		pAnel->cabeca      = 0 ;
+	}
+
+/***************************************************************************
+*
+*  Função: HST  &Inserir elemento no anel
+*  ****/
+
+	void HST_InserirAnel( HST_tpAnel * pAnel , const void * pElemento )
+	{
+		unsigned seq = pAnel->cabeca ;
+
+		/* A publicação da cabeça anterior tem de ficar visível antes de
+		   qualquer escrita na próxima posição, senão um leitor poderia
+		   copiar o elemento já sobrescrito e ainda ver a cabeça antiga */
+
+		__atomic_thread_fence( __ATOMIC_RELEASE ) ;
+
+		memcpy( pAnel->elementos + ( size_t ) ( seq & pAnel->mascara ) * pAnel->tamElemento , pElemento ,
+		        pAnel->tamElemento ) ;
+
+		/* Publica o elemento só depois de escrito por completo */
+
+		__atomic_store_n( &pAnel->cabeca , seq + 1 , __ATOMIC_RELEASE ) ;
+	}
+
+/***************************************************************************
+*
+*  Função: HST  &Ler do anel a partir de um cursor
+*  ****/
+
+	HST_tpCondRet HST_LerAnel( HST_tpAnel * pAnel , uint32_t * pCursor , void * pDestino , unsigned max ,
+	                           unsigned * pNum , uint32_t * pPerdidas )
+	{
+		unsigned char * destino  = ( unsigned char * ) pDestino ;
+		size_t          tamElem  = pAnel->tamElemento ;
+		uint32_t        cursor   = *pCursor ;
+		uint32_t        perdidas = 0 ;
+
+		*pNum = 0 ;
+
+		for ( ;; )
+		{
+			unsigned cabeca = __atomic_load_n( &pAnel->cabeca , __ATOMIC_ACQUIRE ) ;
+			unsigned inicio = cabeca - disponiveisAnel( pAnel , cabeca ) ;
+			unsigned n , pos , ate ;
+
+			if ( ( int32_t ) ( cursor - inicio ) < 0 )
+			{
+				perdidas += inicio - cursor ;
+				cursor    = inicio ;
+			}
+
+			n = cabeca - cursor ;
+
+			if ( n > max )
+			{
+				n = max ;
+			}
+
+			if ( n == 0 )
+			{
+				break ;
+			}
+
+			pos = cursor & pAnel->mascara ;
+			ate = pAnel->mascara + 1 - pos ;       /* Elementos até o fim da área */
+
+			if ( n <= ate )
+			{
+				memcpy( destino , pAnel->elementos + pos * tamElem , n * tamElem ) ;
+			}
+			else
+			{
+				memcpy( destino , pAnel->elementos + pos * tamElem , ate * tamElem ) ;
+				memcpy( destino + ate * tamElem , pAnel->elementos , ( n - ate ) * tamElem ) ;
+			}
+
+			if ( anelValido( pAnel , cursor ) )
+			{
+				*pNum = n ;
+				cursor += n ;
+				break ;
+			}
+
+			/* O produtor passou por cima: recomeça pelo mais antigo válido */
+		}
+
+		*pCursor = cursor ;
+
+		if ( pPerdidas != NULL )
+		{
+			*pPerdidas = perdidas ;
+		}
+
+		return *pNum > 0 ? HST_CondRetOK : HST_CondRetVazio ;
+	}
+
+/*****  Código das funções encapsuladas no módulo  *****/
+
+	/***************************************************************************
+	*
+	*  Função: HST  & Elementos legíveis com a cabeça 'cabeca'
+	*
+	*  A posição que o produtor pode estar escrevendo não é legível.
+	*  ****/
+
+	static unsigned disponiveisAnel( const HST_tpAnel * pAnel , unsigned cabeca )
+	{
+		return cabeca < pAnel->mascara ? cabeca : pAnel->mascara ;
+	}
+
+	/***************************************************************************
+	*
+	*  Função: HST  & Confere que as sequências desde 'inicio' não foram sobrescritas
+	*  ****/
+
+	static int anelValido( HST_tpAnel * pAnel , unsigned inicio )
+	{
+		unsigned cabeca ;
+
+		/* As leituras dos elementos não podem passar desta barreira */
+
+		__atomic_thread_fence( __ATOMIC_ACQUIRE ) ;
+		cabeca = __atomic_load_n( &pAnel->cabeca , __ATOMIC_RELAXED ) ;
+
+		/* O produtor pode estar escrevendo a sequência 'cabeca', que ocupa
+		   a posição da sequência cabeca - capacidade. */
+
+		return cabeca - inicio <= pAnel->mascara ;
+	}
+
+	/***************************************************************************
+	*
+	*  Função: HST  & Montar janela para as sequências [inicio, fim)
+	*  ****/
+
+	static void montarJanela( const HST_historico * pHist , unsigned inicio , unsigned fim , HST_tpJanela * pJanela )
+	{
+		const LER_tpAmostra * amostras = ( const LER_tpAmostra * ) pHist->anel.elementos ;
+		unsigned pos   = inicio & pHist->anel.mascara ;
+		unsigned total = fim - inicio ;
+		unsigned ate   = pHist->anel.mascara + 1 - pos ;   /* Amostras até o fim do vetor */
+
+		pJanela->inicio     = inicio ;
+		pJanela->trecho[ 0 ] = &amostras[ pos ] ;
+
+		if ( total <= ate )
+		{
+			pJanela->tamanho[ 0 ] = total ;
+			pJanela->trecho[ 1 ]  = NULL  ;
+			pJanela->tamanho[ 1 ] = 0     ;
+		}
+		else
+		{
+			pJanela->tamanho[ 0 ] = ate ;
+			pJanela->trecho[ 1 ]  = &amostras[ 0 ] ;
+			pJanela->tamanho[ 1 ] = total - ate ;
+		}
+	}
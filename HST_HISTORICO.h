@@ -0,0 +1,270 @@
+#ifndef HST_HISTORICO
+#define HST_HISTORICO
+
+/**************************************************************************************************************************
+*$MCD Módulo de definição
+*	  Nome : 	                Histórico de amostras dos parametros de voo
+*	  Proprietário :         	Equipe AeroRio
+*	  Projeto :		            SAE AeroDesign Brasil 2014
+*	  Gestor :	 	            Alessandro Soares da Silva Junior
+* 	  Arquivo : 	            HST_HISTORICO.H
+*	  Letras Identificadoras : 	HST
+*	  Autor : 	                Alessandro Soares da Silva Junior
+*
+*$ED Descrição do módulo
+*	Anel de capacidade fixa com as últimas amostras (LER_tpAmostra) produzidas pelo módulo LER. Há um único produtor
+*   (o ciclo de aquisição do LER) e qualquer número de leitores, sem travas: o produtor nunca espera pelos leitores.
+*
+*   O leitor obtém uma janela, que aponta diretamente para as amostras dentro do anel (no máximo dois trechos
+*   contíguos, pois o anel pode dar a volta), processa as amostras e em seguida confirma com HST_JanelaValida que o
+*   produtor não as sobrescreveu nesse meio tempo. Nada é copiado, a menos que o leitor use HST_CopiarJanela.
+*
+*   Toda a memória é alocada em HST_Criar.
+*
+*   O protocolo do anel (HST_tpAnel) não depende do tipo das amostras e é exportado para outros módulos com um
+*   produtor e vários leitores (o CAP, por exemplo): o elemento tem tamanho qualquer e a área é do chamador. Para
+*   esses leitores há HST_LerAnel, que copia a partir de um cursor próprio.
+*
+***************************************************************************************************************************/
+
+#include <stddef.h>
+
+#include "LER_PARAMETROS.h"
+
+/***** Declarações exportadas pelo módulo *****/
+
+/* Tipo referência para um histórico */
+
+typedef struct HST_historico * HST_tpHistorico ;
+
+/***********************************************************************
+*
+*  $TC Tipo de dados: HST Condições de retorno
+*
+***********************************************************************/
+
+   typedef enum {
+
+         HST_CondRetOK            ,
+              /* Executou corretamente                               */
+         HST_CondRetVazio         ,
+              /* Não há amostras que satisfaçam o pedido             */
+         HST_CondRetSobrescrito   ,
+              /* O produtor sobrescreveu parte da janela             */
+
+} HST_tpCondRet ;
+
+/***********************************************************************
+*
+*  $TC Tipo de dados: HST Janela de leitura
+*
+*  $ED Descrição do tipo
+*     Amostras em ordem cronológica: trecho[0] seguido de trecho[1].
+*     tamanho[1] é zero quando a janela não dá a volta no anel.
+*
+***********************************************************************/
+
+   typedef struct {
+
+         const LER_tpAmostra * trecho[ 2 ]  ;
+         unsigned              tamanho[ 2 ] ;
+         unsigned              inicio       ;
+              /* Número de sequência da amostra mais antiga      */
+
+} HST_tpJanela ;
+
+/***********************************************************************
+*
+*  $TC Tipo de dados: HST Anel de um produtor
+*
+*  $ED Descrição do tipo
+*     'cabeca' conta os elementos já inseridos (número de sequência do
+*     próximo). O elemento de sequência s fica na posição s & mascara
+*     de 'elementos'. Contadores de 32 bits com aritmética modular: a
+*     volta só ocorre após 2^32 elementos e não afeta as comparações.
+*     Os campos só são acessados pelas funções HST_...Anel.
+*
+***********************************************************************/
+
+   typedef struct {
+
+         unsigned char * elementos   ;
+              /* Área com 'mascara + 1' elementos, do chamador   */
+         size_t          tamElemento ;
+         unsigned        mascara     ;
+              /* Capacidade - 1 (capacidade é potência de 2)     */
+         unsigned        cabeca      ;
+              /* Publicado pelo produtor com release             */
+
+} HST_tpAnel ;
+
+/***********************************************************************
+*
+*  $FC Função: HST  &Criar histórico
+*
+*  $EP Parâmetros
+*    capacidade  - Número de posições; arredondado para a potência de 2
+*                  seguinte, no mínimo 2. Uma posição é sempre a que o
+*                  produtor está escrevendo: ficam legíveis as
+*                  posições menos uma
+*
+*  $FV Valor retornado
+*     O histórico criado, ou NULL se faltou memória.
+*
+***********************************************************************/
+
+HST_tpHistorico HST_Criar( unsigned capacidade ) ;
+
+/***********************************************************************
+*
+*  $FC Função: HST  &Destruir histórico
+*
+*  $ED Descrição da função
+*     Libera o histórico. Nenhum produtor ou leitor pode estar usando-o.
+*
+***********************************************************************/
+
+void HST_Destruir( HST_tpHistorico pHist ) ;
+
+/***********************************************************************
+*
+*  $FC Função: HST  &Inserir amostra
+*
+*  $ED Descrição da função
+*     Acrescenta uma amostra, sobrescrevendo a mais antiga se o anel
+*     estiver cheio. Só pode ser chamada pelo produtor. Os timestamps
+*     devem ser não decrescentes.
+*
+***********************************************************************/
+
+void HST_Inserir( HST_tpHistorico pHist , const LER_tpAmostra * pAmostra ) ;
+
+/***********************************************************************
+*
+*  $FC Função: HST  &Obter últimas amostras
+*
+*  $EP Parâmetros
+*    n        - Número máximo de amostras desejadas
+*    pJanela  - Recebe a janela com min(n, disponíveis) amostras
+*
+*  $FV Valor retornado
+*     HST_CondRetOK ou HST_CondRetVazio se o histórico está vazio.
+*
+***********************************************************************/
+
+HST_tpCondRet HST_ObterUltimas( HST_tpHistorico pHist , unsigned n , HST_tpJanela * pJanela ) ;
+
+/***********************************************************************
+*
+*  $FC Função: HST  &Obter amostras desde um instante
+*
+*  $ED Descrição da função
+*     Janela com todas as amostras de timestamp estritamente maior que
+*     'desde'. A busca é binária sobre o anel.
+*
+*  $FV Valor retornado
+*     HST_CondRetOK ou HST_CondRetVazio se não há amostras novas.
+*
+***********************************************************************/
+
+HST_tpCondRet HST_ObterDesde( HST_tpHistorico pHist , uint64_t desde , HST_tpJanela * pJanela ) ;
+
+/***********************************************************************
+*
+*  $FC Função: HST  &Validar janela
+*
+*  $ED Descrição da função
+*     Deve ser chamada depois de processar a janela: confirma que nenhuma
+*     das amostras lidas foi sobrescrita pelo produtor.
+*
+*  $FV Valor retornado
+*     HST_CondRetOK ou HST_CondRetSobrescrito (descartar o resultado e
+*     pedir uma nova janela).
+*
+***********************************************************************/
+
+HST_tpCondRet HST_JanelaValida( HST_tpHistorico pHist , const HST_tpJanela * pJanela ) ;
+
+/***********************************************************************
+*
+*  $FC Função: HST  &Copiar janela
+*
+*  $ED Descrição da função
+*     Copia as amostras da janela para um vetor contíguo e valida a
+*     cópia.
+*
+*  $EP Parâmetros
+*    pDestino  - Vetor com espaço para tamanho[0] + tamanho[1] amostras
+*
+*  $FV Valor retornado
+*     HST_CondRetOK ou HST_CondRetSobrescrito.
+*
+***********************************************************************/
+
+HST_tpCondRet HST_CopiarJanela( HST_tpHistorico pHist , const HST_tpJanela * pJanela , LER_tpAmostra * pDestino ) ;
+
+/***********************************************************************
+*
+*  $FC Função: HST  &Capacidade de anel
+*
+*  $FV Valor retornado
+*     'capacidade' arredondada para a potência de 2 seguinte, no mínimo
+*     2: o número de elementos que a área de HST_IniciarAnel deve ter.
+*
+***********************************************************************/
+
+unsigned HST_CapacidadeAnel( unsigned capacidade ) ;
+
+/***********************************************************************
+*
+*  $FC Função: HST  &Iniciar anel
+*
+*  $EP Parâmetros
+*    pElementos   - Área para 'capacidade' elementos; continua do
+*                   chamador e tem de durar tanto quanto o anel
+*    capacidade   - Valor devolvido por HST_CapacidadeAnel
+*    tamElemento  - Tamanho de cada elemento em bytes
+*
+***********************************************************************/
+
+void HST_IniciarAnel( HST_tpAnel * pAnel , void * pElementos , unsigned capacidade , size_t tamElemento ) ;
+
+/***********************************************************************
+*
+*  $FC Função: HST  &Inserir elemento no anel
+*
+*  $ED Descrição da função
+*     Como HST_Inserir: sobrescreve o mais antigo se o anel estiver
+*     cheio. Só pode ser chamada pelo produtor.
+*
+***********************************************************************/
+
+void HST_InserirAnel( HST_tpAnel * pAnel , const void * pElemento ) ;
+
+/***********************************************************************
+*
+*  $FC Função: HST  &Ler do anel a partir de um cursor
+*
+*  $ED Descrição da função
+*     Copia para pDestino até 'max' elementos a partir da sequência
+*     *pCursor e confere, como HST_JanelaValida, que o produtor não os
+*     sobrescreveu durante a cópia; se sobrescreveu, copia de novo.
+*     Se o cursor ficou para trás do anel, começa pelo elemento mais
+*     antigo ainda legível.
+*
+*  $EP Parâmetros
+*    pCursor    - Sequência do próximo elemento; avança o lido.
+*                 Comece com 0
+*    pNum       - Recebe o número de elementos copiados
+*    pPerdidas  - Se não NULL, recebe quantos elementos foram pulados
+*                 por atraso do leitor
+*
+*  $FV Valor retornado
+*     HST_CondRetOK ou HST_CondRetVazio se não há elementos novos.
+*
+***********************************************************************/
+
+HST_tpCondRet HST_LerAnel( HST_tpAnel * pAnel , uint32_t * pCursor , void * pDestino , unsigned max ,
+                           unsigned * pNum , uint32_t * pPerdidas ) ;
+
+#endif
@@ -22,6 +22,21 @@
 #include <stdlib.h>
 #endif
 
+#ifndef _STRING
+#define _STRING
+#include <string.h>
+#endif
+
+#ifndef _STDDEF
+#define _STDDEF
+#include <stddef.h>
+#endif
+
+#ifndef _MATH
+#define _MATH
+#include <math.h>
+#endif
+
 #ifndef _UORB
 #define _UORB
 #include <uORB/uORB.h>
@@ -52,13 +67,41 @@
 #include <uORB/topics/vehicle_local_position.h>
 #endif
 
+#ifndef _PTHREAD
+#define _PTHREAD
+#include <pthread.h>
+#endif
+
+#ifndef _UNISTD
+#define _UNISTD
+#include <unistd.h>
+#endif
+
 #define LER_PARAMETROS_OWN
 #include "LER_PARAMETROS.h"
 #undef LER_PARAMETROS_OWN
 
-#define ATT_FD    2
-#define GLOBAL_FD 1
-#define SENSOR_FD 0
+#include "HST_HISTORICO.h"
+#include "REG_REGISTRO.h"
+#include "AVS_AVISOS.h"
+
+#define LER_JANELA_TAXA_US  1000000ULL         /* Janela de medição da taxa efetiva         */
+#define LER_TAM_BRUTO       512                /* Maior estrutura de tópico aceita, em bytes */
+#define LER_RAD_EM_GRAU     57.29747f
+
+/***********************************************************************
+*
+*  $TC Tipo de dados: LER - Origem da memória de uma estrutura de parâmetros
+*
+***********************************************************************/
+
+typedef enum {
+	LER_MemoriaInvalida ,                      /* Já destruída                              */
+	LER_MemoriaPool     ,                      /* Conjunto estático de LER_CriarParam       */
+	LER_MemoriaHeap     ,                      /* calloc, com o conjunto esgotado           */
+	LER_MemoriaChamador ,                      /* LER_IniciarParam                          */
+
+} LER_origemMemoria;
 
 /***********************************************************************
 *
@@ -68,40 +111,314 @@
 ***********************************************************************/
 
 typedef struct LER_parametros {
-	float pressao    ;                         /* Pressão em MILIBAR                            */
-	float pitchSpeed ;                         /* Velocidade de Pitch em º/s                */
-	float rollSpeed  ;                         /* Velocidade de Roll  em º/s                */
-	float yawSpeed   ;                         /* Velocidade de yaw   em º/s                */
-	float pitch      ;                         /* Angulo de yaw  em º                       */
-	float roll       ;                         /* Angulo de roll em º                       */
-	float yaw        ;                         /* Angulo de yaw  em º                       */
-	float ax         ;                         /* Aceleração no eixo x em m/s²              */
-	float ay         ;                         /* Aceleração no eixo y em m/s²              */
-	float az         ;                         /* Aceleração no eixo z em m/s²              */
-	float altura     ;                         /* Altura em relação ao home point em metros */
+	float valor[LER_NumCampos] ;               /* Indexado por LER_tpCampo, na unidade dele */
+	float rotacao[3][3] ;                      /* Corpo -> NED, da última atitude           */
+	float acelMundo[3]  ;                      /* Aceleração em NED sem a gravidade, m/s²   */
+	ALT_tpEstimativa vertical ;                /* Altura e razão de subida pelo barômetro   */
+	hrt_abstime timestamp ;                    /* Instante do último ciclo com dados novos  */
+	hrt_abstime origem[LER_NumGrupos] ;        /* Timestamp uORB de cada grupo (0 = nunca)  */
+	unsigned    validos   ;                    /* Máscara dos grupos com dado válido        */
+	unsigned    novos     ;                    /* Máscara dos grupos atualizados no ciclo   */
+	unsigned    pendentes ;                    /* Tópicos prontos e não copiados (bit = LER_tpTopico) */
+	struct LER_contexto *contexto ;            /* Quem copia os pendentes (LER_ModoSobDemanda) */
+	LER_origemMemoria memoria ;                /* Como LER_DestruirParam a devolve          */
 
 } LER_parametros;
 
+/***********************************************************************
+*
+*  $TC Tipo de dados: LER - Retrato
+*
+*  $ED Descrição do tipo
+*     Parâmetros publicados por quem faz o poll. Protegido por seqlock:
+*     sequência ímpar = escrita em andamento, par = retrato consistente.
+*
+***********************************************************************/
+
+typedef struct LER_retrato {
+	unsigned          sequencia   ;
+	LER_parametros    dado        ;
+	LER_tpAlinhamento alinhamento ;            /* Só no retrato alinhado                    */
+
+} LER_retrato;
+
+/***********************************************************************
+*
+*  $TC Tipo de dados: LER - Série de um grupo
+*
+*  $ED Descrição do tipo
+*     Últimas amostras de um grupo para o alinhamento, em anel, com
+*     origens crescentes. Escrita só por quem faz o poll.
+*
+***********************************************************************/
+
+#define LER_MASCARA_SERIE  ( LER_PROFUNDIDADE_ALINHAMENTO - 1 )
+
+typedef struct LER_serie {
+	unsigned    cabeca ;                       /* Amostras já inseridas                     */
+	hrt_abstime origem[LER_PROFUNDIDADE_ALINHAMENTO] ;
+	float       valor [LER_PROFUNDIDADE_ALINHAMENTO][LER_NumCampos] ;
+
+} LER_serie;
+
+/***********************************************************************
+*
+*  $TC Tipo de dados: LER - Contexto
+*
+*  $ED Descrição do tipo
+*     Conjunto de assinaturas de um consumidor. Cada contexto tem seus
+*     próprios handles, intervalos e poll set, de modo que consumidores
+*     com taxas diferentes não interferem entre si.
+*
+***********************************************************************/
+
+typedef struct LER_contexto {
+	int              fd[LER_NumTopicos] ;      /* Handle de cada tópico; -1 = não assinado  */
+	struct pollfd    fds[LER_NumTopicos] ;     /* Poll set: só os tópicos assinados         */
+	LER_tpTopico     topicoDoFd[LER_NumTopicos] ; /* Tópico de cada posição de fds          */
+	unsigned         numAssinados  ;
+	unsigned         assinados     ;           /* Máscara dos tópicos assinados             */
+	unsigned         grupos        ;           /* Grupos pedidos em LER_tpConfig            */
+	uint64_t         bruto[LER_TAM_BRUTO / sizeof( uint64_t )] ; /* Destino do orb_copy    */
+	int              prazoPollMs   ;           /* Prazo do poll em ms                       */
+
+	/* Medição da taxa efetiva de cada tópico (amostras novas por segundo) */
+
+	struct {
+		hrt_abstime  ultimaOrigem  ;           /* timestamp da última amostra contada       */
+		hrt_abstime  inicioJanela  ;
+		unsigned     contagem      ;
+		float        taxaHz        ;           /* Última janela completa; < 0 se nenhuma    */
+	} taxa[LER_NumTopicos] ;
+
+	LER_tpModo       modo          ;
+	pthread_t        thread        ;           /* Thread de aquisição (LER_ModoThread)      */
+	volatile int     threadAtiva   ;
+
+	LER_tpDiagnostico diag         ;           /* Escrito só por quem faz o poll            */
+	pthread_t        relator       ;           /* Thread de LER_IniciarRelator              */
+	volatile int     relatorAtivo  ;
+	unsigned         periodoRelatorMs ;
+
+	FLT_tpCanal      filtro[LER_NumCampos] ;   /* Filtros de LER_tpConfig, na unidade do tópico */
+	hrt_abstime      origemFiltro[LER_NumCampos] ; /* Origem da última amostra filtrada      */
+
+	hrt_abstime      origemRotacao ;           /* Atitude de onde veio a matriz abaixo      */
+	float            rotacao[3][3] ;           /* Corpo -> NED, uma vez por atitude nova    */
+
+	ALT_tpEstimador  vertical      ;           /* Tabela e filtro da altura barométrica     */
+
+	SAU_tpConfig     configSaude   ;
+	SAU_tpFonte      fonteSaude[LER_NumTopicos] ; /* Taxa e silêncio de cada tópico         */
+	SAU_tpCanal      canalSaude[LER_NumCampos]  ; /* Estatísticas de cada campo, antes do filtro */
+
+	HST_tpHistorico  historico     ;           /* NULL se LER_AtivarHistorico não foi chamada */
+	REG_tpRegistro   registro      ;           /* NULL se LER_AssociarRegistro não foi chamada */
+	CAP_tpCaptura    captura       ;           /* NULL se LER_AtivarCaptura não foi chamada */
+	LER_tpCompartilhado *compartilhado ;       /* NULL se LER_AssociarCompartilhado não foi chamada */
+	AVS_tpConjunto   *avisos       ;           /* NULL se LER_AssociarAvisos não foi chamada */
+	ESP_tpAnalisador *espectro     ;           /* NULL se LER_AtivarVibracao não foi chamada */
+	uint32_t         cursorEspectro ;          /* Próxima amostra bruta para o analisador   */
+	pthread_mutex_t  travaEspectro ;           /* Serializa LER_ObterVibracao               */
+
+	/* Retrato publicado pela thread de aquisição */
+
+	LER_retrato      retrato       ;
+
+	/* Alinhamento no tempo (LER_FillParamAlinhado) */
+
+	hrt_abstime      atrasoAlinhamentoUs ;     /* 0 = desligado                             */
+	LER_serie        serie[LER_NumGrupos] ;
+	LER_parametros   brutoAlinhamento ;        /* Parâmetros de lerTopicos em LER_ModoSincrono */
+	LER_retrato      alinhado      ;           /* Publicado a cada instante comum novo      */
+
+} LER_contexto;
+
+/* Incremento de contador com um único escritor: leitores concorrentes
+   veem o valor antigo ou o novo, sem a instrução atômica de leitura-
+   modificação-escrita. */
+
+#define INCREMENTAR( x )  __atomic_store_n( &( x ) , ( x ) + 1 , __ATOMIC_RELAXED )
+
 /***** Constantes Globais *****/
 
-static const float CONVERT_RAD_INTO_GRAU = 57.29747 ;
+static const float CONVERT_RAD_INTO_GRAU = LER_RAD_EM_GRAU ;
+
+static const float GRAVIDADE = 9.80665f ;     /* m/s² */
+
+/* A estrutura cabe na área de LER_IniciarParam, cada estrutura do
+   conjunto tem um bit em ocupadosPool e cada campo é um canal do AVS */
 
-/***** Variáveis Globais ******/
+typedef char LER_verificarTamanhos[ ( sizeof( LER_parametros ) <= LER_TAM_MEMORIA_PARAM &&
+                                      LER_TAM_POOL_PARAM >= 1 && LER_TAM_POOL_PARAM <= 32 &&
+                                      LER_NumCampos <= AVS_MAX_CANAIS ) ? 1 : -1 ] ;
 
-static int att_fd           ;
+#define LER_MASCARA_POOL  ( 0xFFFFFFFFu >> ( 32 - LER_TAM_POOL_PARAM ) )
 
-static int global_fd        ;
+/* Desvio abaixo do qual uma amostra nunca é atípica, na unidade do
+   campo: a resolução útil do sensor */
 
-static int sensor_fd        ;
+static const float resolucaoSaude[ LER_NumCampos ] = {
+	0.05f ,                                    /* LER_CampoPressao    (mbar)   */
+	0.5f  ,                                    /* LER_CampoPitchSpeed (º/s)    */
+	0.5f  ,                                    /* LER_CampoRollSpeed           */
+	0.5f  ,                                    /* LER_CampoYawSpeed            */
+	0.2f  ,                                    /* LER_CampoPitch      (º)      */
+	0.2f  ,                                    /* LER_CampoRoll                */
+	0.2f  ,                                    /* LER_CampoYaw                 */
+	0.05f ,                                    /* LER_CampoAx         (m/s²)   */
+	0.05f ,                                    /* LER_CampoAy                  */
+	0.05f ,                                    /* LER_CampoAz                  */
+	0.1f  ,                                    /* LER_CampoAltura     (m)      */
+} ;
 
-static struct pollfd fds[3] ;
+/***** Variáveis Globais *****/
+
+static LER_parametros poolParam[ LER_TAM_POOL_PARAM ] ;
+
+static unsigned ocupadosPool = 0 ;            /* Bit i = poolParam[i] em uso               */
 
 
 /***** Protótipos das funções encapuladas no módulo *****/
 
-	static LER_tpCondRet aquisitarAceleracao    (float *Acel , float *pressao )  ;
-	static LER_tpCondRet aquisitarAtitudes      (float *Att , float *attRates )  ;
-	static LER_tpCondRet aquisitarAltitude      (float *altura   )               ;
+	static void          copiarTopico           (LER_contexto *pCtx , LER_tpTopico topico ,
+	                                             LER_parametros *pParam )                             ;
+	static unsigned      gruposDoTopico         (LER_tpTopico topico )                                ;
+	static float         lerBruto               (const unsigned char *pDado , int tipo )              ;
+	static void          marcarGrupo            (LER_parametros *pParam , LER_tpGrupo grupo , hrt_abstime origem ) ;
+	static LER_tpCondRet condRetDosNovos        (unsigned novos , unsigned todos )                    ;
+	static LER_tpCondRet lerTopicos             (LER_contexto *pCtx , LER_parametros *pParam )        ;
+	static LER_tpCondRet aguardarTopicos        (LER_contexto *pCtx , unsigned *pProntos )            ;
+	static void          derivarParametros      (LER_contexto *pCtx , LER_parametros *pParam )        ;
+	static LER_tpCondRet marcarPendentes        (LER_contexto *pCtx , LER_parametros *pParam )        ;
+	static void          prepararGrupos         (LER_parametros *pParam , unsigned grupos )           ;
+	static void          resolverPendentes      (LER_parametros *pParam , unsigned grupos )           ;
+	static void *        aquisicaoContinua      (void *arg )                                          ;
+	static void          publicarCompartilhado  (LER_tpCompartilhado *pRegiao , const LER_parametros *pParam ,
+	                                             const LER_tpAmostra *pAmostra )                   ;
+	static int           regiaoValida           (const LER_tpCompartilhado *pRegiao )                 ;
+	static LER_tpCondRet condRetDoGrupo         (LER_tpGrupo grupo )                                  ;
+	static unsigned      camposDosGrupos        (unsigned grupos )                                    ;
+	static void          publicarRetrato        (LER_retrato *pRetrato , const LER_parametros *pParam ,
+	                                             const LER_tpAlinhamento *pAlinhamento )               ;
+	static LER_tpCondRet copiarRetrato          (LER_retrato *pRetrato , LER_parametros *pParam ,
+	                                             LER_tpAlinhamento *pAlinhamento , unsigned todos )    ;
+	static void          contarAmostra          (LER_contexto *pCtx , LER_tpTopico topico , hrt_abstime origem ) ;
+	static void          atualizarTaxas         (LER_contexto *pCtx )                                 ;
+	static void          medirCopia             (LER_contexto *pCtx , LER_tpTopico topico ,
+	                                             hrt_abstime inicio , hrt_abstime origem )             ;
+	static void          registrarTempo         (LER_tpHistograma *pHist , hrt_abstime us )           ;
+	static void *        relatorContinuo        (void *arg )                                          ;
+	static float         filtrarCampo           (LER_contexto *pCtx , LER_tpCampo campo , float valor ,
+	                                             hrt_abstime origem )                                 ;
+	static void          transporTrecho         (const LER_tpAmostra *pAmostras , unsigned n ,
+	                                             unsigned destino , LER_tpBloco *pBloco )             ;
+	static void          alinhar                (LER_contexto *pCtx , LER_parametros *pParam )        ;
+	static int           interpolarSerie        (const LER_serie *pSerie , LER_tpGrupo grupo ,
+	                                             hrt_abstime instante , float *valor , uint32_t *pErroUs ) ;
+	static void          aplicarValores         (LER_parametros *pParam , const float *valor )        ;
+	static void          atualizarRotacao       (LER_contexto *pCtx , const void *pBruto )            ;
+	static void          calcularRotacao        (float R[3][3] , float roll , float pitch , float yaw ) ;
+	static void          calcularAcelMundo      (LER_parametros *pParam )                             ;
+
+/***** Tabelas dos tópicos e dos campos *****/
+
+/*  Para ler um tópico novo basta um valor em LER_tpTopico, os campos em
+    LER_tpCampo e LER_GrupoDoCampo, o descritor do tópico e uma linha por
+    campo no mapa. Nenhuma função muda. */
+
+#define LER_SEM_DESLOCAMENTO  ( ( size_t ) -1 )
+
+/***********************************************************************
+*
+*  $TC Tipo de dados: LER - Tipo de um membro da estrutura do tópico
+*
+***********************************************************************/
+
+typedef enum {
+	LER_BrutoFloat  ,
+	LER_BrutoDouble ,
+	LER_BrutoInt32  ,
+	LER_BrutoUint32 ,
+	LER_BrutoInt16  ,
+	LER_BrutoUint8  ,
+
+} LER_tipoBruto;
+
+/***********************************************************************
+*
+*  $TC Tipo de dados: LER - Descritor de um tópico
+*
+***********************************************************************/
+
+typedef struct LER_descritorTopico {
+	const struct orb_metadata * meta ;
+	size_t      deslocTimestamp ;              /* uint64_t com o timestamp do tópico        */
+	void     ( *posCopia )( LER_contexto *pCtx , const void *pBruto ) ;
+	                                           /* Chamada a cada cópia; pode ser NULL       */
+} LER_descritorTopico;
+
+/***********************************************************************
+*
+*  $TC Tipo de dados: LER - Mapeamento de um membro do tópico num campo
+*
+*  $ED Descrição do tipo
+*     O valor lido é convertido para float, passa pelo filtro do campo
+*     (na unidade do tópico) e é multiplicado pela escala.
+*
+***********************************************************************/
+
+typedef struct LER_mapaCampo {
+	LER_tpTopico  topico       ;
+	LER_tpCampo   campo        ;
+	size_t        deslocValor  ;
+	LER_tipoBruto tipo         ;
+	float         escala       ;
+	size_t        deslocOrigem ;               /* uint64_t; ausente ou 0 = timestamp do tópico */
+	size_t        deslocValido ;               /* bool; ausente = sempre válido             */
+} LER_mapaCampo;
+
+#define DESLOC( estrutura , membro )  offsetof( struct estrutura , membro )
+
+static const LER_descritorTopico topicos[ LER_NumTopicos ] = {
+	{ ORB_ID( sensor_combined )        , DESLOC( sensor_combined_s , timestamp )        , NULL             } ,
+	{ ORB_ID( vehicle_local_position ) , DESLOC( vehicle_local_position_s , timestamp ) , NULL             } ,
+	{ ORB_ID( vehicle_attitude )       , DESLOC( vehicle_attitude_s , timestamp )       , atualizarRotacao } ,
+} ;
+
+static const LER_mapaCampo mapa[ ] = {
+
+	/* sensor_combined sai na taxa do giro; cada sensor tem seu timestamp */
+
+	{ LER_TopicoSensor  , LER_CampoAx         , DESLOC( sensor_combined_s , accelerometer_m_s2[0] ) , LER_BrutoFloat , 1.0f ,
+	  DESLOC( sensor_combined_s , accelerometer_timestamp ) , LER_SEM_DESLOCAMENTO } ,
+	{ LER_TopicoSensor  , LER_CampoAy         , DESLOC( sensor_combined_s , accelerometer_m_s2[1] ) , LER_BrutoFloat , 1.0f ,
+	  DESLOC( sensor_combined_s , accelerometer_timestamp ) , LER_SEM_DESLOCAMENTO } ,
+	{ LER_TopicoSensor  , LER_CampoAz         , DESLOC( sensor_combined_s , accelerometer_m_s2[2] ) , LER_BrutoFloat , 1.0f ,
+	  DESLOC( sensor_combined_s , accelerometer_timestamp ) , LER_SEM_DESLOCAMENTO } ,
+	{ LER_TopicoSensor  , LER_CampoPressao    , DESLOC( sensor_combined_s , baro_pres_mbar )        , LER_BrutoFloat , 1.0f ,
+	  DESLOC( sensor_combined_s , baro_timestamp )          , LER_SEM_DESLOCAMENTO } ,
+
+	/* z do NED; o estimador diz se vale */
+
+	{ LER_TopicoPosicao , LER_CampoAltura     , DESLOC( vehicle_local_position_s , z )              , LER_BrutoFloat , 1.0f ,
+	  LER_SEM_DESLOCAMENTO , DESLOC( vehicle_local_position_s , z_valid ) } ,
+
+	{ LER_TopicoAtitude , LER_CampoRoll       , DESLOC( vehicle_attitude_s , roll )       , LER_BrutoFloat , LER_RAD_EM_GRAU ,
+	  LER_SEM_DESLOCAMENTO , LER_SEM_DESLOCAMENTO } ,
+	{ LER_TopicoAtitude , LER_CampoPitch      , DESLOC( vehicle_attitude_s , pitch )      , LER_BrutoFloat , LER_RAD_EM_GRAU ,
+	  LER_SEM_DESLOCAMENTO , LER_SEM_DESLOCAMENTO } ,
+	{ LER_TopicoAtitude , LER_CampoYaw        , DESLOC( vehicle_attitude_s , yaw )        , LER_BrutoFloat , LER_RAD_EM_GRAU ,
+	  LER_SEM_DESLOCAMENTO , LER_SEM_DESLOCAMENTO } ,
+	{ LER_TopicoAtitude , LER_CampoRollSpeed  , DESLOC( vehicle_attitude_s , rollspeed )  , LER_BrutoFloat , LER_RAD_EM_GRAU ,
+	  LER_SEM_DESLOCAMENTO , LER_SEM_DESLOCAMENTO } ,
+	{ LER_TopicoAtitude , LER_CampoPitchSpeed , DESLOC( vehicle_attitude_s , pitchspeed ) , LER_BrutoFloat , LER_RAD_EM_GRAU ,
+	  LER_SEM_DESLOCAMENTO , LER_SEM_DESLOCAMENTO } ,
+	{ LER_TopicoAtitude , LER_CampoYawSpeed   , DESLOC( vehicle_attitude_s , yawspeed )   , LER_BrutoFloat , LER_RAD_EM_GRAU ,
+	  LER_SEM_DESLOCAMENTO , LER_SEM_DESLOCAMENTO } ,
+} ;
+
+#define LER_NUM_MAPA  ( sizeof( mapa ) / sizeof( mapa[0] ) )
 
 /*****  Código das funções exportadas pelo módulo  *****/
 
@@ -113,347 +430,2486 @@ static struct pollfd fds[3] ;
 	LER_tpParametros LER_CriarParam(void)
 	{
 		LER_parametros *pParam = NULL;
+		unsigned ocupados = __atomic_load_n( &ocupadosPool , __ATOMIC_RELAXED ) ;
+		unsigned livres ;
+
+		/* Reserva o primeiro livre do conjunto; se outra thread reservou
+		   no meio, o CAS falha, traz a máscara atual e tenta de novo */
+
+		while ( ( livres = ~ocupados & LER_MASCARA_POOL ) != 0 )
+		{
+			unsigned i = ( unsigned ) __builtin_ctz( livres ) ;
+
+			if ( __atomic_compare_exchange_n( &ocupadosPool , &ocupados , ocupados | ( 1u << i ) , 0 ,
+			                                  __ATOMIC_ACQUIRE , __ATOMIC_RELAXED ) )
+			{
+				pParam = &poolParam[i] ;
+				memset( pParam , 0 , sizeof(LER_parametros) ) ;
+				pParam->memoria = LER_MemoriaPool ;
+
+				return pParam ;
+			}
+		}
 
-		pParam = (LER_parametros *) malloc(sizeof(LER_parametros)) ;
+		pParam = (LER_parametros *) calloc( 1 , sizeof(LER_parametros) ) ;
+
+		if ( pParam != NULL )
+		{
+			pParam->memoria = LER_MemoriaHeap ;
+		}
 
 		return pParam ;
 	}
 
 /***************************************************************************
 *
-*  Função: LER  & Inicializar a estrutura do módulo
+*  Função: LER  & Iniciar estrutura na memória do chamador
 *  ****/
 
-	LER_tpCondRet LER_Iniciar(void)
+	LER_tpCondRet LER_IniciarParam( void * memoria , unsigned tamanho , LER_tpParametros * pParam )
 	{
+		LER_parametros *pNova = ( LER_parametros * ) memoria ;
+
+		*pParam = NULL ;
+
+		if ( memoria == NULL || tamanho < sizeof(LER_parametros) ||
+		     ( ( uintptr_t ) memoria & ( sizeof( uint64_t ) - 1 ) ) != 0 )
+		{
+			return LER_CondRetError ;
+		}
+
+		memset( pNova , 0 , sizeof(LER_parametros) ) ;
+		pNova->memoria = LER_MemoriaChamador ;
 
-		att_fd    = orb_subscribe( ORB_ID( vehicle_attitude ) )         ;
+		*pParam = pNova ;
+
+		return LER_CondRetOK ;
+	}
 
-		global_fd = orb_subscribe( ORB_ID( vehicle_local_position ) )   ;
+/***************************************************************************
+*
+*  Função: LER  & Destruir estrutura
+*  ****/
 
-		sensor_fd = orb_subscribe( ORB_ID( sensor_combined ))           ;
+	void LER_DestruirParam( LER_tpParametros pStructParam )
+	{
+		LER_origemMemoria memoria ;
 
-		fds[ATT_FD].fd        = att_fd                                  ;
-		fds[ATT_FD].events    = POLLIN                                  ;
+		if ( pStructParam == NULL )
+		{
+			return ;
+		}
 
-		fds[GLOBAL_FD].fd     = global_fd                               ;
-		fds[GLOBAL_FD].events = POLLIN                                  ;
+		memoria = pStructParam->memoria ;
+		pStructParam->memoria = LER_MemoriaInvalida ;
 
-		fds[SENSOR_FD].fd     = sensor_fd                               ;
-		fds[SENSOR_FD].events = POLLIN                                  ;
+		switch ( memoria )
+		{
+			case LER_MemoriaPool :
+				__atomic_fetch_and( &ocupadosPool , ~( 1u << ( unsigned ) ( pStructParam - poolParam ) ) , __ATOMIC_RELEASE ) ;
+				break ;
 
-		orb_set_interval( att_fd    , 100   )                           ;
-		orb_set_interval( global_fd , 100   )                           ;
-		orb_set_interval( sensor_fd , 100   )                           ;
+			case LER_MemoriaHeap :
+				free( pStructParam ) ;
+				break ;
 
-		return LER_CondRetOK ;
+			default :                          /* Do chamador ou já destruída */
+				break ;
+		}
 	}
 
 /***************************************************************************
 *
-*  Função: LER  & Preenche a estrutura com os parâmetros fundamentais
+*  Função: LER  & Configuração padrão
 *  ****/
 
-	LER_tpCondRet LER_FillParam(LER_tpParametros pStructParam)
+	void LER_ConfigPadrao( LER_tpConfig * pConfig )
 	{
-		float acel[3]         ;
-		float att [3]         ;
-		float attRates [3]    ;
-		float pressao         ;
-		float altitude        ;
+		int t ;
+
+		pConfig->modo = LER_ModoSincrono                                ;
 
-		LER_tpCondRet retAcel    ; /* Retorno da saída do acelerometro             */
-		LER_tpCondRet retAtt     ; /* Retorno da saída do magnetômetro             */
-		LER_tpCondRet retAttRate ; /* Retorno da saída da derivada do magnetômetro */
-		LER_tpCondRet retPressao ; /* Retorno da saída do barômetro                */
-		LER_tpCondRet retHeight  ; /* Retorno da saída do calculo da altura        */
+		for ( t = 0 ; t < LER_NumTopicos ; t++ )
+		{
+			pConfig->intervaloMs[ t ] = 100                             ;
+		}
 
-		/* Aquisitar os parâmetros e analisar resultados */
+		pConfig->prazoPollMs = 200                                      ;
 
-		/* Verifica se teve dados no último segundo */
+		memset( pConfig->filtro , 0 , sizeof( pConfig->filtro ) )       ;
 
-		int poll_ret = poll( fds , 3 , 200 )               ;
+		pConfig->alinhamentoMs = 0                                      ;
 
-		/* handling resultado */
+		pConfig->grupos        = LER_TODOS_GRUPOS                       ;
 
-		if ( poll_ret == 0 ) /* Sem data */
+		ALT_ConfigPadrao( &pConfig->vertical )                          ;
+
+		SAU_ConfigPadrao( &pConfig->saude )                             ;
+	}
+
+/***************************************************************************
+*
+*  Função: LER  & Inicializar um contexto de leitura
+*  ****/
+
+	LER_tpCondRet LER_Iniciar( LER_tpContexto * ppContexto , const LER_tpConfig * pConfig )
+	{
+		LER_contexto *pCtx = NULL                                       ;
+		LER_tpConfig  padrao                                            ;
+		int           t                                                 ;
+
+		*ppContexto = NULL                                              ;
+
+		if ( pConfig == NULL )
 		{
-			printf(" [Aero] Sem dados por um segundo\n ") ;
-			return LER_CondRetError                       ;
+			LER_ConfigPadrao( &padrao )                                 ;
+			pConfig = &padrao                                           ;
 		}
 
-		else if ( poll_ret < 0) /* Erro bizarro */
+		if ( pConfig->filtro[LER_CampoRoll].numEstagios  != 0 ||
+		     pConfig->filtro[LER_CampoPitch].numEstagios != 0 ||
+		     pConfig->filtro[LER_CampoYaw].numEstagios   != 0 )
 		{
-			printf(" [Aero] Erro bizarro\n ")             ;
-			return LER_CondRetError                       ;
+			return LER_CondRetError                                     ;
 		}
-		else  /* Teve parametros ! */
+
+		/* O alinhamento precisa de todos os tópicos a cada ciclo */
+
+		if ( pConfig->modo == LER_ModoSobDemanda && pConfig->alinhamentoMs != 0 )
 		{
+			return LER_CondRetError                                     ;
+		}
 
-			retAcel = aquisitarAceleracao( acel , &pressao )    ;
+		/* Com intervalo igual ou maior que a janela, cada amostra nova de
+		   um tópico já chega fora dela: o grupo fica retido quase sempre e
+		   o alinhamento piora o que devia corrigir */
 
-			if ( retAcel == LER_CondRetAcelError )
+		for ( t = 0 ; t < LER_NumTopicos && pConfig->alinhamentoMs != 0 ; t++ )
+		{
+			if ( ( gruposDoTopico( ( LER_tpTopico ) t ) & pConfig->grupos ) &&
+			     pConfig->intervaloMs[t] >= pConfig->alinhamentoMs )
 			{
-				printf("Erro no sensor combined\n")             ;
+				return LER_CondRetError                                 ;
 			}
+		}
 
-			retAtt = aquisitarAtitudes ( att , attRates )       ;
+		pCtx = (LER_contexto *) calloc( 1 , sizeof(LER_contexto) )      ;
 
-			if ( retAtt == LER_CondRetAttError )
-			{
-				printf("Erro no attitude\n")                    ;
-			}
+		if ( pCtx == NULL )
+		{
+			return LER_CondRetError                                     ;
+		}
+
+		for ( t = 0 ; t < LER_NumTopicos ; t++ )
+		{
+			pCtx->fd[t] = -1                                            ;
+		}
 
-			retHeight = aquisitarAltitude ( &altitude )         ;
+		/* Coeficientes calculados aqui, antes de qualquer aquisição */
 
-			if ( retHeight == LER_CondRetAltitudeError )
+		for ( t = 0 ; t < LER_NumCampos ; t++ )
+		{
+			if ( FLT_IniciarCanal( &pCtx->filtro[t] , &pConfig->filtro[t] ) != FLT_CondRetOK )
 			{
-				printf("Erro no global\n")                      ;
+				free( pCtx )                                            ;
+				return LER_CondRetError                                 ;
 			}
-
 		}
 
-		/* Preencher os parâmetros caso os dados sejam válidos */
+		if ( ALT_Iniciar( &pCtx->vertical , &pConfig->vertical ) != ALT_CondRetOK )
+		{
+			free( pCtx )                                                ;
+			return LER_CondRetError                                     ;
+		}
 
-		if ( retAcel == LER_CondRetOK )
+		if ( SAU_ValidarConfig( &pConfig->saude ) != SAU_CondRetOK )
 		{
-			pStructParam->ax = acel[0]  ;
-			pStructParam->ay = acel[1]  ;
-			pStructParam->az = acel[2]  ;
+			free( pCtx )                                                ;
+			return LER_CondRetError                                     ;
 		}
 
-		if ( retAtt == LER_CondRetOK )
+		pCtx->configSaude = pConfig->saude                              ;
+
+		for ( t = 0 ; t < LER_NumCampos ; t++ )
 		{
-			pStructParam->roll  = att[0] * CONVERT_RAD_INTO_GRAU ;
-			pStructParam->pitch = att[1] * CONVERT_RAD_INTO_GRAU ;
-			pStructParam->yaw   = att[2] * CONVERT_RAD_INTO_GRAU ;
+			SAU_IniciarCanal( &pCtx->canalSaude[t] , resolucaoSaude[t] ,
+			                  ( t == LER_CampoRoll || t == LER_CampoPitch || t == LER_CampoYaw ) ? 360.0f : 0.0f ) ;
 		}
 
-		if ( retAttRate == LER_CondRetOK )
+		for ( t = 0 ; t < LER_NumTopicos ; t++ )
 		{
-			pStructParam->rollSpeed  = attRates[0] * CONVERT_RAD_INTO_GRAU ;
-			pStructParam->pitchSpeed = attRates[1] * CONVERT_RAD_INTO_GRAU ;
-			pStructParam->yawSpeed   = attRates[2] * CONVERT_RAD_INTO_GRAU ;
+			SAU_IniciarFonte( &pCtx->fonteSaude[t] , hrt_absolute_time( ) ) ;
 		}
 
-		if ( retPressao == LER_CondRetOK )
+		/* Só os tópicos com algum grupo pedido entram no poll set */
+
+		pCtx->grupos = pConfig->grupos & LER_TODOS_GRUPOS               ;
+
+		for ( t = 0 ; t < LER_NumTopicos ; t++ )
 		{
-			pStructParam->pressao = pressao ;
+			pCtx->taxa[t].inicioJanela = hrt_absolute_time( )           ;
+			pCtx->taxa[t].taxaHz       = -1.0f                          ;
+
+			if ( ! ( gruposDoTopico( ( LER_tpTopico ) t ) & pCtx->grupos ) )
+			{
+				continue                                                ;
+			}
+
+			if ( topicos[t].meta->o_size > sizeof( pCtx->bruto ) ||
+			     ( pCtx->fd[t] = orb_subscribe( topicos[t].meta ) ) < 0 )
+			{
+				LER_Terminar( pCtx )                                    ;
+				return LER_CondRetError                                 ;
+			}
+
+			pCtx->fds[pCtx->numAssinados].fd        = pCtx->fd[t]       ;
+			pCtx->fds[pCtx->numAssinados].events    = POLLIN            ;
+			pCtx->topicoDoFd[pCtx->numAssinados]    = ( LER_tpTopico ) t ;
+			pCtx->numAssinados ++                                       ;
+			pCtx->assinados |= 1u << t                                  ;
+
+			orb_set_interval( pCtx->fd[t] , pConfig->intervaloMs[t] )   ;
 		}
 
-		if ( retHeight == LER_CondRetOK )
+		if ( pCtx->numAssinados == 0 )
 		{
-			pStructParam->altura  = altitude ;
+			LER_Terminar( pCtx )                                        ;
+			return LER_CondRetError                                     ;
 		}
 
-		/* Verifica se algumas das anteriores não funcionou direito */
+		pCtx->prazoPollMs = pConfig->prazoPollMs                        ;
+		pCtx->modo        = pConfig->modo                               ;
 
-		if( retAcel    != LER_CondRetOK ||
-			retAtt     != LER_CondRetOK ||
-			retAttRate != LER_CondRetOK ||
-			retPressao != LER_CondRetOK ||
-			retHeight  != LER_CondRetOK   )
+		pCtx->atrasoAlinhamentoUs = ( hrt_abstime ) pConfig->alinhamentoMs * 1000 ;
+
+		if ( pCtx->modo == LER_ModoThread )
 		{
-			return LER_CondRetError;
+			pCtx->threadAtiva = 1                                       ;
+
+			if ( pthread_create( &pCtx->thread , NULL , aquisicaoContinua , pCtx ) != 0 )
+			{
+				pCtx->threadAtiva = 0                                   ;
+				LER_Terminar( pCtx )                                    ;
+				return LER_CondRetError                                 ;
+			}
 		}
 
-		return LER_CondRetOK ;
+		*ppContexto = pCtx                                              ;
 
+		return LER_CondRetOK ;
 	}
 
-	/***************************************************************************
-	*
-	*  Função: LER  & Leitura propriamente dita da pressão
-	*  ****/
+/***************************************************************************
+*
+*  Função: LER  & Terminar um contexto
+*  ****/
 
-	float LER_Pressao( LER_tpParametros pStructParam )
+	void LER_Terminar( LER_tpContexto pContexto )
 	{
-		float pressao ;
+		int t ;
 
-		pressao = pStructParam->pressao ;
+		if ( pContexto == NULL )
+		{
+			return ;
+		}
 
-		if ( pressao < 0 )
-			return -1 ;
+		if ( pContexto->threadAtiva )
+		{
+			pContexto->threadAtiva = 0                                  ;
+			pthread_join( pContexto->thread , NULL )                    ;
+		}
 
-		return pressao ;
-	}
+		if ( pContexto->relatorAtivo )
+		{
+			pContexto->relatorAtivo = 0                                 ;
+			pthread_join( pContexto->relator , NULL )                   ;
+		}
 
-	/***************************************************************************
-	*
-	*  Função: LER  & Leitura propriamente dita do PitchSpeed
-	*  ****/
+		for ( t = 0 ; t < LER_NumTopicos ; t++ )
+		{
+			if ( pContexto->fd[t] >= 0 )
+			{
+				orb_unsubscribe( pContexto->fd[t] )                     ;
+			}
+		}
 
-	float LER_PitchSpeed( LER_tpParametros pStructParam )
-	{
-		return pStructParam->pitchSpeed ;
-	}
+		/* Estruturas do conjunto que ainda apontam para este contexto
+		   deixam de copiar dele; as do heap e as de LER_IniciarParam o
+		   chamador tem de destruir ou repreencher (LER_PARAMETROS.h) */
 
-	/***************************************************************************
-	*
-	*  Função: LER  & Leitura propriamente dita do RollSpeed
-	*  ****/
+		for ( t = 0 ; t < LER_TAM_POOL_PARAM ; t++ )
+		{
+			if ( ( __atomic_load_n( &ocupadosPool , __ATOMIC_ACQUIRE ) & ( 1u << t ) ) &&
+			     poolParam[t].contexto == pContexto )
+			{
+				poolParam[t].pendentes = 0                              ;
+				poolParam[t].contexto  = NULL                           ;
+			}
+		}
 
-	float LER_RollSpeed( LER_tpParametros pStructParam )
-	{
-		return pStructParam->rollSpeed ;
-	}
+		HST_Destruir( pContexto->historico )                            ;
+		CAP_Terminar( pContexto->captura )                              ;
 
-	/***************************************************************************
-	*
-	*  Função: LER  & Leitura propriamente dita do YawSpeed
-	*  ****/
+		if ( pContexto->espectro != NULL )
+		{
+			pthread_mutex_destroy( &pContexto->travaEspectro )          ;
+			free( pContexto->espectro )                                 ;
+		}
 
-	float LER_YawSpeed( LER_tpParametros pStructParam )
-	{
-		return pStructParam->yawSpeed ;
+		free( pContexto )                                               ;
 	}
 
-	/***************************************************************************
-	*
-	*  Função: LER  & Leitura propriamente dita do PitchAngle
-	*  ****/
+/***************************************************************************
+*
+*  Função: LER  & Definir intervalo de um tópico
+*  ****/
 
-	float LER_PitchAngle( LER_tpParametros pStructParam )
+	LER_tpCondRet LER_DefinirIntervalo( LER_tpContexto pContexto , LER_tpTopico topico , unsigned intervaloMs )
 	{
-		return pStructParam->pitch ;
-	}
+		if ( topico >= LER_NumTopicos || pContexto->fd[topico] < 0 )
+		{
+			return LER_CondRetError ;
+		}
 
-	/***************************************************************************
-	*
-	*  Função: LER  & Leitura propriamente dita do RollAngle
-	*  ****/
+		if ( orb_set_interval( pContexto->fd[topico] , intervaloMs ) != 0 )
+		{
+			return LER_CondRetError ;
+		}
 
-	float LER_RollAngle( LER_tpParametros pStructParam )
-	{
-		return pStructParam->roll ;
+		return LER_CondRetOK ;
 	}
 
-	/***************************************************************************
-	*
-	*  Função: LER  & Leitura propriamente dita do YawAngle
-	*  ****/
+/***************************************************************************
+*
+*  Função: LER  & Definir prazo do poll
+*  ****/
 
-	float LER_YawAngle( LER_tpParametros pStructParam )
+	LER_tpCondRet LER_DefinirPrazoPoll( LER_tpContexto pContexto , int prazoMs )
 	{
-		return pStructParam->yaw ;
+		__atomic_store_n( &pContexto->prazoPollMs , prazoMs , __ATOMIC_RELAXED ) ;
+
+		return LER_CondRetOK ;
 	}
 
-	/***************************************************************************
-	*
-	*  Função: LER  & Leitura propriamente dita da aceleração em x
-	*  ****/
+/***************************************************************************
+*
+*  Função: LER  & Obter taxa efetiva de um tópico
+*  ****/
 
-	float LER_AcelX( LER_tpParametros pStructParam )
+	float LER_TaxaEfetiva( LER_tpContexto pContexto , LER_tpTopico topico )
 	{
-		return pStructParam->ax ;
-	}
+		float taxa ;
 
-	/***************************************************************************
-	*
-	*  Função: LER  & Leitura propriamente dita da aceleração em y
-	*  ****/
+		if ( topico >= LER_NumTopicos )
+		{
+			return -1.0f ;
+		}
+
+		__atomic_load( &pContexto->taxa[topico].taxaHz , &taxa , __ATOMIC_RELAXED ) ;
+
+		return taxa ;
+	}
+
+/***************************************************************************
+*
+*  Função: LER  & Obter diagnóstico
+*  ****/
+
+	void LER_ObterDiagnostico( LER_tpContexto pContexto , LER_tpDiagnostico * pDiag )
+	{
+		const uint32_t * origem  = ( const uint32_t * ) &pContexto->diag ;
+		uint32_t *       destino = ( uint32_t * ) pDiag ;
+		unsigned i ;
+
+		/* O tipo só tem campos uint32_t */
+
+		for ( i = 0 ; i < sizeof( LER_tpDiagnostico ) / sizeof( uint32_t ) ; i++ )
+		{
+			destino[ i ] = __atomic_load_n( &origem[ i ] , __ATOMIC_RELAXED ) ;
+		}
+	}
+
+/***************************************************************************
+*
+*  Função: LER  & Obter saúde de um tópico
+*  ****/
+
+	LER_tpCondRet LER_ObterSaude( LER_tpContexto pContexto , LER_tpTopico topico , LER_tpSaude * pSaude )
+	{
+		SAU_tpEstado pior = SAU_EstadoOK ;
+		SAU_tpEstado estado ;
+		unsigned     m ;
+
+		if ( topico >= LER_NumTopicos || pContexto->fd[topico] < 0 )
+		{
+			return LER_CondRetError ;
+		}
+
+		pSaude->pior = LER_NumCampos ;
+
+		for ( m = 0 ; m < LER_NUM_MAPA ; m++ )
+		{
+			LER_tpCampo campo = mapa[m].campo ;
+
+			if ( mapa[m].topico != topico ||
+			     ! ( pContexto->grupos & LER_MASCARA_GRUPO( LER_GrupoDoCampo( campo ) ) ) )
+			{
+				continue ;
+			}
+
+			estado = __atomic_load_n( &pContexto->canalSaude[campo].estado , __ATOMIC_RELAXED ) ;
+
+			if ( estado > pior )
+			{
+				pior         = estado ;
+				pSaude->pior = campo ;
+			}
+		}
+
+		pSaude->estado = SAU_EstadoFonte( &pContexto->fonteSaude[topico] , &pContexto->configSaude ,
+		                                  hrt_absolute_time( ) , pior , &pSaude->taxaHz , &pSaude->idadeS ) ;
+
+		if ( pSaude->estado == SAU_EstadoMudo )
+		{
+			pSaude->pior = LER_NumCampos ;
+		}
+
+		return LER_CondRetOK ;
+	}
+
+/***************************************************************************
+*
+*  Função: LER  & Obter saúde de um campo
+*  ****/
+
+	LER_tpCondRet LER_ObterSaudeCampo( LER_tpContexto pContexto , LER_tpCampo campo , SAU_tpResumoCanal * pResumo )
+	{
+		if ( campo >= LER_NumCampos || ! ( pContexto->grupos & LER_MASCARA_GRUPO( LER_GrupoDoCampo( campo ) ) ) )
+		{
+			return LER_CondRetError ;
+		}
+
+		SAU_ObterCanal( &pContexto->canalSaude[campo] , pResumo ) ;
+
+		return LER_CondRetOK ;
+	}
+
+/***************************************************************************
+*
+*  Função: LER  & Iniciar relator
+*  ****/
+
+	LER_tpCondRet LER_IniciarRelator( LER_tpContexto pContexto , unsigned periodoMs )
+	{
+		if ( pContexto->relatorAtivo )
+		{
+			return LER_CondRetError ;
+		}
+
+		pContexto->periodoRelatorMs = periodoMs < 100 ? 100 : periodoMs ;
+		pContexto->relatorAtivo     = 1 ;
+
+		if ( pthread_create( &pContexto->relator , NULL , relatorContinuo , pContexto ) != 0 )
+		{
+			pContexto->relatorAtivo = 0 ;
+			return LER_CondRetError ;
+		}
+
+		return LER_CondRetOK ;
+	}
+
+/***************************************************************************
+*
+*  Função: LER  & Ativar o histórico de amostras
+*  ****/
+
+	LER_tpCondRet LER_AtivarHistorico( LER_tpContexto pContexto , unsigned capacidade )
+	{
+		HST_tpHistorico novo ;
+
+		if ( pContexto->historico != NULL || pContexto->modo == LER_ModoSobDemanda )
+		{
+			return LER_CondRetError ;
+		}
+
+		novo = HST_Criar( capacidade ) ;
+
+		if ( novo == NULL )
+		{
+			return LER_CondRetError ;
+		}
+
+		/* Publica o histórico pronto para a thread de aquisição */
+
+		__atomic_store_n( &pContexto->historico , novo , __ATOMIC_RELEASE ) ;
+
+		return LER_CondRetOK ;
+	}
+
+/***************************************************************************
+*
+*  Função: LER  & Obter o histórico de amostras
+*  ****/
+
+	struct HST_historico * LER_ObterHistorico( LER_tpContexto pContexto )
+	{
+		return pContexto->historico ;
+	}
+
+/***************************************************************************
+*
+*  Função: LER  & Montar bloco
+*  ****/
+
+	void LER_MontarBloco( LER_tpBloco * pBloco , void * memoria , unsigned capacidade )
+	{
+		unsigned  cap = LER_CAPACIDADE_BLOCO( capacidade ) ;
+		uintptr_t p   = ( ( uintptr_t ) memoria + LER_ALINHAMENTO_BLOCO - 1 ) & ~( uintptr_t ) ( LER_ALINHAMENTO_BLOCO - 1 ) ;
+		int c ;
+
+		/* cap é múltiplo de 4: cada vetor começa alinhado como o primeiro */
+
+		pBloco->capacidade  = cap ;
+		pBloco->numAmostras = 0   ;
+
+		pBloco->timestamp = ( uint64_t * ) p ;
+		p += cap * sizeof( uint64_t ) ;
+
+		for ( c = 0 ; c < LER_NumCampos ; c++ )
+		{
+			pBloco->campo[ c ] = ( float * ) p ;
+			p += cap * sizeof( float ) ;
+		}
+
+		pBloco->validos = ( uint32_t * ) p ;
+		p += cap * sizeof( uint32_t ) ;
+
+		pBloco->novos   = ( uint32_t * ) p ;
+	}
+
+/***************************************************************************
+*
+*  Função: LER  & Preencher bloco de parâmetros
+*  ****/
+
+	LER_tpCondRet LER_FillParamBatch( LER_tpContexto pContexto , uint64_t desde , LER_tpBloco * pBloco )
+	{
+		HST_tpHistorico pHist = __atomic_load_n( &pContexto->historico , __ATOMIC_ACQUIRE ) ;
+		HST_tpJanela    janela ;
+		unsigned        total , n , n0 ;
+
+		pBloco->numAmostras = 0 ;
+
+		if ( pHist == NULL )
+		{
+			return LER_CondRetError ;
+		}
+
+		for ( ;; )
+		{
+			if ( HST_ObterDesde( pHist , desde , &janela ) != HST_CondRetOK )
+			{
+				return LER_CondRetError ;
+			}
+
+			total = janela.tamanho[0] + janela.tamanho[1] ;
+			n     = total < pBloco->capacidade ? total : pBloco->capacidade ;
+			n0    = n < janela.tamanho[0] ? n : janela.tamanho[0] ;
+
+			transporTrecho( janela.trecho[0] , n0     , 0  , pBloco ) ;
+			transporTrecho( janela.trecho[1] , n - n0 , n0 , pBloco ) ;
+
+			/* A mais antiga é a primeira a ser sobrescrita: se ela ainda
+			   vale, todo o trecho copiado vale */
+
+			if ( HST_JanelaValida( pHist , &janela ) == HST_CondRetOK )
+			{
+				break ;
+			}
+		}
+
+		pBloco->numAmostras = n ;
+
+		return n < total ? LER_CondRetParcial : LER_CondRetOK ;
+	}
+
+/***************************************************************************
+*
+*  Função: LER  & Ativar análise de vibração
+*  ****/
+
+	LER_tpCondRet LER_AtivarVibracao( LER_tpContexto pContexto , const ESP_tpConfig * pConfig )
+	{
+		ESP_tpAnalisador * novo ;
+		ESP_tpConfig       padrao ;
+
+		if ( pContexto->captura == NULL || pContexto->espectro != NULL )
+		{
+			return LER_CondRetError ;
+		}
+
+		if ( pConfig == NULL )
+		{
+			ESP_ConfigPadrao( &padrao ) ;
+			pConfig = &padrao ;
+		}
+
+		novo = ( ESP_tpAnalisador * ) malloc( sizeof( ESP_tpAnalisador ) ) ;
+
+		if ( novo == NULL )
+		{
+			return LER_CondRetError ;
+		}
+
+		if ( ESP_Iniciar( novo , pConfig ) != ESP_CondRetOK ||
+		     pthread_mutex_init( &pContexto->travaEspectro , NULL ) != 0 )
+		{
+			free( novo ) ;
+			return LER_CondRetError ;
+		}
+
+		pContexto->cursorEspectro = 0 ;
+
+		__atomic_store_n( &pContexto->espectro , novo , __ATOMIC_RELEASE ) ;
+
+		return LER_CondRetOK ;
+	}
+
+/***************************************************************************
+*
+*  Função: LER  & Obter espectro de vibração
+*  ****/
+
+	LER_tpCondRet LER_ObterVibracao( LER_tpContexto pContexto , ESP_tpResultado * pResultado )
+	{
+		ESP_tpAnalisador * pEsp = __atomic_load_n( &pContexto->espectro , __ATOMIC_ACQUIRE ) ;
+		CAP_tpAmostra      trecho[ 32 ] ;
+		ESP_tpCondRet      ret ;
+		unsigned           n , k ;
+		uint32_t           perdidas ;
+
+		if ( pEsp == NULL )
+		{
+			return LER_CondRetError ;
+		}
+
+		pthread_mutex_lock( &pContexto->travaEspectro ) ;
+
+		while ( CAP_Ler( pContexto->captura , CAP_FluxoBruto , &pContexto->cursorEspectro ,
+		                 trecho , 32 , &n , &perdidas ) == CAP_CondRetOK )
+		{
+			if ( perdidas > 0 )
+			{
+				ESP_Descontinuidade( pEsp ) ;
+			}
+
+			for ( k = 0 ; k < n ; k++ )
+			{
+				ESP_Acrescentar( pEsp , trecho[ k ].timestamp , trecho[ k ].acel ) ;
+			}
+		}
+
+		ret = ESP_ObterResultado( pEsp , pResultado ) ;
+
+		pthread_mutex_unlock( &pContexto->travaEspectro ) ;
+
+		return ret == ESP_CondRetOK ? LER_CondRetOK : LER_CondRetError ;
+	}
+
+/***************************************************************************
+*
+*  Função: LER  & Associar registro de voo
+*  ****/
+
+	LER_tpCondRet LER_AssociarRegistro( LER_tpContexto pContexto , struct REG_registro * pReg )
+	{
+		uint32_t filtrados = 0 ;
+		int c ;
+
+		if ( pContexto->modo == LER_ModoSobDemanda )
+		{
+			return LER_CondRetError ;
+		}
+
+		/* O registro guarda valores já filtrados: a marca no cabeçalho evita
+		   que uma reprodução os passe pelo filtro outra vez */
+
+		if ( pReg != NULL )
+		{
+			for ( c = 0 ; c < LER_NumCampos ; c++ )
+			{
+				if ( FLT_Ativo( &pContexto->filtro[c] ) )
+				{
+					filtrados |= 1u << c ;
+				}
+			}
+
+			REG_MarcarFiltrados( pReg , filtrados ) ;
+		}
+
+		__atomic_store_n( &pContexto->registro , pReg , __ATOMIC_RELEASE ) ;
+
+		return LER_CondRetOK ;
+	}
+
+/***************************************************************************
+*
+*  Função: LER  & Associar avisos de mudança
+*  ****/
+
+	LER_tpCondRet LER_AssociarAvisos( LER_tpContexto pContexto , struct AVS_conjunto * pAvisos )
+	{
+		if ( pContexto->modo == LER_ModoSobDemanda )
+		{
+			return LER_CondRetError ;
+		}
+
+		__atomic_store_n( &pContexto->avisos , pAvisos , __ATOMIC_RELEASE ) ;
+
+		return LER_CondRetOK ;
+	}
+
+/***************************************************************************
+*
+*  Função: LER  & Iniciar região compartilhada
+*  ****/
+
+	void LER_IniciarCompartilhado( LER_tpCompartilhado * pRegiao )
+	{
+		memset( pRegiao , 0 , sizeof( LER_tpCompartilhado ) ) ;
+
+		pRegiao->tamanho = sizeof( LER_tpCompartilhado )      ;
+
+		__atomic_store_n( &pRegiao->magia , LER_MAGIA_COMPARTILHADO , __ATOMIC_RELEASE ) ;
+	}
+
+/***************************************************************************
+*
+*  Função: LER  & Associar região compartilhada
+*  ****/
+
+	LER_tpCondRet LER_AssociarCompartilhado( LER_tpContexto pContexto , LER_tpCompartilhado * pRegiao )
+	{
+		if ( pContexto->modo == LER_ModoSobDemanda )
+		{
+			return LER_CondRetError ;
+		}
+
+		if ( pRegiao != NULL && !regiaoValida( pRegiao ) )
+		{
+			return LER_CondRetError ;
+		}
+
+		__atomic_store_n( &pContexto->compartilhado , pRegiao , __ATOMIC_RELEASE ) ;
+
+		return LER_CondRetOK ;
+	}
+
+/***************************************************************************
+*
+*  Função: LER  & Número da publicação
+*  ****/
+
+	uint32_t LER_PublicacaoCompartilhado( const LER_tpCompartilhado * pRegiao )
+	{
+		return __atomic_load_n( &pRegiao->sequencia , __ATOMIC_ACQUIRE ) >> 1 ;
+	}
+
+/***************************************************************************
+*
+*  Função: LER  & Ler retrato compartilhado
+*
+*  O mesmo protocolo de copiarRetrato, com a região de outro processo.
+*  ****/
+
+	LER_tpCondRet LER_LerCompartilhado( const LER_tpCompartilhado * pRegiao , LER_tpAmostra * pAmostra ,
+	                                    uint64_t pOrigem[ LER_NumGrupos ] , uint32_t * pPublicacao )
+	{
+		uint32_t seq1 , seq2 ;
+
+		if ( !regiaoValida( pRegiao ) )
+		{
+			return LER_CondRetError ;
+		}
+
+		for ( ;; )
+		{
+			seq1 = __atomic_load_n( &pRegiao->sequencia , __ATOMIC_ACQUIRE ) ;
+
+			if ( seq1 == 0 ) /* Nada publicado ainda */
+			{
+				return LER_CondRetError ;
+			}
+
+			if ( seq1 & 1u )
+			{
+				continue ;
+			}
+
+			*pAmostra = pRegiao->amostra ;
+
+			if ( pOrigem != NULL )
+			{
+				memcpy( pOrigem , pRegiao->amostra.origem , sizeof( pRegiao->amostra.origem ) ) ;
+			}
+
+			__atomic_thread_fence( __ATOMIC_ACQUIRE ) ;
+			seq2 = __atomic_load_n( &pRegiao->sequencia , __ATOMIC_RELAXED ) ;
+
+			if ( seq1 == seq2 )
+			{
+				break ;
+			}
+		}
+
+		if ( pPublicacao != NULL )
+		{
+			*pPublicacao = seq1 >> 1 ;
+		}
+
+		return LER_CondRetOK ;
+	}
+
+/***************************************************************************
+*
+*  Função: LER  & Ler campo compartilhado
+*  ****/
+
+	LER_tpCondRet LER_LerCampoCompartilhado( const LER_tpCompartilhado * pRegiao , LER_tpCampo campo ,
+	                                         float * pValor , uint64_t * pTimestamp , uint32_t * pPublicacao )
+	{
+		LER_tpGrupo grupo   ;
+		float       valor   ;
+		uint64_t    origem  ;
+		uint32_t    validos ;
+		uint32_t    seq1 , seq2 ;
+
+		if ( campo >= LER_NumCampos || !regiaoValida( pRegiao ) )
+		{
+			return LER_CondRetError ;
+		}
+
+		grupo = LER_GrupoDoCampo( campo ) ;
+
+		for ( ;; )
+		{
+			seq1 = __atomic_load_n( &pRegiao->sequencia , __ATOMIC_ACQUIRE ) ;
+
+			if ( seq1 == 0 )
+			{
+				return LER_CondRetError ;
+			}
+
+			if ( seq1 & 1u )
+			{
+				continue ;
+			}
+
+			valor   = pRegiao->amostra.valor[ campo ] ;
+			origem  = pRegiao->amostra.origem[ grupo ] ;
+			validos = pRegiao->amostra.validos         ;
+
+			__atomic_thread_fence( __ATOMIC_ACQUIRE ) ;
+			seq2 = __atomic_load_n( &pRegiao->sequencia , __ATOMIC_RELAXED ) ;
+
+			if ( seq1 == seq2 )
+			{
+				break ;
+			}
+		}
+
+		*pValor = valor ;
+
+		if ( pTimestamp != NULL )
+		{
+			*pTimestamp = origem ;
+		}
+
+		if ( pPublicacao != NULL )
+		{
+			*pPublicacao = seq1 >> 1 ;
+		}
+
+		if ( validos & LER_MASCARA_GRUPO( grupo ) )
+		{
+			return LER_CondRetOK ;
+		}
+
+		return condRetDoGrupo( grupo ) ;
+	}
+
+/***************************************************************************
+*
+*  Função: LER  & Ativar captura em taxa plena
+*  ****/
+
+	LER_tpCondRet LER_AtivarCaptura( LER_tpContexto pContexto , const CAP_tpConfig * pConfig )
+	{
+		CAP_tpCaptura nova ;
+
+		if ( pContexto->captura != NULL )
+		{
+			return LER_CondRetError ;
+		}
+
+		if ( CAP_Iniciar( &nova , pConfig ) != CAP_CondRetOK )
+		{
+			return LER_CondRetError ;
+		}
+
+		__atomic_store_n( &pContexto->captura , nova , __ATOMIC_RELEASE ) ;
+
+		return LER_CondRetOK ;
+	}
+
+/***************************************************************************
+*
+*  Função: LER  & Obter a captura em taxa plena
+*  ****/
+
+	CAP_tpCaptura LER_ObterCaptura( LER_tpContexto pContexto )
+	{
+		return __atomic_load_n( &pContexto->captura , __ATOMIC_ACQUIRE ) ;
+	}
+
+/***************************************************************************
+*
+*  Função: LER  & Preenche a estrutura com os parâmetros fundamentais
+*  ****/
+
+	LER_tpCondRet LER_FillParam( LER_tpContexto pContexto , LER_tpParametros pStructParam )
+	{
+		if ( pContexto->modo == LER_ModoThread )
+		{
+			return copiarRetrato( &pContexto->retrato , pStructParam , NULL , pContexto->grupos ) ;
+		}
+
+		if ( pContexto->modo == LER_ModoSobDemanda )
+		{
+			return marcarPendentes( pContexto , pStructParam ) ;
+		}
+
+		return lerTopicos( pContexto , pStructParam ) ;
+	}
+
+/***************************************************************************
+*
+*  Função: LER  & Preenche a estrutura com os parâmetros alinhados no tempo
+*  ****/
+
+	LER_tpCondRet LER_FillParamAlinhado( LER_tpContexto pContexto , LER_tpParametros pStructParam ,
+	                                     LER_tpAlinhamento * pAlinhamento )
+	{
+		if ( pContexto->atrasoAlinhamentoUs == 0 )
+		{
+			return LER_CondRetError ;
+		}
+
+		/* Em LER_ModoSincrono o poll é feito aqui, numa estrutura interna:
+		   a do chamador recebe só o resultado alinhado */
+
+		if ( pContexto->modo == LER_ModoSincrono )
+		{
+			lerTopicos( pContexto , &pContexto->brutoAlinhamento ) ;
+		}
+
+		return copiarRetrato( &pContexto->alinhado , pStructParam , pAlinhamento , pContexto->grupos ) ;
+	}
+
+	/***************************************************************************
+	*
+	*  Função: LER  & Poll e cópia dos tópicos para a estrutura de parâmetros
+	*  ****/
+
+	static LER_tpCondRet lerTopicos( LER_contexto *pCtx , LER_parametros *pStructParam )
+	{
+		HST_tpHistorico pHist    ;
+		REG_tpRegistro  pReg     ;
+		LER_tpCompartilhado *pRegiao ;
+		AVS_tpConjunto  *pAvisos ;
+		unsigned        prontos  ;
+		int             t        ;
+
+		/* Pendentes de um contexto sob demanda usado antes com esta
+		   estrutura sobrescreveriam os valores copiados aqui */
+
+		pStructParam->novos     = 0                        ;
+		pStructParam->pendentes = 0                        ;
+		pStructParam->contexto  = NULL                     ;
+
+		if ( aguardarTopicos( pCtx , &prontos ) != LER_CondRetOK )
+		{
+			return LER_CondRetError                       ;
+		}
+
+		/* Cada tópico pronto é copiado e distribuído pelos seus campos; cada
+		   grupo guarda o seu timestamp de origem */
+
+		for ( t = 0 ; t < LER_NumTopicos ; t++ )
+		{
+			if ( prontos & ( 1u << t ) )
+			{
+				copiarTopico( pCtx , ( LER_tpTopico ) t , pStructParam ) ;
+			}
+		}
+
+		derivarParametros( pCtx , pStructParam ) ;
+
+		pStructParam->timestamp = hrt_absolute_time( ) ;
+
+		/* Alimenta o histórico, o registro de voo e a região compartilhada
+		   (único produtor: quem faz o poll). Ciclos sem nenhum grupo novo só
+		   repetiriam a amostra anterior e não entram, o que mantém os
+		   timestamps crescentes. */
+
+		pHist   = __atomic_load_n( &pCtx->historico     , __ATOMIC_ACQUIRE ) ;
+		pReg    = __atomic_load_n( &pCtx->registro      , __ATOMIC_ACQUIRE ) ;
+		pRegiao = __atomic_load_n( &pCtx->compartilhado , __ATOMIC_ACQUIRE ) ;
+
+		if ( ( pHist != NULL || pReg != NULL || pRegiao != NULL ) && pStructParam->novos != 0 )
+		{
+			LER_tpAmostra amostra ;
+
+			LER_ObterAmostra( pStructParam , &amostra ) ;
+
+			if ( pHist != NULL )
+			{
+				HST_Inserir( pHist , &amostra ) ;
+			}
+
+			if ( pReg != NULL )
+			{
+				REG_Escrever( pReg , &amostra ) ;
+			}
+
+			if ( pRegiao != NULL )
+			{
+				publicarCompartilhado( pRegiao , pStructParam , &amostra ) ;
+			}
+		}
+
+		pAvisos = __atomic_load_n( &pCtx->avisos , __ATOMIC_ACQUIRE ) ;
+
+		if ( pAvisos != NULL && pStructParam->novos != 0 )
+		{
+			AVS_Avaliar( pAvisos , pStructParam->valor ,
+			             camposDosGrupos( pStructParam->novos & pStructParam->validos ) ) ;
+		}
+
+		if ( pCtx->atrasoAlinhamentoUs != 0 && pStructParam->novos != 0 )
+		{
+			alinhar( pCtx , pStructParam ) ;
+		}
+
+		return condRetDosNovos( pStructParam->novos , pCtx->grupos ) ;
+
+	}
+
+	/***************************************************************************
+	*
+	*  Função: LER  & Esperar pelos tópicos do poll set
+	*
+	*  Só contadores, nenhuma E/S. Em *pProntos, um bit por LER_tpTopico
+	*  com dado novo.
+	*  ****/
+
+	static LER_tpCondRet aguardarTopicos( LER_contexto *pCtx , unsigned *pProntos )
+	{
+		unsigned i ;
+
+		/* Verifica se teve dados no último segundo */
+
+		int poll_ret = poll( pCtx->fds , pCtx->numAssinados ,
+		                     __atomic_load_n( &pCtx->prazoPollMs , __ATOMIC_RELAXED ) ) ;
+
+		atualizarTaxas( pCtx )                             ;
+
+		*pProntos = 0                                      ;
+
+		if ( poll_ret == 0 ) /* Sem data */
+		{
+			INCREMENTAR( pCtx->diag.prazosEsgotados )     ;
+			return LER_CondRetError                       ;
+		}
+
+		else if ( poll_ret < 0) /* Erro bizarro */
+		{
+			INCREMENTAR( pCtx->diag.errosPoll )           ;
+			return LER_CondRetError                       ;
+		}
+
+		INCREMENTAR( pCtx->diag.despertares )             ;
+
+		for ( i = 0 ; i < pCtx->numAssinados ; i++ )
+		{
+			if ( pCtx->fds[i].revents & POLLIN )
+			{
+				*pProntos |= 1u << pCtx->topicoDoFd[i]     ;
+			}
+			else if ( pCtx->fds[i].events != 0 )
+			{
+				INCREMENTAR( pCtx->diag.faltas[pCtx->topicoDoFd[i]] ) ;
+			}
+		}
+
+		return LER_CondRetOK ;
+	}
+
+	/***************************************************************************
+	*
+	*  Função: LER  & Grandezas derivadas dos grupos novos
+	*
+	*  Pode ser chamada mais de uma vez no mesmo ciclo (LER_ModoSobDemanda):
+	*  o estimador vertical ignora origens repetidas e o resto é refeito.
+	*  ****/
+
+	static void derivarParametros( LER_contexto *pCtx , LER_parametros *pStructParam )
+	{
+		if ( pStructParam->novos & LER_MASCARA_GRUPO( LER_GrupoAtitude ) )
+		{
+			memcpy( pStructParam->rotacao , pCtx->rotacao , sizeof( pCtx->rotacao ) ) ;
+		}
+
+		/* Altura barométrica: o z (para cima) corrige a referência antes de
+		   a pressão nova avançar o filtro */
+
+		if ( pStructParam->novos & LER_MASCARA_GRUPO( LER_GrupoAltura ) )
+		{
+			ALT_AcrescentarAltura( &pCtx->vertical , pStructParam->origem[LER_GrupoAltura] ,
+			                       -pStructParam->valor[LER_CampoAltura] ) ;
+		}
+
+		if ( pStructParam->novos & LER_MASCARA_GRUPO( LER_GrupoPressao ) )
+		{
+			ALT_AcrescentarPressao( &pCtx->vertical , pStructParam->origem[LER_GrupoPressao] ,
+			                        pStructParam->valor[LER_CampoPressao] ) ;
+		}
+
+		if ( pStructParam->novos & ( LER_MASCARA_GRUPO( LER_GrupoAltura ) | LER_MASCARA_GRUPO( LER_GrupoPressao ) ) )
+		{
+			ALT_ObterEstimativa( &pCtx->vertical , &pStructParam->vertical ) ;
+		}
+
+		/* Aceleração no mundo: depende dos dois grupos, refeita se um deles mudou */
+
+		if ( ( pStructParam->novos & ( LER_MASCARA_GRUPO( LER_GrupoAceleracao ) | LER_MASCARA_GRUPO( LER_GrupoAtitude ) ) ) &&
+		     ( pStructParam->validos & LER_MASCARA_GRUPO( LER_GrupoAceleracao ) ) &&
+		     ( pStructParam->validos & LER_MASCARA_GRUPO( LER_GrupoAtitude ) ) )
+		{
+			calcularAcelMundo( pStructParam ) ;
+		}
+	}
+
+	/***************************************************************************
+	*
+	*  Função: LER  & Poll sem cópia (LER_ModoSobDemanda)
+	*
+	*  Tópicos já pendentes ficam fora do poll: o dado deles continua
+	*  pronto no uORB e, se ninguém o lê, não faria o poll voltar na hora.
+	*  ****/
+
+	static LER_tpCondRet marcarPendentes( LER_contexto *pCtx , LER_parametros *pStructParam )
+	{
+		unsigned prontos ;
+		unsigned i       ;
+
+		/* Pendentes de outro contexto não são deste poll */
+
+		if ( pStructParam->contexto != pCtx )
+		{
+			pStructParam->pendentes = 0    ;
+			pStructParam->contexto  = pCtx ;
+		}
+
+		pStructParam->novos = 0 ;
+
+		if ( ( pStructParam->pendentes & pCtx->assinados ) != pCtx->assinados )
+		{
+			for ( i = 0 ; i < pCtx->numAssinados ; i++ )
+			{
+				pCtx->fds[i].events = ( pStructParam->pendentes & ( 1u << pCtx->topicoDoFd[i] ) ) ? 0 : POLLIN ;
+			}
+
+			if ( aguardarTopicos( pCtx , &prontos ) != LER_CondRetOK )
+			{
+				return pStructParam->pendentes != 0 ? LER_CondRetParcial : LER_CondRetError ;
+			}
+
+			pStructParam->pendentes |= prontos ;
+		}
+
+		pStructParam->timestamp = hrt_absolute_time( ) ;
+
+		return pStructParam->pendentes == pCtx->assinados ? LER_CondRetOK : LER_CondRetParcial ;
+	}
+
+	/***************************************************************************
+	*
+	*  Função: LER  & Copiar os pendentes de que os grupos dependem
+	*
+	*  Chamada por todas as funções de leitura; sem pendentes (os outros
+	*  modos) custa só o teste.
+	*  ****/
+
+	static void prepararGrupos( LER_parametros *pParam , unsigned grupos )
+	{
+		if ( pParam->pendentes != 0 )
+		{
+			resolverPendentes( pParam , grupos ) ;
+		}
+	}
+
+	/***************************************************************************
+	*
+	*  Função: LER  & Copiar os tópicos pendentes de alguns grupos
+	*  ****/
+
+	static void resolverPendentes( LER_parametros *pParam , unsigned grupos )
+	{
+		LER_contexto *pCtx = pParam->contexto ;
+		unsigned      alvo = 0 ;
+		int           t ;
+
+		for ( t = 0 ; t < LER_NumTopicos ; t++ )
+		{
+			if ( ( pParam->pendentes & ( 1u << t ) ) && ( gruposDoTopico( ( LER_tpTopico ) t ) & grupos ) )
+			{
+				alvo |= 1u << t ;
+			}
+		}
+
+		if ( alvo == 0 )
+		{
+			return ;
+		}
+
+		pParam->pendentes &= ~alvo ;
+
+		for ( t = 0 ; t < LER_NumTopicos ; t++ )
+		{
+			if ( alvo & ( 1u << t ) )
+			{
+				copiarTopico( pCtx , ( LER_tpTopico ) t , pParam ) ;
+			}
+		}
+
+		derivarParametros( pCtx , pParam ) ;
+	}
+
+	/***************************************************************************
+	*
+	*  Função: LER  & Marcar um grupo de campos como válido
+	*
+	*  O grupo só conta como novo se a origem avançou em relação ao que a
+	*  estrutura já tinha (cópias repetidas do mesmo dado não contam).
+	*  ****/
+
+	static void marcarGrupo( LER_parametros *pParam , LER_tpGrupo grupo , hrt_abstime origem )
+	{
+		pParam->validos |= LER_MASCARA_GRUPO( grupo ) ;
+
+		if ( origem > pParam->origem[grupo] )
+		{
+			pParam->origem[grupo] = origem                 ;
+			pParam->novos        |= LER_MASCARA_GRUPO( grupo ) ;
+		}
+	}
+
+	/***************************************************************************
+	*
+	*  Função: LER  & Condição de retorno a partir dos grupos novos
+	*  ****/
+
+	static LER_tpCondRet condRetDosNovos( unsigned novos , unsigned todos )
+	{
+		if ( novos == todos )
+		{
+			return LER_CondRetOK ;
+		}
+
+		if ( novos != 0 )
+		{
+			return LER_CondRetParcial ;
+		}
+
+		return LER_CondRetError ;
+	}
+
+	/***************************************************************************
+	*
+	*  Função: LER  & Leitura propriamente dita da pressão
+	*  ****/
+
+	float LER_Pressao( LER_tpParametros pStructParam )
+	{
+		float pressao ;
+
+		prepararGrupos( pStructParam , LER_MASCARA_GRUPO( LER_GrupoPressao ) ) ;
+
+		pressao = pStructParam->valor[LER_CampoPressao] ;
+
+		if ( pressao < 0 )
+			return -1 ;
+
+		return pressao ;
+	}
+
+	/***************************************************************************
+	*
+	*  Função: LER  & Leitura propriamente dita do PitchSpeed
+	*  ****/
+
+	float LER_PitchSpeed( LER_tpParametros pStructParam )
+	{
+		prepararGrupos( pStructParam , LER_MASCARA_GRUPO( LER_GrupoVelAngular ) ) ;
+
+		return pStructParam->valor[LER_CampoPitchSpeed] ;
+	}
+
+	/***************************************************************************
+	*
+	*  Função: LER  & Leitura propriamente dita do RollSpeed
+	*  ****/
+
+	float LER_RollSpeed( LER_tpParametros pStructParam )
+	{
+		prepararGrupos( pStructParam , LER_MASCARA_GRUPO( LER_GrupoVelAngular ) ) ;
+
+		return pStructParam->valor[LER_CampoRollSpeed] ;
+	}
+
+	/***************************************************************************
+	*
+	*  Função: LER  & Leitura propriamente dita do YawSpeed
+	*  ****/
+
+	float LER_YawSpeed( LER_tpParametros pStructParam )
+	{
+		prepararGrupos( pStructParam , LER_MASCARA_GRUPO( LER_GrupoVelAngular ) ) ;
+
+		return pStructParam->valor[LER_CampoYawSpeed] ;
+	}
+
+	/***************************************************************************
+	*
+	*  Função: LER  & Leitura propriamente dita do PitchAngle
+	*  ****/
+
+	float LER_PitchAngle( LER_tpParametros pStructParam )
+	{
+		prepararGrupos( pStructParam , LER_MASCARA_GRUPO( LER_GrupoAtitude ) ) ;
+
+		return pStructParam->valor[LER_CampoPitch] ;
+	}
+
+	/***************************************************************************
+	*
+	*  Função: LER  & Leitura propriamente dita do RollAngle
+	*  ****/
+
+	float LER_RollAngle( LER_tpParametros pStructParam )
+	{
+		prepararGrupos( pStructParam , LER_MASCARA_GRUPO( LER_GrupoAtitude ) ) ;
+
+		return pStructParam->valor[LER_CampoRoll] ;
+	}
+
+	/***************************************************************************
+	*
+	*  Função: LER  & Leitura propriamente dita do YawAngle
+	*  ****/
+
+	float LER_YawAngle( LER_tpParametros pStructParam )
+	{
+		prepararGrupos( pStructParam , LER_MASCARA_GRUPO( LER_GrupoAtitude ) ) ;
+
+		return pStructParam->valor[LER_CampoYaw] ;
+	}
+
+	/***************************************************************************
+	*
+	*  Função: LER  & Leitura propriamente dita da aceleração em x
+	*  ****/
+
+	float LER_AcelX( LER_tpParametros pStructParam )
+	{
+		prepararGrupos( pStructParam , LER_MASCARA_GRUPO( LER_GrupoAceleracao ) ) ;
+
+		return pStructParam->valor[LER_CampoAx] ;
+	}
+
+	/***************************************************************************
+	*
+	*  Função: LER  & Leitura propriamente dita da aceleração em y
+	*  ****/
 
 	float LER_AcelY( LER_tpParametros pStructParam )
 	{
-		return pStructParam->ay ;
+		prepararGrupos( pStructParam , LER_MASCARA_GRUPO( LER_GrupoAceleracao ) ) ;
+
+		return pStructParam->valor[LER_CampoAy] ;
+	}
+
+	/***************************************************************************
+	*
+	*  Função: LER  & Leitura propriamente dita da aceleração em z
+	*  ****/
+
+	float LER_AcelZ( LER_tpParametros pStructParam )
+	{
+		prepararGrupos( pStructParam , LER_MASCARA_GRUPO( LER_GrupoAceleracao ) ) ;
+
+		return pStructParam->valor[LER_CampoAz] ;
+	}
+
+	/***************************************************************************
+	*
+	*  Função: LER  & Leitura propriamente dita da aceleração em z
+	*  ****/
+
+	float LER_Altitude( LER_tpParametros pStructParam )
+	{
+		prepararGrupos( pStructParam , LER_MASCARA_GRUPO( LER_GrupoAltura ) ) ;
+
+		return pStructParam->valor[LER_CampoAltura] ;
+	}
+
+	/***************************************************************************
+	*
+	*  Função: LER  & Copiar os parâmetros para uma amostra indexada
+	*  ****/
+
+	void LER_ObterAmostra( LER_tpParametros pStructParam , LER_tpAmostra * pAmostra )
+	{
+		prepararGrupos( pStructParam , LER_TODOS_GRUPOS ) ;
+
+		pAmostra->timestamp                        = pStructParam->timestamp  ;
+		memcpy( pAmostra->valor , pStructParam->valor , sizeof( pAmostra->valor ) ) ;
+		pAmostra->validos                          = pStructParam->validos    ;
+		pAmostra->novos                            = pStructParam->novos      ;
+		memcpy( pAmostra->origem , pStructParam->origem , sizeof( pAmostra->origem ) ) ;
+	}
+
+	/***************************************************************************
+	*
+	*  Função: LER  & Máscara dos grupos com dado válido
+	*  ****/
+
+	unsigned LER_GruposValidos( LER_tpParametros pStructParam )
+	{
+		prepararGrupos( pStructParam , LER_TODOS_GRUPOS ) ;
+
+		return pStructParam->validos ;
+	}
+
+	/***************************************************************************
+	*
+	*  Função: LER  & Máscara dos grupos atualizados na última leitura
+	*  ****/
+
+	unsigned LER_GruposNovos( LER_tpParametros pStructParam )
+	{
+		prepararGrupos( pStructParam , LER_TODOS_GRUPOS ) ;
+
+		return pStructParam->novos ;
+	}
+
+	/***************************************************************************
+	*
+	*  Função: LER  & Timestamp de origem de um grupo
+	*  ****/
+
+	uint64_t LER_TimestampGrupo( LER_tpParametros pStructParam , LER_tpGrupo grupo )
+	{
+		if ( grupo >= LER_NumGrupos )
+		{
+			return 0 ;
+		}
+
+		prepararGrupos( pStructParam , LER_MASCARA_GRUPO( grupo ) ) ;
+
+		return pStructParam->origem[grupo] ;
+	}
+
+	/***************************************************************************
+	*
+	*  Função: LER  & Grupo a que pertence um campo
+	*  ****/
+
+	LER_tpGrupo LER_GrupoDoCampo( LER_tpCampo campo )
+	{
+		static const LER_tpGrupo grupos[ LER_NumCampos ] = {
+			LER_GrupoPressao    ,                  /* LER_CampoPressao    */
+			LER_GrupoVelAngular ,                  /* LER_CampoPitchSpeed */
+			LER_GrupoVelAngular ,                  /* LER_CampoRollSpeed  */
+			LER_GrupoVelAngular ,                  /* LER_CampoYawSpeed   */
+			LER_GrupoAtitude    ,                  /* LER_CampoPitch      */
+			LER_GrupoAtitude    ,                  /* LER_CampoRoll       */
+			LER_GrupoAtitude    ,                  /* LER_CampoYaw        */
+			LER_GrupoAceleracao ,                  /* LER_CampoAx         */
+			LER_GrupoAceleracao ,                  /* LER_CampoAy         */
+			LER_GrupoAceleracao ,                  /* LER_CampoAz         */
+			LER_GrupoAltura     ,                  /* LER_CampoAltura     */
+		} ;
+
+		return grupos[ campo ] ;
+	}
+
+	/***************************************************************************
+	*
+	*  Função: LER  & Ler um campo com validade e timestamp de origem
+	*  ****/
+
+	LER_tpCondRet LER_LerCampo( LER_tpParametros pStructParam , LER_tpCampo campo ,
+	                            float * pValor , uint64_t * pTimestamp )
+	{
+		LER_tpGrupo   grupo   ;
+
+		if ( campo >= LER_NumCampos )
+		{
+			return LER_CondRetError ;
+		}
+
+		grupo = LER_GrupoDoCampo( campo ) ;
+
+		prepararGrupos( pStructParam , LER_MASCARA_GRUPO( grupo ) ) ;
+
+		*pValor = pStructParam->valor[ campo ] ;
+
+		if ( pTimestamp != NULL )
+		{
+			*pTimestamp = pStructParam->origem[ grupo ] ;
+		}
+
+		if ( pStructParam->validos & LER_MASCARA_GRUPO( grupo ) )
+		{
+			return LER_CondRetOK ;
+		}
+
+		return condRetDoGrupo( grupo ) ;
+	}
+
+	/***************************************************************************
+	*
+	*  Função: LER  & Máscara dos campos de um conjunto de grupos
+	*  ****/
+
+	static unsigned camposDosGrupos( unsigned grupos )
+	{
+		unsigned campos = 0 ;
+		int      c ;
+
+		for ( c = 0 ; c < LER_NumCampos ; c++ )
+		{
+			if ( grupos & LER_MASCARA_GRUPO( LER_GrupoDoCampo( ( LER_tpCampo ) c ) ) )
+			{
+				campos |= 1u << c ;
+			}
+		}
+
+		return campos ;
+	}
+
+	/***************************************************************************
+	*
+	*  Função: LER  & Condição de retorno de um grupo sem dado válido
+	*  ****/
+
+	static LER_tpCondRet condRetDoGrupo( LER_tpGrupo grupo )
+	{
+		switch ( grupo )
+		{
+			case LER_GrupoAceleracao : return LER_CondRetAcelError     ;
+			case LER_GrupoAtitude    : return LER_CondRetAttError      ;
+			case LER_GrupoAltura     : return LER_CondRetAltitudeError ;
+			default                  : return LER_CondRetError         ;
+		}
+	}
+
+	/***************************************************************************
+	*
+	*  Função: LER  & Matriz de rotação da última atitude
+	*  ****/
+
+	LER_tpCondRet LER_MatrizRotacao( LER_tpParametros pStructParam , float R[ 3 ][ 3 ] )
+	{
+		prepararGrupos( pStructParam , LER_MASCARA_GRUPO( LER_GrupoAtitude ) ) ;
+
+		if ( ! ( pStructParam->validos & LER_MASCARA_GRUPO( LER_GrupoAtitude ) ) )
+		{
+			return LER_CondRetAttError ;
+		}
+
+		memcpy( R , pStructParam->rotacao , sizeof( pStructParam->rotacao ) ) ;
+
+		return LER_CondRetOK ;
+	}
+
+	/***************************************************************************
+	*
+	*  Função: LER  & Aceleração em NED sem a gravidade
+	*  ****/
+
+	LER_tpCondRet LER_AcelMundo( LER_tpParametros pStructParam , float acel[ 3 ] )
+	{
+		prepararGrupos( pStructParam , LER_MASCARA_GRUPO( LER_GrupoAtitude ) | LER_MASCARA_GRUPO( LER_GrupoAceleracao ) ) ;
+
+		if ( ! ( pStructParam->validos & LER_MASCARA_GRUPO( LER_GrupoAtitude ) ) )
+		{
+			return LER_CondRetAttError ;
+		}
+
+		if ( ! ( pStructParam->validos & LER_MASCARA_GRUPO( LER_GrupoAceleracao ) ) )
+		{
+			return LER_CondRetAcelError ;
+		}
+
+		acel[0] = pStructParam->acelMundo[0] ;
+		acel[1] = pStructParam->acelMundo[1] ;
+		acel[2] = pStructParam->acelMundo[2] ;
+
+		return LER_CondRetOK ;
+	}
+
+	/***************************************************************************
+	*
+	*  Função: LER  & Estimativa vertical pelo barômetro
+	*  ****/
+
+	LER_tpCondRet LER_EstimativaVertical( LER_tpParametros pStructParam , ALT_tpEstimativa * pEstimativa )
+	{
+		prepararGrupos( pStructParam , LER_MASCARA_GRUPO( LER_GrupoPressao ) | LER_MASCARA_GRUPO( LER_GrupoAltura ) ) ;
+
+		*pEstimativa = pStructParam->vertical ;
+
+		if ( pStructParam->vertical.timestamp == 0 )
+		{
+			return LER_CondRetAltitudeError ;
+		}
+
+		return LER_CondRetOK ;
+	}
+
+	/***************************************************************************
+	*
+	*  Função: LER  & Copiar um tópico e distribuir seus campos
+	*
+	*  Segue o mapa: cada membro é convertido, filtrado e escalado, e o
+	*  grupo do campo é marcado com a origem do membro. Um campo cujo flag
+	*  de validade está falso invalida o grupo.
+	*  ****/
+
+	static void copiarTopico( LER_contexto *pCtx , LER_tpTopico topico , LER_parametros *pParam )
+	{
+		const LER_descritorTopico *pDesc  = &topicos[topico] ;
+		const unsigned char       *pBruto = ( const unsigned char * ) pCtx->bruto ;
+		hrt_abstime                inicio = hrt_absolute_time( ) ;
+		hrt_abstime                timestamp ;
+		unsigned                   m ;
+
+		orb_copy( pDesc->meta , pCtx->fd[topico] , pCtx->bruto ) ;
+
+		memcpy( &timestamp , pBruto + pDesc->deslocTimestamp , sizeof( timestamp ) ) ;
+
+		medirCopia( pCtx , topico , inicio , timestamp ) ;
+		contarAmostra( pCtx , topico , timestamp ) ;
+		SAU_AcrescentarChegada( &pCtx->fonteSaude[topico] , timestamp ) ;
+
+		if ( pDesc->posCopia != NULL )
+		{
+			pDesc->posCopia( pCtx , pBruto ) ;
+		}
+
+		for ( m = 0 ; m < LER_NUM_MAPA ; m++ )
+		{
+			const LER_mapaCampo *pMapa  = &mapa[m] ;
+			LER_tpGrupo          grupo  = LER_GrupoDoCampo( pMapa->campo ) ;
+			hrt_abstime          origem = 0 ;
+			float                valor ;
+
+			if ( pMapa->topico != topico || ! ( pCtx->grupos & LER_MASCARA_GRUPO( grupo ) ) )
+			{
+				continue ;
+			}
+
+			if ( pMapa->deslocOrigem != LER_SEM_DESLOCAMENTO )
+			{
+				memcpy( &origem , pBruto + pMapa->deslocOrigem , sizeof( origem ) ) ;
+			}
+
+			if ( origem == 0 )
+			{
+				origem = timestamp ;
+			}
+
+			if ( pMapa->deslocValido != LER_SEM_DESLOCAMENTO && ! *( const bool * ) ( pBruto + pMapa->deslocValido ) )
+			{
+				if ( grupo == LER_GrupoAltura )
+				{
+					INCREMENTAR( pCtx->diag.alturaInvalida ) ;
+				}
+
+				SAU_AcrescentarValor( &pCtx->canalSaude[pMapa->campo] , &pCtx->configSaude , origem , NAN ) ;
+
+				pParam->validos &= ~LER_MASCARA_GRUPO( grupo ) ;
+				continue ;
+			}
+
+			valor = lerBruto( pBruto + pMapa->deslocValor , pMapa->tipo ) ;
+
+			SAU_AcrescentarValor( &pCtx->canalSaude[pMapa->campo] , &pCtx->configSaude , origem , valor * pMapa->escala ) ;
+
+			pParam->valor[pMapa->campo] = filtrarCampo( pCtx , pMapa->campo , valor , origem ) * pMapa->escala ;
+
+			marcarGrupo( pParam , grupo , origem ) ;
+		}
+	}
+
+	/***************************************************************************
+	*
+	*  Função: LER  & Grupos que um tópico alimenta
+	*  ****/
+
+	static unsigned gruposDoTopico( LER_tpTopico topico )
+	{
+		unsigned grupos = 0 ;
+		unsigned m ;
+
+		for ( m = 0 ; m < LER_NUM_MAPA ; m++ )
+		{
+			if ( mapa[m].topico == topico )
+			{
+				grupos |= LER_MASCARA_GRUPO( LER_GrupoDoCampo( mapa[m].campo ) ) ;
+			}
+		}
+
+		return grupos ;
+	}
+
+	/***************************************************************************
+	*
+	*  Função: LER  & Converter um membro do tópico para float
+	*
+	*  memcpy porque o membro pode não estar alinhado para o tipo.
+	*  ****/
+
+	static float lerBruto( const unsigned char *pDado , int tipo )
+	{
+		switch ( tipo )
+		{
+			case LER_BrutoFloat  : { float    v ; memcpy( &v , pDado , sizeof( v ) ) ; return v ;           }
+			case LER_BrutoDouble : { double   v ; memcpy( &v , pDado , sizeof( v ) ) ; return ( float ) v ; }
+			case LER_BrutoInt32  : { int32_t  v ; memcpy( &v , pDado , sizeof( v ) ) ; return ( float ) v ; }
+			case LER_BrutoUint32 : { uint32_t v ; memcpy( &v , pDado , sizeof( v ) ) ; return ( float ) v ; }
+			case LER_BrutoInt16  : { int16_t  v ; memcpy( &v , pDado , sizeof( v ) ) ; return ( float ) v ; }
+			case LER_BrutoUint8  : return ( float ) *pDado ;
+			default              : return 0.0f ;
+		}
+	}
+
+	/***************************************************************************
+	*
+	*  Função: LER  & Thread de aquisição (LER_ModoThread)
+	*
+	*  É a única a usar fds[]. Acumula os parâmetros numa cópia local e a
+	*  publica a cada ciclo de poll, de forma que os leitores nunca esperam
+	*  pelo uORB.
+	*  ****/
+
+	static void * aquisicaoContinua( void *arg )
+	{
+		LER_contexto * pCtx = ( LER_contexto * ) arg ;
+		LER_parametros atual = { 0 } ;
+
+		while ( pCtx->threadAtiva )
+		{
+			if ( lerTopicos( pCtx , &atual ) != LER_CondRetError )
+			{
+				publicarRetrato( &pCtx->retrato , &atual , NULL ) ;
+			}
+		}
+
+		return NULL ;
+	}
+
+	/***************************************************************************
+	*
+	*  Função: LER  & Publicar retrato (lado escritor do seqlock)
+	*  ****/
+
+	static void publicarRetrato( LER_retrato *pRetrato , const LER_parametros *pParam ,
+	                             const LER_tpAlinhamento *pAlinhamento )
+	{
+		unsigned seq = pRetrato->sequencia ;
+
+		__atomic_store_n( &pRetrato->sequencia , seq + 1 , __ATOMIC_RELAXED ) ;
+		__atomic_thread_fence( __ATOMIC_RELEASE )                           ;
+
+		pRetrato->dado        = *pParam                                     ;
+
+		if ( pAlinhamento != NULL )
+		{
+			pRetrato->alinhamento = *pAlinhamento                           ;
+		}
+
+		__atomic_store_n( &pRetrato->sequencia , seq + 2 , __ATOMIC_RELEASE ) ;
+	}
+
+	/***************************************************************************
+	*
+	*  Função: LER  & Publicar na região compartilhada
+	*
+	*  Lado escritor do seqlock da região: nunca espera pelos leitores.
+	*  ****/
+
+	static void publicarCompartilhado( LER_tpCompartilhado *pRegiao , const LER_parametros *pParam ,
+	                                   const LER_tpAmostra *pAmostra )
+	{
+		uint32_t seq = pRegiao->sequencia ;
+
+		__atomic_store_n( &pRegiao->sequencia , seq + 1 , __ATOMIC_RELAXED ) ;
+		__atomic_thread_fence( __ATOMIC_RELEASE )                          ;
+
+		pRegiao->amostra  = *pAmostra                                      ;
+		memcpy( pRegiao->rotacao   , pParam->rotacao   , sizeof( pRegiao->rotacao   ) ) ;
+		memcpy( pRegiao->acelMundo , pParam->acelMundo , sizeof( pRegiao->acelMundo ) ) ;
+		pRegiao->vertical = pParam->vertical                               ;
+
+		__atomic_store_n( &pRegiao->sequencia , seq + 2 , __ATOMIC_RELEASE ) ;
 	}
 
 	/***************************************************************************
 	*
-	*  Função: LER  & Leitura propriamente dita da aceleração em z
+	*  Função: LER  & Região iniciada por esta versão do módulo
 	*  ****/
 
-	float LER_AcelZ( LER_tpParametros pStructParam )
+	static int regiaoValida( const LER_tpCompartilhado *pRegiao )
 	{
-		return pStructParam->az ;
+		return __atomic_load_n( &pRegiao->magia , __ATOMIC_ACQUIRE ) == LER_MAGIA_COMPARTILHADO &&
+		       pRegiao->tamanho == sizeof( LER_tpCompartilhado ) ;
 	}
 
 	/***************************************************************************
 	*
-	*  Função: LER  & Leitura propriamente dita da aceleração em z
+	*  Função: LER  & Copiar retrato (lado leitor do seqlock)
+	*
+	*  Só repete a cópia se a thread publicou no meio dela, o que custa no
+	*  máximo a cópia de um LER_parametros.
 	*  ****/
 
-	float LER_Altitude( LER_tpParametros pStructParam )
+	static LER_tpCondRet copiarRetrato( LER_retrato *pRetrato , LER_parametros *pParam ,
+	                                    LER_tpAlinhamento *pAlinhamento , unsigned todos )
+	{
+		LER_parametros    copia   ;
+		LER_tpAlinhamento alinhamento ;
+		unsigned          seq1 , seq2 ;
+		int               g       ;
+
+		pParam->pendentes = 0    ;                 /* Como em lerTopicos */
+		pParam->contexto  = NULL ;
+
+		for ( ;; )
+		{
+			seq1 = __atomic_load_n( &pRetrato->sequencia , __ATOMIC_ACQUIRE ) ;
+
+			if ( seq1 == 0 ) /* Nenhum ciclo de aquisição concluído ainda */
+			{
+				pParam->novos = 0 ;
+				return LER_CondRetError ;
+			}
+
+			if ( seq1 & 1u )
+			{
+				continue ;
+			}
+
+			copia   = pRetrato->dado    ;
+
+			if ( pAlinhamento != NULL )
+			{
+				alinhamento = pRetrato->alinhamento ;
+			}
+
+			__atomic_thread_fence( __ATOMIC_ACQUIRE ) ;
+			seq2 = __atomic_load_n( &pRetrato->sequencia , __ATOMIC_RELAXED ) ;
+
+			if ( seq1 == seq2 )
+			{
+				break ;
+			}
+		}
+
+		/* Novo é o que avançou desde a última leitura deste consumidor, não
+		   apenas no último ciclo da thread, que pode ter rodado várias vezes */
+
+		copia.novos = 0 ;
+
+		for ( g = 0 ; g < LER_NumGrupos ; g++ )
+		{
+			if ( copia.origem[g] > pParam->origem[g] )
+			{
+				copia.novos |= LER_MASCARA_GRUPO( g ) ;
+			}
+		}
+
+		copia.memoria = pParam->memoria ;
+
+		*pParam = copia ;
+
+		if ( pAlinhamento != NULL )
+		{
+			*pAlinhamento = alinhamento ;
+		}
+
+		return condRetDosNovos( copia.novos , todos ) ;
+	}
+
+	/***************************************************************************
+	*
+	*  Função: LER  & Contar amostra nova para a taxa efetiva do tópico
+	*
+	*  Cópias repetidas (mesmo timestamp de origem) não contam.
+	*  ****/
+
+	static void contarAmostra( LER_contexto *pCtx , LER_tpTopico topico , hrt_abstime origem )
 	{
-		return pStructParam->altura ;
+		if ( origem != pCtx->taxa[topico].ultimaOrigem )
+		{
+			pCtx->taxa[topico].ultimaOrigem = origem ;
+			pCtx->taxa[topico].contagem ++           ;
+		}
+		else
+		{
+			INCREMENTAR( pCtx->diag.repetidos[topico] ) ;
+		}
 	}
 
 	/***************************************************************************
 	*
-	*  Função: LER  & Aquisitar o parâmetro aceleração
+	*  Função: LER  & Fechar as janelas de taxa que completaram 1 s
+	*
+	*  Chamada a cada ciclo de poll, inclusive sem dados, para que um
+	*  tópico que parou de publicar passe a mostrar taxa zero.
 	*  ****/
 
-	static LER_tpCondRet aquisitarAceleracao( float *Acel , float *pressao )
+	static void atualizarTaxas( LER_contexto *pCtx )
 	{
+		hrt_abstime agora = hrt_absolute_time( ) ;
+		int t ;
 
-		struct sensor_combined_s raw ;
+		for ( t = 0 ; t < LER_NumTopicos ; t++ )
+		{
+			hrt_abstime decorrido = agora - pCtx->taxa[t].inicioJanela ;
 
-			if ( fds[SENSOR_FD].revents & POLLIN ) /* Checando se teve parametros novos e copiar se for o caso */
+			if ( decorrido >= LER_JANELA_TAXA_US )
 			{
-				orb_copy( ORB_ID( sensor_combined ) , sensor_fd, &raw)                 ;
+				float taxa = ( float ) pCtx->taxa[t].contagem * 1e6f / ( float ) decorrido ;
+
+				__atomic_store( &pCtx->taxa[t].taxaHz , &taxa , __ATOMIC_RELAXED ) ;
+
+				pCtx->taxa[t].contagem     = 0     ;
+				pCtx->taxa[t].inicioJanela = agora ;
+			}
+		}
+	}
+
+	/***************************************************************************
+	*
+	*  Função: LER  & Registrar duração e idade de um orb_copy
+	*  ****/
+
+	static void medirCopia( LER_contexto *pCtx , LER_tpTopico topico , hrt_abstime inicio , hrt_abstime origem )
+	{
+		hrt_abstime agora = hrt_absolute_time( ) ;
 
-				Acel[0]  = raw.accelerometer_m_s2[0]                                   ;
-				Acel[1]  = raw.accelerometer_m_s2[1]                                   ;
-				Acel[2]  = raw.accelerometer_m_s2[2]                                   ;
+		INCREMENTAR( pCtx->diag.copias[topico] ) ;
 
-				*pressao = raw.baro_pres_mbar                                          ;
+		registrarTempo( &pCtx->diag.duracaoCopia[topico] , agora - inicio ) ;
+		registrarTempo( &pCtx->diag.idade[topico] , agora > origem ? agora - origem : 0 ) ;
+	}
+
+	/***************************************************************************
+	*
+	*  Função: LER  & Registrar um tempo em µs no histograma logarítmico
+	*  ****/
+
+	static void registrarTempo( LER_tpHistograma *pHist , hrt_abstime us )
+	{
+		uint32_t valor = us > 0xFFFFFFFFu ? 0xFFFFFFFFu : ( uint32_t ) us ;
+		int      faixa = 0 ;
+
+		if ( valor > 0 )
+		{
+			faixa = 32 - __builtin_clz( valor ) ;
 
-				return LER_CondRetOK                                                   ;
+			if ( faixa >= LER_FAIXAS_HIST )
+			{
+				faixa = LER_FAIXAS_HIST - 1 ;
 			}
+		}
 
-		return LER_CondRetAcelError                                                    ;
+		INCREMENTAR( pHist->contagem[faixa] ) ;
 
+		if ( valor > pHist->maximoUs )
+		{
+			__atomic_store_n( &pHist->maximoUs , valor , __ATOMIC_RELAXED ) ;
+		}
 	}
 
 	/***************************************************************************
 	*
-	*  Função: LER  & Aquisitar as atitudes
+	*  Função: LER  & Thread do relator (LER_IniciarRelator)
+	*
+	*  Só lê os contadores; escreve uma linha por período quando algo deu
+	*  errado no período. Dorme em passos curtos para LER_Terminar não
+	*  esperar um período inteiro.
 	*  ****/
 
-	static LER_tpCondRet aquisitarAtitudes( float *Att , float *attRates )
+	static void * relatorContinuo( void *arg )
 	{
+		static const char * nomesSaude[ ] = { "ok" , "aquecendo" , "ruidoso" , "travado" , "mudo" } ;
+
+		LER_contexto *    pCtx = ( LER_contexto * ) arg ;
+		LER_tpDiagnostico anterior , atual ;
+		LER_tpSaude       saude[LER_NumTopicos] ;
+		SAU_tpEstado      estadoAnterior[LER_NumTopicos] ;
+		unsigned          dormido = 0 ;
+		int               t , mudou ;
+
+		for ( t = 0 ; t < LER_NumTopicos ; t++ )
+		{
+			estadoAnterior[t] = SAU_EstadoAquecendo ;
+		}
+
+		LER_ObterDiagnostico( pCtx , &anterior ) ;
+
+		while ( pCtx->relatorAtivo )
+		{
+			uint32_t faltas = 0 ;
+
+			usleep( 50000 ) ;
+			dormido += 50 ;
+
+			if ( dormido < pCtx->periodoRelatorMs )
+			{
+				continue ;
+			}
+
+			dormido = 0 ;
 
-		struct vehicle_attitude_s raw ;
+			LER_ObterDiagnostico( pCtx , &atual ) ;
+
+			for ( t = 0 ; t < LER_NumTopicos ; t++ )
+			{
+				faltas += atual.faltas[t] - anterior.faltas[t] ;
+			}
 
-			if ( fds[ATT_FD].revents & POLLIN ) /* Checando se teve parametros novos e copiar se for o caso */
+			if ( atual.prazosEsgotados != anterior.prazosEsgotados || atual.errosPoll != anterior.errosPoll ||
+			     atual.alturaInvalida != anterior.alturaInvalida || faltas != 0 )
 			{
-				orb_copy( ORB_ID( vehicle_attitude ) , att_fd, &raw)                 ;
+				printf( " [Aero] despertares %u, sem dados %u, erros de poll %u, faltas sensor/posicao/atitude %u/%u/%u, z invalido %u\n" ,
+				        ( unsigned ) ( atual.despertares     - anterior.despertares ) ,
+				        ( unsigned ) ( atual.prazosEsgotados - anterior.prazosEsgotados ) ,
+				        ( unsigned ) ( atual.errosPoll       - anterior.errosPoll ) ,
+				        ( unsigned ) ( atual.faltas[LER_TopicoSensor]  - anterior.faltas[LER_TopicoSensor] ) ,
+				        ( unsigned ) ( atual.faltas[LER_TopicoPosicao] - anterior.faltas[LER_TopicoPosicao] ) ,
+				        ( unsigned ) ( atual.faltas[LER_TopicoAtitude] - anterior.faltas[LER_TopicoAtitude] ) ,
+				        ( unsigned ) ( atual.alturaInvalida  - anterior.alturaInvalida ) ) ;
+			}
 
-				Att[0]      = raw.roll                                               ;
-				Att[1]      = raw.pitch                                              ;
-				Att[2]      = raw.yaw                                                ;
+			/* Saúde: só as mudanças de estado */
 
-				attRates[0] =raw.rollspeed                                           ;
-				attRates[1] =raw.pitchspeed                                          ;
-				attRates[2] =raw.yawspeed                                            ;
+			mudou = 0 ;
 
+			for ( t = 0 ; t < LER_NumTopicos ; t++ )
+			{
+				saude[t].estado = SAU_EstadoOK ;
+
+				if ( LER_ObterSaude( pCtx , ( LER_tpTopico ) t , &saude[t] ) == LER_CondRetOK &&
+				     saude[t].estado != estadoAnterior[t] )
+				{
+					mudou             = 1 ;
+					estadoAnterior[t] = saude[t].estado ;
+				}
+			}
 
-				return LER_CondRetOK                                                 ;
+			if ( mudou )
+			{
+				printf( " [Aero] saude sensor/posicao/atitude %s/%s/%s\n" ,
+				        nomesSaude[ saude[LER_TopicoSensor].estado ] ,
+				        nomesSaude[ saude[LER_TopicoPosicao].estado ] ,
+				        nomesSaude[ saude[LER_TopicoAtitude].estado ] ) ;
 			}
 
-		return LER_CondRetAttError ;
+			anterior = atual ;
+		}
+
+		return NULL ;
 	}
 
 	/***************************************************************************
 	*
-	*  Função: LER  & Aquisitar as atitudes rates
+	*  Função: LER  & Transpor n amostras para as colunas do bloco a partir
+	*                 da posição 'destino'
+	*
+	*  Um campo por vez: a escrita é sequencial em cada coluna.
 	*  ****/
 
-	static LER_tpCondRet aquisitarAltitude( float *altura )
+	static void transporTrecho( const LER_tpAmostra *pAmostras , unsigned n , unsigned destino , LER_tpBloco *pBloco )
 	{
+		unsigned k ;
+		int      c ;
 
-		struct vehicle_local_position_s raw ;
+		for ( k = 0 ; k < n ; k++ )
+		{
+			pBloco->timestamp[ destino + k ] = pAmostras[ k ].timestamp ;
+		}
 
-		if ( fds[ATT_FD].revents & POLLIN ) /* Checando se teve parametros novos e copiar se for o caso */
+		for ( c = 0 ; c < LER_NumCampos ; c++ )
 		{
-			orb_copy( ORB_ID( vehicle_local_position ) , global_fd, &raw)                 ;
+			float * coluna = pBloco->campo[ c ] + destino ;
+
+			for ( k = 0 ; k < n ; k++ )
+			{
+				coluna[ k ] = pAmostras[ k ].valor[ c ] ;
+			}
+		}
 
-			*altura = raw.z ;
+		if ( pBloco->validos != NULL )
+		{
+			for ( k = 0 ; k < n ; k++ )
+			{
+				pBloco->validos[ destino + k ] = pAmostras[ k ].validos ;
+			}
+		}
 
-			return LER_CondRetOK ;
+		if ( pBloco->novos != NULL )
+		{
+			for ( k = 0 ; k < n ; k++ )
+			{
+				pBloco->novos[ destino + k ] = pAmostras[ k ].novos ;
+			}
+		}
+	}
+
+	/***************************************************************************
+	*
+	*  Função: LER  & Passar um valor recém-copiado pelo filtro do campo
+	*
+	*  Só amostras com origem nova avançam o filtro; uma cópia repetida
+	*  devolve a saída anterior, para que a taxa vista pelo filtro seja a
+	*  do sensor e não a do poll.
+	*  ****/
+
+	static float filtrarCampo( LER_contexto *pCtx , LER_tpCampo campo , float valor , hrt_abstime origem )
+	{
+		FLT_tpCanal *pCanal = &pCtx->filtro[campo] ;
+
+		if ( ! FLT_Ativo( pCanal ) )
+		{
+			return valor ;
+		}
+
+		if ( origem == pCtx->origemFiltro[campo] )
+		{
+			return FLT_UltimaSaida( pCanal ) ;
 		}
 
-		return LER_CondRetAltitudeError ;
+		pCtx->origemFiltro[campo] = origem ;
+
+		return FLT_Filtrar( pCanal , valor ) ;
+	}
+
+	/***************************************************************************
+	*
+	*  Função: LER  & Alinhar os grupos num instante comum
+	*
+	*  Guarda as amostras novas de cada grupo e escolhe o instante: a mais
+	*  antiga das últimas amostras entre os grupos que estão a menos de
+	*  atrasoAlinhamentoUs da mais recente. Os demais não seguram o
+	*  instante e ficam retidos. Só publica quando o instante avança.
+	*  ****/
+
+	static void alinhar( LER_contexto *pCtx , LER_parametros *pParam )
+	{
+		LER_tpAmostra     amostra                ;
+		LER_tpAlinhamento info                   ;
+		LER_parametros    saida                  ;
+		hrt_abstime       ultima[LER_NumGrupos]  ;
+		hrt_abstime       maisNova = 0           ;
+		hrt_abstime       instante               ;
+		unsigned          disponiveis = 0        ;
+		int               g                      ;
+
+		LER_ObterAmostra( pParam , &amostra ) ;
+
+		for ( g = 0 ; g < LER_NumGrupos ; g++ )
+		{
+			LER_serie *pSerie = &pCtx->serie[g] ;
+			unsigned   mascara = LER_MASCARA_GRUPO( g ) ;
+
+			/* Em LER_ModoSincrono duas estruturas podem trazer a mesma
+			   origem: a série só aceita origens crescentes */
+
+			if ( ( pParam->novos & mascara ) &&
+			     ( pSerie->cabeca == 0 || pParam->origem[g] > pSerie->origem[( pSerie->cabeca - 1 ) & LER_MASCARA_SERIE] ) )
+			{
+				unsigned k = pSerie->cabeca & LER_MASCARA_SERIE ;
+
+				pSerie->origem[k] = pParam->origem[g] ;
+				memcpy( pSerie->valor[k] , amostra.valor , sizeof( pSerie->valor[k] ) ) ;
+				pSerie->cabeca ++ ;
+			}
+
+			if ( ( pParam->validos & mascara ) && pSerie->cabeca != 0 )
+			{
+				ultima[g]    = pSerie->origem[( pSerie->cabeca - 1 ) & LER_MASCARA_SERIE] ;
+				disponiveis |= mascara ;
+
+				if ( ultima[g] > maisNova )
+				{
+					maisNova = ultima[g] ;
+				}
+			}
+		}
+
+		if ( disponiveis == 0 )
+		{
+			return ;
+		}
+
+		instante = maisNova ;
+
+		for ( g = 0 ; g < LER_NumGrupos ; g++ )
+		{
+			if ( ( disponiveis & LER_MASCARA_GRUPO( g ) ) &&
+			     ultima[g] + pCtx->atrasoAlinhamentoUs >= maisNova && ultima[g] < instante )
+			{
+				instante = ultima[g] ;
+			}
+		}
+
+		if ( instante <= pCtx->alinhado.dado.timestamp )
+		{
+			return ;
+		}
+
+		memset( &info , 0 , sizeof( info ) ) ;
+		info.instante = instante ;
+
+		saida           = *pParam     ;
+		saida.timestamp = instante    ;
+		saida.validos   = disponiveis ;
+		saida.novos     = 0           ;
+
+		for ( g = 0 ; g < LER_NumGrupos ; g++ )
+		{
+			if ( disponiveis & LER_MASCARA_GRUPO( g ) )
+			{
+				if ( interpolarSerie( &pCtx->serie[g] , ( LER_tpGrupo ) g , instante , amostra.valor , &info.erroUs[g] ) )
+				{
+					info.retidos |= LER_MASCARA_GRUPO( g ) ;
+				}
+
+				saida.origem[g] = instante ;
+			}
+		}
+
+		aplicarValores( &saida , amostra.valor ) ;
+
+		/* A matriz e a aceleração no mundo acompanham os valores interpolados */
+
+		if ( disponiveis & LER_MASCARA_GRUPO( LER_GrupoAtitude ) )
+		{
+			calcularRotacao( saida.rotacao , saida.valor[LER_CampoRoll]  / CONVERT_RAD_INTO_GRAU ,
+			                 saida.valor[LER_CampoPitch] / CONVERT_RAD_INTO_GRAU ,
+			                 saida.valor[LER_CampoYaw]   / CONVERT_RAD_INTO_GRAU ) ;
+
+			if ( disponiveis & LER_MASCARA_GRUPO( LER_GrupoAceleracao ) )
+			{
+				calcularAcelMundo( &saida ) ;
+			}
+		}
+
+		publicarRetrato( &pCtx->alinhado , &saida , &info ) ;
+	}
+
+	/***************************************************************************
+	*
+	*  Função: LER  & Valor dos campos de um grupo num instante
+	*
+	*  Interpola linearmente entre as amostras que cercam o instante; os
+	*  ângulos pelo menor arco. Fora do que a série guarda, usa a amostra
+	*  da ponta. Retorna 1 se o instante é posterior à última amostra
+	*  (valor retido).
+	*  ****/
+
+	static int interpolarSerie( const LER_serie *pSerie , LER_tpGrupo grupo , hrt_abstime instante ,
+	                            float *valor , uint32_t *pErroUs )
+	{
+		unsigned     fim    = pSerie->cabeca ;
+		unsigned     inicio = fim > LER_PROFUNDIDADE_ALINHAMENTO ? fim - LER_PROFUNDIDADE_ALINHAMENTO : 0 ;
+		unsigned     k      = fim - 1 ;
+		const float *a , *b ;
+		hrt_abstime  ta , tb , erro ;
+		float        peso ;
+		int          c ;
+
+		/* Da mais nova para a mais antiga: o instante fica perto do fim */
+
+		while ( k > inicio && pSerie->origem[k & LER_MASCARA_SERIE] > instante )
+		{
+			k-- ;
+		}
+
+		ta = pSerie->origem[k & LER_MASCARA_SERIE] ;
+		a  = pSerie->valor [k & LER_MASCARA_SERIE] ;
+
+		if ( ta >= instante || k == fim - 1 )
+		{
+			erro     = ta > instante ? ta - instante : instante - ta ;
+			*pErroUs = erro > 0xFFFFFFFFu ? 0xFFFFFFFFu : ( uint32_t ) erro ;
+
+			for ( c = 0 ; c < LER_NumCampos ; c++ )
+			{
+				if ( LER_GrupoDoCampo( ( LER_tpCampo ) c ) == grupo )
+				{
+					valor[c] = a[c] ;
+				}
+			}
+
+			return ta < instante ;
+		}
+
+		tb = pSerie->origem[( k + 1 ) & LER_MASCARA_SERIE] ;
+		b  = pSerie->valor [( k + 1 ) & LER_MASCARA_SERIE] ;
+
+		peso     = ( float ) ( instante - ta ) / ( float ) ( tb - ta ) ;
+		erro     = instante - ta < tb - instante ? instante - ta : tb - instante ;
+		*pErroUs = erro > 0xFFFFFFFFu ? 0xFFFFFFFFu : ( uint32_t ) erro ;
+
+		for ( c = 0 ; c < LER_NumCampos ; c++ )
+		{
+			float delta ;
+
+			if ( LER_GrupoDoCampo( ( LER_tpCampo ) c ) != grupo )
+			{
+				continue ;
+			}
+
+			delta = b[c] - a[c] ;
+
+			if ( grupo == LER_GrupoAtitude )
+			{
+				if ( delta > 180.0f )
+				{
+					delta -= 360.0f ;
+				}
+				else if ( delta < -180.0f )
+				{
+					delta += 360.0f ;
+				}
+			}
+
+			valor[c] = a[c] + peso * delta ;
+
+			if ( grupo == LER_GrupoAtitude )
+			{
+				if ( valor[c] > 180.0f )
+				{
+					valor[c] -= 360.0f ;
+				}
+				else if ( valor[c] <= -180.0f )
+				{
+					valor[c] += 360.0f ;
+				}
+			}
+		}
+
+		return 0 ;
+	}
+
+	/***************************************************************************
+	*
+	*  Função: LER  & Copiar valores indexados por LER_tpCampo para os
+	*                 parâmetros (inverso de LER_ObterAmostra)
+	*  ****/
+
+	static void aplicarValores( LER_parametros *pParam , const float *valor )
+	{
+		memcpy( pParam->valor , valor , sizeof( pParam->valor ) ) ;
+	}
+
+	/***************************************************************************
+	*
+	*  Função: LER  & Atualizar a matriz de rotação do contexto
+	*
+	*  Só quando a atitude é nova: cópias repetidas e os vários consumidores
+	*  reaproveitam a matriz. A do estimador dispensa qualquer trigonometria.
+	*  ****/
+
+	static void atualizarRotacao( LER_contexto *pCtx , const void *pBruto )
+	{
+		const struct vehicle_attitude_s *pRaw = pBruto ;
+
+		if ( pRaw->timestamp == pCtx->origemRotacao )
+		{
+			return ;
+		}
+
+		pCtx->origemRotacao = pRaw->timestamp ;
+
+		if ( pRaw->R_valid )
+		{
+			memcpy( pCtx->rotacao , pRaw->R , sizeof( pCtx->rotacao ) ) ;
+		}
+		else
+		{
+			calcularRotacao( pCtx->rotacao , pRaw->roll , pRaw->pitch , pRaw->yaw ) ;
+		}
+	}
+
+	/***************************************************************************
+	*
+	*  Função: LER  & Matriz corpo -> NED a partir de roll, pitch e yaw (rad)
+	*
+	*  Sequência Tait-Bryan z-y-x, como o R do vehicle_attitude.
+	*  ****/
+
+	static void calcularRotacao( float R[3][3] , float roll , float pitch , float yaw )
+	{
+		float cr = cosf( roll  ) , sr = sinf( roll  ) ;
+		float cp = cosf( pitch ) , sp = sinf( pitch ) ;
+		float cy = cosf( yaw   ) , sy = sinf( yaw   ) ;
+
+		R[0][0] = cp * cy ;
+		R[0][1] = sr * sp * cy - cr * sy ;
+		R[0][2] = cr * sp * cy + sr * sy ;
+		R[1][0] = cp * sy ;
+		R[1][1] = sr * sp * sy + cr * cy ;
+		R[1][2] = cr * sp * sy - sr * cy ;
+		R[2][0] = -sp ;
+		R[2][1] = sr * cp ;
+		R[2][2] = cr * cp ;
 	}
 
+	/***************************************************************************
+	*
+	*  Função: LER  & Aceleração em NED sem a gravidade
+	*
+	*  O acelerômetro mede força específica (em repouso, -g no eixo z do
+	*  NED); somar g em z deixa só a aceleração do movimento.
+	*  ****/
+
+	static void calcularAcelMundo( LER_parametros *pParam )
+	{
+		const float *a = &pParam->valor[LER_CampoAx] ;
+		int i ;
+
+		for ( i = 0 ; i < 3 ; i++ )
+		{
+			pParam->acelMundo[i] = pParam->rotacao[i][0] * a[0] + pParam->rotacao[i][1] * a[1] + pParam->rotacao[i][2] * a[2] ;
+		}
 
+		pParam->acelMundo[2] += GRAVIDADE ;
+	}
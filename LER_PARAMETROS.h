@@ -1,6 +1,5 @@
 #ifndef LER_PARAMETROS
 #define LER_PARAMETROS
-#endif
 
 /**************************************************************************************************************************
 *$MCD Módulo de definição
@@ -39,12 +38,29 @@
 	#define LER_PARAMETROS_EXT extern
 #endif
 
+#include <stdint.h>
+
+#include "FLT_FILTROS.h"
+#include "CAP_CAPTURA.h"
+#include "ESP_ESPECTRO.h"
+#include "ALT_ALTITUDE.h"
+#include "SAU_SAUDE.h"
+
 /***** Declarações exportadas pelo módulo *****/
 
 /* Tipo referência para os parametros */
 
 typedef struct LER_parametros * LER_tpParametros ;
 
+/* Tipo referência para um contexto de leitura (conjunto de assinaturas) */
+
+typedef struct LER_contexto * LER_tpContexto ;
+
+/* Registro de voo (módulo REG) */
+
+struct REG_registro ;
+struct AVS_conjunto ;
+
 
 /***********************************************************************
 *
@@ -68,9 +84,346 @@ typedef struct LER_parametros * LER_tpParametros ;
               /* Não leu o mag corretamente                */
          LER_CondRetAltitudeError ,
          	  /* Não leu a altitude corretamente           */
+         LER_CondRetParcial       ,
+         	  /* Só parte dos grupos de campos foi atualizada
+         	     (ver LER_GruposNovos)                     */
 
 } LER_tpCondRet ;
 
+/***********************************************************************
+*
+*  $TC Tipo de dados: LER Campos dos parametros
+*
+*
+*  $ED Descrição do tipo
+*     Índice de cada parâmetro em LER_tpAmostra::valor
+*
+***********************************************************************/
+
+   typedef enum {
+
+         LER_CampoPressao     ,      /* mbar                           */
+         LER_CampoPitchSpeed  ,      /* º/s                            */
+         LER_CampoRollSpeed   ,      /* º/s                            */
+         LER_CampoYawSpeed    ,      /* º/s                            */
+         LER_CampoPitch       ,      /* º                              */
+         LER_CampoRoll        ,      /* º                              */
+         LER_CampoYaw         ,      /* º                              */
+         LER_CampoAx          ,      /* m/s²                           */
+         LER_CampoAy          ,      /* m/s²                           */
+         LER_CampoAz          ,      /* m/s²                           */
+         LER_CampoAltura      ,      /* m em relação ao home point     */
+         LER_NumCampos
+
+} LER_tpCampo ;
+
+/***********************************************************************
+*
+*  $TC Tipo de dados: LER Grupos de campos
+*
+*
+*  $ED Descrição do tipo
+*     Campos que chegam juntos e compartilham validade e timestamp de
+*     origem. LER_MASCARA_GRUPO dá o bit do grupo nas máscaras de
+*     validade (LER_GruposValidos / LER_GruposNovos).
+*
+***********************************************************************/
+
+   typedef enum {
+
+         LER_GrupoPressao     ,      /* pressao                  (sensor_combined, baro_timestamp)  */
+         LER_GrupoVelAngular  ,      /* roll/pitch/yawSpeed      (vehicle_attitude)                  */
+         LER_GrupoAtitude     ,      /* roll, pitch, yaw         (vehicle_attitude)                  */
+         LER_GrupoAceleracao  ,      /* ax, ay, az               (sensor_combined, accel timestamp)  */
+         LER_GrupoAltura      ,      /* altura                   (vehicle_local_position)            */
+         LER_NumGrupos
+
+} LER_tpGrupo ;
+
+#define LER_MASCARA_GRUPO( grupo )   ( 1u << ( grupo ) )
+#define LER_TODOS_GRUPOS             ( ( 1u << LER_NumGrupos ) - 1u )
+
+/***********************************************************************
+*
+*  $TC Tipo de dados: LER Amostra com timestamp
+*
+*
+*  $ED Descrição do tipo
+*     Cópia pública de uma estrutura de parametros, usada pelo histórico
+*     e por quem precisa dos valores indexados por LER_tpCampo.
+*
+***********************************************************************/
+
+   typedef struct {
+
+         uint64_t timestamp              ;
+              /* Instante (hrt, us) do ciclo de aquisição  */
+         float    valor[ LER_NumCampos ] ;
+         uint32_t validos                ;
+              /* Máscara dos grupos com dado válido        */
+         uint32_t novos                  ;
+              /* Máscara dos grupos atualizados no ciclo   */
+         uint64_t origem[ LER_NumGrupos ] ;
+              /* Timestamp uORB de cada grupo, como em     */
+              /* LER_TimestampGrupo (0 = nunca chegou)     */
+
+} LER_tpAmostra ;
+
+/***********************************************************************
+*
+*  $TC Tipo de dados: LER Bloco de amostras em colunas
+*
+*
+*  $ED Descrição do tipo
+*     Estrutura de vetores (SoA): campo[c][k] é o campo c da amostra k.
+*     Os vetores são do chamador; LER_MontarBloco os distribui numa área
+*     única, cada um alinhado a LER_ALINHAMENTO_BLOCO bytes e com a
+*     capacidade arredondada para múltiplo de 4 floats, de modo que
+*     laços sobre um campo possam ser vetorizados sem tratar sobras
+*     desalinhadas.
+*
+***********************************************************************/
+
+#define LER_ALINHAMENTO_BLOCO  16
+
+/* Capacidade efetiva e bytes de memória exigidos por LER_MontarBloco */
+
+#define LER_CAPACIDADE_BLOCO( n )  ( ( ( n ) + 3u ) & ~3u )
+#define LER_MEMORIA_BLOCO( n )     ( LER_ALINHAMENTO_BLOCO + LER_CAPACIDADE_BLOCO( n ) * \
+                                     ( sizeof( uint64_t ) + 2 * sizeof( uint32_t ) + LER_NumCampos * sizeof( float ) ) )
+
+   typedef struct {
+
+         unsigned   capacidade                 ;
+              /* Amostras que cabem em cada vetor               */
+         unsigned   numAmostras                ;
+              /* Amostras preenchidas pela última drenagem     */
+         uint64_t * timestamp                  ;
+         float *    campo[ LER_NumCampos ]     ;
+         uint32_t * validos                    ;
+              /* Pode ser NULL se o chamador não precisa        */
+         uint32_t * novos                      ;
+              /* Pode ser NULL se o chamador não precisa        */
+
+} LER_tpBloco ;
+
+/***********************************************************************
+*
+*  $TC Tipo de dados: LER Modo de aquisição
+*
+*
+*  $ED Descrição do tipo
+*     Define quem faz o poll dos tópicos do uORB
+*
+***********************************************************************/
+
+   typedef enum {
+
+         LER_ModoSincrono        ,
+              /* LER_FillParam faz o poll e copia os tópicos (bloqueia até 200 ms) */
+         LER_ModoThread          ,
+              /* Uma thread dedicada faz o poll e publica um retrato consistente;
+                 LER_FillParam apenas copia o retrato, sem bloquear             */
+         LER_ModoSobDemanda      ,
+              /* LER_FillParam faz o poll mas só marca os tópicos prontos; cada
+                 tópico é copiado na primeira leitura de um campo dele no ciclo */
+
+} LER_tpModo ;
+
+/***********************************************************************
+*
+*  $TC Tipo de dados: LER Tópicos assinados
+*
+*
+*  $ED Descrição do tipo
+*     Tópicos do uORB lidos pelo módulo. O valor é o índice do tópico na
+*     tabela de descritores do módulo; só os tópicos com algum grupo
+*     pedido (LER_tpConfig::grupos) são assinados e entram no poll set.
+*
+***********************************************************************/
+
+   typedef enum {
+
+         LER_TopicoSensor     ,      /* sensor_combined                */
+         LER_TopicoPosicao    ,      /* vehicle_local_position         */
+         LER_TopicoAtitude    ,      /* vehicle_attitude               */
+         LER_NumTopicos
+
+} LER_tpTopico ;
+
+/***********************************************************************
+*
+*  $TC Tipo de dados: LER Configuração de um contexto
+*
+*
+*  $ED Descrição do tipo
+*     Parâmetros de LER_Iniciar. Use LER_ConfigPadrao para obter os
+*     valores históricos (100 ms por tópico, poll de 200 ms) e altere
+*     apenas o necessário.
+*
+*     filtro[campo] é aplicado logo após o orb_copy, uma vez por amostra
+*     nova do sensor (cópias repetidas não avançam o filtro), na unidade
+*     do tópico. taxaHz deve ser a taxa real de publicação do campo com o
+*     intervalo escolhido; a pressão vem na taxa do barômetro. Os ângulos
+*     (roll, pitch e yaw) não podem ser filtrados, pois dão a volta em
+*     ±180º.
+*
+*     alinhamentoMs liga o estágio de alinhamento (LER_FillParamAlinhado)
+*     e é o atraso máximo do instante comum em relação à amostra mais
+*     recente. Deve ser maior que o intervaloMs de todo tópico assinado
+*     (LER_Iniciar recusa o contexto caso contrário): um tópico que chega
+*     mais espaçado que a janela fica retido quase sempre. E deve ser
+*     menor que LER_PROFUNDIDADE_ALINHAMENTO períodos do tópico mais
+*     rápido, senão o instante sai da memória desse tópico. Não existe em
+*     LER_ModoSobDemanda.
+*
+*     saude é a configuração do monitor de saúde (LER_ObterSaude), que
+*     vê os campos brutos, antes dos filtros.
+*
+***********************************************************************/
+
+   typedef struct {
+
+         LER_tpModo modo                           ;
+              /* Quem faz o poll dos tópicos                              */
+         unsigned   intervaloMs[ LER_NumTopicos ]  ;
+              /* orb_set_interval de cada tópico; 0 = toda publicação      */
+         int        prazoPollMs                    ;
+              /* Tempo máximo de espera do poll por um tópico novo          */
+         FLT_tpConfig filtro[ LER_NumCampos ]      ;
+              /* Cadeia de filtros de cada campo; numEstagios 0 = nenhum    */
+         unsigned   alinhamentoMs                  ;
+              /* Atraso máximo do instante comum; 0 = sem alinhamento       */
+         ALT_tpConfig vertical                     ;
+              /* Altura e razão de subida pela pressão (LER_EstimativaVertical) */
+         unsigned   grupos                         ;
+              /* Grupos desejados (LER_MASCARA_GRUPO); padrão LER_TODOS_GRUPOS */
+         SAU_tpConfig saude                        ;
+              /* Monitor de saúde dos tópicos (LER_ObterSaude)              */
+
+} LER_tpConfig ;
+
+/***********************************************************************
+*
+*  $TC Tipo de dados: LER Histograma de tempos
+*
+*
+*  $ED Descrição do tipo
+*     Faixa 0 conta 0 µs; a faixa f (1..LER_FAIXAS_HIST-1) conta tempos
+*     em [2^(f-1), 2^f) µs, e a última também tudo o que passar dela.
+*
+***********************************************************************/
+
+#define LER_FAIXAS_HIST  16
+
+   typedef struct {
+
+         uint32_t contagem[ LER_FAIXAS_HIST ] ;
+         uint32_t maximoUs                    ;
+
+} LER_tpHistograma ;
+
+/***********************************************************************
+*
+*  $TC Tipo de dados: LER Diagnóstico do ciclo de aquisição
+*
+*
+*  $ED Descrição do tipo
+*     Contadores acumulados desde LER_Iniciar, atualizados por quem faz o
+*     poll sem travas nem E/S. Apenas campos uint32_t (voltam a zero
+*     após 2^32; use diferenças entre duas leituras).
+*
+***********************************************************************/
+
+   typedef struct {
+
+         uint32_t         despertares                       ;
+              /* Retornos do poll com algum tópico pronto                 */
+         uint32_t         prazosEsgotados                   ;
+              /* Retornos do poll sem nenhum tópico (antes: printf)       */
+         uint32_t         errosPoll                         ;
+              /* poll retornou erro                                       */
+         uint32_t         faltas[ LER_NumTopicos ]          ;
+              /* Despertares em que o tópico não tinha dado novo          */
+         uint32_t         copias[ LER_NumTopicos ]          ;
+              /* orb_copy feitos                                          */
+         uint32_t         repetidos[ LER_NumTopicos ]       ;
+              /* Cópias com o mesmo timestamp de origem da anterior       */
+         uint32_t         alturaInvalida                    ;
+              /* vehicle_local_position com z_valid falso                 */
+         LER_tpHistograma duracaoCopia[ LER_NumTopicos ]    ;
+              /* Duração de cada orb_copy                                 */
+         LER_tpHistograma idade[ LER_NumTopicos ]           ;
+              /* Idade da amostra no momento da cópia (agora - timestamp)  */
+
+} LER_tpDiagnostico ;
+
+/***********************************************************************
+*
+*  $TC Tipo de dados: LER Resultado do alinhamento
+*
+*
+*  $ED Descrição do tipo
+*     Acompanha cada LER_FillParamAlinhado. Os tópicos chegam com
+*     timestamps próprios; o alinhamento leva todos os grupos a um mesmo
+*     instante, interpolando entre as duas amostras guardadas que o
+*     cercam. erroUs mede a distância do instante à amostra real mais
+*     próxima do grupo (0 = amostra exata); num grupo retido é a idade
+*     do valor mantido.
+*
+***********************************************************************/
+
+#define LER_PROFUNDIDADE_ALINHAMENTO  16    /* Amostras guardadas por grupo */
+
+   typedef struct {
+
+         uint64_t instante                 ;
+              /* Instante comum (hrt, us) de todos os grupos      */
+         uint32_t erroUs[ LER_NumGrupos ]  ;
+              /* Distância à amostra real mais próxima            */
+         uint32_t retidos                  ;
+              /* Grupos sem amostra depois do instante, mantidos  */
+              /* no último valor em vez de interpolados           */
+
+} LER_tpAlinhamento ;
+
+/***********************************************************************
+*
+*  $TC Tipo de dados: LER Região compartilhada
+*
+*
+*  $ED Descrição do tipo
+*     Retrato publicado por um contexto para outras tarefas ou processos
+*     (LER_AssociarCompartilhado), numa memória que todos enxergam: um
+*     objeto de shm_open mapeado por cada processo no Linux, ou uma
+*     variável global no NuttX, onde as tarefas dividem o espaço de
+*     endereços. O layout é fixo e não tem ponteiros.
+*
+*     Protegido por seqlock: sequencia ímpar = publicação em andamento.
+*     sequencia / 2 é o número da publicação, que muda a cada retrato
+*     novo. Só o contexto escreve; qualquer número de leitores lê sem
+*     travas nem chamadas ao sistema e nunca atrasa o escritor.
+*
+***********************************************************************/
+
+#define LER_MAGIA_COMPARTILHADO  0x3152454Cu   /* "LER1" */
+
+   typedef struct {
+
+         uint32_t         magia                      ;
+              /* LER_MAGIA_COMPARTILHADO depois de iniciada       */
+         uint32_t         tamanho                    ;
+              /* sizeof( LER_tpCompartilhado ) de quem a iniciou  */
+         uint32_t         sequencia                  ;
+         uint32_t         reservado                  ;
+         LER_tpAmostra    amostra                    ;
+              /* Com o timestamp uORB de cada grupo               */
+         float            rotacao[ 3 ][ 3 ]          ;
+         float            acelMundo[ 3 ]             ;
+         ALT_tpEstimativa vertical                   ;
+
+} LER_tpCompartilhado ;
+
 /***********************************************************************
 *
 *  $FC Função: LER  &Cria estrutura de parametros
@@ -78,6 +431,11 @@ typedef struct LER_parametros * LER_tpParametros ;
 *  $ED Descrição da função
 *     Criar e inicializar uma estrutura de parâmetros
 *
+*     A estrutura vem de um conjunto estático de LER_TAM_POOL_PARAM
+*     estruturas, sem heap; só quando o conjunto se esgota ela é alocada
+*     com calloc. Deve ser devolvida com LER_DestruirParam, nunca free.
+*     Pode ser chamada de qualquer thread.
+*
 *  $FV Valor retornado
 *     Se executou corretamente retorna a estrutura
 *
@@ -85,186 +443,329 @@ typedef struct LER_parametros * LER_tpParametros ;
 *
 ***********************************************************************/
 
+#ifndef LER_TAM_POOL_PARAM
+#define LER_TAM_POOL_PARAM  8        /* Estruturas estáticas de LER_CriarParam (até 32) */
+#endif
+
 LER_tpParametros LER_CriarParam(void);
 
 /***********************************************************************
 *
-*  $FC Função: LER  &Inicializar Módulo LER
+*  $FC Função: LER  &Iniciar estrutura de parametros na memória do chamador
 *
 *  $ED Descrição da função
-*     Inicializa todas as variáveis globais necessárias ao bom funcionamento
-*     do módulo. (OBS: Esta função deve ser chamada uma única vez)
+*     Zera e prepara uma estrutura de parâmetros numa área do chamador
+*     (estática, na pilha ou dentro de outra estrutura). Nenhuma
+*     alocação; LER_DestruirParam não libera a área.
+*
+*  $EP Parâmetros
+*    memoria   - Área alinhada para uint64_t
+*    tamanho   - Bytes da área; basta LER_TAM_MEMORIA_PARAM
+*    pParam    - Recebe a estrutura (que começa em memoria)
 *
 *  $FV Valor retornado
-*     Se executou corretamente retorna LER_CondRetOK.
+*     LER_CondRetOK ou LER_CondRetError se a área é pequena ou está
+*     desalinhada.
+*
+***********************************************************************/
+
+#define LER_TAM_MEMORIA_PARAM  256  /* Limite superior do tamanho da estrutura, em bytes */
+
+LER_tpCondRet LER_IniciarParam( void * memoria , unsigned tamanho , LER_tpParametros * pParam ) ;
+
+/***********************************************************************
 *
-*     Se ocorreu algum erro, retornará LER_CondRetError.
+*  $FC Função: LER  &Destruir estrutura de parametros
+*
+*  $ED Descrição da função
+*     Devolve a estrutura ao conjunto estático, ao heap ou, se veio de
+*     LER_IniciarParam, apenas a invalida. NULL é ignorado.
 *
 ***********************************************************************/
 
-LER_tpCondRet LER_Iniciar(void);
+void LER_DestruirParam( LER_tpParametros pStructParam ) ;
 
 /***********************************************************************
 *
-*  $FC Função: LER  &Preencher Parametros
+*  $FC Função: LER  &Obter configuração padrão
 *
 *  $ED Descrição da função
-*     Preenche uma estrutura de parâmetros com todos os seus valores
-*     ja filtrados e devidamente compensados.
+*     Preenche pConfig com LER_ModoSincrono, 100 ms para cada tópico,
+*     prazo de poll de 200 ms e nenhum filtro.
+*
+***********************************************************************/
+
+void LER_ConfigPadrao( LER_tpConfig * pConfig );
+
+/***********************************************************************
+*
+*  $FC Função: LER  &Inicializar Contexto LER
+*
+*  $ED Descrição da função
+*     Cria um contexto de leitura com suas próprias assinaturas dos
+*     tópicos, intervalo e poll set. Cada consumidor (estabilizador,
+*     logger...) deve criar o seu, com a taxa de que precisa.
+*
+*     Em LER_ModoThread dispara a thread de aquisição do contexto, que
+*     passa a ser a única dona do seu poll set e mantém o retrato mais
+*     recente dos parâmetros protegido por um seqlock.
 *
 *  $EP Parâmetros
-*    pStructParam  - Ponteiro para uma estrutura de paramêtros
+*    ppContexto   - Recebe o contexto criado (NULL em caso de erro)
+*    pConfig      - Modo, intervalos por tópico, prazo do poll e filtros.
+*                   NULL equivale a LER_ConfigPadrao.
 *
 *  $FV Valor retornado
 *     Se executou corretamente retorna LER_CondRetOK.
 *
-*     Se ocorreu algum erro, retornará LER_CondRetError.
+*     Se ocorreu algum erro, inclusive um filtro inválido, nenhum grupo
+*     pedido ou alinhamentoMs que não supera o intervaloMs de um tópico
+*     assinado, retornará LER_CondRetError.
 *
 ***********************************************************************/
 
-LER_tpCondRet LER_FillParam(LER_tpParametros pStructParam);
+LER_tpCondRet LER_Iniciar( LER_tpContexto * ppContexto , const LER_tpConfig * pConfig );
 
 /***********************************************************************
 *
-*  $FC Função: LER  &Ler Pressão
+*  $FC Função: LER  &Terminar Contexto LER
 *
 *  $ED Descrição da função
-*     Le e testa a pressão (em mbar) da estrutura de parametros
-*
-*  $EP Parâmetros
-*    pStructParam  - Ponteiro para uma estrutura de paramêtros
+*     Para a thread de aquisição (se houver), cancela as assinaturas
+*     feitas em LER_Iniciar e libera o contexto.
 *
+*     Em LER_ModoSobDemanda a estrutura de parâmetros guarda o contexto
+*     até as leituras copiarem os tópicos pendentes. As estruturas do
+*     conjunto de LER_CriarParam são desligadas aqui e mantêm os valores
+*     já copiados. As alocadas no heap (conjunto esgotado) e as de
+*     LER_IniciarParam não são alcançadas: o chamador deve destruí-las ou
+*     passá-las por LER_FillParam de outro contexto antes de ler campos
+*     delas outra vez.
 *
 ***********************************************************************/
 
-float LER_Pressao( LER_tpParametros pStructParam ) ;
+void LER_Terminar( LER_tpContexto pContexto );
 
 /***********************************************************************
 *
-*  $FC Função: LER  &Ler Velocidade de Pitch
+*  $FC Função: LER  &Definir intervalo de um tópico
 *
 *  $ED Descrição da função
-*     Le e testa a Velocidade de Pitch (em º/s) da estrutura de parametros
+*     Altera em tempo de execução o orb_set_interval de um tópico do
+*     contexto (por exemplo, a cada fase de voo). Pode ser chamada com
+*     a thread de aquisição rodando.
 *
 *  $EP Parâmetros
-*    pStructParam  - Ponteiro para uma estrutura de paramêtros
+*    pContexto    - Contexto criado por LER_Iniciar
+*    topico       - Tópico a alterar
+*    intervaloMs  - Novo intervalo; 0 = toda publicação
 *
+*  $FV Valor retornado
+*     LER_CondRetOK ou LER_CondRetError se o tópico é inválido, não foi
+*     assinado por falta de grupo pedido ou o uORB recusou o intervalo.
 *
 ***********************************************************************/
 
-float LER_PitchSpeed( LER_tpParametros pStructParam ) ;
+LER_tpCondRet LER_DefinirIntervalo( LER_tpContexto pContexto , LER_tpTopico topico , unsigned intervaloMs );
 
 /***********************************************************************
 *
-*  $FC Função: LER  &Ler Velocidade de Roll
+*  $FC Função: LER  &Definir prazo do poll
 *
 *  $ED Descrição da função
-*     Le e testa a Velocidade de Roll (em º/s) da estrutura de parametros
+*     Altera o tempo máximo que o poll do contexto espera por dados. Vale
+*     a partir do próximo ciclo de aquisição.
 *
-*  $EP Parâmetros
-*    pStructParam  - Ponteiro para uma estrutura de paramêtros
+***********************************************************************/
+
+LER_tpCondRet LER_DefinirPrazoPoll( LER_tpContexto pContexto , int prazoMs );
+
+/***********************************************************************
+*
+*  $FC Função: LER  &Obter taxa efetiva de um tópico
+*
+*  $ED Descrição da função
+*     Informa quantas amostras novas do tópico o contexto efetivamente
+*     copiou por segundo, medido na última janela de 1 s completa.
 *
+*  $FV Valor retornado
+*     A taxa em Hz, ou um valor negativo se ainda não há janela completa.
 *
 ***********************************************************************/
 
-float LER_RollSpeed( LER_tpParametros pStructParam ) ;
+float LER_TaxaEfetiva( LER_tpContexto pContexto , LER_tpTopico topico );
 
 /***********************************************************************
 *
-*  $FC Função: LER  &Ler Velocidade de yaw
+*  $FC Função: LER  &Obter diagnóstico
 *
 *  $ED Descrição da função
-*     Le e testa a Velocidade de yaw da estrutura de parametros
+*     Copia os contadores do contexto. Pode ser chamada de qualquer
+*     thread a qualquer momento; cada campo é lido atomicamente, mas a
+*     cópia não é um retrato instantâneo do conjunto.
 *
-*  $EP Parâmetros
-*    pStructParam  - Ponteiro para uma estrutura de paramêtros
+***********************************************************************/
+
+void LER_ObterDiagnostico( LER_tpContexto pContexto , LER_tpDiagnostico * pDiag );
+
+/***********************************************************************
 *
+*  $TC Tipo de dados: LER Saúde de um tópico
 *
 ***********************************************************************/
 
-float LER_YawSpeed( LER_tpParametros pStructParam ) ;
+   typedef struct {
+
+         SAU_tpEstado estado        ;
+              /* O pior dos campos do tópico, ou mudo                */
+         LER_tpCampo  pior          ;
+              /* Campo que deu o estado (LER_NumCampos se nenhum)    */
+         float        taxaHz        ;
+              /* Taxa de amostras novas (média exponencial)          */
+         float        idadeS        ;
+              /* Tempo desde a última amostra nova                   */
+
+} LER_tpSaude ;
 
 /***********************************************************************
 *
-*  $FC Função: LER  &Ler Angulo de Pitch
+*  $FC Função: LER  &Obter saúde de um tópico
 *
 *  $ED Descrição da função
-*     Le e testa o Angulo de Pitch da estrutura de parametros
+*     Cada cópia de um tópico alimenta, em quem faz o poll, a média e a
+*     variância de cada campo pedido (SAU_SAUDE) e os detectores de
+*     valor travado e de amostras atípicas; o estado mudo é avaliado
+*     aqui, no instante da consulta, de modo que um tópico que parou de
+*     publicar aparece mesmo sem nenhuma cópia. Custo constante por
+*     amostra. Pode ser chamada de qualquer thread.
 *
-*  $EP Parâmetros
-*    pStructParam  - Ponteiro para uma estrutura de paramêtros
+*     Em LER_ModoSobDemanda só as amostras copiadas são vistas: um
+*     tópico que o consumidor não lê fica mudo.
 *
+*  $FV Valor retornado
+*     LER_CondRetOK ou LER_CondRetError se o tópico não foi assinado.
 *
 ***********************************************************************/
 
-float LER_PitchAngle( LER_tpParametros pStructParam ) ;
+LER_tpCondRet LER_ObterSaude( LER_tpContexto pContexto , LER_tpTopico topico , LER_tpSaude * pSaude ) ;
 
 /***********************************************************************
 *
-*  $FC Função: LER  &Ler Angulo de Roll
+*  $FC Função: LER  &Obter saúde de um campo
 *
 *  $ED Descrição da função
-*     Le e testa o Angulo de Roll da estrutura de parametros
-*
-*  $EP Parâmetros
-*    pStructParam  - Ponteiro para uma estrutura de paramêtros
+*     Estado, média, desvio e contadores do campo, na unidade dele.
 *
+*  $FV Valor retornado
+*     LER_CondRetOK ou LER_CondRetError se o campo é inválido ou o seu
+*     grupo não foi pedido.
 *
 ***********************************************************************/
 
-float LER_RollAngle( LER_tpParametros pStructParam ) ;
+LER_tpCondRet LER_ObterSaudeCampo( LER_tpContexto pContexto , LER_tpCampo campo , SAU_tpResumoCanal * pResumo ) ;
 
 /***********************************************************************
 *
-*  $FC Função: LER  &Ler Angulo de Yaw
+*  $FC Função: LER  &Iniciar relator
 *
 *  $ED Descrição da função
-*     Le e testa o Angulo de Yaw da estrutura de parametros
+*     Dispara uma thread que, a cada período, escreve
+*     em stdout uma linha com as diferenças dos contadores, apenas se
+*     houve prazo esgotado, erro de poll, falta ou altura inválida no
+*     período, e outra com o estado de saúde dos tópicos quando algum
+*     muda (LER_ObterSaude). O ciclo de aquisição nunca espera por ela.
+*     Terminada por LER_Terminar.
 *
 *  $EP Parâmetros
-*    pStructParam  - Ponteiro para uma estrutura de paramêtros
+*    periodoMs  - Intervalo mínimo entre linhas (no mínimo 100 ms)
 *
+*  $FV Valor retornado
+*     LER_CondRetOK ou LER_CondRetError se já estava ativo ou a thread
+*     não pôde ser criada.
 *
 ***********************************************************************/
 
-float LER_YawAngle( LER_tpParametros pStructParam ) ;
+LER_tpCondRet LER_IniciarRelator( LER_tpContexto pContexto , unsigned periodoMs );
 
 /***********************************************************************
 *
-*  $FC Função: LER  &Ler Aceleração no eixo x
+*  $FC Função: LER  &Preencher Parametros
 *
 *  $ED Descrição da função
-*     Le e testa a aceleração em x da estrutura de parametros
+*     Preenche uma estrutura de parâmetros com todos os seus valores
+*     ja filtrados e devidamente compensados.
+*
+*     Em LER_ModoThread não bloqueia: copia em tempo constante o último
+*     retrato publicado pela thread de aquisição.
+*
+*     Em LER_ModoSobDemanda só espera e marca em pStructParam os tópicos
+*     prontos. O orb_copy, o filtro e a distribuição de um tópico ficam
+*     para a primeira função de leitura (LER_PitchAngle, LER_LerCampo,
+*     LER_ObterAmostra, ...) que precisar dele; tópicos que ninguém lê
+*     não são copiados, e os que continuam pendentes saem do poll. Os
+*     filtros e as taxas desses tópicos só veem as amostras copiadas. A
+*     estrutura passa a apontar para o contexto e deve ser lida pela
+*     mesma thread que chama LER_FillParam.
 *
 *  $EP Parâmetros
+*    pContexto     - Contexto criado por LER_Iniciar
 *    pStructParam  - Ponteiro para uma estrutura de paramêtros
 *
+*     Cada grupo de campos (LER_tpGrupo) guarda sua validade e o timestamp
+*     uORB de origem; um grupo é novo quando sua origem avançou em relação
+*     ao que pStructParam já continha, de modo que atualizações parciais
+*     podem ser aproveitadas.
+*
+*  $FV Valor retornado
+*     LER_CondRetOK se todos os grupos pedidos foram atualizados.
+*
+*     LER_CondRetParcial se apenas alguns foram (ver LER_GruposNovos).
+*
+*     LER_CondRetError se nenhum dado novo chegou.
+*
+*     Em LER_ModoSobDemanda: LER_CondRetOK se todos os tópicos assinados
+*     estão pendentes, LER_CondRetParcial se alguns, LER_CondRetError se
+*     nenhum (prazo esgotado).
 *
 ***********************************************************************/
 
-float LER_AcelX( LER_tpParametros pStructParam ) ;
+LER_tpCondRet LER_FillParam( LER_tpContexto pContexto , LER_tpParametros pStructParam );
 
 /***********************************************************************
 *
-*  $FC Função: LER  &Ler Aceleração no eixo y
+*  $FC Função: LER  &Preencher Parametros alinhados no tempo
 *
 *  $ED Descrição da função
-*     Le e testa a aceleração em y da estrutura de parametros
+*     Como LER_FillParam, mas todos os grupos válidos vêm interpolados
+*     para um único instante: a mais antiga das últimas amostras dos
+*     grupos em dia. Um grupo cuja última amostra está mais de
+*     alinhamentoMs atrás da mais recente não segura o instante; fica
+*     com o último valor e é marcado em pAlinhamento->retidos. Assim a
+*     latência do resultado é limitada por alinhamentoMs e a memória por
+*     LER_PROFUNDIDADE_ALINHAMENTO amostras de cada grupo.
+*
+*     O timestamp e a origem de todos os grupos válidos passam a ser o
+*     instante comum. Os ângulos são interpolados pelo menor arco.
 *
 *  $EP Parâmetros
-*    pStructParam  - Ponteiro para uma estrutura de paramêtros
+*    pAlinhamento  - Recebe o instante e o erro de cada grupo (pode ser
+*                    NULL)
 *
+*  $FV Valor retornado
+*     Como LER_FillParam; LER_CondRetError também se o contexto foi
+*     iniciado com alinhamentoMs 0.
 *
 ***********************************************************************/
 
-float LER_AcelY( LER_tpParametros pStructParam ) ;
+LER_tpCondRet LER_FillParamAlinhado( LER_tpContexto pContexto , LER_tpParametros pStructParam ,
+                                     LER_tpAlinhamento * pAlinhamento );
 
 /***********************************************************************
 *
-*  $FC Função: LER  &Ler Aceleração no eixo z
+*  $FC Função: LER  &Ler Pressão
 *
 *  $ED Descrição da função
-*     Le e testa a aceleração em z da estrutura de parametros
+*     Le e testa a pressão (em mbar) da estrutura de parametros
 *
 *  $EP Parâmetros
 *    pStructParam  - Ponteiro para uma estrutura de paramêtros
@@ -272,14 +773,14 @@ float LER_AcelY( LER_tpParametros pStructParam ) ;
 *
 ***********************************************************************/
 
-float LER_AcelZ( LER_tpParametros pStructParam ) ;
+float LER_Pressao( LER_tpParametros pStructParam ) ;
 
 /***********************************************************************
 *
-*  $FC Função: LER  &Ler Altitude
+*  $FC Função: LER  &Ler Velocidade de Pitch
 *
 *  $ED Descrição da função
-*     Le e testa a altitude da estrutura de parametros
+*     Le e testa a Velocidade de Pitch (em º/s) da estrutura de parametros
 *
 *  $EP Parâmetros
 *    pStructParam  - Ponteiro para uma estrutura de paramêtros
@@ -287,9 +788,563 @@ float LER_AcelZ( LER_tpParametros pStructParam ) ;
 *
 ***********************************************************************/
 
-float LER_Altitude( LER_tpParametros pStructParam ) ;
-
-
-
+float LER_PitchSpeed( LER_tpParametros pStructParam ) ;
 
-#undef LER_PARAMETROS
+/***********************************************************************
+*
+*  $FC Função: LER  &Ler Velocidade de Roll
+*
+*  $ED Descrição da função
+*     Le e testa a Velocidade de Roll (em º/s) da estrutura de parametros
+*
+*  $EP Parâmetros
+*    pStructParam  - Ponteiro para uma estrutura de paramêtros
+*
+*
+***********************************************************************/
+
+float LER_RollSpeed( LER_tpParametros pStructParam ) ;
+
+/***********************************************************************
+*
+*  $FC Função: LER  &Ler Velocidade de yaw
+*
+*  $ED Descrição da função
+*     Le e testa a Velocidade de yaw da estrutura de parametros
+*
+*  $EP Parâmetros
+*    pStructParam  - Ponteiro para uma estrutura de paramêtros
+*
+*
+***********************************************************************/
+
+float LER_YawSpeed( LER_tpParametros pStructParam ) ;
+
+/***********************************************************************
+*
+*  $FC Função: LER  &Ler Angulo de Pitch
+*
+*  $ED Descrição da função
+*     Le e testa o Angulo de Pitch da estrutura de parametros
+*
+*  $EP Parâmetros
+*    pStructParam  - Ponteiro para uma estrutura de paramêtros
+*
+*
+***********************************************************************/
+
+float LER_PitchAngle( LER_tpParametros pStructParam ) ;
+
+/***********************************************************************
+*
+*  $FC Função: LER  &Ler Angulo de Roll
+*
+*  $ED Descrição da função
+*     Le e testa o Angulo de Roll da estrutura de parametros
+*
+*  $EP Parâmetros
+*    pStructParam  - Ponteiro para uma estrutura de paramêtros
+*
+*
+***********************************************************************/
+
+float LER_RollAngle( LER_tpParametros pStructParam ) ;
+
+/***********************************************************************
+*
+*  $FC Função: LER  &Ler Angulo de Yaw
+*
+*  $ED Descrição da função
+*     Le e testa o Angulo de Yaw da estrutura de parametros
+*
+*  $EP Parâmetros
+*    pStructParam  - Ponteiro para uma estrutura de paramêtros
+*
+*
+***********************************************************************/
+
+float LER_YawAngle( LER_tpParametros pStructParam ) ;
+
+/***********************************************************************
+*
+*  $FC Função: LER  &Ler Aceleração no eixo x
+*
+*  $ED Descrição da função
+*     Le e testa a aceleração em x da estrutura de parametros
+*
+*  $EP Parâmetros
+*    pStructParam  - Ponteiro para uma estrutura de paramêtros
+*
+*
+***********************************************************************/
+
+float LER_AcelX( LER_tpParametros pStructParam ) ;
+
+/***********************************************************************
+*
+*  $FC Função: LER  &Ler Aceleração no eixo y
+*
+*  $ED Descrição da função
+*     Le e testa a aceleração em y da estrutura de parametros
+*
+*  $EP Parâmetros
+*    pStructParam  - Ponteiro para uma estrutura de paramêtros
+*
+*
+***********************************************************************/
+
+float LER_AcelY( LER_tpParametros pStructParam ) ;
+
+/***********************************************************************
+*
+*  $FC Função: LER  &Ler Aceleração no eixo z
+*
+*  $ED Descrição da função
+*     Le e testa a aceleração em z da estrutura de parametros
+*
+*  $EP Parâmetros
+*    pStructParam  - Ponteiro para uma estrutura de paramêtros
+*
+*
+***********************************************************************/
+
+float LER_AcelZ( LER_tpParametros pStructParam ) ;
+
+/***********************************************************************
+*
+*  $FC Função: LER  &Ler Altitude
+*
+*  $ED Descrição da função
+*     Le e testa a altitude da estrutura de parametros
+*
+*  $EP Parâmetros
+*    pStructParam  - Ponteiro para uma estrutura de paramêtros
+*
+*
+***********************************************************************/
+
+float LER_Altitude( LER_tpParametros pStructParam ) ;
+
+/***********************************************************************
+*
+*  $FC Função: LER  &Obter amostra
+*
+*  $ED Descrição da função
+*     Copia todos os parâmetros e o timestamp da estrutura para uma
+*     amostra indexada por LER_tpCampo.
+*
+*  $EP Parâmetros
+*    pStructParam  - Ponteiro para uma estrutura de paramêtros
+*    pAmostra      - Amostra a ser preenchida
+*
+***********************************************************************/
+
+void LER_ObterAmostra( LER_tpParametros pStructParam , LER_tpAmostra * pAmostra ) ;
+
+/***********************************************************************
+*
+*  $FC Função: LER  &Grupos válidos
+*
+*  $ED Descrição da função
+*     Máscara (LER_MASCARA_GRUPO) dos grupos que já receberam dado
+*     válido. Campos de grupos fora da máscara não devem ser usados.
+*
+***********************************************************************/
+
+unsigned LER_GruposValidos( LER_tpParametros pStructParam ) ;
+
+/***********************************************************************
+*
+*  $FC Função: LER  &Grupos novos
+*
+*  $ED Descrição da função
+*     Máscara dos grupos atualizados pela última chamada de LER_FillParam.
+*
+***********************************************************************/
+
+unsigned LER_GruposNovos( LER_tpParametros pStructParam ) ;
+
+/***********************************************************************
+*
+*  $FC Função: LER  &Timestamp de origem de um grupo
+*
+*  $ED Descrição da função
+*     Timestamp uORB (hrt, us) do dado que está no grupo; 0 se o grupo
+*     nunca foi preenchido. hrt_absolute_time() menos este valor é a
+*     idade do dado.
+*
+***********************************************************************/
+
+uint64_t LER_TimestampGrupo( LER_tpParametros pStructParam , LER_tpGrupo grupo ) ;
+
+/***********************************************************************
+*
+*  $FC Função: LER  &Grupo de um campo
+*
+***********************************************************************/
+
+LER_tpGrupo LER_GrupoDoCampo( LER_tpCampo campo ) ;
+
+/***********************************************************************
+*
+*  $FC Função: LER  &Ler campo com validade
+*
+*  $ED Descrição da função
+*     Lê um campo junto com o timestamp de origem do seu grupo.
+*
+*  $EP Parâmetros
+*    pStructParam  - Ponteiro para uma estrutura de paramêtros
+*    campo         - Campo desejado
+*    pValor        - Recebe o valor
+*    pTimestamp    - Recebe o timestamp de origem (pode ser NULL)
+*
+*  $FV Valor retornado
+*     LER_CondRetOK se o campo é válido; caso contrário o erro do grupo
+*     (LER_CondRetAcelError, LER_CondRetAttError, LER_CondRetAltitudeError
+*     ou LER_CondRetError).
+*
+***********************************************************************/
+
+LER_tpCondRet LER_LerCampo( LER_tpParametros pStructParam , LER_tpCampo campo ,
+                            float * pValor , uint64_t * pTimestamp ) ;
+
+/***********************************************************************
+*
+*  $FC Função: LER  &Ler matriz de rotação
+*
+*  $ED Descrição da função
+*     Copia a matriz de rotação do corpo para NED (R[i][j], v_ned =
+*     R · v_corpo) da atitude mais recente. É montada uma única vez por
+*     amostra nova do vehicle_attitude: a matriz do estimador quando
+*     R_valid, senão a partir de roll, pitch e yaw. Dispensa o
+*     consumidor de refazer senos e cossenos a cada ciclo.
+*
+*  $FV Valor retornado
+*     LER_CondRetOK, ou LER_CondRetAttError se a atitude não é válida.
+*
+***********************************************************************/
+
+LER_tpCondRet LER_MatrizRotacao( LER_tpParametros pStructParam , float R[ 3 ][ 3 ] ) ;
+
+/***********************************************************************
+*
+*  $FC Função: LER  &Ler aceleração no referencial do mundo
+*
+*  $ED Descrição da função
+*     Aceleração em NED (norte, leste, baixo) sem a gravidade, em m/s²:
+*     R · (ax, ay, az) + (0, 0, g). Em repouso é (0, 0, 0). Recalculada
+*     quando chega aceleração ou atitude nova.
+*
+*  $FV Valor retornado
+*     LER_CondRetOK; LER_CondRetAttError ou LER_CondRetAcelError se
+*     falta a atitude ou a aceleração.
+*
+***********************************************************************/
+
+LER_tpCondRet LER_AcelMundo( LER_tpParametros pStructParam , float acel[ 3 ] ) ;
+
+/***********************************************************************
+*
+*  $FC Função: LER  &Ler estimativa vertical
+*
+*  $ED Descrição da função
+*     Altura e razão de subida do estimador barométrico (módulo ALT),
+*     atualizadas a cada pressão nova e corrigidas pelo z do
+*     vehicle_local_position. Positivas para cima, ao contrário de
+*     LER_Altitude, que devolve o z do NED.
+*
+*  $FV Valor retornado
+*     LER_CondRetOK, ou LER_CondRetAltitudeError se nenhuma pressão
+*     válida chegou ainda.
+*
+***********************************************************************/
+
+LER_tpCondRet LER_EstimativaVertical( LER_tpParametros pStructParam , ALT_tpEstimativa * pEstimativa ) ;
+
+/***********************************************************************
+*
+*  $FC Função: LER  &Ativar histórico
+*
+*  $ED Descrição da função
+*     Cria o histórico de amostras (ver HST_HISTORICO.h) do contexto,
+*     alimentado a cada ciclo de aquisição com dados novos. Deve ser
+*     chamada após LER_Iniciar; a memória é toda alocada aqui.
+*
+*  $EP Parâmetros
+*    capacidade  - Número de amostras (arredondado para potência de 2)
+*
+*  $FV Valor retornado
+*     LER_CondRetOK ou LER_CondRetError se faltou memória, o histórico
+*     já estava ativo ou o contexto é LER_ModoSobDemanda.
+*
+***********************************************************************/
+
+LER_tpCondRet LER_AtivarHistorico( LER_tpContexto pContexto , unsigned capacidade ) ;
+
+/***********************************************************************
+*
+*  $FC Função: LER  &Obter histórico
+*
+*  $FV Valor retornado
+*     Handle do histórico para os leitores (HST_Obter*), ou NULL se
+*     LER_AtivarHistorico não foi chamada.
+*
+***********************************************************************/
+
+struct HST_historico * LER_ObterHistorico( LER_tpContexto pContexto ) ;
+
+/***********************************************************************
+*
+*  $FC Função: LER  &Montar bloco
+*
+*  $ED Descrição da função
+*     Distribui os vetores de um LER_tpBloco numa área do chamador.
+*
+*  $EP Parâmetros
+*    memoria     - Área com LER_MEMORIA_BLOCO( capacidade ) bytes
+*    capacidade  - Amostras desejadas; a capacidade efetiva é
+*                  LER_CAPACIDADE_BLOCO( capacidade )
+*
+***********************************************************************/
+
+void LER_MontarBloco( LER_tpBloco * pBloco , void * memoria , unsigned capacidade ) ;
+
+/***********************************************************************
+*
+*  $FC Função: LER  &Preencher bloco de parâmetros
+*
+*  $ED Descrição da função
+*     Drena do histórico do contexto, em ordem cronológica, as amostras
+*     com timestamp maior que 'desde', até a capacidade do bloco, e as
+*     transpõe para as colunas do bloco. Para continuar de onde parou,
+*     passe como 'desde' o último timestamp do bloco anterior.
+*
+*     Não faz poll: quem alimenta o histórico é LER_FillParam (modo
+*     síncrono) ou a thread de aquisição. Amostras sobrescritas pelo
+*     produtor durante a cópia são descartadas e a drenagem recomeça
+*     pelas que ainda existem.
+*
+*  $EP Parâmetros
+*    desde   - Timestamp da última amostra já consumida (0 = todas)
+*    pBloco  - Bloco com vetores já montados; numAmostras é preenchido
+*
+*  $FV Valor retornado
+*     LER_CondRetOK       - todas as amostras pendentes couberam
+*     LER_CondRetParcial  - bloco cheio, há mais amostras pendentes
+*     LER_CondRetError    - nenhuma amostra nova ou histórico inativo
+*
+***********************************************************************/
+
+LER_tpCondRet LER_FillParamBatch( LER_tpContexto pContexto , uint64_t desde , LER_tpBloco * pBloco ) ;
+
+/***********************************************************************
+*
+*  $FC Função: LER  &Associar registro de voo
+*
+*  $ED Descrição da função
+*     A cada leitura com algum grupo novo, a amostra é acrescentada ao
+*     registro (REG_Escrever). O registro continua pertencendo ao
+*     chamador: desassociar com NULL antes de REG_Fechar (em
+*     LER_ModoThread, fechar só depois de LER_Terminar). Os valores
+*     gravados são os de saída, depois do filtro de cada campo; os campos
+*     com filtro ficam marcados no cabeçalho (REG_MarcarFiltrados).
+*
+*  $EP Parâmetros
+*    pReg  - Registro aberto com REG_Abrir, ou NULL para desassociar
+*
+*  $FV Valor retornado
+*     LER_CondRetOK ou LER_CondRetError se o contexto é
+*     LER_ModoSobDemanda, que não lê todos os tópicos a cada ciclo.
+*
+***********************************************************************/
+
+LER_tpCondRet LER_AssociarRegistro( LER_tpContexto pContexto , struct REG_registro * pReg ) ;
+
+/***********************************************************************
+*
+*  $FC Função: LER  &Associar avisos de mudança
+*
+*  $ED Descrição da função
+*     A cada leitura com algum grupo novo, quem faz o poll avalia o
+*     conjunto de condições (AVS_AVISOS, canal = LER_tpCampo) sobre os
+*     campos dos grupos novos e válidos, numa passada, já filtrados. Os
+*     assinantes esperam com AVS_Aguardar em vez de ler os getters a cada
+*     amostra. O conjunto continua pertencendo ao chamador.
+*
+*  $EP Parâmetros
+*    pAvisos  - Conjunto iniciado por AVS_Iniciar, ou NULL para desassociar
+*
+*  $FV Valor retornado
+*     LER_CondRetOK ou LER_CondRetError em LER_ModoSobDemanda, em que
+*     ninguém lê os campos que o consumidor não pediu.
+*
+***********************************************************************/
+
+LER_tpCondRet LER_AssociarAvisos( LER_tpContexto pContexto , struct AVS_conjunto * pAvisos ) ;
+
+/***********************************************************************
+*
+*  $FC Função: LER  &Iniciar região compartilhada
+*
+*  $ED Descrição da função
+*     Zera a região e grava a magia e o tamanho. Chamada só pelo
+*     processo que publica, antes de LER_AssociarCompartilhado.
+*
+***********************************************************************/
+
+void LER_IniciarCompartilhado( LER_tpCompartilhado * pRegiao ) ;
+
+/***********************************************************************
+*
+*  $FC Função: LER  &Associar região compartilhada
+*
+*  $ED Descrição da função
+*     A cada leitura com algum grupo novo, quem faz o poll (a thread em
+*     LER_ModoThread) publica o retrato na região. A região continua
+*     pertencendo ao chamador: desassociar com NULL antes de desmapeá-la.
+*
+*  $EP Parâmetros
+*    pRegiao  - Região iniciada, ou NULL para desassociar
+*
+*  $FV Valor retornado
+*     LER_CondRetOK ou LER_CondRetError se a região não foi iniciada ou
+*     o contexto é LER_ModoSobDemanda.
+*
+***********************************************************************/
+
+LER_tpCondRet LER_AssociarCompartilhado( LER_tpContexto pContexto , LER_tpCompartilhado * pRegiao ) ;
+
+/***********************************************************************
+*
+*  $FC Função: LER  &Número da publicação
+*
+*  $ED Descrição da função
+*     Uma leitura atômica, para descobrir se há retrato novo antes de
+*     copiá-lo.
+*
+*  $FV Valor retornado
+*     Número da última publicação completa (0 = nenhuma).
+*
+***********************************************************************/
+
+uint32_t LER_PublicacaoCompartilhado( const LER_tpCompartilhado * pRegiao ) ;
+
+/***********************************************************************
+*
+*  $FC Função: LER  &Ler retrato compartilhado
+*
+*  $ED Descrição da função
+*     Copia da região uma amostra consistente. Só repete se o escritor
+*     publicou no meio da cópia.
+*
+*  $EP Parâmetros
+*    pAmostra     - Recebe a amostra
+*    pOrigem      - Recebe o timestamp de cada grupo (o mesmo de
+*                   pAmostra->origem), ou NULL
+*    pPublicacao  - Recebe o número da publicação lida, ou NULL
+*
+*  $FV Valor retornado
+*     LER_CondRetOK ou LER_CondRetError se a região não foi iniciada
+*     por esta versão ou nada foi publicado ainda.
+*
+***********************************************************************/
+
+LER_tpCondRet LER_LerCompartilhado( const LER_tpCompartilhado * pRegiao , LER_tpAmostra * pAmostra ,
+                                    uint64_t pOrigem[ LER_NumGrupos ] , uint32_t * pPublicacao ) ;
+
+/***********************************************************************
+*
+*  $FC Função: LER  &Ler campo compartilhado
+*
+*  $ED Descrição da função
+*     Lê um campo e o timestamp do seu grupo diretamente da região, sem
+*     copiar o retrato, com a mesma garantia de LER_LerCompartilhado.
+*
+*  $FV Valor retornado
+*     LER_CondRetOK; LER_CondRetError como em LER_LerCompartilhado ou se
+*     o campo é inválido; a condição do grupo (LER_CondRetAttError, ...)
+*     se o grupo não tem dado válido.
+*
+***********************************************************************/
+
+LER_tpCondRet LER_LerCampoCompartilhado( const LER_tpCompartilhado * pRegiao , LER_tpCampo campo ,
+                                         float * pValor , uint64_t * pTimestamp , uint32_t * pPublicacao ) ;
+
+/***********************************************************************
+*
+*  $FC Função: LER  &Ativar captura em taxa plena
+*
+*  $ED Descrição da função
+*     Inicia uma captura (módulo CAP) de todas as publicações do
+*     sensor_combined, com assinatura e thread próprias: o intervalo e o
+*     poll set do contexto não mudam. A captura pertence ao contexto e é
+*     terminada por LER_Terminar.
+*
+*  $EP Parâmetros
+*    pConfig  - Configuração da captura; NULL equivale a CAP_ConfigPadrao
+*
+*  $FV Valor retornado
+*     LER_CondRetOK, ou LER_CondRetError se a captura já estava ativa ou
+*     não pôde ser iniciada.
+*
+***********************************************************************/
+
+LER_tpCondRet LER_AtivarCaptura( LER_tpContexto pContexto , const CAP_tpConfig * pConfig ) ;
+
+/***********************************************************************
+*
+*  $FC Função: LER  &Obter a captura em taxa plena
+*
+*  $FV Valor retornado
+*     A captura, para CAP_Ler, ou NULL se não foi ativada.
+*
+***********************************************************************/
+
+CAP_tpCaptura LER_ObterCaptura( LER_tpContexto pContexto ) ;
+
+/***********************************************************************
+*
+*  $FC Função: LER  &Ativar análise de vibração
+*
+*  $ED Descrição da função
+*     Associa ao contexto um analisador de espectro (módulo ESP),
+*     alimentado pelo fluxo bruto da captura em taxa plena. Exige
+*     LER_AtivarCaptura antes; a memória do analisador é alocada aqui,
+*     uma única vez.
+*
+*  $EP Parâmetros
+*    pConfig  - taxaHz deve ser a taxa da captura. NULL equivale a
+*               ESP_ConfigPadrao (250 Hz, como CAP_ConfigPadrao).
+*
+*  $FV Valor retornado
+*     LER_CondRetOK, ou LER_CondRetError se não há captura, a análise
+*     já estava ativa ou a configuração é inválida.
+*
+***********************************************************************/
+
+LER_tpCondRet LER_AtivarVibracao( LER_tpContexto pContexto , const ESP_tpConfig * pConfig ) ;
+
+/***********************************************************************
+*
+*  $FC Função: LER  &Obter espectro de vibração
+*
+*  $ED Descrição da função
+*     Passa ao analisador as amostras que a captura acumulou desde a
+*     última chamada (processando as janelas completas) e copia o
+*     resultado mais recente: picos, energia por banda, rms e PSD de
+*     cada eixo. Deve ser chamada com frequência suficiente para que o
+*     anel bruto da captura não dê a volta; amostras perdidas apenas
+*     reiniciam a janela.
+*
+*  $FV Valor retornado
+*     LER_CondRetOK, ou LER_CondRetError se a análise não está ativa ou
+*     ainda não completou o primeiro resultado.
+*
+***********************************************************************/
+
+LER_tpCondRet LER_ObterVibracao( LER_tpContexto pContexto , ESP_tpResultado * pResultado ) ;
+
+
+
+
+#endif
@@ -0,0 +1,1087 @@
+/***************************************************************************
+*  $MCI Módulo de implementação: REG Registro binário de voo
+*
+*  Arquivo gerado:              REG_REGISTRO.c
+*  Letras identificadoras:      REG
+*
+*
+*  Projeto: SAE AeroDesign Brasil 2014
+*  Gestor:  Alessandro Soares da Silva Junior
+*  Autores: Alessandro Soares da Silva Junior
+*
+*  Os valores são gravados na ordem de bytes da máquina; tanto o STM32
+*  quanto o host x86/ARM são little-endian.
+*
+***************************************************************************/
+
+#ifndef _STDLIB
+#define _STDLIB
+#include <stdlib.h>
+#endif
+
+#ifndef _STRING
+#define _STRING
+#include <string.h>
+#endif
+
+#ifndef _FCNTL
+#define _FCNTL
+#include <fcntl.h>
+#endif
+
+#ifndef _UNISTD
+#define _UNISTD
+#include <unistd.h>
+#endif
+
+#ifndef _PTHREAD
+#define _PTHREAD
+#include <pthread.h>
+#endif
+
+#include <drivers/drv_hrt.h>
+
+#ifndef __NuttX__
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#define REG_REGISTRO_OWN
+#include "REG_REGISTRO.h"
+#undef REG_REGISTRO_OWN
+
+#define TAM_CABECALHO   32
+#define TAM_REGISTRO_V1 ( 8 + 4 + 4 * LER_NumCampos )
+#define TAM_REGISTRO    ( TAM_REGISTRO_V1 + 4 * LER_NumGrupos )
+#define TAM_ENTRADA     16
+#define TAM_RODAPE      24
+#define VERSAO_V1       1                      /* Sem as idades das origens                 */
+#define VERSAO_CMP      2
+#define VERSAO          3
+
+static const char MAGICO_CABECALHO[ 8 ] = { 'A' , 'E' , 'R' , 'O' , 'L' , 'O' , 'G' , 0 } ;
+static const char MAGICO_RODAPE[ 4 ]    = { 'R' , 'I' , 'D' , 'X' } ;
+
+/***********************************************************************
+*
+*  $TC Tipo de dados: REG - Entrada do índice esparso
+*
+***********************************************************************/
+
+typedef struct {
+	uint64_t timestamp ;
+	uint64_t posicao   ;                       /* Número do registro                        */
+} tpEntrada ;
+
+/***********************************************************************
+*
+*  $TC Tipo de dados: REG - Registro aberto para escrita
+*
+***********************************************************************/
+
+typedef struct REG_registro {
+	int              fd                 ;
+	unsigned char    bloco[2][REG_TAM_BLOCO] ;
+	int              atual              ;      /* Bloco sendo preenchido pelo produtor      */
+	unsigned         usado              ;      /* Bytes ocupados no bloco atual             */
+
+	pthread_t        escritor           ;
+	pthread_mutex_t  mutex              ;
+	pthread_cond_t   cond               ;
+	int              pendente           ;      /* Bloco entregue à escritora, ou -1         */
+	int              encerrar           ;
+	int              erroEscrita        ;
+
+	tpEntrada        indice[REG_ENTRADAS_INDICE] ;
+	unsigned         numIndice          ;
+	unsigned         passo              ;      /* Registros entre entradas do índice        */
+
+	int              comprimido         ;      /* Versão 2: blocos CMP, sem índice          */
+	CMP_tpConfig     config             ;
+	CMP_tpCodificador cod               ;      /* Bloco CMP em construção em bloco[atual]   */
+
+	REG_tpEstatisticas est              ;
+} REG_registro ;
+
+/***********************************************************************
+*
+*  $TC Tipo de dados: REG - Registro aberto para leitura
+*
+***********************************************************************/
+
+typedef struct REG_leitor {
+	const unsigned char * base         ;
+	size_t                tamanho      ;
+	unsigned              tamRegistro  ;       /* TAM_REGISTRO ou TAM_REGISTRO_V1           */
+	uint64_t              numRegistros ;
+	uint32_t              filtrados    ;       /* Campos marcados no cabeçalho              */
+	const unsigned char * indice       ;       /* NULL se o arquivo não tem rodapé          */
+	unsigned              numIndice    ;
+
+	/* Registro comprimido */
+
+	int                   comprimido   ;
+	CMP_tpConfig          config       ;
+	uint64_t              numBlocos    ;       /* Blocos CMP, sem contar o de cabeçalho     */
+	LER_tpAmostra *       cache        ;       /* Amostras do último bloco decodificado     */
+	uint64_t              blocoCache   ;       /* numBlocos se nenhum                       */
+	uint64_t              primeiraCache ;
+	unsigned              numCache     ;
+} REG_leitor ;
+
+/***** Protótipos das funções encapuladas no módulo *****/
+
+	static REG_tpCondRet abrir              ( const char * caminho , const CMP_tpConfig * pConfig , REG_tpRegistro * ppReg ) ;
+	static REG_tpCondRet escreverComprimido ( REG_registro * pReg , const LER_tpAmostra * pAmostra )    ;
+	static void *        threadEscritora    ( void * arg )                                               ;
+	static int           escreverTudo       ( int fd , const void * dado , size_t tam )                  ;
+	static void          acrescentar        ( REG_registro * pReg , const unsigned char * dado , unsigned tam ) ;
+	static void          entregarBloco      ( REG_registro * pReg )                                      ;
+	static void          registrarIndice    ( REG_registro * pReg , uint64_t timestamp )                 ;
+
+#ifndef __NuttX__
+	static REG_tpCondRet cabecalhoBloco     ( REG_leitor * pLeitor , uint64_t bloco , unsigned * pNum ,
+	                                          uint64_t * pPrimeira , uint64_t * pTs )                    ;
+	static REG_tpCondRet carregarBloco      ( REG_leitor * pLeitor , uint64_t bloco )                    ;
+	static REG_tpCondRet buscarComprimido   ( REG_leitor * pLeitor , uint64_t instante , uint64_t * pPosicao ) ;
+	static REG_tpCondRet lerComprimido      ( REG_leitor * pLeitor , uint64_t posicao , LER_tpAmostra * pAmostra ) ;
+#endif
+
+/*****  Código das funções exportadas pelo módulo  *****/
+
+/***************************************************************************
+*
+*  Função: REG  &Abrir registro para escrita
+*  ****/
+
+	REG_tpCondRet REG_Abrir( const char * caminho , REG_tpRegistro * ppReg )
+	{
+		return abrir( caminho , NULL , ppReg ) ;
+	}
+
+/***************************************************************************
+*
+*  Função: REG  &Abrir registro comprimido para escrita
+*  ****/
+
+	REG_tpCondRet REG_AbrirComprimido( const char * caminho , const CMP_tpConfig * pConfig , REG_tpRegistro * ppReg )
+	{
+		CMP_tpConfig padrao ;
+
+		if ( pConfig == NULL )
+		{
+			CMP_ConfigPadrao( &padrao ) ;
+			pConfig = &padrao ;
+		}
+
+		return abrir( caminho , pConfig , ppReg ) ;
+	}
+
+/***************************************************************************
+*
+*  Função: REG  &Escrever amostra
+*  ****/
+
+	REG_tpCondRet REG_Escrever( REG_tpRegistro pReg , const LER_tpAmostra * pAmostra )
+	{
+		unsigned char reg[ TAM_REGISTRO ] ;
+		uint32_t grupos = ( pAmostra->validos & 0xFFFFu ) | ( pAmostra->novos << 16 ) ;
+		int g ;
+
+		if ( pReg->comprimido )
+		{
+			return escreverComprimido( pReg , pAmostra ) ;
+		}
+
+		/* Se o registro não cabe no bloco e a escritora ainda não devolveu o
+		   outro, não há onde colocá-lo sem esperar: descarta. */
+
+		if ( pReg->usado + TAM_REGISTRO > REG_TAM_BLOCO &&
+		     __atomic_load_n( &pReg->pendente , __ATOMIC_ACQUIRE ) != -1 )
+		{
+			pReg->est.descartados ++ ;
+			return REG_CondRetDescartado ;
+		}
+
+		memcpy( reg      , &pAmostra->timestamp , 8 ) ;
+		memcpy( reg + 8  , &grupos              , 4 ) ;
+		memcpy( reg + 12 , pAmostra->valor      , 4 * LER_NumCampos ) ;
+
+		for ( g = 0 ; g < LER_NumGrupos ; g++ )
+		{
+			uint64_t idade = pAmostra->timestamp - pAmostra->origem[ g ] ;
+			uint32_t gravada ;
+
+			if ( pAmostra->origem[ g ] == 0 )
+			{
+				gravada = REG_IDADE_SEM_ORIGEM ;
+			}
+			else if ( pAmostra->origem[ g ] > pAmostra->timestamp )
+			{
+				gravada = 0 ;
+			}
+			else
+			{
+				gravada = idade < REG_IDADE_SEM_ORIGEM ? ( uint32_t ) idade : REG_IDADE_SEM_ORIGEM - 1 ;
+			}
+
+			memcpy( reg + TAM_REGISTRO_V1 + 4 * g , &gravada , 4 ) ;
+		}
+
+		registrarIndice( pReg , pAmostra->timestamp ) ;
+
+		acrescentar( pReg , reg , TAM_REGISTRO ) ;
+
+		pReg->est.gravados ++ ;
+
+		return REG_CondRetOK ;
+	}
+
+/***************************************************************************
+*
+*  Função: REG  &Obter estatísticas de escrita
+*  ****/
+
+	void REG_ObterEstatisticas( REG_tpRegistro pReg , REG_tpEstatisticas * pEst )
+	{
+		*pEst = pReg->est ;
+		pEst->blocos = __atomic_load_n( &pReg->est.blocos , __ATOMIC_RELAXED ) ;
+	}
+
+/***************************************************************************
+*
+*  Função: REG  &Marcar campos filtrados
+*  ****/
+
+	void REG_MarcarFiltrados( REG_tpRegistro pReg , uint32_t campos )
+	{
+		pthread_mutex_lock( &pReg->mutex ) ;
+
+		while ( pReg->pendente != -1 )
+		{
+			pthread_cond_wait( &pReg->cond , &pReg->mutex ) ;
+		}
+
+		/* Com o mutex, nenhum bloco é entregue: se o primeiro ainda não foi
+		   escrito, o cabeçalho está em memória; senão, vai direto no arquivo
+		   (pwrite não mexe na posição dos acréscimos da escritora) */
+
+		if ( __atomic_load_n( &pReg->est.blocos , __ATOMIC_RELAXED ) == 0 )
+		{
+			memcpy( pReg->bloco[ 0 ] + 24 , &campos , 4 ) ;
+		}
+		else if ( pwrite( pReg->fd , &campos , 4 , 24 ) != 4 )
+		{
+			pReg->erroEscrita = 1 ;
+		}
+
+		pthread_mutex_unlock( &pReg->mutex ) ;
+	}
+
+/***************************************************************************
+*
+*  Função: REG  &Fechar registro
+*  ****/
+
+	REG_tpCondRet REG_Fechar( REG_tpRegistro pReg )
+	{
+		unsigned char rodape[ TAM_RODAPE ] ;
+		uint32_t numIndice = pReg->numIndice , passo = pReg->passo ;
+		REG_tpCondRet condRet = REG_CondRetOK ;
+		unsigned i ;
+
+		/* Espera a escritora esvaziar e a encerra */
+
+		pthread_mutex_lock( &pReg->mutex ) ;
+
+		while ( pReg->pendente != -1 )
+		{
+			pthread_cond_wait( &pReg->cond , &pReg->mutex ) ;
+		}
+
+		pReg->encerrar = 1 ;
+		pthread_cond_broadcast( &pReg->cond ) ;
+		pthread_mutex_unlock( &pReg->mutex ) ;
+
+		pthread_join( pReg->escritor , NULL ) ;
+
+		if ( pReg->comprimido )
+		{
+			pReg->usado = 0 ;
+
+			if ( CMP_NumAmostras( &pReg->cod ) > 0 )
+			{
+				CMP_FecharBloco( &pReg->cod ) ;
+				pReg->usado = REG_TAM_BLOCO ;
+			}
+		}
+
+		/* Bloco parcial, índice e rodapé: escritas únicas, fora do voo */
+
+		if ( escreverTudo( pReg->fd , pReg->bloco[ pReg->atual ] , pReg->usado ) != 0 )
+		{
+			condRet = REG_CondRetErroArquivo ;
+		}
+
+		for ( i = 0 ; i < pReg->numIndice ; i++ )
+		{
+			unsigned char ent[ TAM_ENTRADA ] ;
+
+			memcpy( ent     , &pReg->indice[ i ].timestamp , 8 ) ;
+			memcpy( ent + 8 , &pReg->indice[ i ].posicao   , 8 ) ;
+
+			if ( escreverTudo( pReg->fd , ent , TAM_ENTRADA ) != 0 )
+			{
+				condRet = REG_CondRetErroArquivo ;
+			}
+		}
+
+		memset( rodape , 0 , sizeof( rodape ) ) ;
+		memcpy( rodape      , &pReg->est.gravados , 8 ) ;
+		memcpy( rodape + 8  , &numIndice          , 4 ) ;
+		memcpy( rodape + 12 , &passo              , 4 ) ;
+		memcpy( rodape + 16 , MAGICO_RODAPE       , 4 ) ;
+
+		if ( escreverTudo( pReg->fd , rodape , TAM_RODAPE ) != 0 || pReg->erroEscrita )
+		{
+			condRet = REG_CondRetErroArquivo ;
+		}
+
+		if ( close( pReg->fd ) != 0 )
+		{
+			condRet = REG_CondRetErroArquivo ;
+		}
+
+		pthread_mutex_destroy( &pReg->mutex ) ;
+		pthread_cond_destroy( &pReg->cond ) ;
+		free( pReg ) ;
+
+		return condRet ;
+	}
+
+#ifndef __NuttX__
+
+/***************************************************************************
+*
+*  Função: REG  &Abrir registro para leitura
+*  ****/
+
+	REG_tpCondRet REG_AbrirLeitura( const char * caminho , REG_tpLeitor * ppLeitor )
+	{
+		REG_leitor * pLeitor ;
+		struct stat info ;
+		uint16_t versao , tamReg , numCampos ;
+		int fd ;
+
+		*ppLeitor = NULL ;
+
+		fd = open( caminho , O_RDONLY ) ;
+
+		if ( fd < 0 )
+		{
+			return REG_CondRetErroArquivo ;
+		}
+
+		pLeitor = ( REG_leitor * ) calloc( 1 , sizeof( REG_leitor ) ) ;
+
+		if ( pLeitor == NULL || fstat( fd , &info ) != 0 )
+		{
+			free( pLeitor ) ;
+			close( fd ) ;
+			return REG_CondRetErroArquivo ;
+		}
+
+		pLeitor->tamanho = ( size_t ) info.st_size ;
+
+		if ( pLeitor->tamanho < TAM_CABECALHO )
+		{
+			free( pLeitor ) ;
+			close( fd ) ;
+			return REG_CondRetFormato ;
+		}
+
+		pLeitor->base = mmap( NULL , pLeitor->tamanho , PROT_READ , MAP_SHARED , fd , 0 ) ;
+		close( fd ) ;
+
+		if ( pLeitor->base == MAP_FAILED )
+		{
+			free( pLeitor ) ;
+			return REG_CondRetErroArquivo ;
+		}
+
+		memcpy( &versao    , pLeitor->base + 8  , 2 ) ;
+		memcpy( &tamReg    , pLeitor->base + 10 , 2 ) ;
+		memcpy( &numCampos , pLeitor->base + 12 , 2 ) ;
+		memcpy( &pLeitor->filtrados , pLeitor->base + 24 , 4 ) ;
+
+		if ( memcmp( pLeitor->base , MAGICO_CABECALHO , 8 ) != 0 || numCampos != LER_NumCampos )
+		{
+			REG_FecharLeitura( pLeitor ) ;
+			return REG_CondRetFormato ;
+		}
+
+		if ( versao == VERSAO_CMP && tamReg == REG_TAM_BLOCO && pLeitor->tamanho >= REG_TAM_BLOCO )
+		{
+			unsigned num ;
+			uint64_t primeira , ts ;
+
+			pLeitor->comprimido = 1 ;
+			pLeitor->numBlocos  = pLeitor->tamanho / REG_TAM_BLOCO - 1 ;
+			pLeitor->blocoCache = pLeitor->numBlocos ;
+			pLeitor->cache      = ( LER_tpAmostra * ) malloc( CMP_MAX_AMOSTRAS( REG_TAM_BLOCO ) * sizeof( LER_tpAmostra ) ) ;
+
+			memcpy( pLeitor->config.resolucao , pLeitor->base + TAM_CABECALHO , sizeof( pLeitor->config.resolucao ) ) ;
+
+			if ( pLeitor->cache == NULL )
+			{
+				REG_FecharLeitura( pLeitor ) ;
+				return REG_CondRetErroArquivo ;
+			}
+
+			/* Blocos finais ilegíveis (escrita interrompida) são ignorados; o
+			   número de registros vem do cabeçalho do último bloco. */
+
+			while ( pLeitor->numBlocos > 0 &&
+			        cabecalhoBloco( pLeitor , pLeitor->numBlocos - 1 , &num , &primeira , &ts ) != REG_CondRetOK )
+			{
+				pLeitor->numBlocos -- ;
+			}
+
+			pLeitor->numRegistros = 0 ;
+
+			if ( pLeitor->numBlocos > 0 )
+			{
+				pLeitor->numRegistros = primeira + num ;
+			}
+
+			*ppLeitor = pLeitor ;
+
+			return REG_CondRetOK ;
+		}
+
+		if ( ! ( versao == VERSAO && tamReg == TAM_REGISTRO ) && ! ( versao == VERSAO_V1 && tamReg == TAM_REGISTRO_V1 ) )
+		{
+			REG_FecharLeitura( pLeitor ) ;
+			return REG_CondRetFormato ;
+		}
+
+		pLeitor->tamRegistro = tamReg ;
+
+		/* Com rodapé: número de registros e índice vêm dele. Sem rodapé (o
+		   arquivo não foi fechado), vale o que couber de registros inteiros. */
+
+		pLeitor->numRegistros = ( pLeitor->tamanho - TAM_CABECALHO ) / tamReg ;
+
+		if ( pLeitor->tamanho >= TAM_CABECALHO + TAM_RODAPE &&
+		     memcmp( pLeitor->base + pLeitor->tamanho - TAM_RODAPE + 16 , MAGICO_RODAPE , 4 ) == 0 )
+		{
+			const unsigned char * rodape = pLeitor->base + pLeitor->tamanho - TAM_RODAPE ;
+			uint64_t numRegistros ;
+			uint32_t numIndice ;
+
+			memcpy( &numRegistros , rodape     , 8 ) ;
+			memcpy( &numIndice    , rodape + 8 , 4 ) ;
+
+			if ( TAM_CABECALHO + numRegistros * tamReg + ( uint64_t ) numIndice * TAM_ENTRADA + TAM_RODAPE
+			     == pLeitor->tamanho )
+			{
+				pLeitor->numRegistros = numRegistros ;
+				pLeitor->numIndice    = numIndice    ;
+				pLeitor->indice       = pLeitor->base + TAM_CABECALHO + numRegistros * tamReg ;
+			}
+		}
+
+		*ppLeitor = pLeitor ;
+
+		return REG_CondRetOK ;
+	}
+
+/***************************************************************************
+*
+*  Função: REG  &Número de registros
+*  ****/
+
+	uint64_t REG_NumRegistros( REG_tpLeitor pLeitor )
+	{
+		return pLeitor->numRegistros ;
+	}
+
+/***************************************************************************
+*
+*  Função: REG  &Campos filtrados
+*  ****/
+
+	uint32_t REG_CamposFiltrados( REG_tpLeitor pLeitor )
+	{
+		return pLeitor->filtrados ;
+	}
+
+/***************************************************************************
+*
+*  Função: REG  &Buscar instante
+*  ****/
+
+	REG_tpCondRet REG_Buscar( REG_tpLeitor pLeitor , uint64_t instante , uint64_t * pPosicao )
+	{
+		uint64_t baixo = 0 , alto = pLeitor->numRegistros ;
+
+		if ( pLeitor->comprimido )
+		{
+			return buscarComprimido( pLeitor , instante , pPosicao ) ;
+		}
+
+		/* 1) Índice: última entrada com timestamp < instante limita o trecho */
+
+		if ( pLeitor->indice != NULL && pLeitor->numIndice > 0 )
+		{
+			unsigned b = 0 , a = pLeitor->numIndice ;
+
+			while ( b != a )
+			{
+				unsigned meio = b + ( a - b ) / 2 ;
+				uint64_t ts ;
+
+				memcpy( &ts , pLeitor->indice + ( size_t ) meio * TAM_ENTRADA , 8 ) ;
+
+				if ( ts < instante )
+				{
+					b = meio + 1 ;
+				}
+				else
+				{
+					a = meio ;
+				}
+			}
+
+			if ( b > 0 )
+			{
+				memcpy( &baixo , pLeitor->indice + ( size_t ) ( b - 1 ) * TAM_ENTRADA + 8 , 8 ) ;
+			}
+
+			if ( b < pLeitor->numIndice )
+			{
+				memcpy( &alto , pLeitor->indice + ( size_t ) b * TAM_ENTRADA + 8 , 8 ) ;
+				alto ++ ;
+			}
+		}
+
+		/* 2) Busca binária nos registros do trecho */
+
+		while ( baixo != alto )
+		{
+			uint64_t meio = baixo + ( alto - baixo ) / 2 ;
+			uint64_t ts ;
+
+			memcpy( &ts , pLeitor->base + TAM_CABECALHO + meio * pLeitor->tamRegistro , 8 ) ;
+
+			if ( ts < instante )
+			{
+				baixo = meio + 1 ;
+			}
+			else
+			{
+				alto = meio ;
+			}
+		}
+
+		if ( baixo >= pLeitor->numRegistros )
+		{
+			return REG_CondRetFim ;
+		}
+
+		*pPosicao = baixo ;
+
+		return REG_CondRetOK ;
+	}
+
+/***************************************************************************
+*
+*  Função: REG  &Ler registro
+*  ****/
+
+	REG_tpCondRet REG_Ler( REG_tpLeitor pLeitor , uint64_t posicao , LER_tpAmostra * pAmostra )
+	{
+		const unsigned char * reg ;
+		uint32_t grupos ;
+		int g ;
+
+		if ( posicao >= pLeitor->numRegistros )
+		{
+			return REG_CondRetFim ;
+		}
+
+		if ( pLeitor->comprimido )
+		{
+			return lerComprimido( pLeitor , posicao , pAmostra ) ;
+		}
+
+		reg = pLeitor->base + TAM_CABECALHO + posicao * pLeitor->tamRegistro ;
+
+		memcpy( &pAmostra->timestamp , reg      , 8 ) ;
+		memcpy( &grupos              , reg + 8  , 4 ) ;
+		memcpy( pAmostra->valor      , reg + 12 , 4 * LER_NumCampos ) ;
+
+		pAmostra->validos = grupos & 0xFFFFu ;
+		pAmostra->novos   = grupos >> 16 ;
+
+		for ( g = 0 ; g < LER_NumGrupos ; g++ )
+		{
+			uint32_t idade = 0 ;
+
+			if ( pLeitor->tamRegistro == TAM_REGISTRO )
+			{
+				memcpy( &idade , reg + TAM_REGISTRO_V1 + 4 * g , 4 ) ;
+			}
+
+			pAmostra->origem[ g ] = idade == REG_IDADE_SEM_ORIGEM ? 0 : pAmostra->timestamp - idade ;
+		}
+
+		return REG_CondRetOK ;
+	}
+
+/***************************************************************************
+*
+*  Função: REG  &Fechar leitor
+*  ****/
+
+	void REG_FecharLeitura( REG_tpLeitor pLeitor )
+	{
+		if ( pLeitor == NULL )
+		{
+			return ;
+		}
+
+		munmap( ( void * ) pLeitor->base , pLeitor->tamanho ) ;
+		free( pLeitor->cache ) ;
+		free( pLeitor ) ;
+	}
+
+#endif /* __NuttX__ */
+
+/*****  Código das funções encapsuladas no módulo  *****/
+
+	/***************************************************************************
+	*
+	*  Função: REG  & Abrir registro, bruto (pConfig NULL) ou comprimido
+	*  ****/
+
+	static REG_tpCondRet abrir( const char * caminho , const CMP_tpConfig * pConfig , REG_tpRegistro * ppReg )
+	{
+		REG_registro * pReg ;
+		unsigned char * cab ;
+		uint16_t versao = VERSAO , tamReg = TAM_REGISTRO , numCampos = LER_NumCampos ;
+		uint64_t abertura = hrt_absolute_time( ) ;
+
+		*ppReg = NULL ;
+
+		pReg = ( REG_registro * ) calloc( 1 , sizeof( REG_registro ) ) ;
+
+		if ( pReg == NULL )
+		{
+			return REG_CondRetErroArquivo ;
+		}
+
+		pReg->fd = open( caminho , O_WRONLY | O_CREAT | O_TRUNC , 0644 ) ;
+
+		if ( pReg->fd < 0 )
+		{
+			free( pReg ) ;
+			return REG_CondRetErroArquivo ;
+		}
+
+		pReg->pendente = -1 ;
+		pReg->passo    = 1  ;
+
+		pthread_mutex_init( &pReg->mutex , NULL ) ;
+		pthread_cond_init( &pReg->cond , NULL ) ;
+
+		if ( pthread_create( &pReg->escritor , NULL , threadEscritora , pReg ) != 0 )
+		{
+			close( pReg->fd ) ;
+			free( pReg ) ;
+			return REG_CondRetErroArquivo ;
+		}
+
+		if ( pConfig != NULL )
+		{
+			pReg->comprimido = 1 ;
+			pReg->config     = *pConfig ;
+			versao           = VERSAO_CMP ;
+			tamReg           = REG_TAM_BLOCO ;
+		}
+
+		/* O cabeçalho entra no fluxo de blocos: todas as escritas ficam
+		   alinhadas. O bloco recém-alocado já está zerado. */
+
+		cab = pReg->bloco[ pReg->atual ] ;
+
+		memcpy( cab      , MAGICO_CABECALHO , 8 ) ;
+		memcpy( cab + 8  , &versao          , 2 ) ;
+		memcpy( cab + 10 , &tamReg          , 2 ) ;
+		memcpy( cab + 12 , &numCampos       , 2 ) ;
+		memcpy( cab + 16 , &abertura        , 8 ) ;
+
+		pReg->usado = TAM_CABECALHO ;
+
+		if ( pReg->comprimido )
+		{
+			/* Cabeçalho e resoluções ocupam o primeiro bloco inteiro */
+
+			memcpy( cab + TAM_CABECALHO , pConfig->resolucao , sizeof( pConfig->resolucao ) ) ;
+			entregarBloco( pReg ) ;
+
+			CMP_IniciarBloco( &pReg->cod , &pReg->config , pReg->bloco[ pReg->atual ] , REG_TAM_BLOCO , 0 ) ;
+		}
+
+		*ppReg = pReg ;
+
+		return REG_CondRetOK ;
+	}
+
+	/***************************************************************************
+	*
+	*  Função: REG  & Copiar bytes para o bloco atual, trocando de bloco
+	*                 quando ele enche
+	*
+	*  O chamador garante que o outro bloco está livre se a troca for
+	*  necessária.
+	*  ****/
+
+	static void acrescentar( REG_registro * pReg , const unsigned char * dado , unsigned tam )
+	{
+		while ( tam > 0 )
+		{
+			unsigned livre = REG_TAM_BLOCO - pReg->usado ;
+			unsigned n     = tam < livre ? tam : livre ;
+
+			memcpy( pReg->bloco[ pReg->atual ] + pReg->usado , dado , n ) ;
+			pReg->usado += n ;
+			dado        += n ;
+			tam         -= n ;
+
+			if ( pReg->usado == REG_TAM_BLOCO )
+			{
+				entregarBloco( pReg ) ;
+			}
+		}
+	}
+
+	/***************************************************************************
+	*
+	*  Função: REG  & Entregar o bloco atual à thread escritora e passar
+	*                 para o outro
+	*  ****/
+
+	static void entregarBloco( REG_registro * pReg )
+	{
+		pthread_mutex_lock( &pReg->mutex ) ;
+		pReg->pendente = pReg->atual ;
+		pthread_cond_signal( &pReg->cond ) ;
+		pthread_mutex_unlock( &pReg->mutex ) ;
+
+		pReg->atual = 1 - pReg->atual ;
+		pReg->usado = 0 ;
+	}
+
+	/***************************************************************************
+	*
+	*  Função: REG  & Acrescentar amostra a um registro comprimido
+	*
+	*  Com o bloco CMP cheio, ele é fechado e entregue; se a escritora ainda
+	*  estiver com o anterior, a amostra é descartada e o bloco continua
+	*  cheio até a próxima tentativa.
+	*  ****/
+
+	static REG_tpCondRet escreverComprimido( REG_registro * pReg , const LER_tpAmostra * pAmostra )
+	{
+		if ( CMP_Acrescentar( &pReg->cod , pAmostra ) == CMP_CondRetCheio )
+		{
+			if ( __atomic_load_n( &pReg->pendente , __ATOMIC_ACQUIRE ) != -1 )
+			{
+				pReg->est.descartados ++ ;
+				return REG_CondRetDescartado ;
+			}
+
+			CMP_FecharBloco( &pReg->cod ) ;
+			entregarBloco( pReg ) ;
+
+			CMP_IniciarBloco( &pReg->cod , &pReg->config , pReg->bloco[ pReg->atual ] ,
+			                  REG_TAM_BLOCO , pReg->est.gravados ) ;
+			CMP_Acrescentar( &pReg->cod , pAmostra ) ;
+		}
+
+		pReg->est.gravados ++ ;
+
+		return REG_CondRetOK ;
+	}
+
+	/***************************************************************************
+	*
+	*  Função: REG  & Registrar a próxima posição no índice esparso
+	*
+	*  Com o índice cheio, fica uma entrada a cada duas e o passo dobra:
+	*  a memória é fixa e a densidade se ajusta ao tamanho do voo.
+	*  ****/
+
+	static void registrarIndice( REG_registro * pReg , uint64_t timestamp )
+	{
+		uint64_t posicao = pReg->est.gravados ;
+		unsigned i ;
+
+		if ( posicao % pReg->passo != 0 )
+		{
+			return ;
+		}
+
+		if ( pReg->numIndice == REG_ENTRADAS_INDICE )
+		{
+			for ( i = 0 ; i < REG_ENTRADAS_INDICE / 2 ; i++ )
+			{
+				pReg->indice[ i ] = pReg->indice[ 2 * i ] ;
+			}
+
+			pReg->numIndice = REG_ENTRADAS_INDICE / 2 ;
+			pReg->passo    *= 2 ;
+
+			if ( posicao % pReg->passo != 0 )
+			{
+				return ;
+			}
+		}
+
+		pReg->indice[ pReg->numIndice ].timestamp = timestamp ;
+		pReg->indice[ pReg->numIndice ].posicao   = posicao   ;
+		pReg->numIndice ++ ;
+	}
+
+	/***************************************************************************
+	*
+	*  Função: REG  & Thread escritora: grava cada bloco entregue
+	*  ****/
+
+	static void * threadEscritora( void * arg )
+	{
+		REG_registro * pReg = ( REG_registro * ) arg ;
+
+		pthread_mutex_lock( &pReg->mutex ) ;
+
+		for ( ;; )
+		{
+			while ( pReg->pendente == -1 && ! pReg->encerrar )
+			{
+				pthread_cond_wait( &pReg->cond , &pReg->mutex ) ;
+			}
+
+			if ( pReg->pendente == -1 )
+			{
+				break ;
+			}
+
+			pthread_mutex_unlock( &pReg->mutex ) ;
+
+			if ( escreverTudo( pReg->fd , pReg->bloco[ pReg->pendente ] , REG_TAM_BLOCO ) != 0 )
+			{
+				pReg->erroEscrita = 1 ;
+			}
+
+			__atomic_add_fetch( &pReg->est.blocos , 1 , __ATOMIC_RELAXED ) ;
+
+			pthread_mutex_lock( &pReg->mutex ) ;
+			__atomic_store_n( &pReg->pendente , -1 , __ATOMIC_RELEASE ) ;
+			pthread_cond_broadcast( &pReg->cond ) ;
+		}
+
+		pthread_mutex_unlock( &pReg->mutex ) ;
+
+		return NULL ;
+	}
+
+	/***************************************************************************
+	*
+	*  Função: REG  & write() repetido até gravar tudo
+	*  ****/
+
+	static int escreverTudo( int fd , const void * dado , size_t tam )
+	{
+		const unsigned char * p = ( const unsigned char * ) dado ;
+
+		while ( tam > 0 )
+		{
+			ssize_t n = write( fd , p , tam ) ;
+
+			if ( n <= 0 )
+			{
+				return -1 ;
+			}
+
+			p   += n ;
+			tam -= ( size_t ) n ;
+		}
+
+		return 0 ;
+	}
+
+#ifndef __NuttX__
+
+	/***************************************************************************
+	*
+	*  Função: REG  & Ler o cabeçalho do bloco CMP de número 'bloco'
+	*  ****/
+
+	static REG_tpCondRet cabecalhoBloco( REG_leitor * pLeitor , uint64_t bloco , unsigned * pNum ,
+	                                     uint64_t * pPrimeira , uint64_t * pTs )
+	{
+		const unsigned char * p = pLeitor->base + ( bloco + 1 ) * REG_TAM_BLOCO ;
+
+		if ( CMP_LerCabecalho( p , REG_TAM_BLOCO , pNum , pPrimeira , pTs ) != CMP_CondRetOK || *pNum == 0 )
+		{
+			return REG_CondRetFormato ;
+		}
+
+		return REG_CondRetOK ;
+	}
+
+	/***************************************************************************
+	*
+	*  Função: REG  & Decodificar um bloco CMP para o cache do leitor
+	*  ****/
+
+	static REG_tpCondRet carregarBloco( REG_leitor * pLeitor , uint64_t bloco )
+	{
+		const unsigned char * p = pLeitor->base + ( bloco + 1 ) * REG_TAM_BLOCO ;
+		unsigned num ;
+		uint64_t ts ;
+
+		if ( pLeitor->blocoCache == bloco )
+		{
+			return REG_CondRetOK ;
+		}
+
+		pLeitor->blocoCache = pLeitor->numBlocos ;
+
+		if ( cabecalhoBloco( pLeitor , bloco , &num , &pLeitor->primeiraCache , &ts ) != REG_CondRetOK ||
+		     CMP_DecodificarBloco( &pLeitor->config , p , REG_TAM_BLOCO , pLeitor->cache ,
+		                           CMP_MAX_AMOSTRAS( REG_TAM_BLOCO ) , &pLeitor->numCache ) != CMP_CondRetOK )
+		{
+			return REG_CondRetFormato ;
+		}
+
+		pLeitor->blocoCache = bloco ;
+
+		return REG_CondRetOK ;
+	}
+
+	/***************************************************************************
+	*
+	*  Função: REG  & Buscar instante num registro comprimido
+	*
+	*  Busca binária nos timestamps dos cabeçalhos dos blocos; só o bloco
+	*  anterior ao primeiro com timestamp >= instante é decodificado.
+	*  ****/
+
+	static REG_tpCondRet buscarComprimido( REG_leitor * pLeitor , uint64_t instante , uint64_t * pPosicao )
+	{
+		uint64_t baixo = 0 , alto = pLeitor->numBlocos ;
+		uint64_t primeira , ts ;
+		unsigned num , i ;
+
+		while ( baixo != alto )
+		{
+			uint64_t meio = baixo + ( alto - baixo ) / 2 ;
+
+			if ( cabecalhoBloco( pLeitor , meio , &num , &primeira , &ts ) != REG_CondRetOK )
+			{
+				return REG_CondRetFormato ;
+			}
+
+			if ( ts < instante )
+			{
+				baixo = meio + 1 ;
+			}
+			else
+			{
+				alto = meio ;
+			}
+		}
+
+		if ( baixo > 0 )
+		{
+			if ( carregarBloco( pLeitor , baixo - 1 ) != REG_CondRetOK )
+			{
+				return REG_CondRetFormato ;
+			}
+
+			for ( i = 0 ; i < pLeitor->numCache ; i++ )
+			{
+				if ( pLeitor->cache[ i ].timestamp >= instante )
+				{
+					*pPosicao = pLeitor->primeiraCache + i ;
+					return REG_CondRetOK ;
+				}
+			}
+		}
+
+		if ( baixo >= pLeitor->numBlocos )
+		{
+			return REG_CondRetFim ;
+		}
+
+		cabecalhoBloco( pLeitor , baixo , &num , pPosicao , &ts ) ;
+
+		return REG_CondRetOK ;
+	}
+
+	/***************************************************************************
+	*
+	*  Função: REG  & Ler registro de um registro comprimido
+	*  ****/
+
+	static REG_tpCondRet lerComprimido( REG_leitor * pLeitor , uint64_t posicao , LER_tpAmostra * pAmostra )
+	{
+		uint64_t baixo = 0 , alto = pLeitor->numBlocos ;
+		uint64_t primeira , ts ;
+		unsigned num ;
+
+		/* Caminho comum: leitura sequencial dentro do bloco em cache */
+
+		if ( pLeitor->blocoCache == pLeitor->numBlocos ||
+		     posicao < pLeitor->primeiraCache || posicao - pLeitor->primeiraCache >= pLeitor->numCache )
+		{
+			/* Último bloco cuja primeira amostra é <= posicao */
+
+			while ( alto - baixo > 1 )
+			{
+				uint64_t meio = baixo + ( alto - baixo ) / 2 ;
+
+				if ( cabecalhoBloco( pLeitor , meio , &num , &primeira , &ts ) != REG_CondRetOK )
+				{
+					return REG_CondRetFormato ;
+				}
+
+				if ( primeira <= posicao )
+				{
+					baixo = meio ;
+				}
+				else
+				{
+					alto = meio ;
+				}
+			}
+
+			if ( carregarBloco( pLeitor , baixo ) != REG_CondRetOK )
+			{
+				return REG_CondRetFormato ;
+			}
+
+			if ( posicao < pLeitor->primeiraCache || posicao - pLeitor->primeiraCache >= pLeitor->numCache )
+			{
+				return REG_CondRetFim ;
+			}
+		}
+
+		*pAmostra = pLeitor->cache[ posicao - pLeitor->primeiraCache ] ;
+
+		return REG_CondRetOK ;
+	}
+
+#endif /* __NuttX__ */
@@ -0,0 +1,259 @@
+#ifndef REG_REGISTRO
+#define REG_REGISTRO
+
+/**************************************************************************************************************************
+*$MCD Módulo de definição
+*	  Nome : 	                Registro binário de voo
+*	  Proprietário :         	Equipe AeroRio
+*	  Projeto :		            SAE AeroDesign Brasil 2014
+*	  Gestor :	 	            Alessandro Soares da Silva Junior
+* 	  Arquivo : 	            REG_REGISTRO.H
+*	  Letras Identificadoras : 	REG
+*	  Autor : 	                Alessandro Soares da Silva Junior
+*
+*$ED Descrição do módulo
+*	Grava as amostras do módulo LER num arquivo binário só de acréscimo, com registros de tamanho fixo, e permite
+*   ler esse arquivo buscando diretamente qualquer instante do voo.
+*
+*   Formato do arquivo (little-endian):
+*
+*   	cabeçalho   32 bytes   "AEROLOG", versão, tamanho do registro (do bloco na versão 2), número de campos,
+*   	                       instante de abertura (u64), campos filtrados pelo LER (u32, bit = LER_tpCampo)
+*   	registros   76 bytes   timestamp (u64), grupos válidos | grupos novos << 16 (u32), LER_NumCampos floats,
+*   	                       LER_NumGrupos idades da origem (u32, timestamp - origem; REG_IDADE_SEM_ORIGEM se o
+*   	                       grupo nunca chegou)
+*   	índice      16 bytes   timestamp (u64), número do registro (u64) -- uma entrada a cada 'passo' registros
+*   	rodapé      24 bytes   número de registros (u64), entradas do índice (u32), passo (u32), "RIDX", reservado
+*
+*   Escrita: o caminho quente só copia o registro para um bloco em memória. Blocos cheios (REG_TAM_BLOCO bytes,
+*   sempre escritos inteiros e alinhados) são entregues a uma thread escritora enquanto o próximo é preenchido; se
+*   ela ainda estiver ocupada com o bloco anterior, o registro é descartado e contado, nunca bloqueia. O índice
+*   esparso fica em memória de tamanho fixo: quando enche, metade das entradas é descartada e o passo dobra.
+*
+*   A versão 1 tinha registros de 56 bytes, sem as idades; os leitores ainda a aceitam e dão a cada grupo a origem
+*   igual ao timestamp do registro. Idades acima de REG_IDADE_SEM_ORIGEM - 1 (mais de uma hora) são saturadas, e
+*   uma origem posterior ao timestamp é gravada com idade 0.
+*
+*   Registro comprimido (REG_AbrirComprimido, versão 2): o primeiro bloco de REG_TAM_BLOCO bytes contém o cabeçalho
+*   seguido das LER_NumCampos resoluções de quantização (floats); cada bloco seguinte é um bloco CMP completo e
+*   independente; o rodapé vem logo depois, sem índice (a busca usa o cabeçalho de cada bloco, que fica numa
+*   posição fixa do arquivo).
+*
+*   Leitura (apenas no host): o arquivo é mapeado com mmap; a busca por instante é binária no índice e depois
+*   dentro do trecho de registros apontado por ele. Um arquivo sem rodapé (queda de energia) continua legível,
+*   com a busca binária feita direto sobre os registros.
+*
+***************************************************************************************************************************/
+
+#include "LER_PARAMETROS.h"
+#include "CMP_COMPRESSAO.h"
+
+/***** Declarações exportadas pelo módulo *****/
+
+#define REG_TAM_BLOCO        4096    /* Bytes por escrita no cartão                 */
+#define REG_ENTRADAS_INDICE  512     /* Capacidade do índice esparso em memória     */
+#define REG_IDADE_SEM_ORIGEM 0xFFFFFFFFu   /* Idade gravada para origem 0           */
+
+/* Tipo referência para um registro aberto para escrita */
+
+typedef struct REG_registro * REG_tpRegistro ;
+
+/* Tipo referência para um registro aberto para leitura */
+
+typedef struct REG_leitor * REG_tpLeitor ;
+
+/***********************************************************************
+*
+*  $TC Tipo de dados: REG Condições de retorno
+*
+***********************************************************************/
+
+   typedef enum {
+
+         REG_CondRetOK            ,
+              /* Executou corretamente                               */
+         REG_CondRetErroArquivo   ,
+              /* Falha ao abrir, escrever ou mapear o arquivo        */
+         REG_CondRetFormato       ,
+              /* O arquivo não é um registro de voo válido           */
+         REG_CondRetDescartado    ,
+              /* Registro descartado: thread escritora atrasada      */
+         REG_CondRetFim           ,
+              /* Não há registro na posição ou instante pedido       */
+
+} REG_tpCondRet ;
+
+/***********************************************************************
+*
+*  $TC Tipo de dados: REG Estatísticas de escrita
+*
+***********************************************************************/
+
+   typedef struct {
+
+         uint64_t gravados    ;
+              /* Registros aceitos                              */
+         uint64_t descartados ;
+              /* Registros perdidos por atraso da escrita       */
+         uint64_t blocos      ;
+              /* Blocos escritos no arquivo                     */
+
+} REG_tpEstatisticas ;
+
+/***********************************************************************
+*
+*  $FC Função: REG  &Abrir registro para escrita
+*
+*  $ED Descrição da função
+*     Cria (ou trunca) o arquivo, aloca os dois blocos e o índice e
+*     dispara a thread escritora.
+*
+*  $EP Parâmetros
+*    caminho   - Arquivo a criar (ex.: /fs/microsd/voo.bin)
+*    ppReg     - Recebe o registro aberto
+*
+***********************************************************************/
+
+REG_tpCondRet REG_Abrir( const char * caminho , REG_tpRegistro * ppReg ) ;
+
+/***********************************************************************
+*
+*  $FC Função: REG  &Abrir registro comprimido para escrita
+*
+*  $ED Descrição da função
+*     Como REG_Abrir, mas as amostras são quantizadas e codificadas em
+*     blocos CMP. Os leitores reconhecem o formato sozinhos.
+*
+*  $EP Parâmetros
+*    pConfig   - Resoluções de quantização; NULL usa CMP_ConfigPadrao
+*
+***********************************************************************/
+
+REG_tpCondRet REG_AbrirComprimido( const char * caminho , const CMP_tpConfig * pConfig , REG_tpRegistro * ppReg ) ;
+
+/***********************************************************************
+*
+*  $FC Função: REG  &Escrever amostra
+*
+*  $ED Descrição da função
+*     Acrescenta uma amostra. Só copia para memória, exceto na troca de
+*     bloco, que apenas sinaliza a thread escritora. Um único produtor.
+*
+*  $FV Valor retornado
+*     REG_CondRetOK ou REG_CondRetDescartado.
+*
+***********************************************************************/
+
+REG_tpCondRet REG_Escrever( REG_tpRegistro pReg , const LER_tpAmostra * pAmostra ) ;
+
+/***********************************************************************
+*
+*  $FC Função: REG  &Obter estatísticas de escrita
+*
+***********************************************************************/
+
+void REG_ObterEstatisticas( REG_tpRegistro pReg , REG_tpEstatisticas * pEst ) ;
+
+/***********************************************************************
+*
+*  $FC Função: REG  &Marcar campos filtrados
+*
+*  $ED Descrição da função
+*     Grava no cabeçalho quais campos chegam depois do filtro do LER
+*     (LER_AssociarRegistro chama), para que uma reprodução não os
+*     filtre de novo. Pode esperar a escritora terminar o bloco em curso;
+*     não chamar do caminho quente.
+*
+*  $EP Parâmetros
+*    campos  - Bit ( 1 << LER_tpCampo ) de cada campo filtrado
+*
+***********************************************************************/
+
+void REG_MarcarFiltrados( REG_tpRegistro pReg , uint32_t campos ) ;
+
+/***********************************************************************
+*
+*  $FC Função: REG  &Fechar registro
+*
+*  $ED Descrição da função
+*     Grava o bloco parcial, o índice e o rodapé, encerra a thread
+*     escritora e libera o registro.
+*
+***********************************************************************/
+
+REG_tpCondRet REG_Fechar( REG_tpRegistro pReg ) ;
+
+/***********************************************************************
+*
+*  $FC Função: REG  &Abrir registro para leitura
+*
+*  $ED Descrição da função
+*     Mapeia o arquivo em memória. Disponível apenas fora do NuttX.
+*
+***********************************************************************/
+
+REG_tpCondRet REG_AbrirLeitura( const char * caminho , REG_tpLeitor * ppLeitor ) ;
+
+/***********************************************************************
+*
+*  $FC Função: REG  &Número de registros
+*
+***********************************************************************/
+
+uint64_t REG_NumRegistros( REG_tpLeitor pLeitor ) ;
+
+/***********************************************************************
+*
+*  $FC Função: REG  &Campos filtrados
+*
+*  $FV Valor retornado
+*     Os campos marcados por REG_MarcarFiltrados; zero em arquivos
+*     gravados sem marca.
+*
+***********************************************************************/
+
+uint32_t REG_CamposFiltrados( REG_tpLeitor pLeitor ) ;
+
+/***********************************************************************
+*
+*  $FC Função: REG  &Buscar instante
+*
+*  $ED Descrição da função
+*     Encontra o primeiro registro com timestamp maior ou igual a
+*     'instante', sem varrer o arquivo.
+*
+*  $EP Parâmetros
+*    pPosicao  - Recebe o número do registro
+*
+*  $FV Valor retornado
+*     REG_CondRetOK ou REG_CondRetFim se todos são anteriores.
+*
+***********************************************************************/
+
+REG_tpCondRet REG_Buscar( REG_tpLeitor pLeitor , uint64_t instante , uint64_t * pPosicao ) ;
+
+/***********************************************************************
+*
+*  $FC Função: REG  &Ler registro
+*
+*  $ED Descrição da função
+*     Num registro comprimido, decodifica o bloco da posição pedida e o
+*     mantém em cache: a leitura sequencial decodifica cada bloco uma vez.
+*
+*  $EP Parâmetros
+*    posicao   - Número do registro (0 .. REG_NumRegistros - 1)
+*    pAmostra  - Recebe a amostra
+*
+***********************************************************************/
+
+REG_tpCondRet REG_Ler( REG_tpLeitor pLeitor , uint64_t posicao , LER_tpAmostra * pAmostra ) ;
+
+/***********************************************************************
+*
+*  $FC Função: REG  &Fechar leitor
+*
+***********************************************************************/
+
+void REG_FecharLeitura( REG_tpLeitor pLeitor ) ;
+
+#endif
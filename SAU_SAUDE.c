@@ -0,0 +1,334 @@
+/***************************************************************************
+*  $MCI Módulo de implementação: SAU Saúde dos sensores em voo
+*
+*  Arquivo gerado:              SAU_SAUDE.c
+*  Letras identificadoras:      SAU
+*
+*
+*  Projeto: SAE AeroDesign Brasil 2014
+*  Gestor:  Alessandro Soares da Silva Junior
+*  Autores: Alessandro Soares da Silva Junior
+*
+*
+***************************************************************************/
+
+#ifndef _STRING
+#define _STRING
+#include <string.h>
+#endif
+
+#ifndef _MATH
+#define _MATH
+#include <math.h>
+#endif
+
+#define SAU_SAUDE_OWN
+#include "SAU_SAUDE.h"
+#undef SAU_SAUDE_OWN
+
+#define SAU_PESO_PERIODO  0.125f            /* Média exponencial do período da fonte */
+
+/* Escrita com um único produtor: leitores veem o valor antigo ou o novo */
+
+#define PUBLICAR( x , v )  __atomic_store_n( &( x ) , ( v ) , __ATOMIC_RELAXED )
+
+/***** Protótipos das funções encapuladas no módulo *****/
+
+	static void publicarFloat ( float * pDestino , float valor )   ;
+	static float lerFloat     ( const float * pOrigem )             ;
+
+/*****  Código das funções exportadas pelo módulo  *****/
+
+/***************************************************************************
+*
+*  Função: SAU  &Configuração padrão
+*  ****/
+
+	void SAU_ConfigPadrao( SAU_tpConfig * pConfig )
+	{
+		pConfig->tauS             = 2.0f  ;
+		pConfig->aquecimento      = 20    ;
+		pConfig->limiarSigma      = 6.0f  ;
+		pConfig->atipicasSeguidas = 8     ;
+		pConfig->fracaoAtipicas   = 0.02f ;
+		pConfig->planoS           = 0.5f  ;
+		pConfig->fatorSilencio    = 10.0f ;
+		pConfig->silencioMinS     = 0.5f  ;
+	}
+
+/***************************************************************************
+*
+*  Função: SAU  &Validar configuração
+*  ****/
+
+	SAU_tpCondRet SAU_ValidarConfig( const SAU_tpConfig * pConfig )
+	{
+		if ( ! ( pConfig->tauS > 0.0f ) || pConfig->aquecimento < 2 || ! ( pConfig->limiarSigma > 0.0f ) ||
+		     pConfig->atipicasSeguidas == 0 || ! ( pConfig->fracaoAtipicas > 0.0f ) ||
+		     ! ( pConfig->planoS > 0.0f ) || ! ( pConfig->fatorSilencio >= 1.0f ) ||
+		     ! ( pConfig->silencioMinS > 0.0f ) )
+		{
+			return SAU_CondRetConfig ;
+		}
+
+		return SAU_CondRetOK ;
+	}
+
+/***************************************************************************
+*
+*  Função: SAU  &Iniciar canal
+*  ****/
+
+	void SAU_IniciarCanal( SAU_tpCanal * pCanal , float desvioMinimo , float volta )
+	{
+		memset( pCanal , 0 , sizeof( *pCanal ) ) ;
+
+		pCanal->desvioMinimo = desvioMinimo ;
+		pCanal->volta        = volta ;
+		pCanal->estado       = SAU_EstadoAquecendo ;
+	}
+
+/***************************************************************************
+*
+*  Função: SAU  &Acrescentar valor
+*  ****/
+
+	SAU_tpEstado SAU_AcrescentarValor( SAU_tpCanal * pCanal , const SAU_tpConfig * pConfig ,
+	                                   uint64_t origem , float valor )
+	{
+		float        media     = pCanal->media ;
+		float        variancia = pCanal->variancia ;
+		float        dtS = 0.0f , peso = 0.0f , d , alfa ;
+		int          atipica   = 0 ;
+		SAU_tpEstado estado ;
+
+		/* Um canal mais lento que o tópico (o barômetro no sensor_combined)
+		   repete a amostra com a mesma origem: não é amostra nova */
+
+		if ( pCanal->amostras > 0 )
+		{
+			if ( origem <= pCanal->ultimaOrigem )
+			{
+				return pCanal->estado ;
+			}
+
+			dtS  = ( float ) ( origem - pCanal->ultimaOrigem ) * 1e-6f ;
+			peso = dtS / ( pConfig->tauS + dtS ) ;
+		}
+
+		PUBLICAR( pCanal->amostras , pCanal->amostras + 1 ) ;
+
+		if ( ! isfinite( valor ) )
+		{
+			atipica = 1 ;
+			PUBLICAR( pCanal->invalidas , pCanal->invalidas + 1 ) ;
+		}
+		else if ( pCanal->n == 0 )
+		{
+			media              = valor ;
+			variancia          = 0.0f ;
+			pCanal->n          = 1 ;
+			pCanal->seguidas   = 0 ;
+			pCanal->ultimo     = valor ;
+			PUBLICAR( pCanal->inicioPlano , origem ) ;
+		}
+		else
+		{
+			/* Travado: o mesmo valor bit a bit, não só próximo */
+
+			if ( memcmp( &valor , &pCanal->ultimo , sizeof( valor ) ) != 0 )
+			{
+				pCanal->ultimo = valor ;
+				PUBLICAR( pCanal->inicioPlano , origem ) ;
+			}
+
+			d = valor - media ;
+
+			if ( pCanal->volta > 0.0f )
+			{
+				d = remainderf( d , pCanal->volta ) ;
+			}
+
+			if ( pCanal->n >= pConfig->aquecimento && fabsf( d ) > pCanal->desvioMinimo &&
+			     d * d > pConfig->limiarSigma * pConfig->limiarSigma * variancia )
+			{
+				atipica = 1 ;
+				PUBLICAR( pCanal->atipicas , pCanal->atipicas + 1 ) ;
+
+				/* Muitas seguidas: o sinal mudou de patamar, não é ruído */
+
+				if ( ++ pCanal->seguidas >= pConfig->atipicasSeguidas )
+				{
+					media            = valor ;
+					variancia        = 0.0f ;
+					pCanal->n        = 1 ;
+					pCanal->seguidas = 0 ;
+				}
+			}
+			else
+			{
+				/* Welford com peso 1 / n no aquecimento, exponencial depois */
+
+				alfa = pCanal->n < pConfig->aquecimento ? 1.0f / ( float ) ( pCanal->n + 1 ) : peso ;
+
+				media    += alfa * d ;
+				variancia = ( 1.0f - alfa ) * ( variancia + alfa * d * d ) ;
+
+				if ( pCanal->volta > 0.0f )
+				{
+					media = remainderf( media , pCanal->volta ) ;
+				}
+
+				pCanal->n        ++ ;
+				pCanal->seguidas = 0 ;
+			}
+		}
+
+		PUBLICAR( pCanal->ultimaOrigem , origem ) ;
+		pCanal->fracao      += peso * ( ( float ) atipica - pCanal->fracao ) ;
+
+		if ( pCanal->n > 0 && origem - pCanal->inicioPlano >= ( uint64_t ) ( pConfig->planoS * 1e6f ) )
+		{
+			estado = SAU_EstadoTravado ;
+		}
+		else if ( pCanal->amostras >= pConfig->aquecimento && pCanal->fracao > pConfig->fracaoAtipicas )
+		{
+			estado = SAU_EstadoRuidoso ;
+		}
+		else if ( pCanal->n < pConfig->aquecimento )
+		{
+			estado = SAU_EstadoAquecendo ;
+		}
+		else
+		{
+			estado = SAU_EstadoOK ;
+		}
+
+		publicarFloat( &pCanal->media , media ) ;
+		publicarFloat( &pCanal->variancia , variancia ) ;
+		PUBLICAR( pCanal->estado , estado ) ;
+
+		return estado ;
+	}
+
+/***************************************************************************
+*
+*  Função: SAU  &Obter resumo de um canal
+*  ****/
+
+	void SAU_ObterCanal( const SAU_tpCanal * pCanal , SAU_tpResumoCanal * pResumo )
+	{
+		uint64_t inicio = __atomic_load_n( &pCanal->inicioPlano  , __ATOMIC_RELAXED ) ;
+		uint64_t ultima = __atomic_load_n( &pCanal->ultimaOrigem , __ATOMIC_RELAXED ) ;
+
+		pResumo->estado    = __atomic_load_n( &pCanal->estado    , __ATOMIC_RELAXED ) ;
+		pResumo->media     = lerFloat( &pCanal->media ) ;
+		pResumo->desvio    = sqrtf( lerFloat( &pCanal->variancia ) ) ;
+		pResumo->planoS    = ultima > inicio ? ( float ) ( ultima - inicio ) * 1e-6f : 0.0f ;
+		pResumo->amostras  = __atomic_load_n( &pCanal->amostras  , __ATOMIC_RELAXED ) ;
+		pResumo->atipicas  = __atomic_load_n( &pCanal->atipicas  , __ATOMIC_RELAXED ) ;
+		pResumo->invalidas = __atomic_load_n( &pCanal->invalidas , __ATOMIC_RELAXED ) ;
+	}
+
+/***************************************************************************
+*
+*  Função: SAU  &Iniciar fonte
+*  ****/
+
+	void SAU_IniciarFonte( SAU_tpFonte * pFonte , uint64_t agora )
+	{
+		memset( pFonte , 0 , sizeof( *pFonte ) ) ;
+
+		pFonte->inicio = agora ;
+	}
+
+/***************************************************************************
+*
+*  Função: SAU  &Acrescentar chegada
+*  ****/
+
+	int SAU_AcrescentarChegada( SAU_tpFonte * pFonte , uint64_t origem )
+	{
+		float dtS ;
+
+		if ( pFonte->amostras > 0 )
+		{
+			if ( origem <= pFonte->ultimaOrigem )
+			{
+				return 0 ;
+			}
+
+			dtS = ( float ) ( origem - pFonte->ultimaOrigem ) * 1e-6f ;
+
+			publicarFloat( &pFonte->periodoS , pFonte->amostras == 1 ? dtS :
+			               pFonte->periodoS + SAU_PESO_PERIODO * ( dtS - pFonte->periodoS ) ) ;
+		}
+
+		PUBLICAR( pFonte->ultimaOrigem , origem ) ;
+		PUBLICAR( pFonte->amostras , pFonte->amostras + 1 ) ;
+
+		return 1 ;
+	}
+
+/***************************************************************************
+*
+*  Função: SAU  &Estado de uma fonte
+*  ****/
+
+	SAU_tpEstado SAU_EstadoFonte( const SAU_tpFonte * pFonte , const SAU_tpConfig * pConfig , uint64_t agora ,
+	                              SAU_tpEstado piorCanal , float * pTaxaHz , float * pIdadeS )
+	{
+		uint32_t amostras   = __atomic_load_n( &pFonte->amostras , __ATOMIC_RELAXED ) ;
+		uint64_t referencia = amostras > 0 ? __atomic_load_n( &pFonte->ultimaOrigem , __ATOMIC_RELAXED ) : pFonte->inicio ;
+		float    periodoS   = amostras > 1 ? lerFloat( &pFonte->periodoS ) : 0.0f ;
+		float    idadeS     = agora > referencia ? ( float ) ( agora - referencia ) * 1e-6f : 0.0f ;
+		float    prazoS     = pConfig->fatorSilencio * periodoS ;
+
+		if ( pTaxaHz != NULL )
+		{
+			*pTaxaHz = periodoS > 0.0f ? 1.0f / periodoS : 0.0f ;
+		}
+
+		if ( pIdadeS != NULL )
+		{
+			*pIdadeS = idadeS ;
+		}
+
+		if ( idadeS > ( prazoS > pConfig->silencioMinS ? prazoS : pConfig->silencioMinS ) )
+		{
+			return SAU_EstadoMudo ;
+		}
+
+		if ( amostras == 0 )
+		{
+			return SAU_EstadoAquecendo ;
+		}
+
+		return piorCanal ;
+	}
+
+/*****  Código das funções encapsuladas no módulo  *****/
+
+	/***************************************************************************
+	*
+	*  Função: SAU  & Escrever um float visível a outra thread
+	*  ****/
+
+	static void publicarFloat( float * pDestino , float valor )
+	{
+		__atomic_store( pDestino , &valor , __ATOMIC_RELAXED ) ;
+	}
+
+	/***************************************************************************
+	*
+	*  Função: SAU  & Ler um float escrito por outra thread
+	*  ****/
+
+	static float lerFloat( const float * pOrigem )
+	{
+		float valor ;
+
+		__atomic_load( pOrigem , &valor , __ATOMIC_RELAXED ) ;
+
+		return valor ;
+	}
@@ -0,0 +1,280 @@
+#ifndef SAU_SAUDE
+#define SAU_SAUDE
+
+/**************************************************************************************************************************
+*$MCD Módulo de definição
+*	  Nome : 	                Saúde dos sensores em voo
+*	  Proprietário :         	Equipe AeroRio
+*	  Projeto :		            SAE AeroDesign Brasil 2014
+*	  Gestor :	 	            Alessandro Soares da Silva Junior
+* 	  Arquivo : 	            SAU_SAUDE.H
+*	  Letras Identificadoras : 	SAU
+*	  Autor : 	                Alessandro Soares da Silva Junior
+*
+*$ED Descrição do módulo
+*	Detecta sensor travado, mudo ou ruidoso a partir das próprias amostras, a cada amostra, em memória constante:
+*   nenhuma janela de amostras é guardada e nenhuma tarefa de análise à parte é necessária.
+*
+*   Cada canal (um campo de um tópico) mantém média e variância pelo algoritmo de Welford. Nas primeiras
+*   'aquecimento' amostras o peso é 1 / n (média exata); depois passa a dt / ( tauS + dt ), o que esquece o passado
+*   com constante de tempo tauS e acompanha o voo. Sobre essas estatísticas:
+*
+*   	atípica  : amostra a mais de limiarSigma desvios da média (e além do desvio mínimo do canal), ou NaN; não
+*   	           entra na média. 'atipicasSeguidas' seguidas indicam mudança de patamar e reiniciam a média
+*   	travado  : o mesmo valor, bit a bit, por planoS segundos de amostras novas
+*
+*   Cada fonte (um tópico) mede o período entre amostras novas (média exponencial) e fica muda quando a última
+*   amostra tem mais de fatorSilencio períodos e mais de silencioMinS.
+*
+*   Os estados seguem a ordem de gravidade de SAU_tpEstado; o estado de uma fonte é o pior dos seus canais, ou mudo.
+*   Um único produtor; leitores concorrentes veem cada campo antigo ou novo, como nos contadores do LER.
+*
+***************************************************************************************************************************/
+
+#include <stdint.h>
+
+/***** Declarações exportadas pelo módulo *****/
+
+/***********************************************************************
+*
+*  $TC Tipo de dados: SAU Condições de retorno
+*
+***********************************************************************/
+
+   typedef enum {
+
+         SAU_CondRetOK            ,
+              /* Executou corretamente                               */
+         SAU_CondRetConfig        ,
+              /* Constante de tempo, limiar ou prazo inválido        */
+
+} SAU_tpCondRet ;
+
+/***********************************************************************
+*
+*  $TC Tipo de dados: SAU Estado de saúde
+*
+*  $ED Descrição do tipo
+*     Em ordem crescente de gravidade.
+*
+***********************************************************************/
+
+   typedef enum {
+
+         SAU_EstadoOK             ,
+         SAU_EstadoAquecendo      ,
+              /* Amostras ainda insuficientes para julgar            */
+         SAU_EstadoRuidoso        ,
+              /* Fração de atípicas ou inválidas acima do limite     */
+         SAU_EstadoTravado        ,
+              /* Valor constante por planoS                          */
+         SAU_EstadoMudo           ,
+              /* Sem amostra nova no prazo                           */
+
+} SAU_tpEstado ;
+
+/***********************************************************************
+*
+*  $TC Tipo de dados: SAU Configuração
+*
+***********************************************************************/
+
+   typedef struct {
+
+         float    tauS              ;
+              /* Memória da média e da variância                     */
+         unsigned aquecimento       ;
+              /* Amostras antes do primeiro julgamento               */
+         float    limiarSigma       ;
+              /* Desvios da média que tornam a amostra atípica       */
+         unsigned atipicasSeguidas  ;
+              /* Seguidas que reiniciam a média (mudança de patamar) */
+         float    fracaoAtipicas    ;
+              /* Fração média (em tauS) que torna o canal ruidoso    */
+         float    planoS            ;
+              /* Tempo com o mesmo valor que torna o canal travado   */
+         float    fatorSilencio     ;
+              /* Períodos sem amostra que tornam a fonte muda        */
+         float    silencioMinS      ;
+              /* Prazo mínimo para mudo, e prazo da primeira amostra */
+
+} SAU_tpConfig ;
+
+/***********************************************************************
+*
+*  $TC Tipo de dados: SAU Canal
+*
+*  $ED Descrição do tipo
+*     Os campos são internos ao módulo; o tipo é exportado para que o
+*     chamador o aloque.
+*
+***********************************************************************/
+
+   typedef struct {
+
+         float        desvioMinimo    ;
+              /* Desvios menores nunca são atípicos (resolução)      */
+         float        volta           ;
+              /* Período de um ângulo (360); 0 = canal linear        */
+         uint32_t     n               ;
+              /* Amostras na média desde o último reinício           */
+         float        media           ;
+         float        variancia       ;
+         float        ultimo          ;
+         uint64_t     inicioPlano     ;
+              /* Origem da primeira amostra com o valor atual        */
+         uint64_t     ultimaOrigem    ;
+         float        fracao          ;
+              /* Média exponencial das atípicas e inválidas          */
+         unsigned     seguidas        ;
+         uint32_t     amostras        ;
+         uint32_t     atipicas        ;
+         uint32_t     invalidas       ;
+         SAU_tpEstado estado          ;
+
+} SAU_tpCanal ;
+
+/***********************************************************************
+*
+*  $TC Tipo de dados: SAU Resumo de um canal
+*
+***********************************************************************/
+
+   typedef struct {
+
+         SAU_tpEstado estado          ;
+         float        media           ;
+         float        desvio          ;
+         float        planoS          ;
+              /* Tempo com o valor atual                             */
+         uint32_t     amostras        ;
+         uint32_t     atipicas        ;
+         uint32_t     invalidas       ;
+
+} SAU_tpResumoCanal ;
+
+/***********************************************************************
+*
+*  $TC Tipo de dados: SAU Fonte
+*
+*  $ED Descrição do tipo
+*     Os campos são internos ao módulo; o tipo é exportado para que o
+*     chamador o aloque.
+*
+***********************************************************************/
+
+   typedef struct {
+
+         uint64_t     inicio          ;
+         uint64_t     ultimaOrigem    ;
+         float        periodoS        ;
+              /* Média exponencial do intervalo entre amostras novas */
+         uint32_t     amostras        ;
+
+} SAU_tpFonte ;
+
+/***********************************************************************
+*
+*  $FC Função: SAU  &Configuração padrão
+*
+*  $ED Descrição da função
+*     Memória de 2 s, 20 amostras de aquecimento, atípica a 6 desvios,
+*     8 seguidas reiniciam, ruidoso acima de 2% de atípicas, travado em
+*     0,5 s, mudo após 10 períodos e ao menos 0,5 s.
+*
+***********************************************************************/
+
+void SAU_ConfigPadrao( SAU_tpConfig * pConfig ) ;
+
+/***********************************************************************
+*
+*  $FC Função: SAU  &Validar configuração
+*
+*  $FV Valor retornado
+*     SAU_CondRetOK ou SAU_CondRetConfig.
+*
+***********************************************************************/
+
+SAU_tpCondRet SAU_ValidarConfig( const SAU_tpConfig * pConfig ) ;
+
+/***********************************************************************
+*
+*  $FC Função: SAU  &Iniciar canal
+*
+*  $EP Parâmetros
+*    desvioMinimo  - Resolução útil do canal, na unidade dele
+*    volta         - 360 para ângulos em graus (±180); 0 para os demais
+*
+***********************************************************************/
+
+void SAU_IniciarCanal( SAU_tpCanal * pCanal , float desvioMinimo , float volta ) ;
+
+/***********************************************************************
+*
+*  $FC Função: SAU  &Acrescentar valor
+*
+*  $ED Descrição da função
+*     Uma amostra do canal. NaN conta como inválida; amostra com a origem
+*     da anterior, ou mais velha, é ignorada.
+*
+*  $EP Parâmetros
+*    origem  - Timestamp da amostra (us)
+*
+*  $FV Valor retornado
+*     Estado do canal depois da amostra.
+*
+***********************************************************************/
+
+SAU_tpEstado SAU_AcrescentarValor( SAU_tpCanal * pCanal , const SAU_tpConfig * pConfig ,
+                                   uint64_t origem , float valor ) ;
+
+/***********************************************************************
+*
+*  $FC Função: SAU  &Obter resumo de um canal
+*
+***********************************************************************/
+
+void SAU_ObterCanal( const SAU_tpCanal * pCanal , SAU_tpResumoCanal * pResumo ) ;
+
+/***********************************************************************
+*
+*  $FC Função: SAU  &Iniciar fonte
+*
+*  $EP Parâmetros
+*    agora  - Início da espera pela primeira amostra (us)
+*
+***********************************************************************/
+
+void SAU_IniciarFonte( SAU_tpFonte * pFonte , uint64_t agora ) ;
+
+/***********************************************************************
+*
+*  $FC Função: SAU  &Acrescentar chegada
+*
+*  $ED Descrição da função
+*     Registra a origem de uma cópia do tópico.
+*
+*  $FV Valor retornado
+*     1 se a amostra é nova, 0 se repete a origem da anterior ou é mais
+*     velha que ela.
+*
+***********************************************************************/
+
+int SAU_AcrescentarChegada( SAU_tpFonte * pFonte , uint64_t origem ) ;
+
+/***********************************************************************
+*
+*  $FC Função: SAU  &Estado de uma fonte
+*
+*  $EP Parâmetros
+*    agora      - Instante da consulta (us)
+*    piorCanal  - Pior estado entre os canais da fonte
+*    pTaxaHz    - Recebe a taxa medida (0 antes da segunda amostra), ou NULL
+*    pIdadeS    - Recebe o tempo desde a última amostra nova, ou NULL
+*
+***********************************************************************/
+
+SAU_tpEstado SAU_EstadoFonte( const SAU_tpFonte * pFonte , const SAU_tpConfig * pConfig , uint64_t agora ,
+                              SAU_tpEstado piorCanal , float * pTaxaHz , float * pIdadeS ) ;
+
+#endif
@@ -0,0 +1,551 @@
+/***************************************************************************
+*  $MCI Módulo de implementação: TLM Telemetria compacta para o rádio
+*
+*  Arquivo gerado:              TLM_TELEMETRIA.c
+*  Letras identificadoras:      TLM
+*
+*
+*  Projeto: SAE AeroDesign Brasil 2014
+*  Gestor:  Alessandro Soares da Silva Junior
+*  Autores: Alessandro Soares da Silva Junior
+*
+*
+***************************************************************************/
+
+#ifndef _STRING
+#define _STRING
+#include <string.h>
+#endif
+
+#ifndef _MATH
+#define _MATH
+#include <math.h>
+#endif
+
+#define TLM_TELEMETRIA_OWN
+#include "TLM_TELEMETRIA.h"
+#undef TLM_TELEMETRIA_OWN
+
+#define TLM_SEM_VALOR     ( -32768 )          /* Inteiro de um campo NaN                   */
+#define TLM_MIN_CORPO     ( TLM_TAM_CABECALHO - 3 )   /* Comprimento sem nenhum campo      */
+
+/***** Protótipos das funções encapuladas no módulo *****/
+
+	static float   custoPlano    ( const TLM_tpPlano * pPlano , unsigned habilitados ) ;
+	static int16_t quantizar     ( float valor , float deslocamento , float escala ) ;
+	static void    escreverU16   ( unsigned char * p , unsigned v ) ;
+	static void    escreverU32   ( unsigned char * p , uint32_t v ) ;
+	static void    aceitarQuadro ( TLM_tpDecodificador * pDec , TLM_tpQuadro * pQuadro ) ;
+
+/*****  Código das funções exportadas pelo módulo  *****/
+
+/***************************************************************************
+*
+*  Função: TLM  &Configuração padrão
+*  ****/
+
+	void TLM_ConfigPadrao( TLM_tpConfig * pConfig )
+	{
+		static const TLM_tpCampoConfig padrao[ LER_NumCampos ] = {
+			{ 10.0f , 1.0f  , 3 , 0.02f  , 700.0f } ,        /* LER_CampoPressao    */
+			{ 50.0f , 5.0f  , 6 , 0.02f  , 0.0f   } ,        /* LER_CampoPitchSpeed */
+			{ 50.0f , 5.0f  , 6 , 0.02f  , 0.0f   } ,        /* LER_CampoRollSpeed  */
+			{ 50.0f , 5.0f  , 6 , 0.02f  , 0.0f   } ,        /* LER_CampoYawSpeed   */
+			{ 50.0f , 10.0f , 7 , 0.01f  , 0.0f   } ,        /* LER_CampoPitch      */
+			{ 50.0f , 10.0f , 7 , 0.01f  , 0.0f   } ,        /* LER_CampoRoll       */
+			{ 50.0f , 10.0f , 7 , 0.01f  , 0.0f   } ,        /* LER_CampoYaw        */
+			{ 25.0f , 2.0f  , 4 , 0.005f , 0.0f   } ,        /* LER_CampoAx         */
+			{ 25.0f , 2.0f  , 4 , 0.005f , 0.0f   } ,        /* LER_CampoAy         */
+			{ 25.0f , 2.0f  , 4 , 0.005f , 0.0f   } ,        /* LER_CampoAz         */
+			{ 10.0f , 1.0f  , 5 , 0.05f  , 0.0f   } ,        /* LER_CampoAltura     */
+		} ;
+
+		pConfig->bytesPorSegundo = 2880.0f ;
+
+		memcpy( pConfig->campo , padrao , sizeof( padrao ) ) ;
+	}
+
+/***************************************************************************
+*
+*  Função: TLM  &Iniciar codificador
+*  ****/
+
+	TLM_tpCondRet TLM_IniciarCodificador( TLM_tpCodificador * pCod , const TLM_tpConfig * pConfig )
+	{
+		TLM_tpPlano * pPlano = &pCod->plano ;
+		unsigned      habilitados = 0 , limite[ LER_NumCampos ] ;
+		float         base = 0.0f ;
+		int           c ;
+
+		if ( ! ( pConfig->bytesPorSegundo > 0.0f ) )
+		{
+			return TLM_CondRetConfig ;
+		}
+
+		memset( pCod , 0 , sizeof( *pCod ) ) ;
+		pCod->config = *pConfig ;
+
+		for ( c = 0 ; c < LER_NumCampos ; c++ )
+		{
+			const TLM_tpCampoConfig * pCampo = &pConfig->campo[ c ] ;
+
+			if ( ! ( pCampo->resolucao > 0.0f ) || ! ( pCampo->taxaHz >= 0.0f ) || pCampo->taxaMinHz > pCampo->taxaHz )
+			{
+				return TLM_CondRetConfig ;
+			}
+
+			pCod->escala[ c ] = 1.0f / pCampo->resolucao ;
+
+			if ( pCampo->taxaHz > base )
+			{
+				base = pCampo->taxaHz ;
+			}
+		}
+
+		if ( base == 0.0f )
+		{
+			return TLM_CondRetConfig ;
+		}
+
+		/* Divisor inicial: a menor potência de 2 que não passa da taxa
+		   pedida. Limite: o maior que ainda não fica abaixo da mínima. */
+
+		for ( c = 0 ; c < LER_NumCampos ; c++ )
+		{
+			const TLM_tpCampoConfig * pCampo = &pConfig->campo[ c ] ;
+			unsigned k = 1 ;
+
+			if ( pCampo->taxaHz == 0.0f )
+			{
+				continue ;
+			}
+
+			while ( base / k > pCampo->taxaHz * 1.0001f && k < TLM_DIVISOR_MAX )
+			{
+				k *= 2 ;
+			}
+
+			pPlano->divisor[ c ] = k ;
+			limite[ c ]          = k ;
+
+			while ( limite[ c ] < TLM_DIVISOR_MAX && base / ( limite[ c ] * 2 ) >= pCampo->taxaMinHz )
+			{
+				limite[ c ] *= 2 ;
+			}
+
+			habilitados |= 1u << c ;
+		}
+
+		pPlano->taxaBaseHz = base ;
+
+		/* Reduz o menos prioritário (entre iguais, o mais rápido) até a
+		   mínima; com todos na mínima, desliga o menos prioritário */
+
+		while ( custoPlano( pPlano , habilitados ) > pConfig->bytesPorSegundo )
+		{
+			int escolhido = -1 ;
+
+			for ( c = 0 ; c < LER_NumCampos ; c++ )
+			{
+				if ( ( habilitados & ( 1u << c ) ) && pPlano->divisor[ c ] < limite[ c ] &&
+				     ( escolhido < 0 ||
+				       pConfig->campo[ c ].prioridade < pConfig->campo[ escolhido ].prioridade ||
+				       ( pConfig->campo[ c ].prioridade == pConfig->campo[ escolhido ].prioridade &&
+				         pPlano->divisor[ c ] <= pPlano->divisor[ escolhido ] ) ) )
+				{
+					escolhido = c ;
+				}
+			}
+
+			if ( escolhido >= 0 )
+			{
+				pPlano->divisor[ escolhido ] *= 2 ;
+				pPlano->reduzidos |= 1u << escolhido ;
+				continue ;
+			}
+
+			for ( c = 0 ; c < LER_NumCampos ; c++ )
+			{
+				if ( ( habilitados & ( 1u << c ) ) &&
+				     ( escolhido < 0 || pConfig->campo[ c ].prioridade <= pConfig->campo[ escolhido ].prioridade ) )
+				{
+					escolhido = c ;
+				}
+			}
+
+			if ( escolhido < 0 )
+			{
+				return TLM_CondRetOrcamento ;
+			}
+
+			habilitados                  &= ~( 1u << escolhido ) ;
+			pPlano->desligados           |= 1u << escolhido ;
+			pPlano->divisor[ escolhido ]  = 0 ;
+		}
+
+		if ( habilitados == 0 )
+		{
+			return TLM_CondRetOrcamento ;
+		}
+
+		pPlano->bytesPorSegundo = custoPlano( pPlano , habilitados ) ;
+
+		for ( c = 0 ; c < LER_NumCampos ; c++ )
+		{
+			pPlano->taxaHz[ c ] = pPlano->divisor[ c ] != 0 ? base / pPlano->divisor[ c ] : 0.0f ;
+
+			if ( pPlano->divisor[ c ] != 0 &&
+			     ( pPlano->taxaQuadrosHz == 0.0f || pPlano->taxaHz[ c ] > pPlano->taxaQuadrosHz ) )
+			{
+				pPlano->taxaQuadrosHz = pPlano->taxaHz[ c ] ;
+			}
+		}
+
+		return TLM_CondRetOK ;
+	}
+
+/***************************************************************************
+*
+*  Função: TLM  &Obter plano
+*  ****/
+
+	void TLM_ObterPlano( const TLM_tpCodificador * pCod , TLM_tpPlano * pPlano )
+	{
+		*pPlano = pCod->plano ;
+	}
+
+/***************************************************************************
+*
+*  Função: TLM  &Escalonar
+*  ****/
+
+	unsigned TLM_Escalonar( TLM_tpCodificador * pCod , uint64_t agora , const LER_tpAmostra * pAmostra ,
+	                        unsigned char * quadro )
+	{
+		const TLM_tpPlano * pPlano = &pCod->plano ;
+		uint64_t            posicao ;
+		unsigned            mascara = 0 ;
+		int                 c ;
+
+		if ( ! pCod->iniciado )
+		{
+			pCod->iniciado      = 1     ;
+			pCod->inicio        = agora ;
+			pCod->ultimaPosicao = 0     ;
+
+			for ( c = 0 ; c < LER_NumCampos ; c++ )
+			{
+				if ( pPlano->divisor[ c ] != 0 )
+				{
+					mascara |= 1u << c ;
+				}
+			}
+
+			return TLM_Codificar( pCod , pAmostra , mascara , quadro ) ;
+		}
+
+		posicao = ( uint64_t ) ( ( double ) ( agora - pCod->inicio ) * pPlano->taxaBaseHz * 1e-6 ) ;
+
+		if ( posicao <= pCod->ultimaPosicao )
+		{
+			return 0 ;
+		}
+
+		/* O campo vence se algum múltiplo do seu divisor está em
+		   ( ultimaPosicao , posicao ] */
+
+		for ( c = 0 ; c < LER_NumCampos ; c++ )
+		{
+			unsigned k = pPlano->divisor[ c ] ;
+
+			if ( k != 0 && posicao / k > pCod->ultimaPosicao / k )
+			{
+				mascara |= 1u << c ;
+			}
+		}
+
+		pCod->ultimaPosicao = posicao ;
+
+		return TLM_Codificar( pCod , pAmostra , mascara , quadro ) ;
+	}
+
+/***************************************************************************
+*
+*  Função: TLM  &Codificar
+*  ****/
+
+	unsigned TLM_Codificar( TLM_tpCodificador * pCod , const LER_tpAmostra * pAmostra , unsigned mascara ,
+	                        unsigned char * quadro )
+	{
+		unsigned char * p = quadro + TLM_TAM_CABECALHO ;
+		unsigned        comprimento ;
+		int             c ;
+
+		mascara &= ( 1u << LER_NumCampos ) - 1u ;
+
+		if ( mascara == 0 )
+		{
+			return 0 ;
+		}
+
+		for ( c = 0 ; c < LER_NumCampos ; c++ )
+		{
+			if ( mascara & ( 1u << c ) )
+			{
+				escreverU16( p , ( uint16_t ) quantizar( pAmostra->valor[ c ] , pCod->config.campo[ c ].deslocamento ,
+				                                         pCod->escala[ c ] ) ) ;
+				p += 2 ;
+			}
+		}
+
+		comprimento = ( unsigned ) ( p - quadro ) - 3 ;
+
+		quadro[ 0 ] = TLM_SINCRONISMO ;
+		quadro[ 1 ] = ( unsigned char ) comprimento ;
+		quadro[ 2 ] = pCod->sequencia ++ ;
+		escreverU32( quadro + 3 , ( uint32_t ) ( pAmostra->timestamp / 1000 ) ) ;
+		escreverU16( quadro + 7 , mascara ) ;
+		quadro[ 9 ] = ( unsigned char ) ( pAmostra->validos & LER_TODOS_GRUPOS ) ;
+
+		escreverU16( p , TLM_Crc( 0xFFFF , quadro + 1 , comprimento + 2 ) ) ;
+
+		return comprimento + 3 + TLM_TAM_CRC ;
+	}
+
+/***************************************************************************
+*
+*  Função: TLM  &Iniciar decodificador
+*  ****/
+
+	void TLM_IniciarDecodificador( TLM_tpDecodificador * pDec , const TLM_tpConfig * pConfig )
+	{
+		memset( pDec , 0 , sizeof( *pDec ) ) ;
+		pDec->config = *pConfig ;
+	}
+
+/***************************************************************************
+*
+*  Função: TLM  &Receber byte
+*  ****/
+
+	TLM_tpCondRet TLM_Receber( TLM_tpDecodificador * pDec , unsigned char byte , TLM_tpQuadro * pQuadro )
+	{
+		TLM_tpEstatisticas * pEst = &pDec->estatisticas ;
+		unsigned             n ;
+
+		if ( pDec->recebidos == 0 )
+		{
+			if ( byte != TLM_SINCRONISMO )
+			{
+				pEst->descartados ++ ;
+				return TLM_CondRetIncompleto ;
+			}
+
+			pDec->quadro[ pDec->recebidos ++ ] = byte ;
+			return TLM_CondRetIncompleto ;
+		}
+
+		if ( pDec->recebidos == 1 )
+		{
+			/* Comprimento impossível: o sincronismo era um byte qualquer */
+
+			if ( byte < TLM_MIN_CORPO || byte > TLM_MAX_QUADRO - 3 - TLM_TAM_CRC || ( byte - TLM_MIN_CORPO ) % 2 != 0 )
+			{
+				pEst->descartados += 2 ;
+				pDec->recebidos    = 0 ;
+				return TLM_CondRetCorrompido ;
+			}
+
+			pDec->esperados = 3u + byte + TLM_TAM_CRC ;
+		}
+
+		pDec->quadro[ pDec->recebidos ++ ] = byte ;
+
+		if ( pDec->recebidos < pDec->esperados )
+		{
+			return TLM_CondRetIncompleto ;
+		}
+
+		n               = pDec->recebidos ;
+		pDec->recebidos = 0 ;
+
+		if ( TLM_Crc( 0xFFFF , pDec->quadro + 1 , n - 1 - TLM_TAM_CRC ) !=
+		     ( uint16_t ) ( pDec->quadro[ n - 2 ] | pDec->quadro[ n - 1 ] << 8 ) )
+		{
+			pEst->errosCrc ++ ;
+			pEst->descartados += n ;
+			return TLM_CondRetCorrompido ;
+		}
+
+		/* A máscara tem de bater com o comprimento */
+
+		if ( ( unsigned ) __builtin_popcount( pDec->quadro[ 7 ] | pDec->quadro[ 8 ] << 8 ) * 2 + TLM_MIN_CORPO != pDec->quadro[ 1 ] ||
+		     ( pDec->quadro[ 8 ] >> ( LER_NumCampos - 8 ) ) != 0 )
+		{
+			pEst->descartados += n ;
+			return TLM_CondRetCorrompido ;
+		}
+
+		aceitarQuadro( pDec , pQuadro ) ;
+
+		return TLM_CondRetOK ;
+	}
+
+/***************************************************************************
+*
+*  Função: TLM  &Obter estatísticas
+*  ****/
+
+	void TLM_ObterEstatisticas( const TLM_tpDecodificador * pDec , TLM_tpEstatisticas * pEst )
+	{
+		*pEst = pDec->estatisticas ;
+	}
+
+/***************************************************************************
+*
+*  Função: TLM  &CRC-16/X.25
+*  ****/
+
+	uint16_t TLM_Crc( uint16_t crc , const unsigned char * dado , unsigned n )
+	{
+		unsigned i ;
+
+		for ( i = 0 ; i < n ; i++ )
+		{
+			uint8_t t = ( uint8_t ) ( dado[ i ] ^ ( crc & 0xFF ) ) ;
+
+			t   ^= ( uint8_t ) ( t << 4 ) ;
+			crc  = ( uint16_t ) ( ( crc >> 8 ) ^ ( t << 8 ) ^ ( t << 3 ) ^ ( t >> 4 ) ) ;
+		}
+
+		return crc ;
+	}
+
+/*****  Código das funções encapsuladas no módulo  *****/
+
+	/***************************************************************************
+	*
+	*  Função: TLM  &Custo de um plano em bytes/s
+	*
+	*  Com divisores potências de 2, as posições do menor divisor contêm
+	*  as de todos os outros: há um quadro a cada menor divisor.
+	*  ****/
+
+	static float custoPlano( const TLM_tpPlano * pPlano , unsigned habilitados )
+	{
+		unsigned menor = 0 ;
+		float    campos = 0.0f ;
+		int      c ;
+
+		for ( c = 0 ; c < LER_NumCampos ; c++ )
+		{
+			if ( habilitados & ( 1u << c ) )
+			{
+				campos += 2.0f * pPlano->taxaBaseHz / pPlano->divisor[ c ] ;
+
+				if ( menor == 0 || pPlano->divisor[ c ] < menor )
+				{
+					menor = pPlano->divisor[ c ] ;
+				}
+			}
+		}
+
+		if ( menor == 0 )
+		{
+			return 0.0f ;
+		}
+
+		return campos + TLM_SOBRECARGA * pPlano->taxaBaseHz / menor ;
+	}
+
+	/***************************************************************************
+	*
+	*  Função: TLM  &Quantizar um campo
+	*
+	*  Satura na faixa do int16; TLM_SEM_VALOR fica para o NaN.
+	*  ****/
+
+	static int16_t quantizar( float valor , float deslocamento , float escala )
+	{
+		float q ;
+
+		if ( valor != valor )
+		{
+			return TLM_SEM_VALOR ;
+		}
+
+		q = roundf( ( valor - deslocamento ) * escala ) ;
+
+		if ( q > 32767.0f )
+		{
+			return 32767 ;
+		}
+
+		if ( q < -32767.0f )
+		{
+			return -32767 ;
+		}
+
+		return ( int16_t ) q ;
+	}
+
+	/***************************************************************************
+	*
+	*  Função: TLM  &Escrever inteiros little-endian
+	*  ****/
+
+	static void escreverU16( unsigned char * p , unsigned v )
+	{
+		p[ 0 ] = ( unsigned char ) ( v & 0xFF ) ;
+		p[ 1 ] = ( unsigned char ) ( ( v >> 8 ) & 0xFF ) ;
+	}
+
+	static void escreverU32( unsigned char * p , uint32_t v )
+	{
+		escreverU16( p     , v & 0xFFFF ) ;
+		escreverU16( p + 2 , v >> 16    ) ;
+	}
+
+	/***************************************************************************
+	*
+	*  Função: TLM  &Desempacotar um quadro aceito
+	*  ****/
+
+	static void aceitarQuadro( TLM_tpDecodificador * pDec , TLM_tpQuadro * pQuadro )
+	{
+		const unsigned char * q = pDec->quadro ;
+		const unsigned char * p = q + TLM_TAM_CABECALHO ;
+		TLM_tpEstatisticas *  pEst = &pDec->estatisticas ;
+		int c ;
+
+		pQuadro->sequencia   = q[ 2 ] ;
+		pQuadro->timestampMs = ( uint32_t ) q[ 3 ] | ( uint32_t ) q[ 4 ] << 8 | ( uint32_t ) q[ 5 ] << 16 | ( uint32_t ) q[ 6 ] << 24 ;
+		pQuadro->mascara     = ( unsigned ) ( q[ 7 ] | q[ 8 ] << 8 ) ;
+		pQuadro->validos     = q[ 9 ] ;
+
+		for ( c = 0 ; c < LER_NumCampos ; c++ )
+		{
+			pQuadro->valor[ c ] = NAN ;
+
+			if ( pQuadro->mascara & ( 1u << c ) )
+			{
+				int16_t v = ( int16_t ) ( p[ 0 ] | p[ 1 ] << 8 ) ;
+
+				if ( v != TLM_SEM_VALOR )
+				{
+					pQuadro->valor[ c ] = pDec->config.campo[ c ].deslocamento + v * pDec->config.campo[ c ].resolucao ;
+				}
+
+				p += 2 ;
+			}
+		}
+
+		if ( pDec->temSequencia )
+		{
+			pEst->perdidos += ( uint8_t ) ( pQuadro->sequencia - pDec->ultimaSequencia - 1 ) ;
+		}
+
+		pDec->temSequencia    = 1 ;
+		pDec->ultimaSequencia = pQuadro->sequencia ;
+		pEst->quadros ++ ;
+	}
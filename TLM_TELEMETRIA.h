@@ -0,0 +1,326 @@
+#ifndef TLM_TELEMETRIA
+#define TLM_TELEMETRIA
+
+/**************************************************************************************************************************
+*$MCD Módulo de definição
+*	  Nome : 	                Telemetria compacta para o rádio
+*	  Proprietário :         	Equipe AeroRio
+*	  Projeto :		            SAE AeroDesign Brasil 2014
+*	  Gestor :	 	            Alessandro Soares da Silva Junior
+* 	  Arquivo : 	            TLM_TELEMETRIA.H
+*	  Letras Identificadoras : 	TLM
+*	  Autor : 	                Alessandro Soares da Silva Junior
+*
+*$ED Descrição do módulo
+*	Empacota as amostras do LER em quadros pequenos com CRC para a UART do rádio (57600 baud, cerca de 5760
+*   bytes/s), de modo que os onze campos caibam no enlace com taxas úteis, e desempacota os quadros em terra.
+*
+*   Cada campo tem taxa desejada, taxa mínima, prioridade e quantização (int16: valor = deslocamento + inteiro *
+*   resolução). TLM_IniciarCodificador calcula um plano que cabe no orçamento de bytes/s: a taxa de base é a maior
+*   taxa pedida e cada campo sai a cada 'divisor' posições de base, divisor potência de 2, de modo que as posições
+*   se encaixam e o custo do plano é exato. Enquanto o plano não cabe, o campo de menor prioridade (e, entre
+*   iguais, o mais rápido) tem a taxa dividida por 2 até a mínima; se todos estão na mínima, o de menor prioridade
+*   é desligado. Os campos mais importantes ficam com a taxa pedida enquanto houver orçamento.
+*
+*   Formato do quadro (little-endian), no máximo TLM_MAX_QUADRO bytes:
+*
+*   	sincronismo (0xAE), comprimento (u8, bytes do timestamp ao último campo), sequência (u8)
+*   	timestamp da amostra em ms (u32), máscara dos campos presentes (u16, bit = LER_tpCampo),
+*   	grupos válidos (u8), int16 de cada campo presente em ordem de LER_tpCampo
+*   	CRC-16/X.25 do comprimento ao último campo (o mesmo do MAVLink)
+*
+*   O inteiro -32768 marca campo sem valor (NaN). O decodificador recebe um byte por vez, de qualquer fonte
+*   (UART, pty, arquivo), e conta quadros, erros de CRC, bytes descartados e quadros perdidos pela sequência.
+*
+***************************************************************************************************************************/
+
+#include <stdint.h>
+
+#include "LER_PARAMETROS.h"
+
+/***** Declarações exportadas pelo módulo *****/
+
+#define TLM_SINCRONISMO     0xAE
+#define TLM_TAM_CABECALHO   10                       /* Sincronismo a grupos válidos        */
+#define TLM_TAM_CRC         2
+#define TLM_SOBRECARGA      ( TLM_TAM_CABECALHO + TLM_TAM_CRC )
+#define TLM_MAX_QUADRO      ( TLM_SOBRECARGA + 2 * LER_NumCampos )
+#define TLM_DIVISOR_MAX     1024                     /* Maior divisor da taxa de base       */
+
+/***********************************************************************
+*
+*  $TC Tipo de dados: TLM Condições de retorno
+*
+***********************************************************************/
+
+   typedef enum {
+
+         TLM_CondRetOK            ,
+              /* Executou corretamente; no decodificador, quadro pronto */
+         TLM_CondRetConfig        ,
+              /* Taxa, resolução ou orçamento inválido                */
+         TLM_CondRetOrcamento     ,
+              /* Nenhum campo cabe no orçamento                       */
+         TLM_CondRetIncompleto    ,
+              /* O quadro ainda não chegou inteiro                    */
+         TLM_CondRetCorrompido    ,
+              /* Quadro descartado (CRC ou comprimento)               */
+
+} TLM_tpCondRet ;
+
+/***********************************************************************
+*
+*  $TC Tipo de dados: TLM Configuração de um campo
+*
+***********************************************************************/
+
+   typedef struct {
+
+         float    taxaHz       ;
+              /* Taxa desejada; 0 = campo não enviado                */
+         float    taxaMinHz    ;
+              /* Abaixo desta o campo é desligado em vez de reduzido */
+         unsigned prioridade   ;
+              /* Maior = reduzido por último                         */
+         float    resolucao    ;
+              /* Na unidade do campo; o erro é no máximo a metade    */
+         float    deslocamento ;
+              /* Centro da faixa representável                       */
+
+} TLM_tpCampoConfig ;
+
+/***********************************************************************
+*
+*  $TC Tipo de dados: TLM Configuração
+*
+***********************************************************************/
+
+   typedef struct {
+
+         float             bytesPorSegundo             ;
+              /* Orçamento do enlace para a telemetria              */
+         TLM_tpCampoConfig campo[ LER_NumCampos ]      ;
+
+} TLM_tpConfig ;
+
+/***********************************************************************
+*
+*  $TC Tipo de dados: TLM Plano de envio
+*
+***********************************************************************/
+
+   typedef struct {
+
+         float    taxaBaseHz                    ;
+              /* Posições por segundo                               */
+         float    taxaQuadrosHz                 ;
+              /* Quadros por segundo (posições com algum campo)     */
+         unsigned divisor[ LER_NumCampos ]      ;
+              /* Posições entre dois envios do campo; 0 = desligado */
+         float    taxaHz[ LER_NumCampos ]       ;
+              /* Taxa resultante de cada campo                      */
+         unsigned reduzidos                     ;
+              /* Máscara dos campos abaixo da taxa pedida           */
+         unsigned desligados                    ;
+              /* Máscara dos campos desligados pelo orçamento       */
+         float    bytesPorSegundo               ;
+              /* Custo do plano                                     */
+
+} TLM_tpPlano ;
+
+/***********************************************************************
+*
+*  $TC Tipo de dados: TLM Codificador
+*
+*  $ED Descrição do tipo
+*     Os campos são internos ao módulo; o tipo é exportado para que o
+*     chamador o aloque.
+*
+***********************************************************************/
+
+   typedef struct {
+
+         TLM_tpConfig config                    ;
+         TLM_tpPlano  plano                     ;
+         float        escala[ LER_NumCampos ]   ;
+              /* 1 / resolução                                      */
+         int          iniciado                  ;
+         uint64_t     inicio                    ;
+         uint64_t     ultimaPosicao             ;
+         uint8_t      sequencia                 ;
+
+} TLM_tpCodificador ;
+
+/***********************************************************************
+*
+*  $TC Tipo de dados: TLM Quadro decodificado
+*
+***********************************************************************/
+
+   typedef struct {
+
+         uint8_t  sequencia                     ;
+         uint32_t timestampMs                   ;
+         unsigned mascara                       ;
+              /* Campos presentes (bit = LER_tpCampo)               */
+         unsigned validos                       ;
+              /* Grupos válidos na amostra (LER_MASCARA_GRUPO)      */
+         float    valor[ LER_NumCampos ]        ;
+              /* NaN nos campos ausentes ou sem valor               */
+
+} TLM_tpQuadro ;
+
+/***********************************************************************
+*
+*  $TC Tipo de dados: TLM Estatísticas do decodificador
+*
+***********************************************************************/
+
+   typedef struct {
+
+         uint32_t quadros      ;
+              /* Quadros aceitos                                    */
+         uint32_t errosCrc     ;
+         uint32_t descartados  ;
+              /* Bytes fora de quadro ou de quadros rejeitados      */
+         uint32_t perdidos     ;
+              /* Saltos na sequência                                */
+
+} TLM_tpEstatisticas ;
+
+/***********************************************************************
+*
+*  $TC Tipo de dados: TLM Decodificador
+*
+***********************************************************************/
+
+   typedef struct {
+
+         TLM_tpConfig       config                  ;
+         unsigned char      quadro[ TLM_MAX_QUADRO ] ;
+         unsigned           recebidos               ;
+         unsigned           esperados               ;
+         int                temSequencia            ;
+         uint8_t            ultimaSequencia         ;
+         TLM_tpEstatisticas estatisticas            ;
+
+} TLM_tpDecodificador ;
+
+/***********************************************************************
+*
+*  $FC Função: TLM  &Configuração padrão
+*
+*  $ED Descrição da função
+*     Metade do enlace de 57600 baud (2880 bytes/s). Atitude e
+*     velocidades angulares a 50 Hz, aceleração a 25 Hz, pressão e
+*     altura a 10 Hz; atitude com a maior prioridade. Resoluções de
+*     0,02 mbar, 0,02 º/s, 0,01 º, 0,005 m/s² e 5 cm.
+*
+***********************************************************************/
+
+void TLM_ConfigPadrao( TLM_tpConfig * pConfig ) ;
+
+/***********************************************************************
+*
+*  $FC Função: TLM  &Iniciar codificador
+*
+*  $ED Descrição da função
+*     Valida a configuração e calcula o plano de envio.
+*
+*  $FV Valor retornado
+*     TLM_CondRetOK, TLM_CondRetConfig ou TLM_CondRetOrcamento.
+*
+***********************************************************************/
+
+TLM_tpCondRet TLM_IniciarCodificador( TLM_tpCodificador * pCod , const TLM_tpConfig * pConfig ) ;
+
+/***********************************************************************
+*
+*  $FC Função: TLM  &Obter plano
+*
+***********************************************************************/
+
+void TLM_ObterPlano( const TLM_tpCodificador * pCod , TLM_tpPlano * pPlano ) ;
+
+/***********************************************************************
+*
+*  $FC Função: TLM  &Escalonar
+*
+*  $ED Descrição da função
+*     Monta o quadro da posição de base corrente com os campos que
+*     vencem nela. Deve ser chamada ao menos na taxa de base (mais vezes
+*     não custa); posições puladas entram no quadro seguinte. A primeira
+*     chamada envia todos os campos do plano.
+*
+*  $EP Parâmetros
+*    agora    - Instante da chamada (hrt, us)
+*    quadro   - Área de TLM_MAX_QUADRO bytes
+*
+*  $FV Valor retornado
+*     Bytes do quadro; 0 se nada vence nesta chamada.
+*
+***********************************************************************/
+
+unsigned TLM_Escalonar( TLM_tpCodificador * pCod , uint64_t agora , const LER_tpAmostra * pAmostra ,
+                        unsigned char * quadro ) ;
+
+/***********************************************************************
+*
+*  $FC Função: TLM  &Codificar
+*
+*  $ED Descrição da função
+*     Monta um quadro com os campos de 'mascara', fora do plano.
+*
+*  $FV Valor retornado
+*     Bytes do quadro (0 se a máscara é vazia).
+*
+***********************************************************************/
+
+unsigned TLM_Codificar( TLM_tpCodificador * pCod , const LER_tpAmostra * pAmostra , unsigned mascara ,
+                        unsigned char * quadro ) ;
+
+/***********************************************************************
+*
+*  $FC Função: TLM  &Iniciar decodificador
+*
+*  $ED Descrição da função
+*     pConfig deve ter as mesmas resoluções e deslocamentos do
+*     codificador; taxas e orçamento não são usados.
+*
+***********************************************************************/
+
+void TLM_IniciarDecodificador( TLM_tpDecodificador * pDec , const TLM_tpConfig * pConfig ) ;
+
+/***********************************************************************
+*
+*  $FC Função: TLM  &Receber byte
+*
+*  $FV Valor retornado
+*     TLM_CondRetOK quando o byte completa um quadro válido (em
+*     *pQuadro), TLM_CondRetIncompleto enquanto não, ou
+*     TLM_CondRetCorrompido quando um quadro foi rejeitado.
+*
+***********************************************************************/
+
+TLM_tpCondRet TLM_Receber( TLM_tpDecodificador * pDec , unsigned char byte , TLM_tpQuadro * pQuadro ) ;
+
+/***********************************************************************
+*
+*  $FC Função: TLM  &Obter estatísticas
+*
+***********************************************************************/
+
+void TLM_ObterEstatisticas( const TLM_tpDecodificador * pDec , TLM_tpEstatisticas * pEst ) ;
+
+/***********************************************************************
+*
+*  $FC Função: TLM  &CRC-16/X.25
+*
+*  $ED Descrição da função
+*     Acumula 'n' bytes sobre 'crc' (0xFFFF para começar).
+*
+***********************************************************************/
+
+uint16_t TLM_Crc( uint16_t crc , const unsigned char * dado , unsigned n ) ;
+
+#endif
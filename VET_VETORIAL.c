@@ -0,0 +1,347 @@
+/***************************************************************************
+*  $MCI Módulo de implementação: VET Núcleos vetoriais sobre colunas de amostras
+*
+*  Arquivo gerado:              VET_VETORIAL.c
+*  Letras identificadoras:      VET
+*
+*
+*  Projeto: SAE AeroDesign Brasil 2014
+*  Gestor:  Alessandro Soares da Silva Junior
+*  Autores: Alessandro Soares da Silva Junior
+*
+*
+***************************************************************************/
+
+#ifndef _MATH
+#define _MATH
+#include <math.h>
+#endif
+
+#if ! defined( VET_SOMENTE_ESCALAR ) && ( defined( __ARM_NEON ) || defined( __ARM_NEON__ ) )
+	#define VET_NEON
+	#include <arm_neon.h>
+#elif ! defined( VET_SOMENTE_ESCALAR ) && ( defined( __SSE2__ ) || defined( _M_X64 ) )
+	#define VET_SSE2
+	#include <emmintrin.h>
+#endif
+
+#define VET_VETORIAL_OWN
+#include "VET_VETORIAL.h"
+#undef VET_VETORIAL_OWN
+
+/***** Protótipos das funções encapuladas no módulo *****/
+
+	static void  trechoEstatisticas  ( const float * v , unsigned n , float base , float * pSoma ,
+	                                   float * pSomaQ , float * pMin , float * pMax )            ;
+	static float trechoSomaQuadrados ( const float * v , unsigned n )                           ;
+
+/*****  Código das funções exportadas pelo módulo  *****/
+
+/***************************************************************************
+*
+*  Função: VET  &Implementação em uso
+*  ****/
+
+	const char * VET_Implementacao( void )
+	{
+#if defined( VET_NEON )
+		return "neon" ;
+#elif defined( VET_SSE2 )
+		return "sse2" ;
+#else
+		return "escalar" ;
+#endif
+	}
+
+/***************************************************************************
+*
+*  Função: VET  &Multiplicar por escalar
+*  ****/
+
+	void VET_Escalar( const float * origem , float * destino , unsigned n , float fator )
+	{
+		unsigned i = 0 ;
+
+#if defined( VET_NEON )
+		float32x4_t f = vdupq_n_f32( fator ) ;
+
+		for ( ; i + 8 <= n ; i += 8 )
+		{
+			float32x4_t a = vld1q_f32( origem + i     ) ;
+			float32x4_t b = vld1q_f32( origem + i + 4 ) ;
+
+			vst1q_f32( destino + i     , vmulq_f32( a , f ) ) ;
+			vst1q_f32( destino + i + 4 , vmulq_f32( b , f ) ) ;
+		}
+#elif defined( VET_SSE2 )
+		__m128 f = _mm_set1_ps( fator ) ;
+
+		for ( ; i + 8 <= n ; i += 8 )
+		{
+			__m128 a = _mm_loadu_ps( origem + i     ) ;
+			__m128 b = _mm_loadu_ps( origem + i + 4 ) ;
+
+			_mm_storeu_ps( destino + i     , _mm_mul_ps( a , f ) ) ;
+			_mm_storeu_ps( destino + i + 4 , _mm_mul_ps( b , f ) ) ;
+		}
+#endif
+
+		for ( ; i < n ; i++ )
+		{
+			destino[ i ] = origem[ i ] * fator ;
+		}
+	}
+
+/***************************************************************************
+*
+*  Função: VET  &Converter radianos para graus
+*  ****/
+
+	void VET_RadParaGrau( const float * origem , float * destino , unsigned n )
+	{
+		VET_Escalar( origem , destino , n , VET_RAD_PARA_GRAU ) ;
+	}
+
+/***************************************************************************
+*
+*  Função: VET  &Calcular estatísticas
+*  ****/
+
+	VET_tpCondRet VET_Estatisticas( const float * v , unsigned n , VET_tpEstatisticas * pEst )
+	{
+		double   soma = 0.0 , somaQ = 0.0 , media ;
+		float    base , minimo , maximo ;
+		unsigned i ;
+
+		if ( n == 0 )
+		{
+			return VET_CondRetVazio ;
+		}
+
+		base   = v[ 0 ] ;
+		minimo = v[ 0 ] ;
+		maximo = v[ 0 ] ;
+
+		for ( i = 0 ; i < n ; i += VET_TRECHO )
+		{
+			unsigned tam = n - i < VET_TRECHO ? n - i : VET_TRECHO ;
+			float s , q , mn , mx ;
+
+			trechoEstatisticas( v + i , tam , base , &s , &q , &mn , &mx ) ;
+
+			soma  += s ;
+			somaQ += q ;
+
+			if ( mn < minimo )
+			{
+				minimo = mn ;
+			}
+
+			if ( mx > maximo )
+			{
+				maximo = mx ;
+			}
+		}
+
+		media = soma / n ;
+
+		pEst->media     = ( float ) ( base + media ) ;
+		pEst->variancia = ( float ) ( somaQ / n - media * media ) ;
+		pEst->minimo    = minimo ;
+		pEst->maximo    = maximo ;
+
+		if ( pEst->variancia < 0.0f )
+		{
+			pEst->variancia = 0.0f ;
+		}
+
+		return VET_CondRetOK ;
+	}
+
+/***************************************************************************
+*
+*  Função: VET  &Calcular valor RMS
+*  ****/
+
+	float VET_Rms( const float * v , unsigned n )
+	{
+		double   somaQ = 0.0 ;
+		unsigned i ;
+
+		if ( n == 0 )
+		{
+			return 0.0f ;
+		}
+
+		for ( i = 0 ; i < n ; i += VET_TRECHO )
+		{
+			somaQ += trechoSomaQuadrados( v + i , n - i < VET_TRECHO ? n - i : VET_TRECHO ) ;
+		}
+
+		return ( float ) sqrt( somaQ / n ) ;
+	}
+
+/*****  Código das funções encapsuladas no módulo  *****/
+
+	/***************************************************************************
+	*
+	*  Função: VET  & Soma, soma dos quadrados (deslocados por 'base'),
+	*                 mínimo e máximo de um trecho (n >= 1)
+	*  ****/
+
+	static void trechoEstatisticas( const float * v , unsigned n , float base , float * pSoma ,
+	                                float * pSomaQ , float * pMin , float * pMax )
+	{
+		float    s = 0.0f , q = 0.0f , mn = v[ 0 ] , mx = v[ 0 ] ;
+		unsigned i = 0 ;
+
+#if defined( VET_NEON )
+		float32x4_t vb  = vdupq_n_f32( base ) ;
+		float32x4_t vs  = vdupq_n_f32( 0.0f ) ;
+		float32x4_t vq  = vdupq_n_f32( 0.0f ) ;
+		float32x4_t vmn = vdupq_n_f32( v[ 0 ] ) ;
+		float32x4_t vmx = vdupq_n_f32( v[ 0 ] ) ;
+		float32x2_t par ;
+
+		for ( ; i + 4 <= n ; i += 4 )
+		{
+			float32x4_t x = vld1q_f32( v + i ) ;
+			float32x4_t d = vsubq_f32( x , vb ) ;
+
+			vs  = vaddq_f32( vs , d ) ;
+			vq  = vmlaq_f32( vq , d , d ) ;
+			vmn = vminq_f32( vmn , x ) ;
+			vmx = vmaxq_f32( vmx , x ) ;
+		}
+
+		par = vadd_f32( vget_low_f32( vs ) , vget_high_f32( vs ) ) ;
+		s   = vget_lane_f32( vpadd_f32( par , par ) , 0 ) ;
+		par = vadd_f32( vget_low_f32( vq ) , vget_high_f32( vq ) ) ;
+		q   = vget_lane_f32( vpadd_f32( par , par ) , 0 ) ;
+		par = vmin_f32( vget_low_f32( vmn ) , vget_high_f32( vmn ) ) ;
+		mn  = vget_lane_f32( vpmin_f32( par , par ) , 0 ) ;
+		par = vmax_f32( vget_low_f32( vmx ) , vget_high_f32( vmx ) ) ;
+		mx  = vget_lane_f32( vpmax_f32( par , par ) , 0 ) ;
+#elif defined( VET_SSE2 )
+		__m128 vb  = _mm_set1_ps( base ) ;
+		__m128 vs  = _mm_setzero_ps( ) ;
+		__m128 vq  = _mm_setzero_ps( ) ;
+		__m128 vmn = _mm_set1_ps( v[ 0 ] ) ;
+		__m128 vmx = _mm_set1_ps( v[ 0 ] ) ;
+		float  a[ 4 ] ;
+
+		for ( ; i + 4 <= n ; i += 4 )
+		{
+			__m128 x = _mm_loadu_ps( v + i ) ;
+			__m128 d = _mm_sub_ps( x , vb ) ;
+
+			vs  = _mm_add_ps( vs , d ) ;
+			vq  = _mm_add_ps( vq , _mm_mul_ps( d , d ) ) ;
+			vmn = _mm_min_ps( vmn , x ) ;
+			vmx = _mm_max_ps( vmx , x ) ;
+		}
+
+		_mm_storeu_ps( a , vs  ) ; s  = ( a[ 0 ] + a[ 1 ] ) + ( a[ 2 ] + a[ 3 ] ) ;
+		_mm_storeu_ps( a , vq  ) ; q  = ( a[ 0 ] + a[ 1 ] ) + ( a[ 2 ] + a[ 3 ] ) ;
+		_mm_storeu_ps( a , vmn ) ; mn = fminf( fminf( a[ 0 ] , a[ 1 ] ) , fminf( a[ 2 ] , a[ 3 ] ) ) ;
+		_mm_storeu_ps( a , vmx ) ; mx = fmaxf( fmaxf( a[ 0 ] , a[ 1 ] ) , fmaxf( a[ 2 ] , a[ 3 ] ) ) ;
+#else
+		/* Quatro acumuladores independentes: mesma ordem de soma das
+		   versões SIMD e sem dependência entre iterações */
+
+		float s4[ 4 ] = { 0.0f , 0.0f , 0.0f , 0.0f } ;
+		float q4[ 4 ] = { 0.0f , 0.0f , 0.0f , 0.0f } ;
+		int   j ;
+
+		for ( ; i + 4 <= n ; i += 4 )
+		{
+			for ( j = 0 ; j < 4 ; j++ )
+			{
+				float x = v[ i + j ] ;
+				float d = x - base ;
+
+				s4[ j ] += d ;
+				q4[ j ] += d * d ;
+				mn = x < mn ? x : mn ;
+				mx = x > mx ? x : mx ;
+			}
+		}
+
+		s = ( s4[ 0 ] + s4[ 1 ] ) + ( s4[ 2 ] + s4[ 3 ] ) ;
+		q = ( q4[ 0 ] + q4[ 1 ] ) + ( q4[ 2 ] + q4[ 3 ] ) ;
+#endif
+
+		for ( ; i < n ; i++ )
+		{
+			float d = v[ i ] - base ;
+
+			s += d ;
+			q += d * d ;
+			mn = v[ i ] < mn ? v[ i ] : mn ;
+			mx = v[ i ] > mx ? v[ i ] : mx ;
+		}
+
+		*pSoma  = s  ;
+		*pSomaQ = q  ;
+		*pMin   = mn ;
+		*pMax   = mx ;
+	}
+
+	/***************************************************************************
+	*
+	*  Função: VET  & Soma dos quadrados de um trecho
+	*  ****/
+
+	static float trechoSomaQuadrados( const float * v , unsigned n )
+	{
+		float    q = 0.0f ;
+		unsigned i = 0 ;
+
+#if defined( VET_NEON )
+		float32x4_t vq = vdupq_n_f32( 0.0f ) ;
+		float32x2_t par ;
+
+		for ( ; i + 4 <= n ; i += 4 )
+		{
+			float32x4_t x = vld1q_f32( v + i ) ;
+
+			vq = vmlaq_f32( vq , x , x ) ;
+		}
+
+		par = vadd_f32( vget_low_f32( vq ) , vget_high_f32( vq ) ) ;
+		q   = vget_lane_f32( vpadd_f32( par , par ) , 0 ) ;
+#elif defined( VET_SSE2 )
+		__m128 vq = _mm_setzero_ps( ) ;
+		float  a[ 4 ] ;
+
+		for ( ; i + 4 <= n ; i += 4 )
+		{
+			__m128 x = _mm_loadu_ps( v + i ) ;
+
+			vq = _mm_add_ps( vq , _mm_mul_ps( x , x ) ) ;
+		}
+
+		_mm_storeu_ps( a , vq ) ;
+		q = ( a[ 0 ] + a[ 1 ] ) + ( a[ 2 ] + a[ 3 ] ) ;
+#else
+		float q4[ 4 ] = { 0.0f , 0.0f , 0.0f , 0.0f } ;
+		int   j ;
+
+		for ( ; i + 4 <= n ; i += 4 )
+		{
+			for ( j = 0 ; j < 4 ; j++ )
+			{
+				q4[ j ] += v[ i + j ] * v[ i + j ] ;
+			}
+		}
+
+		q = ( q4[ 0 ] + q4[ 1 ] ) + ( q4[ 2 ] + q4[ 3 ] ) ;
+#endif
+
+		for ( ; i < n ; i++ )
+		{
+			q += v[ i ] * v[ i ] ;
+		}
+
+		return q ;
+	}
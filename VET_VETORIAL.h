@@ -0,0 +1,120 @@
+#ifndef VET_VETORIAL
+#define VET_VETORIAL
+
+/**************************************************************************************************************************
+*$MCD Módulo de definição
+*	  Nome : 	                Núcleos vetoriais sobre colunas de amostras
+*	  Proprietário :         	Equipe AeroRio
+*	  Projeto :		            SAE AeroDesign Brasil 2014
+*	  Gestor :	 	            Alessandro Soares da Silva Junior
+* 	  Arquivo : 	            VET_VETORIAL.H
+*	  Letras Identificadoras : 	VET
+*	  Autor : 	                Alessandro Soares da Silva Junior
+*
+*$ED Descrição do módulo
+*	Conversão de unidades e estatísticas sobre vetores contíguos de float, como as colunas de um LER_tpBloco
+*   (LER_FillParamBatch). Há uma implementação com NEON (ARM com Advanced SIMD), outra com SSE2 (x86) e uma
+*   escalar portátil, escolhidas na compilação; VET_Implementacao informa qual foi usada. Defina VET_SOMENTE_ESCALAR
+*   para forçar a escalar.
+*
+*   O Cortex-M4 do Pixhawk não tem NEON e usa a versão escalar; as versões SIMD atendem à análise em solo dos
+*   registros de voo. Nenhuma função exige alinhamento, mas colunas alinhadas a 16 bytes são mais rápidas.
+*
+*   As somas são feitas em float por trechos de VET_TRECHO elementos e acumuladas em double entre os trechos, e a
+*   variância é calculada sobre os valores deslocados pelo primeiro elemento, de modo que voos longos e grandezas com
+*   valor médio alto (pressão) não perdem precisão.
+*
+***************************************************************************************************************************/
+
+/***** Declarações exportadas pelo módulo *****/
+
+#define VET_TRECHO  1024
+
+/* Fator de LER_PARAMETROS.c, para que a conversão em lote coincida com a do LER */
+
+#define VET_RAD_PARA_GRAU  57.29747f
+
+/***********************************************************************
+*
+*  $TC Tipo de dados: VET Condições de retorno
+*
+***********************************************************************/
+
+   typedef enum {
+
+         VET_CondRetOK            ,
+              /* Executou corretamente                               */
+         VET_CondRetVazio         ,
+              /* Vetor sem elementos                                 */
+
+} VET_tpCondRet ;
+
+/***********************************************************************
+*
+*  $TC Tipo de dados: VET Estatísticas de um vetor
+*
+***********************************************************************/
+
+   typedef struct {
+
+         float media     ;
+         float variancia ;
+              /* Populacional (divide por n)                    */
+         float minimo    ;
+         float maximo    ;
+
+} VET_tpEstatisticas ;
+
+/***********************************************************************
+*
+*  $FC Função: VET  &Implementação em uso
+*
+*  $FV Valor retornado
+*     "neon", "sse2" ou "escalar".
+*
+***********************************************************************/
+
+const char * VET_Implementacao( void ) ;
+
+/***********************************************************************
+*
+*  $FC Função: VET  &Multiplicar por escalar
+*
+*  $ED Descrição da função
+*     destino[i] = origem[i] * fator. destino pode ser igual a origem.
+*
+***********************************************************************/
+
+void VET_Escalar( const float * origem , float * destino , unsigned n , float fator ) ;
+
+/***********************************************************************
+*
+*  $FC Função: VET  &Converter radianos para graus
+*
+***********************************************************************/
+
+void VET_RadParaGrau( const float * origem , float * destino , unsigned n ) ;
+
+/***********************************************************************
+*
+*  $FC Função: VET  &Calcular estatísticas
+*
+*  $FV Valor retornado
+*     VET_CondRetOK ou VET_CondRetVazio se n é zero.
+*
+***********************************************************************/
+
+VET_tpCondRet VET_Estatisticas( const float * v , unsigned n , VET_tpEstatisticas * pEst ) ;
+
+/***********************************************************************
+*
+*  $FC Função: VET  &Calcular valor RMS
+*
+*  $FV Valor retornado
+*     sqrt( soma( v[i]² ) / n ), ou 0 se n é zero.
+*
+***********************************************************************/
+
+float VET_Rms( const float * v , unsigned n ) ;
+
+#endif
@@ -0,0 +1,3845 @@
+/***************************************************************************
+*  $MCI Módulo de implementação: BNC Benchmark do módulo LER no host
+*
+*  Arquivo gerado:              BNC_LER.c
+*  Letras identificadoras:      BNC
+*
+*
+*  Projeto: SAE AeroDesign Brasil 2014
+*  Gestor:  Alessandro Soares da Silva Junior
+*  Autores: Alessandro Soares da Silva Junior
+*
+*  $ED Descrição do módulo
+*     Programa de medição do caminho de aquisição do LER sobre o
+*     substituto do uORB (SIM). Uso:
+*
+*        bnc_ler [-m modo] [-t segundos] [-a hz] [-s hz] [-p hz] [-T] [-c us] [-i ms] [-P ms] [-o arquivo] [-R ms]
+*                [-F hz] [-G grupos] [-V x]
+*
+*     -a, -s e -p são as taxas de publicação de vehicle_attitude,
+*     sensor_combined e vehicle_local_position. -T usa LER_ModoThread e
+*     -c espera o período dado entre chamadas, como um laço de controle,
+*     -i é o intervalo de todas as assinaturas do contexto LER e -P o
+*     prazo do poll (padrão 100 ms e 200 ms). -o é o arquivo gravado
+*     pelo modo "registro" e reproduzido pelo modo "compressao". -R liga
+*     o relator do LER com o período dado. -F liga no contexto LER um
+*     passa-baixa com o corte dado na aceleração e nas velocidades
+*     angulares. -G é a máscara de grupos pedidos ao contexto (LER_tpGrupo;
+*     1F = todos), para medir o custo de só parte dos tópicos. -V é a
+*     velocidade (múltiplo do tempo real) da passagem cadenciada do modo
+*     "reproducao", que refaz o voo do arquivo -o pelo relógio virtual.
+*     O relatório é escrito em stderr; em stdout fica só o que vier do
+*     relator do LER.
+*
+***************************************************************************/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <math.h>
+#include <pthread.h>
+#include <fcntl.h>
+#include <termios.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+
+#include <drivers/drv_hrt.h>
+
+#include <uORB/topics/sensor_combined.h>
+#include <uORB/topics/vehicle_attitude.h>
+#include <uORB/topics/vehicle_local_position.h>
+
+#include "SIM_UORB.h"
+#include "../LER_PARAMETROS.h"
+#include "../REG_REGISTRO.h"
+#include "../VET_VETORIAL.h"
+#include "../TLM_TELEMETRIA.h"
+#include "../AVS_AVISOS.h"
+#include "../SAU_SAUDE.h"
+
+/***********************************************************************
+*
+*  $TC Tipo de dados: BNC - Opções de linha de comando
+*
+***********************************************************************/
+
+typedef struct {
+	const char * modo       ;                  /* Benchmark a executar                      */
+	double       segundos   ;                  /* Duração da medição                        */
+	SIM_tpConfig sim        ;                  /* Taxas do gerador sintético                */
+	LER_tpConfig ler        ;                  /* Configuração do contexto LER              */
+	long         periodoUs  ;                  /* Espera entre chamadas (0 = sem espera)    */
+	const char * arquivo    ;                  /* Registro de voo do modo "registro"        */
+	unsigned     relatorMs  ;                  /* Período do relator do LER (0 = desligado) */
+	float        filtroHz   ;                  /* Corte do passa-baixa de -F (0 = sem filtro) */
+	float        velocidade ;                  /* Reprodução cadenciada do modo "reproducao"  */
+} tpOpcoes ;
+
+/***********************************************************************
+*
+*  $TC Tipo de dados: BNC - Histograma de latências
+*
+*  $ED Descrição do tipo
+*     Escala logarítmica com 16 sub-faixas por potência de 2 (erro < 7%),
+*     de modo que qualquer número de amostras cabe em memória fixa.
+*
+***********************************************************************/
+
+#define BNC_SUBFAIXAS  16
+#define BNC_FAIXAS     ( 64 * BNC_SUBFAIXAS )
+
+typedef struct {
+	unsigned long long contagem[ BNC_FAIXAS ] ;
+	unsigned long long total                  ;
+	unsigned long long maximo                 ;   /* em ns */
+} tpHistograma ;
+
+/***********************************************************************
+*
+*  $TC Tipo de dados: BNC - Entrada da tabela de benchmarks
+*
+***********************************************************************/
+
+typedef struct {
+	const char * nome ;
+	int ( * executar )( const tpOpcoes * pOpcoes ) ;
+} tpBenchmark ;
+
+/***********************************************************************
+*
+*  $TC Tipo de dados: BNC - Consumidor do modo "pool"
+*
+***********************************************************************/
+
+typedef struct {
+	LER_tpContexto   ctx        ;
+	pthread_t        thread     ;
+	unsigned long    ciclos     ;              /* Criar, ler e destruir                     */
+	unsigned long    comDados   ;              /* Ciclos em que FillParam trouxe dados      */
+	unsigned long    nulos      ;              /* LER_CriarParam ou LER_IniciarParam falhou */
+} tpConsumidorPool ;
+
+/***********************************************************************
+*
+*  $TC Tipo de dados: BNC - Enlace de telemetria sobre um pty
+*
+*  $ED Descrição do tipo
+*     O transmissor guarda, por número de sequência, a amostra e o
+*     instante de cada quadro; o receptor confere o que decodifica.
+*
+***********************************************************************/
+
+typedef struct {
+	int                 fd                    ;    /* Lado escravo do pty (receptor)            */
+	TLM_tpConfig        config                ;
+	volatile int        ativo                 ;
+	LER_tpAmostra       enviada[ 256 ]        ;
+	double              envio[ 256 ]          ;
+	tpHistograma        latencia              ;
+	unsigned long       bytes                 ;
+	unsigned long       recebidosCampo[ LER_NumCampos ] ;
+	unsigned long       errosValor            ;
+	TLM_tpEstatisticas  estatisticas          ;
+} tpEnlace ;
+
+/***********************************************************************
+*
+*  $TC Tipo de dados: BNC - Área compartilhada do modo "compartilhado"
+*
+*  $ED Descrição do tipo
+*     A região do LER e, em linhas de cache separadas, o resultado de
+*     cada processo leitor. Cada leitor abre e mapeia o objeto pelo nome,
+*     como faria uma tarefa independente.
+*
+***********************************************************************/
+
+#define BNC_MAX_LEITORES  8
+
+typedef struct {
+	tpHistograma        leitura               ;    /* Custo de LER_LerCompartilhado            */
+	tpHistograma        idade                 ;    /* Agora - timestamp da amostra nova        */
+	unsigned long long  leituras              ;
+	unsigned long long  novas                 ;    /* Publicações distintas vistas              */
+	unsigned long long  rasgadas              ;    /* Roll que não bate com o da sua origem     */
+	unsigned long long  regressoes            ;    /* Publicação ou origem que voltou atrás     */
+	int                 pronto                ;
+} __attribute__(( aligned( 64 ) )) tpLeitorCompartilhado ;
+
+typedef struct {
+	LER_tpCompartilhado   regiao ;
+	volatile int          estado __attribute__(( aligned( 64 ) )) ;    /* 0 = espera, 1 = mede, 2 = fim */
+	tpLeitorCompartilhado leitor[ BNC_MAX_LEITORES ] ;
+} tpAreaCompartilhada ;
+
+/***********************************************************************
+*
+*  $TC Tipo de dados: BNC - Assinante do modo "avisos"
+*
+*  $ED Descrição do tipo
+*     Espera por um limiar no roll e uma faixa morta na altura e confere
+*     cada disparo contra o anterior.
+*
+***********************************************************************/
+
+typedef struct {
+	AVS_tpAssinante     ass                   ;
+	pthread_t           thread                ;
+	unsigned            bitRoll , bitAltura   ;
+	float               limiteRoll , histerese , faixaAltura ;
+	unsigned long       despertares           ;
+	unsigned long       disparosRoll          ;
+	unsigned long       disparosAltura        ;
+	unsigned long       vazios                ;    /* Despertares sem nenhum bit                */
+	unsigned long       errados               ;    /* Disparo que a condição não justifica      */
+} tpVigilante ;
+
+/***** Variáveis Globais ******/
+
+static unsigned long chamadasHeap = 0 ;        /* malloc, calloc, realloc e free do processo */
+
+static volatile int  consumidoresAtivos = 0 ;
+
+/***** Protótipos das funções encapuladas no módulo *****/
+
+	static int      benchFillParam   ( const tpOpcoes * pOpcoes )          ;
+	static int      benchRegistro    ( const tpOpcoes * pOpcoes )          ;
+	static int      benchCompressao  ( const tpOpcoes * pOpcoes )          ;
+	static int      benchLote        ( const tpOpcoes * pOpcoes )          ;
+	static int      benchVetorial    ( const tpOpcoes * pOpcoes )          ;
+	static int      benchFiltro      ( const tpOpcoes * pOpcoes )          ;
+	static int      benchCaptura     ( const tpOpcoes * pOpcoes )          ;
+	static int      benchEspectro    ( const tpOpcoes * pOpcoes )          ;
+	static int      benchAlinhamento ( const tpOpcoes * pOpcoes )          ;
+	static int      benchRotacao     ( const tpOpcoes * pOpcoes )          ;
+	static int      benchVertical    ( const tpOpcoes * pOpcoes )          ;
+	static int      benchDemanda     ( const tpOpcoes * pOpcoes )          ;
+	static int      benchPool        ( const tpOpcoes * pOpcoes )          ;
+	static void *   consumidorPool   ( void * arg )                        ;
+	static int      benchTelemetria  ( const tpOpcoes * pOpcoes )          ;
+	static void *   receptorTelemetria( void * arg )                       ;
+	static int      conferirPlano    ( const TLM_tpConfig * pConfig , const TLM_tpPlano * pPlano ) ;
+	static int      benchCompartilhado( const tpOpcoes * pOpcoes )         ;
+	static int      benchAvisos      ( const tpOpcoes * pOpcoes )          ;
+	static void *   vigilanteAvisos  ( void * arg )                        ;
+	static int      benchSaude       ( const tpOpcoes * pOpcoes )          ;
+	static int      benchReproducao  ( const tpOpcoes * pOpcoes )          ;
+	static unsigned long compararAmostra( const LER_tpAmostra * pGravada , const LER_tpAmostra * pSaida ,
+	                                      unsigned grupos , int primeira ) ;
+	static uint64_t acumularHash     ( uint64_t hash , const LER_tpAmostra * pAmostra ) ;
+	static void     leitorCompartilhado( const char * nome , unsigned indice , int porCampo ) ;
+	static double   agoraSeg         ( void )                              ;
+	static void     registrarNs      ( tpHistograma * pHist , unsigned long long ns ) ;
+	static double   percentilUs      ( const tpHistograma * pHist , double p )         ;
+	static void     imprimirLatencia ( const char * rotulo , const tpHistograma * pHist ) ;
+	static unsigned percentilLerUs   ( const LER_tpHistograma * pHist , double p )     ;
+	static void     configurarFiltro ( tpOpcoes * pOpcoes )                            ;
+	static float    rollSimulado     ( hrt_abstime instante )                          ;
+	static void     montarRotacao    ( LER_tpParametros param , float R[ 3 ][ 3 ] )    ;
+	static void     acumularDiferenca( float valor , unsigned long indice , double * pAnterior ,
+	                                   double * pSomaQ , double * pNum )                ;
+
+/***** Tabela de benchmarks *****/
+
+static const tpBenchmark benchmarks[ ] = {
+	{ "fill"       , benchFillParam  } ,
+	{ "registro"   , benchRegistro   } ,
+	{ "compressao" , benchCompressao } ,
+	{ "lote"       , benchLote       } ,
+	{ "vetorial"   , benchVetorial   } ,
+	{ "filtro"     , benchFiltro     } ,
+	{ "captura"    , benchCaptura    } ,
+	{ "espectro"   , benchEspectro   } ,
+	{ "alinhamento", benchAlinhamento } ,
+	{ "rotacao"    , benchRotacao    } ,
+	{ "vertical"   , benchVertical   } ,
+	{ "demanda"    , benchDemanda    } ,
+	{ "pool"       , benchPool       } ,
+	{ "telemetria" , benchTelemetria } ,
+	{ "compartilhado", benchCompartilhado } ,
+	{ "avisos"     , benchAvisos     } ,
+	{ "saude"      , benchSaude      } ,
+	{ "reproducao" , benchReproducao } ,
+} ;
+
+#define NUM_BENCHMARKS ( sizeof( benchmarks ) / sizeof( benchmarks[ 0 ] ) )
+
+#define BNC_TAM_BRUTO  ( 8 + 4 + 4 * LER_NumCampos + 4 * LER_NumGrupos )   /* Registro não comprimido do REG */
+
+/*****  Código das funções exportadas pelo módulo  *****/
+
+#ifdef __GLIBC__
+
+/***************************************************************************
+*
+*  Função: BNC  & Contagem das chamadas ao heap
+*
+*  Substituem as da glibc no programa inteiro (inclusive nas threads do
+*  LER e do SIM) só para contar; a alocação é a própria da glibc.
+*  ****/
+
+	extern void * __libc_malloc ( size_t tamanho ) ;
+	extern void * __libc_calloc ( size_t n , size_t tamanho ) ;
+	extern void * __libc_realloc( void * p , size_t tamanho ) ;
+	extern void   __libc_free   ( void * p ) ;
+
+	void * malloc( size_t tamanho )
+	{
+		__atomic_add_fetch( &chamadasHeap , 1 , __ATOMIC_RELAXED ) ;
+		return __libc_malloc( tamanho ) ;
+	}
+
+	void * calloc( size_t n , size_t tamanho )
+	{
+		__atomic_add_fetch( &chamadasHeap , 1 , __ATOMIC_RELAXED ) ;
+		return __libc_calloc( n , tamanho ) ;
+	}
+
+	void * realloc( void * p , size_t tamanho )
+	{
+		__atomic_add_fetch( &chamadasHeap , 1 , __ATOMIC_RELAXED ) ;
+		return __libc_realloc( p , tamanho ) ;
+	}
+
+	void free( void * p )
+	{
+		__atomic_add_fetch( &chamadasHeap , 1 , __ATOMIC_RELAXED ) ;
+		__libc_free( p ) ;
+	}
+
+#endif
+
+	int main( int argc , char * argv[ ] )
+	{
+		tpOpcoes opcoes ;
+		unsigned i ;
+		int opt ;
+
+		opcoes.modo                               = "fill" ;
+		opcoes.segundos                           = 10.0   ;
+		opcoes.sim.taxaHz[ SIM_TopicoAtitude ]    = 250.0f ;
+		opcoes.sim.taxaHz[ SIM_TopicoSensor ]     = 250.0f ;
+		opcoes.sim.taxaHz[ SIM_TopicoPosicao ]    = 50.0f  ;
+		opcoes.periodoUs                          = 0      ;
+		opcoes.arquivo                            = "voo.bin" ;
+		opcoes.relatorMs                          = 0      ;
+		opcoes.filtroHz                           = 0.0f   ;
+		opcoes.velocidade                         = 20.0f  ;
+
+		LER_ConfigPadrao( &opcoes.ler ) ;
+
+		while ( ( opt = getopt( argc , argv , "m:t:a:s:p:Tc:i:P:o:R:F:G:V:" ) ) != -1 )
+		{
+			switch ( opt )
+			{
+				case 'm' : opcoes.modo = optarg                                      ; break ;
+				case 't' : opcoes.segundos = atof( optarg )                          ; break ;
+				case 'a' : opcoes.sim.taxaHz[ SIM_TopicoAtitude ] = atof( optarg )   ; break ;
+				case 's' : opcoes.sim.taxaHz[ SIM_TopicoSensor ]  = atof( optarg )   ; break ;
+				case 'p' : opcoes.sim.taxaHz[ SIM_TopicoPosicao ] = atof( optarg )   ; break ;
+				case 'T' : opcoes.ler.modo = LER_ModoThread                          ; break ;
+				case 'c' : opcoes.periodoUs = atol( optarg )                         ; break ;
+				case 'i' :
+					for ( i = 0 ; i < LER_NumTopicos ; i++ )
+					{
+						opcoes.ler.intervaloMs[ i ] = ( unsigned ) atoi( optarg ) ;
+					}
+					break ;
+				case 'P' : opcoes.ler.prazoPollMs = atoi( optarg )                   ; break ;
+				case 'o' : opcoes.arquivo = optarg                                   ; break ;
+				case 'R' : opcoes.relatorMs = ( unsigned ) atoi( optarg )            ; break ;
+				case 'F' : opcoes.filtroHz = ( float ) atof( optarg )                ; break ;
+				case 'G' : opcoes.ler.grupos = ( unsigned ) strtoul( optarg , NULL , 16 ) ; break ;
+				case 'V' : opcoes.velocidade = ( float ) atof( optarg )              ; break ;
+				default  :
+					fprintf( stderr , "uso: %s [-m modo] [-t segundos] [-a hz] [-s hz] [-p hz] [-T] [-c us] [-i ms] [-P ms] [-o arquivo] [-R ms] [-F hz] [-G grupos] [-V x]\n" , argv[ 0 ] ) ;
+					return 1 ;
+			}
+		}
+
+		configurarFiltro( &opcoes ) ;
+
+		for ( i = 0 ; i < NUM_BENCHMARKS ; i++ )
+		{
+			if ( strcmp( benchmarks[ i ].nome , opcoes.modo ) == 0 )
+			{
+				return benchmarks[ i ].executar( &opcoes ) ;
+			}
+		}
+
+		fprintf( stderr , "modo desconhecido: %s\n" , opcoes.modo ) ;
+		return 1 ;
+	}
+
+/*****  Código das funções encapsuladas no módulo  *****/
+
+	/***************************************************************************
+	*
+	*  Função: BNC  & Latência de LER_FillParam e contadores por tópico
+	*  ****/
+
+	static int benchFillParam( const tpOpcoes * pOpcoes )
+	{
+		static const char * nomes[ SIM_NumTopicos ] = { "sensor_combined" , "vehicle_local_position" , "vehicle_attitude" } ;
+		static tpHistograma hist ;
+
+		LER_tpParametros  param ;
+		LER_tpContexto    ctx   ;
+		LER_tpDiagnostico diag  ;
+		unsigned long ok = 0 , parciais = 0 , erros = 0 ;
+		double inicio , fim ;
+		int t ;
+
+		param = LER_CriarParam( ) ;
+
+		if ( param == NULL )
+		{
+			fprintf( stderr , "sem memoria\n" ) ;
+			return 1 ;
+		}
+
+		if ( LER_Iniciar( &ctx , &pOpcoes->ler ) != LER_CondRetOK || SIM_Iniciar( &pOpcoes->sim ) != SIM_CondRetOK )
+		{
+			fprintf( stderr , "falha ao iniciar\n" ) ;
+			return 1 ;
+		}
+
+		if ( pOpcoes->relatorMs > 0 )
+		{
+			LER_IniciarRelator( ctx , pOpcoes->relatorMs ) ;
+		}
+
+		memset( &hist , 0 , sizeof( hist ) ) ;
+
+		inicio = agoraSeg( ) ;
+		fim    = inicio + pOpcoes->segundos ;
+
+		for ( ;; )
+		{
+			double t0 = agoraSeg( ) ;
+
+			if ( t0 >= fim )
+			{
+				break ;
+			}
+
+			switch ( LER_FillParam( ctx , param ) )
+			{
+				case LER_CondRetOK      : ok ++       ; break ;
+				case LER_CondRetParcial : parciais ++ ; break ;
+				default                 : erros ++    ; break ;
+			}
+
+			registrarNs( &hist , ( unsigned long long ) ( ( agoraSeg( ) - t0 ) * 1e9 ) ) ;
+
+			if ( pOpcoes->periodoUs > 0 )
+			{
+				usleep( ( useconds_t ) pOpcoes->periodoUs ) ;
+			}
+		}
+
+		fim = agoraSeg( ) ;
+
+		SIM_Parar( ) ;
+
+		fprintf( stderr , "\n=== LER_FillParam %s (%.1f s, att %.0f Hz, sensor %.0f Hz, pos %.0f Hz) ===\n" ,
+		         pOpcoes->ler.modo == LER_ModoThread ? "thread" : "sincrono" ,
+		         fim - inicio , pOpcoes->sim.taxaHz[ SIM_TopicoAtitude ] ,
+		         pOpcoes->sim.taxaHz[ SIM_TopicoSensor ] , pOpcoes->sim.taxaHz[ SIM_TopicoPosicao ] ) ;
+		fprintf( stderr , "chamadas      : %llu (%lu OK, %lu parcial, %lu erro)\n" , hist.total , ok , parciais , erros ) ;
+		fprintf( stderr , "amostras/s    : %.1f (OK: %.1f)\n" , hist.total / ( fim - inicio ) , ok / ( fim - inicio ) ) ;
+		imprimirLatencia( "latencia (us) :" , &hist ) ;
+
+		fprintf( stderr , "%-24s %10s %10s %10s %10s %12s\n" , "topico" , "publicados" , "copiados" ,
+		         "perdidos" , "repetidos" , "taxa LER Hz" ) ;
+
+		for ( t = 0 ; t < SIM_NumTopicos ; t++ )
+		{
+			SIM_tpContadores cont ;
+
+			SIM_ObterContadores( ( SIM_tpTopico ) t , &cont ) ;
+			fprintf( stderr , "%-24s %10lu %10lu %10lu %10lu %12.1f\n" , nomes[ t ] ,
+			         cont.publicados , cont.copiados , cont.perdidos , cont.repetidos ,
+			         LER_TaxaEfetiva( ctx , ( LER_tpTopico ) t ) ) ;
+		}
+
+		LER_ObterDiagnostico( ctx , &diag ) ;
+
+		fprintf( stderr , "poll          : %u despertares, %u sem dados, %u erros, %u z invalido\n" ,
+		         diag.despertares , diag.prazosEsgotados , diag.errosPoll , diag.alturaInvalida ) ;
+		fprintf( stderr , "%-24s %8s %8s %16s %16s\n" , "topico (LER)" , "faltas" , "repetid" ,
+		         "orb_copy p50/p99" , "idade p50/p99" ) ;
+
+		for ( t = 0 ; t < LER_NumTopicos ; t++ )
+		{
+			fprintf( stderr , "%-24s %8u %8u %7u/%-8u %7u/%-8u\n" , nomes[ t ] , diag.faltas[ t ] , diag.repetidos[ t ] ,
+			         percentilLerUs( &diag.duracaoCopia[ t ] , 0.50 ) , percentilLerUs( &diag.duracaoCopia[ t ] , 0.99 ) ,
+			         percentilLerUs( &diag.idade[ t ] , 0.50 ) , percentilLerUs( &diag.idade[ t ] , 0.99 ) ) ;
+		}
+
+		LER_Terminar( ctx ) ;
+		LER_DestruirParam( param ) ;
+
+		return 0 ;
+	}
+
+	/***************************************************************************
+	*
+	*  Função: BNC  & Gravação do registro de voo durante a aquisição e
+	*                 busca por instante no arquivo gravado
+	*  ****/
+
+	static int benchRegistro( const tpOpcoes * pOpcoes )
+	{
+		static tpHistograma hist ;
+
+		LER_tpParametros   param   ;
+		LER_tpContexto     ctx     ;
+		REG_tpRegistro     reg     ;
+		REG_tpLeitor       leitor  ;
+		REG_tpEstatisticas est     ;
+		LER_tpAmostra      primeira , ultima , amostra ;
+		uint64_t           n , i , pos ;
+		unsigned long      erros = 0 ;
+		double             inicio , fim ;
+
+		param = LER_CriarParam( ) ;
+
+		if ( param == NULL || REG_Abrir( pOpcoes->arquivo , &reg ) != REG_CondRetOK )
+		{
+			fprintf( stderr , "falha ao criar %s\n" , pOpcoes->arquivo ) ;
+			return 1 ;
+		}
+
+		if ( LER_Iniciar( &ctx , &pOpcoes->ler ) != LER_CondRetOK || SIM_Iniciar( &pOpcoes->sim ) != SIM_CondRetOK )
+		{
+			fprintf( stderr , "falha ao iniciar\n" ) ;
+			return 1 ;
+		}
+
+		LER_AssociarRegistro( ctx , reg ) ;
+
+		inicio = agoraSeg( ) ;
+		fim    = inicio + pOpcoes->segundos ;
+
+		while ( agoraSeg( ) < fim )
+		{
+			LER_FillParam( ctx , param ) ;
+
+			if ( pOpcoes->periodoUs > 0 )
+			{
+				usleep( ( useconds_t ) pOpcoes->periodoUs ) ;
+			}
+		}
+
+		LER_AssociarRegistro( ctx , NULL ) ;
+		LER_Terminar( ctx ) ;
+		SIM_Parar( ) ;
+
+		REG_ObterEstatisticas( reg , &est ) ;
+
+		if ( REG_Fechar( reg ) != REG_CondRetOK )
+		{
+			fprintf( stderr , "falha ao fechar %s\n" , pOpcoes->arquivo ) ;
+			return 1 ;
+		}
+
+		fprintf( stderr , "\n=== registro %s (%.1f s) ===\n" , pOpcoes->arquivo , pOpcoes->segundos ) ;
+		fprintf( stderr , "gravados      : %llu (%.1f/s), descartados %llu, blocos %llu\n" ,
+		         ( unsigned long long ) est.gravados , est.gravados / pOpcoes->segundos ,
+		         ( unsigned long long ) est.descartados , ( unsigned long long ) est.blocos ) ;
+
+		/* Leitura: confere o arquivo e mede a busca por instante */
+
+		if ( REG_AbrirLeitura( pOpcoes->arquivo , &leitor ) != REG_CondRetOK )
+		{
+			fprintf( stderr , "falha ao ler %s\n" , pOpcoes->arquivo ) ;
+			return 1 ;
+		}
+
+		n = REG_NumRegistros( leitor ) ;
+
+		if ( n != est.gravados || n == 0 )
+		{
+			fprintf( stderr , "arquivo com %llu registros\n" , ( unsigned long long ) n ) ;
+			REG_FecharLeitura( leitor ) ;
+			return 1 ;
+		}
+
+		REG_Ler( leitor , 0     , &primeira ) ;
+		REG_Ler( leitor , n - 1 , &ultima   ) ;
+
+		memset( &hist , 0 , sizeof( hist ) ) ;
+		srand( 1 ) ;
+
+		for ( i = 0 ; i < 100000 ; i++ )
+		{
+			uint64_t instante = primeira.timestamp +
+			                    ( uint64_t ) ( ( double ) rand( ) / RAND_MAX * ( double ) ( ultima.timestamp - primeira.timestamp ) ) ;
+			double t0 = agoraSeg( ) ;
+
+			if ( REG_Buscar( leitor , instante , &pos ) != REG_CondRetOK )
+			{
+				erros ++ ;
+				continue ;
+			}
+
+			registrarNs( &hist , ( unsigned long long ) ( ( agoraSeg( ) - t0 ) * 1e9 ) ) ;
+
+			/* Primeiro registro com timestamp >= instante */
+
+			REG_Ler( leitor , pos , &amostra ) ;
+
+			if ( amostra.timestamp < instante )
+			{
+				erros ++ ;
+			}
+			else if ( pos > 0 )
+			{
+				REG_Ler( leitor , pos - 1 , &amostra ) ;
+
+				if ( amostra.timestamp >= instante )
+				{
+					erros ++ ;
+				}
+			}
+		}
+
+		fprintf( stderr , "buscas        : %llu (%lu erradas)\n" , hist.total , erros ) ;
+		imprimirLatencia( "busca (us)    :" , &hist ) ;
+
+		REG_FecharLeitura( leitor ) ;
+		LER_DestruirParam( param ) ;
+
+		return erros == 0 ? 0 : 1 ;
+	}
+
+	/***************************************************************************
+	*
+	*  Função: BNC  & Compressão CMP sobre um registro gravado
+	*
+	*  Reproduz as amostras do arquivo -o: mede codificação e decodificação
+	*  em memória e a taxa de compressão, confere a volta (timestamps,
+	*  origens e grupos exatos, campos dentro de meia resolução) e grava o mesmo voo
+	*  com REG_AbrirComprimido, conferindo leitura e busca contra o original.
+	*  ****/
+
+	static int benchCompressao( const tpOpcoes * pOpcoes )
+	{
+		static unsigned char blocos[ 2 ][ REG_TAM_BLOCO ] ;
+		static LER_tpAmostra decod[ CMP_MAX_AMOSTRAS( REG_TAM_BLOCO ) ] ;
+
+		CMP_tpConfig      config ;
+		CMP_tpCodificador cod    ;
+		REG_tpLeitor      leitor , leitorCmp ;
+		REG_tpRegistro    regCmp ;
+		LER_tpAmostra *   amostras ;
+		LER_tpAmostra     a , b ;
+		char              caminhoCmp[ 512 ] ;
+		uint64_t          n , i , pos , posCmp ;
+		unsigned long     erros = 0 , numBlocos = 0 ;
+		unsigned long long bytesUsados = 0 ;
+		double            t0 , tCod = 0.0 , tDec = 0.0 ;
+		unsigned          k , numDecod , usadoBloco ;
+		int               c , rep , repeticoes ;
+
+		if ( REG_AbrirLeitura( pOpcoes->arquivo , &leitor ) != REG_CondRetOK )
+		{
+			fprintf( stderr , "falha ao ler %s (gravar antes com -m registro)\n" , pOpcoes->arquivo ) ;
+			return 1 ;
+		}
+
+		n = REG_NumRegistros( leitor ) ;
+		amostras = ( LER_tpAmostra * ) malloc( ( size_t ) ( n + 1 ) * sizeof( LER_tpAmostra ) ) ;
+
+		if ( amostras == NULL || n == 0 )
+		{
+			fprintf( stderr , "registro vazio\n" ) ;
+			return 1 ;
+		}
+
+		for ( i = 0 ; i < n ; i++ )
+		{
+			REG_Ler( leitor , i , &amostras[ i ] ) ;
+		}
+
+		CMP_ConfigPadrao( &config ) ;
+
+		/* Várias passagens para medir com poucos registros */
+
+		repeticoes = ( int ) ( 2000000 / n ) + 1 ;
+
+		for ( rep = 0 ; rep < repeticoes ; rep++ )
+		{
+			uint64_t base = 0 ;
+
+			i = 0 ;
+
+			while ( i < n )
+			{
+				t0 = agoraSeg( ) ;
+
+				CMP_IniciarBloco( &cod , &config , blocos[ 0 ] , REG_TAM_BLOCO , base ) ;
+
+				while ( i < n && CMP_Acrescentar( &cod , &amostras[ i ] ) == CMP_CondRetOK )
+				{
+					i ++ ;
+				}
+
+				usadoBloco = CMP_FecharBloco( &cod ) ;
+				tCod += agoraSeg( ) - t0 ;
+
+				t0 = agoraSeg( ) ;
+
+				if ( CMP_DecodificarBloco( &config , blocos[ 0 ] , REG_TAM_BLOCO , decod ,
+				                           CMP_MAX_AMOSTRAS( REG_TAM_BLOCO ) , &numDecod ) != CMP_CondRetOK ||
+				     numDecod != CMP_NumAmostras( &cod ) )
+				{
+					erros ++ ;
+					break ;
+				}
+
+				tDec += agoraSeg( ) - t0 ;
+
+				if ( rep == 0 )
+				{
+					numBlocos   ++ ;
+					bytesUsados += usadoBloco ;
+
+					for ( k = 0 ; k < numDecod ; k++ )
+					{
+						const LER_tpAmostra * pOrig = &amostras[ base + k ] ;
+
+						if ( decod[ k ].timestamp != pOrig->timestamp || decod[ k ].validos != pOrig->validos ||
+						     decod[ k ].novos != pOrig->novos ||
+						     memcmp( decod[ k ].origem , pOrig->origem , sizeof( pOrig->origem ) ) != 0 )
+						{
+							erros ++ ;
+							continue ;
+						}
+
+						for ( c = 0 ; c < LER_NumCampos ; c++ )
+						{
+							float tol = config.resolucao[ c ] * 0.5f * 1.001f + fabsf( pOrig->valor[ c ] ) * 1e-6f ;
+
+							if ( fabsf( decod[ k ].valor[ c ] - pOrig->valor[ c ] ) > tol )
+							{
+								erros ++ ;
+							}
+						}
+					}
+				}
+
+				base = i ;
+			}
+		}
+
+		fprintf( stderr , "\n=== compressao %s (%llu amostras, %d passagens) ===\n" , pOpcoes->arquivo ,
+		         ( unsigned long long ) n , repeticoes ) ;
+		fprintf( stderr , "tamanho       : bruto %llu B, CMP %llu B em %lu blocos (%.2f B/amostra)\n" ,
+		         ( unsigned long long ) n * BNC_TAM_BRUTO , bytesUsados , numBlocos ,
+		         ( double ) bytesUsados / ( double ) n ) ;
+		fprintf( stderr , "taxa          : %.2fx (blocos inteiros: %.2fx)\n" ,
+		         ( double ) n * BNC_TAM_BRUTO / ( double ) bytesUsados ,
+		         ( double ) n * BNC_TAM_BRUTO / ( ( double ) numBlocos * REG_TAM_BLOCO ) ) ;
+		fprintf( stderr , "codificacao   : %.1f Mamostras/s (%.1f MB/s brutos)\n" ,
+		         ( double ) n * repeticoes / tCod * 1e-6 , ( double ) n * repeticoes * BNC_TAM_BRUTO / tCod * 1e-6 ) ;
+		fprintf( stderr , "decodificacao : %.1f Mamostras/s (%.1f MB/s brutos)\n" ,
+		         ( double ) n * repeticoes / tDec * 1e-6 , ( double ) n * repeticoes * BNC_TAM_BRUTO / tDec * 1e-6 ) ;
+
+		/* Mesmo voo pelo REG comprimido: leitura sequencial e busca */
+
+		snprintf( caminhoCmp , sizeof( caminhoCmp ) , "%s.cmp" , pOpcoes->arquivo ) ;
+
+		if ( REG_AbrirComprimido( caminhoCmp , &config , &regCmp ) != REG_CondRetOK )
+		{
+			fprintf( stderr , "falha ao criar %s\n" , caminhoCmp ) ;
+			return 1 ;
+		}
+
+		REG_MarcarFiltrados( regCmp , REG_CamposFiltrados( leitor ) ) ;
+
+		for ( i = 0 ; i < n ; i++ )
+		{
+			/* Sem pressa aqui: espera a escritora em vez de descartar */
+
+			while ( REG_Escrever( regCmp , &amostras[ i ] ) == REG_CondRetDescartado )
+			{
+				usleep( 100 ) ;
+			}
+		}
+
+		if ( REG_Fechar( regCmp ) != REG_CondRetOK ||
+		     REG_AbrirLeitura( caminhoCmp , &leitorCmp ) != REG_CondRetOK ||
+		     REG_NumRegistros( leitorCmp ) != n || REG_CamposFiltrados( leitorCmp ) != REG_CamposFiltrados( leitor ) )
+		{
+			fprintf( stderr , "falha no registro comprimido %s\n" , caminhoCmp ) ;
+			return 1 ;
+		}
+
+		for ( i = 0 ; i < n ; i++ )
+		{
+			if ( REG_Ler( leitorCmp , i , &a ) != REG_CondRetOK || a.timestamp != amostras[ i ].timestamp ||
+			     memcmp( a.origem , amostras[ i ].origem , sizeof( a.origem ) ) != 0 )
+			{
+				erros ++ ;
+			}
+		}
+
+		srand( 1 ) ;
+
+		for ( i = 0 ; i < 10000 ; i++ )
+		{
+			uint64_t instante = amostras[ 0 ].timestamp +
+			                    ( uint64_t ) ( ( double ) rand( ) / RAND_MAX * ( double ) ( amostras[ n - 1 ].timestamp - amostras[ 0 ].timestamp + 2 ) ) ;
+			REG_tpCondRet r1 = REG_Buscar( leitor , instante , &pos ) ;
+			REG_tpCondRet r2 = REG_Buscar( leitorCmp , instante , &posCmp ) ;
+
+			if ( r1 != r2 || ( r1 == REG_CondRetOK && pos != posCmp ) )
+			{
+				erros ++ ;
+			}
+		}
+
+		REG_Ler( leitorCmp , n - 1 , &b ) ;
+
+		fprintf( stderr , "arquivo CMP   : %s, volta e busca %s (%lu erros)\n" , caminhoCmp ,
+		         erros == 0 ? "OK" : "FALHOU" , erros ) ;
+
+		REG_FecharLeitura( leitorCmp ) ;
+		REG_FecharLeitura( leitor ) ;
+		free( amostras ) ;
+
+		return erros == 0 ? 0 : 1 ;
+	}
+
+	/***************************************************************************
+	*
+	*  Função: BNC  & Drenagem do histórico em blocos SoA
+	*
+	*  A thread de aquisição alimenta o histórico; o consumidor drena a
+	*  cada -c us (padrão 20 ms) e confere que os timestamps seguem em
+	*  ordem, sem repetição, de um bloco para o outro.
+	*  ****/
+
+	static int benchLote( const tpOpcoes * pOpcoes )
+	{
+		static unsigned char memoria[ LER_MEMORIA_BLOCO( 256 ) ] ;
+		static tpHistograma hist ;
+
+		LER_tpConfig   config = pOpcoes->ler ;
+		LER_tpContexto ctx    ;
+		LER_tpBloco    bloco  ;
+		LER_tpCondRet  ret    ;
+		uint64_t       ultimo = 0 ;
+		unsigned long  amostras = 0 , blocos = 0 , erros = 0 ;
+		double         inicio , fim , t0 ;
+		unsigned       k ;
+
+		config.modo = LER_ModoThread ;
+
+		if ( LER_Iniciar( &ctx , &config ) != LER_CondRetOK || LER_AtivarHistorico( ctx , 1024 ) != LER_CondRetOK ||
+		     SIM_Iniciar( &pOpcoes->sim ) != SIM_CondRetOK )
+		{
+			fprintf( stderr , "falha ao iniciar\n" ) ;
+			return 1 ;
+		}
+
+		LER_MontarBloco( &bloco , memoria , 256 ) ;
+		memset( &hist , 0 , sizeof( hist ) ) ;
+
+		inicio = agoraSeg( ) ;
+		fim    = inicio + pOpcoes->segundos ;
+
+		while ( agoraSeg( ) < fim )
+		{
+			usleep( ( useconds_t ) ( pOpcoes->periodoUs > 0 ? pOpcoes->periodoUs : 20000 ) ) ;
+
+			do
+			{
+				t0  = agoraSeg( ) ;
+				ret = LER_FillParamBatch( ctx , ultimo , &bloco ) ;
+
+				if ( bloco.numAmostras == 0 )
+				{
+					break ;
+				}
+
+				registrarNs( &hist , ( unsigned long long ) ( ( agoraSeg( ) - t0 ) * 1e9 ) ) ;
+
+				for ( k = 0 ; k < bloco.numAmostras ; k++ )
+				{
+					if ( bloco.timestamp[ k ] <= ultimo )
+					{
+						erros ++ ;
+					}
+
+					ultimo = bloco.timestamp[ k ] ;
+				}
+
+				amostras += bloco.numAmostras ;
+				blocos   ++ ;
+			} while ( ret == LER_CondRetParcial ) ;
+		}
+
+		fim = agoraSeg( ) ;
+
+		LER_Terminar( ctx ) ;
+		SIM_Parar( ) ;
+
+		fprintf( stderr , "\n=== LER_FillParamBatch (%.1f s, bloco de %u) ===\n" , fim - inicio , bloco.capacidade ) ;
+		fprintf( stderr , "amostras      : %lu em %lu blocos (%.1f/s), %lu fora de ordem\n" ,
+		         amostras , blocos , amostras / ( fim - inicio ) , erros ) ;
+		imprimirLatencia( "drenagem (us) :" , &hist ) ;
+
+		return erros == 0 ? 0 : 1 ;
+	}
+
+	/***************************************************************************
+	*
+	*  Função: BNC  & Captura em taxa plena ao lado de um contexto LER
+	*
+	*  O contexto continua com o intervalo da linha de comando (100 ms
+	*  por padrão) enquanto a captura recebe todas as publicações do
+	*  sensor_combined. A vibração de 80 Hz do SIM é medida pelo rms da
+	*  diferença entre amostras consecutivas de ax (a manobra lenta quase
+	*  não contribui) no fluxo bruto, numa decimação ingênua (uma a cada
+	*  'fator' amostras brutas) e no fluxo decimado com anti-aliasing.
+	*  Publicações que a captura não copiou (publicados menos capturadas)
+	*  e lacunas contam contra um orçamento de 1% das publicações, mais a
+	*  que pode estar a caminho quando o SIM para.
+	*  ****/
+
+	static int benchCaptura( const tpOpcoes * pOpcoes )
+	{
+		static CAP_tpAmostra buf[ 512 ] ;
+
+		LER_tpConfig     config = pOpcoes->ler ;
+		CAP_tpConfig     capCfg ;
+		CAP_tpContadores cont ;
+		SIM_tpContadores pub ;
+		LER_tpContexto   ctx ;
+		CAP_tpCaptura    cap ;
+		uint32_t         cursor[ CAP_NumFluxos ] = { 0 , 0 } ;
+		uint64_t         ultimo[ CAP_NumFluxos ] = { 0 , 0 } ;
+		unsigned long    lidas[ CAP_NumFluxos ] = { 0 , 0 } , perdidas = 0 , erros = 0 ;
+		unsigned long    naoCapturadas , orcamento ;
+		double           anterior[ 3 ] = { 0 } , somaQ[ 3 ] = { 0 } , diferencas[ 3 ] = { 0 } ;
+		double           inicio , fim , taxaLer ;
+		unsigned         n , k , f ;
+
+		config.modo = LER_ModoThread ;
+
+		CAP_ConfigPadrao( &capCfg ) ;
+		capCfg.taxaHz = pOpcoes->sim.taxaHz[ SIM_TopicoSensor ] ;
+
+		if ( LER_Iniciar( &ctx , &config ) != LER_CondRetOK || LER_AtivarCaptura( ctx , &capCfg ) != LER_CondRetOK ||
+		     SIM_Iniciar( &pOpcoes->sim ) != SIM_CondRetOK )
+		{
+			fprintf( stderr , "falha ao iniciar\n" ) ;
+			return 1 ;
+		}
+
+		cap = LER_ObterCaptura( ctx ) ;
+
+		inicio = agoraSeg( ) ;
+		fim    = inicio + pOpcoes->segundos ;
+
+		while ( agoraSeg( ) < fim )
+		{
+			usleep( ( useconds_t ) ( pOpcoes->periodoUs > 0 ? pOpcoes->periodoUs : 20000 ) ) ;
+
+			for ( f = 0 ; f < CAP_NumFluxos ; f++ )
+			{
+				uint32_t p ;
+
+				while ( CAP_Ler( cap , ( CAP_tpFluxo ) f , &cursor[ f ] , buf , 512 , &n , &p ) == CAP_CondRetOK )
+				{
+					perdidas += p ;
+
+					for ( k = 0 ; k < n ; k++ )
+					{
+						/* 0: bruto, 1: ingênuo (uma a cada 'fator' brutas), 2: decimado */
+
+						unsigned s = f == CAP_FluxoBruto ? 0 : 2 ;
+
+						if ( buf[ k ].timestamp <= ultimo[ f ] )
+						{
+							erros ++ ;
+						}
+
+						ultimo[ f ] = buf[ k ].timestamp ;
+
+						acumularDiferenca( buf[ k ].acel[ 0 ] , lidas[ f ] + k , &anterior[ s ] , &somaQ[ s ] , &diferencas[ s ] ) ;
+
+						if ( f == CAP_FluxoBruto && ( lidas[ f ] + k ) % capCfg.fator == 0 )
+						{
+							acumularDiferenca( buf[ k ].acel[ 0 ] , ( lidas[ f ] + k ) / capCfg.fator ,
+							                   &anterior[ 1 ] , &somaQ[ 1 ] , &diferencas[ 1 ] ) ;
+						}
+					}
+
+					lidas[ f ] += n ;
+				}
+			}
+		}
+
+		fim     = agoraSeg( ) ;
+		taxaLer = LER_TaxaEfetiva( ctx , LER_TopicoSensor ) ;
+
+		SIM_Parar( ) ;
+
+		/* A thread da captura pode estar no meio da última publicação, com
+		   o bruto já contado e o decimado não: com o SIM parado, um prazo
+		   de poll basta para ela terminar */
+
+		usleep( ( useconds_t ) capCfg.prazoPollMs * 1000 ) ;
+		CAP_ObterContadores( cap , &cont ) ;
+		SIM_ObterContadores( SIM_TopicoSensor , &pub ) ;
+		LER_Terminar( ctx ) ;
+
+		fprintf( stderr , "\n=== CAP (%.1f s, sensor %.0f Hz, fator %u) ===\n" , fim - inicio ,
+		         pOpcoes->sim.taxaHz[ SIM_TopicoSensor ] , capCfg.fator ) ;
+		fprintf( stderr , "publicados    : %lu\n" , pub.publicados ) ;
+		fprintf( stderr , "bruto         : %u capturadas (%.1f/s), %lu lidas, %u lacunas, %u repetidas\n" ,
+		         cont.amostras[ CAP_FluxoBruto ] , cont.amostras[ CAP_FluxoBruto ] / ( fim - inicio ) ,
+		         lidas[ CAP_FluxoBruto ] , cont.lacunas , cont.repetidas ) ;
+		naoCapturadas = pub.publicados > cont.amostras[ CAP_FluxoBruto ] ? pub.publicados - cont.amostras[ CAP_FluxoBruto ] : 0 ;
+		orcamento     = pub.publicados / 100 + 1 ;
+
+		fprintf( stderr , "perda         : %lu publicacoes nao capturadas, %u lacunas (orcamento %lu)\n" ,
+		         naoCapturadas , cont.lacunas , orcamento ) ;
+		fprintf( stderr , "decimado      : %u capturadas (%.1f/s), %lu lidas\n" , cont.amostras[ CAP_FluxoDecimado ] ,
+		         cont.amostras[ CAP_FluxoDecimado ] / ( fim - inicio ) , lidas[ CAP_FluxoDecimado ] ) ;
+		fprintf( stderr , "leitor        : %lu perdidas, %lu fora de ordem\n" , perdidas , erros ) ;
+		fprintf( stderr , "contexto LER  : sensor_combined a %.1f Hz (intervalo %u ms)\n" ,
+		         taxaLer , config.intervaloMs[ LER_TopicoSensor ] ) ;
+
+		for ( k = 0 ; k < 3 ; k++ )
+		{
+			static const char * rotulos[ 3 ] = { "bruto" , "ingenuo" , "decimado" } ;
+
+			fprintf( stderr , "vibracao ax %-9s: %.4f m/s2 rms entre amostras\n" , rotulos[ k ] ,
+			         diferencas[ k ] > 0 ? sqrt( somaQ[ k ] / diferencas[ k ] ) : 0.0 ) ;
+		}
+
+		if ( cont.amostras[ CAP_FluxoDecimado ] != cont.amostras[ CAP_FluxoBruto ] / capCfg.fator ||
+		     cont.amostras[ CAP_FluxoBruto ] > pub.publicados || naoCapturadas > orcamento || cont.lacunas > orcamento )
+		{
+			erros ++ ;
+		}
+
+		fprintf( stderr , "conferencia   : %s\n" , erros == 0 ? "OK" : "FALHOU" ) ;
+
+		return erros == 0 ? 0 : 1 ;
+	}
+
+	/***************************************************************************
+	*
+	*  Função: BNC  & Custo por janela e exatidão do espectro ESP
+	*
+	*  Parte sintética a 1 kHz com senoides conhecidas em cada eixo:
+	*  confere a frequência dos picos e a energia das bandas contra a
+	*  variância teórica (A²/2) e mede o custo de cada janela (ciclos
+	*  pelo TSC em x86, senão só ns). Depois roda o caminho completo,
+	*  LER + captura + análise sobre o SIM, cuja vibração é de 80 Hz.
+	*  ****/
+
+	static int benchEspectro( const tpOpcoes * pOpcoes )
+	{
+		static ESP_tpAnalisador analisador ;
+		static ESP_tpResultado  res ;
+		static float            re[ ESP_TAM_JANELA ] , im[ ESP_TAM_JANELA ] ;
+
+		static const struct {
+			int   eixo ;
+			float freqHz ;
+			float amplitude ;
+			int   banda ;
+		} tons[ ] = {
+			{ 0 ,  80.0f , 0.30f , 1 } ,
+			{ 1 , 123.0f , 0.50f , 2 } ,
+			{ 2 ,  40.0f , 0.20f , 0 } ,
+			{ 2 , 210.0f , 0.10f , 3 } ,
+		} ;
+
+		const unsigned   amostras = 1u << 20 ;
+		ESP_tpConfig     config ;
+		LER_tpConfig     lerCfg = pOpcoes->ler ;
+		CAP_tpConfig     capCfg ;
+		LER_tpContexto   ctx ;
+		float *          sinal ;
+		double           t0 , t ;
+		unsigned long long c0 = 0 , ciclos = 0 ;
+		unsigned         i , k , janelas , resultados = 0 , erros = 0 ;
+		int              e ;
+
+		ESP_ConfigPadrao( &config ) ;
+		config.taxaHz = 1000.0f ;
+		config.bandaHz[ 0 ][ 0 ] = 1.0f   ; config.bandaHz[ 0 ][ 1 ] = 50.0f  ;
+		config.bandaHz[ 1 ][ 0 ] = 50.0f  ; config.bandaHz[ 1 ][ 1 ] = 100.0f ;
+		config.bandaHz[ 2 ][ 0 ] = 100.0f ; config.bandaHz[ 2 ][ 1 ] = 200.0f ;
+		config.bandaHz[ 3 ][ 0 ] = 200.0f ; config.bandaHz[ 3 ][ 1 ] = 500.0f ;
+
+		if ( ESP_Iniciar( &analisador , &config ) != ESP_CondRetOK )
+		{
+			fprintf( stderr , "falha ao iniciar\n" ) ;
+			return 1 ;
+		}
+
+		sinal = ( float * ) malloc( ( size_t ) amostras * ESP_NUM_EIXOS * sizeof( float ) ) ;
+
+		if ( sinal == NULL )
+		{
+			fprintf( stderr , "sem memoria\n" ) ;
+			return 1 ;
+		}
+
+		srand( 1 ) ;
+
+		for ( i = 0 ; i < amostras ; i++ )
+		{
+			double tempo = i / ( double ) config.taxaHz ;
+			float * acel = &sinal[ i * ESP_NUM_EIXOS ] ;
+
+			acel[ 0 ] = 0.0f ;
+			acel[ 1 ] = 0.0f ;
+			acel[ 2 ] = -9.81f ;
+
+			for ( k = 0 ; k < sizeof( tons ) / sizeof( tons[ 0 ] ) ; k++ )
+			{
+				acel[ tons[ k ].eixo ] += ( float ) ( tons[ k ].amplitude * sin( 2 * M_PI * tons[ k ].freqHz * tempo ) ) ;
+			}
+
+			for ( e = 0 ; e < ESP_NUM_EIXOS ; e++ )
+			{
+				acel[ e ] += 0.01f * ( ( float ) rand( ) / RAND_MAX - 0.5f ) ;
+			}
+		}
+
+		t0 = agoraSeg( ) ;
+#if defined( __x86_64__ ) || defined( __i386__ )
+		c0 = __builtin_ia32_rdtsc( ) ;
+#endif
+
+		for ( i = 0 ; i < amostras ; i++ )
+		{
+			resultados += ESP_Acrescentar( &analisador , ( uint64_t ) i * 1000u , &sinal[ i * ESP_NUM_EIXOS ] ) ;
+		}
+
+#if defined( __x86_64__ ) || defined( __i386__ )
+		ciclos = __builtin_ia32_rdtsc( ) - c0 ;
+#endif
+		t = agoraSeg( ) - t0 ;
+
+		free( sinal ) ;
+
+		janelas = ( amostras - ESP_TAM_JANELA ) / ( ESP_TAM_JANELA / 2 ) + 1 ;
+
+		fprintf( stderr , "\n=== ESP (janela %d, %u amostras a %.0f Hz, %u janelas, %u resultados) ===\n" ,
+		         ESP_TAM_JANELA , amostras , config.taxaHz , janelas , resultados ) ;
+		fprintf( stderr , "por janela    : %.2f us (amostras + 2 FFT + Welch)" , t / janelas * 1e6 ) ;
+
+		if ( ciclos != 0 )
+		{
+			fprintf( stderr , ", %.0f ciclos TSC" , ( double ) ciclos / janelas ) ;
+		}
+
+		fprintf( stderr , "\n" ) ;
+
+		/* FFT isolada */
+
+		t0 = agoraSeg( ) ;
+#if defined( __x86_64__ ) || defined( __i386__ )
+		c0 = __builtin_ia32_rdtsc( ) ;
+#endif
+		for ( i = 0 ; i < 20000 ; i++ )
+		{
+			for ( k = 0 ; k < ESP_TAM_JANELA ; k++ )
+			{
+				re[ k ] = ( float ) ( k & 7 ) ;
+				im[ k ] = 0.0f ;
+			}
+
+			ESP_Transformar( &analisador , re , im ) ;
+		}
+#if defined( __x86_64__ ) || defined( __i386__ )
+		ciclos = __builtin_ia32_rdtsc( ) - c0 ;
+#endif
+		t = agoraSeg( ) - t0 ;
+
+		fprintf( stderr , "FFT %d pontos: %.2f us" , ESP_TAM_JANELA , t / 20000 * 1e6 ) ;
+
+		if ( ciclos != 0 )
+		{
+			fprintf( stderr , ", %.0f ciclos TSC" , ( double ) ciclos / 20000 ) ;
+		}
+
+		fprintf( stderr , "\n" ) ;
+
+		ESP_ObterResultado( &analisador , &res ) ;
+
+		for ( k = 0 ; k < sizeof( tons ) / sizeof( tons[ 0 ] ) ; k++ )
+		{
+			int   eixo     = tons[ k ].eixo ;
+			float esperada = 0.5f * tons[ k ].amplitude * tons[ k ].amplitude ;
+			float energia  = res.energiaBanda[ eixo ][ tons[ k ].banda ] ;
+			float melhor   = 1e9f ;
+			int   p , ok ;
+
+			for ( p = 0 ; p < ESP_MAX_PICOS ; p++ )
+			{
+				if ( res.pico[ eixo ][ p ].densidade > 0.0f && fabsf( res.pico[ eixo ][ p ].freqHz - tons[ k ].freqHz ) < melhor )
+				{
+					melhor = fabsf( res.pico[ eixo ][ p ].freqHz - tons[ k ].freqHz ) ;
+				}
+			}
+
+			ok = melhor < 0.5f * res.resolucaoHz && fabsf( energia - esperada ) < 0.1f * esperada ;
+
+			if ( ! ok )
+			{
+				erros ++ ;
+			}
+
+			fprintf( stderr , "eixo %d %5.1f Hz: erro do pico %.3f Hz (raia %.2f Hz)  banda %.5f / %.5f (m/s2)2  %s\n" ,
+			         eixo , tons[ k ].freqHz , melhor , res.resolucaoHz , energia , esperada , ok ? "OK" : "FALHOU" ) ;
+		}
+
+		/* Caminho completo sobre o SIM */
+
+		CAP_ConfigPadrao( &capCfg ) ;
+		ESP_ConfigPadrao( &config ) ;
+		capCfg.taxaHz = pOpcoes->sim.taxaHz[ SIM_TopicoSensor ] ;
+		config.taxaHz = capCfg.taxaHz ;
+		lerCfg.modo   = LER_ModoThread ;
+
+		if ( LER_Iniciar( &ctx , &lerCfg ) != LER_CondRetOK || LER_AtivarCaptura( ctx , &capCfg ) != LER_CondRetOK ||
+		     LER_AtivarVibracao( ctx , &config ) != LER_CondRetOK || SIM_Iniciar( &pOpcoes->sim ) != SIM_CondRetOK )
+		{
+			fprintf( stderr , "falha ao iniciar\n" ) ;
+			return 1 ;
+		}
+
+		fprintf( stderr , "SIM (sensor %.0f Hz, %.1f s):\n" , capCfg.taxaHz , pOpcoes->segundos ) ;
+
+		res.numResultado = 0 ;
+		t0 = agoraSeg( ) ;
+
+		while ( agoraSeg( ) - t0 < pOpcoes->segundos )
+		{
+			uint32_t anterior = res.numResultado ;
+
+			usleep( 100000 ) ;
+
+			if ( LER_ObterVibracao( ctx , &res ) == LER_CondRetOK && res.numResultado != anterior )
+			{
+				fprintf( stderr , "  resultado %u:" , res.numResultado ) ;
+
+				for ( e = 0 ; e < ESP_NUM_EIXOS ; e++ )
+				{
+					fprintf( stderr , "  %c pico %.1f Hz rms %.3f" , 'x' + e , res.pico[ e ][ 0 ].freqHz , res.rms[ e ] ) ;
+				}
+
+				fprintf( stderr , "\n" ) ;
+			}
+		}
+
+		SIM_Parar( ) ;
+		LER_Terminar( ctx ) ;
+
+		fprintf( stderr , "conferencia   : %s\n" , erros == 0 ? "OK" : "FALHOU" ) ;
+
+		return erros == 0 ? 0 : 1 ;
+	}
+
+	/***************************************************************************
+	*
+	*  Função: BNC  & Núcleos VET contra o laço escalar equivalente
+	*
+	*  Colunas sintéticas do tamanho de um voo longo (4 M amostras): uma
+	*  pressão com ruído e uma aceleração com vibração. O laço escalar é
+	*  a referência: a conversão deve ser idêntica e as estatísticas,
+	*  calculadas em double, devem coincidir dentro da precisão do float.
+	*  ****/
+
+	static int benchVetorial( const tpOpcoes * pOpcoes )
+	{
+		const unsigned n = 4u << 20 ;
+		const int      repeticoes = 10 ;
+
+		float *  pressao = ( float * ) malloc( n * sizeof( float ) ) ;
+		float *  acel    = ( float * ) malloc( n * sizeof( float ) ) ;
+		float *  saida   = ( float * ) malloc( n * sizeof( float ) ) ;
+		float *  refer   = ( float * ) malloc( n * sizeof( float ) ) ;
+		VET_tpEstatisticas est ;
+		double   t0 , tVet , tEsc , soma , somaQ , media , variancia , rms = 0.0 ;
+		float    minimo , maximo , rmsVet = 0.0f ;
+		unsigned i , erros = 0 ;
+		int      r ;
+
+		( void ) pOpcoes ;
+
+		if ( pressao == NULL || acel == NULL || saida == NULL || refer == NULL )
+		{
+			fprintf( stderr , "sem memoria\n" ) ;
+			return 1 ;
+		}
+
+		srand( 1 ) ;
+
+		for ( i = 0 ; i < n ; i++ )
+		{
+			double t = i * 0.004 ;
+
+			pressao[ i ] = ( float ) ( 1013.25 - 2.4 * sin( 0.126 * t ) + 0.05 * ( ( double ) rand( ) / RAND_MAX - 0.5 ) ) ;
+			acel[ i ]    = ( float ) ( -9.81 + 0.3 * sin( 2 * M_PI * 80 * t ) + 0.2 * sin( 2.5 * t ) ) ;
+		}
+
+		fprintf( stderr , "\n=== VET (%s, %u amostras, %d passagens) ===\n" , VET_Implementacao( ) , n , repeticoes ) ;
+
+		/* Conversão rad -> graus */
+
+		t0 = agoraSeg( ) ;
+		for ( r = 0 ; r < repeticoes ; r++ )
+		{
+			VET_RadParaGrau( acel , saida , n ) ;
+		}
+		tVet = agoraSeg( ) - t0 ;
+
+		t0 = agoraSeg( ) ;
+		for ( r = 0 ; r < repeticoes ; r++ )
+		{
+			for ( i = 0 ; i < n ; i++ )
+			{
+				refer[ i ] = acel[ i ] * VET_RAD_PARA_GRAU ;
+			}
+			__asm__ volatile( "" : : "r"( refer ) : "memory" ) ;
+		}
+		tEsc = agoraSeg( ) - t0 ;
+
+		if ( memcmp( saida , refer , n * sizeof( float ) ) != 0 )
+		{
+			erros ++ ;
+		}
+
+		fprintf( stderr , "rad->graus    : %.3f ns/amostra (escalar %.3f, %.1fx)\n" ,
+		         tVet / repeticoes / n * 1e9 , tEsc / repeticoes / n * 1e9 , tEsc / tVet ) ;
+
+		/* Estatísticas: a referência escalar é em double, em duas passagens */
+
+		t0 = agoraSeg( ) ;
+		for ( r = 0 ; r < repeticoes ; r++ )
+		{
+			VET_Estatisticas( pressao , n , &est ) ;
+		}
+		tVet = agoraSeg( ) - t0 ;
+
+		t0 = agoraSeg( ) ;
+		for ( r = 0 ; r < repeticoes ; r++ )
+		{
+			soma   = 0.0 ;
+			minimo = pressao[ 0 ] ;
+			maximo = pressao[ 0 ] ;
+
+			for ( i = 0 ; i < n ; i++ )
+			{
+				soma  += pressao[ i ] ;
+				minimo = pressao[ i ] < minimo ? pressao[ i ] : minimo ;
+				maximo = pressao[ i ] > maximo ? pressao[ i ] : maximo ;
+			}
+
+			media = soma / n ;
+			somaQ = 0.0 ;
+
+			for ( i = 0 ; i < n ; i++ )
+			{
+				somaQ += ( pressao[ i ] - media ) * ( pressao[ i ] - media ) ;
+			}
+
+			variancia = somaQ / n ;
+		}
+		tEsc = agoraSeg( ) - t0 ;
+
+		if ( fabs( est.media - media ) > 1e-4 || fabs( est.variancia - variancia ) > 1e-3 * variancia ||
+		     est.minimo != minimo || est.maximo != maximo )
+		{
+			erros ++ ;
+		}
+
+		fprintf( stderr , "estatisticas  : %.3f ns/amostra (escalar %.3f, %.1fx)  media %.4f/%.4f var %.5f/%.5f\n" ,
+		         tVet / repeticoes / n * 1e9 , tEsc / repeticoes / n * 1e9 , tEsc / tVet ,
+		         est.media , media , est.variancia , variancia ) ;
+
+		/* RMS */
+
+		t0 = agoraSeg( ) ;
+		for ( r = 0 ; r < repeticoes ; r++ )
+		{
+			rmsVet = VET_Rms( acel , n ) ;
+		}
+		tVet = agoraSeg( ) - t0 ;
+
+		t0 = agoraSeg( ) ;
+		for ( r = 0 ; r < repeticoes ; r++ )
+		{
+			somaQ = 0.0 ;
+
+			for ( i = 0 ; i < n ; i++ )
+			{
+				somaQ += ( double ) acel[ i ] * acel[ i ] ;
+			}
+
+			rms = sqrt( somaQ / n ) ;
+		}
+		tEsc = agoraSeg( ) - t0 ;
+
+		if ( fabs( rmsVet - rms ) > 1e-5 * rms )
+		{
+			erros ++ ;
+		}
+
+		fprintf( stderr , "rms           : %.3f ns/amostra (escalar %.3f, %.1fx)  %.6f/%.6f\n" ,
+		         tVet / repeticoes / n * 1e9 , tEsc / repeticoes / n * 1e9 , tEsc / tVet , rmsVet , rms ) ;
+		fprintf( stderr , "conferencia   : %s\n" , erros == 0 ? "OK" : "FALHOU" ) ;
+
+		free( pressao ) ;
+		free( acel ) ;
+		free( saida ) ;
+		free( refer ) ;
+
+		return erros == 0 ? 0 : 1 ;
+	}
+
+	/***************************************************************************
+	*
+	*  Função: BNC  & Custo por amostra e atenuação dos filtros FLT
+	*
+	*  Acelerômetro sintético a 1 kHz: gravidade, manobra de 1 Hz e
+	*  vibração de 80 Hz. Mede o custo de cada cadeia e quanto da vibração
+	*  sobra na saída (segunda metade, já em regime). Confere também que a
+	*  primeira amostra não produz transitório.
+	*  ****/
+
+	static int benchFiltro( const tpOpcoes * pOpcoes )
+	{
+		const unsigned n    = 4u << 20 ;
+		const float    taxa = 1000.0f ;
+
+		static const struct {
+			const char *        rotulo ;
+			unsigned            numEstagios ;
+			FLT_tpEstagioConfig estagio[ FLT_MAX_ESTAGIOS ] ;
+			double              minimoDb ;         /* Atenuação mínima exigida a 80 Hz */
+		} cadeias[ ] = {
+			{ "passa-baixa 30 Hz" , 1 , { { FLT_PassaBaixa , 30.0f , 0.7071f , 0 } } , 12.0 } ,
+			{ "notch 80 Hz q=2"   , 1 , { { FLT_Notch      , 80.0f , 2.0f    , 0 } } , 20.0 } ,
+			{ "media movel 8"     , 1 , { { FLT_MediaMovel , 0.0f  , 0.0f    , 8 } } ,  3.0 } ,
+			{ "cadeia completa"   , 3 , { { FLT_PassaBaixa , 30.0f , 0.7071f , 0 } ,
+			                              { FLT_Notch      , 80.0f , 2.0f    , 0 } ,
+			                              { FLT_MediaMovel , 0.0f  , 0.0f    , 8 } } , 25.0 } ,
+		} ;
+
+		float *  entrada = ( float * ) malloc( n * sizeof( float ) ) ;
+		float *  lenta   = ( float * ) malloc( n * sizeof( float ) ) ;
+		float *  saida   = ( float * ) malloc( n * sizeof( float ) ) ;
+		unsigned c , i , erros = 0 ;
+
+		( void ) pOpcoes ;
+
+		if ( entrada == NULL || lenta == NULL || saida == NULL )
+		{
+			fprintf( stderr , "sem memoria\n" ) ;
+			return 1 ;
+		}
+
+		for ( i = 0 ; i < n ; i++ )
+		{
+			double t = i / ( double ) taxa ;
+
+			lenta[ i ]   = ( float ) ( -9.81 + 0.2 * sin( 2 * M_PI * t ) ) ;
+			entrada[ i ] = lenta[ i ] + ( float ) ( 0.5 * sin( 2 * M_PI * 80 * t ) ) ;
+		}
+
+		fprintf( stderr , "\n=== FLT (%u amostras a %.0f Hz, vibracao de 80 Hz) ===\n" , n , taxa ) ;
+
+		for ( c = 0 ; c < sizeof( cadeias ) / sizeof( cadeias[ 0 ] ) ; c++ )
+		{
+			FLT_tpConfig config ;
+			FLT_tpCanal  canal ;
+			double       t0 , t , somaE = 0.0 , somaS = 0.0 , db ;
+			float        partida ;
+			int          ok ;
+
+			config.taxaHz      = taxa ;
+			config.numEstagios = cadeias[ c ].numEstagios ;
+			memcpy( config.estagio , cadeias[ c ].estagio , sizeof( config.estagio ) ) ;
+
+			if ( FLT_IniciarCanal( &canal , &config ) != FLT_CondRetOK )
+			{
+				fprintf( stderr , "%-18s: configuracao rejeitada\n" , cadeias[ c ].rotulo ) ;
+				erros ++ ;
+				continue ;
+			}
+
+			/* Partida: entrada constante deve sair igual desde a primeira amostra */
+
+			partida = FLT_Filtrar( &canal , -9.81f ) ;
+
+			for ( i = 0 ; i < 100 ; i++ )
+			{
+				float y = FLT_Filtrar( &canal , -9.81f ) ;
+
+				partida = fabsf( y + 9.81f ) > fabsf( partida + 9.81f ) ? y : partida ;
+			}
+
+			FLT_IniciarCanal( &canal , &config ) ;
+
+			t0 = agoraSeg( ) ;
+			for ( i = 0 ; i < n ; i++ )
+			{
+				saida[ i ] = FLT_Filtrar( &canal , entrada[ i ] ) ;
+			}
+			t = agoraSeg( ) - t0 ;
+
+			for ( i = n / 2 ; i < n ; i++ )
+			{
+				somaE += ( double ) ( entrada[ i ] - lenta[ i ] ) * ( entrada[ i ] - lenta[ i ] ) ;
+				somaS += ( double ) ( saida[ i ]   - lenta[ i ] ) * ( saida[ i ]   - lenta[ i ] ) ;
+			}
+
+			db = 10.0 * log10( somaE / ( somaS > 0.0 ? somaS : 1e-30 ) ) ;
+			ok = db >= cadeias[ c ].minimoDb && fabsf( partida + 9.81f ) < 1e-4f ;
+
+			if ( ! ok )
+			{
+				erros ++ ;
+			}
+
+			fprintf( stderr , "%-18s: %6.2f ns/amostra  residuo 80 Hz %.4f -> %.4f m/s2 rms (%5.1f dB)  partida %+.6f  %s\n" ,
+			         cadeias[ c ].rotulo , t / n * 1e9 , sqrt( somaE / ( n - n / 2 ) ) , sqrt( somaS / ( n - n / 2 ) ) ,
+			         db , partida + 9.81f , ok ? "OK" : "FALHOU" ) ;
+		}
+
+		fprintf( stderr , "conferencia       : %s\n" , erros == 0 ? "OK" : "FALHOU" ) ;
+
+		free( entrada ) ;
+		free( lenta ) ;
+		free( saida ) ;
+
+		return erros == 0 ? 0 : 1 ;
+	}
+
+	/***************************************************************************
+	*
+	*  Função: BNC  & Alinhamento no tempo dos grupos
+	*
+	*  Dois contextos em LER_ModoThread sobre o mesmo SIM, um lido por
+	*  LER_FillParam e outro por LER_FillParamAlinhado. Compara a
+	*  dispersão das origens dos grupos com o erro do alinhamento e o
+	*  roll de cada um com o roll exato do SIM no instante que a
+	*  estrutura atribui aos dados (no bruto, a origem da altura, que é
+	*  o tópico mais lento). Os intervalos de assinatura maiores que um
+	*  quinto da janela são encurtados para ela (os dois contextos usam os
+	*  mesmos), e o alinhado tem de errar menos que o bruto.
+	*  ****/
+
+	static int benchAlinhamento( const tpOpcoes * pOpcoes )
+	{
+		static const char * nomes[ LER_NumGrupos ] = { "pressao" , "vel. angular" , "atitude" , "aceleracao" , "altura" } ;
+		static tpHistograma dispersao , atraso , custo , erro[ LER_NumGrupos ] ;
+
+		LER_tpConfig      config = pOpcoes->ler ;
+		LER_tpParametros  bruto , alinhado ;
+		LER_tpContexto    ctxBruto , ctxAlinhado ;
+		LER_tpAlinhamento info ;
+		unsigned long     leituras = 0 , retidos = 0 , falhas = 0 ;
+		double            somaQBruto = 0.0 , somaQAlinhado = 0.0 ;
+		unsigned long     nBruto = 0 , nAlinhado = 0 ;
+		double            inicio , fim , rmsBruto , rmsAlinhado ;
+		int               g ;
+
+		config.modo = LER_ModoThread ;
+
+		if ( config.alinhamentoMs == 0 )
+		{
+			config.alinhamentoMs = 50 ;
+		}
+
+		/* Cada tópico tem de chegar várias vezes dentro da janela */
+
+		for ( g = 0 ; g < LER_NumTopicos ; g++ )
+		{
+			if ( config.intervaloMs[ g ] > config.alinhamentoMs / 5 )
+			{
+				config.intervaloMs[ g ] = config.alinhamentoMs / 5 ;
+			}
+		}
+
+		bruto    = LER_CriarParam( ) ;
+		alinhado = LER_CriarParam( ) ;
+
+		if ( bruto == NULL || alinhado == NULL ||
+		     LER_Iniciar( &ctxBruto , &config ) != LER_CondRetOK || LER_Iniciar( &ctxAlinhado , &config ) != LER_CondRetOK ||
+		     SIM_Iniciar( &pOpcoes->sim ) != SIM_CondRetOK )
+		{
+			fprintf( stderr , "falha ao iniciar\n" ) ;
+			return 1 ;
+		}
+
+		inicio = agoraSeg( ) ;
+		fim    = inicio + pOpcoes->segundos ;
+
+		while ( agoraSeg( ) < fim )
+		{
+			LER_tpCondRet ret ;
+			double        t0 ;
+
+			usleep( ( useconds_t ) ( pOpcoes->periodoUs > 0 ? pOpcoes->periodoUs : 4000 ) ) ;
+
+			if ( LER_FillParam( ctxBruto , bruto ) != LER_CondRetError &&
+			     LER_GruposValidos( bruto ) == LER_TODOS_GRUPOS )
+			{
+				uint64_t menor = ~0ULL , maior = 0 , ref ;
+				float    roll ;
+
+				for ( g = 0 ; g < LER_NumGrupos ; g++ )
+				{
+					uint64_t o = LER_TimestampGrupo( bruto , ( LER_tpGrupo ) g ) ;
+
+					menor = o < menor ? o : menor ;
+					maior = o > maior ? o : maior ;
+				}
+
+				registrarNs( &dispersao , ( maior - menor ) * 1000ULL ) ;
+
+				ref  = LER_TimestampGrupo( bruto , LER_GrupoAltura ) ;
+				roll = LER_RollAngle( bruto ) - rollSimulado( ref ) ;
+
+				somaQBruto += ( double ) roll * roll ;
+				nBruto ++ ;
+			}
+
+			t0  = agoraSeg( ) ;
+			ret = LER_FillParamAlinhado( ctxAlinhado , alinhado , &info ) ;
+			registrarNs( &custo , ( unsigned long long ) ( ( agoraSeg( ) - t0 ) * 1e9 ) ) ;
+
+			if ( ret == LER_CondRetError || LER_GruposValidos( alinhado ) != LER_TODOS_GRUPOS )
+			{
+				continue ;
+			}
+
+			leituras ++ ;
+
+			if ( info.retidos != 0 )
+			{
+				retidos ++ ;
+			}
+
+			for ( g = 0 ; g < LER_NumGrupos ; g++ )
+			{
+				registrarNs( &erro[ g ] , ( unsigned long long ) info.erroUs[ g ] * 1000ULL ) ;
+
+				if ( LER_TimestampGrupo( alinhado , ( LER_tpGrupo ) g ) != info.instante )
+				{
+					falhas ++ ;
+				}
+			}
+
+			registrarNs( &atraso , ( hrt_absolute_time( ) - info.instante ) * 1000ULL ) ;
+
+			{
+				float roll = LER_RollAngle( alinhado ) - rollSimulado( info.instante ) ;
+
+				somaQAlinhado += ( double ) roll * roll ;
+				nAlinhado ++ ;
+			}
+		}
+
+		fim = agoraSeg( ) ;
+
+		SIM_Parar( ) ;
+		LER_Terminar( ctxBruto ) ;
+		LER_Terminar( ctxAlinhado ) ;
+
+		fprintf( stderr , "\n=== Alinhamento (%.1f s, att %.0f Hz, sensor %.0f Hz, pos %.0f Hz, atraso max %u ms) ===\n" ,
+		         fim - inicio , pOpcoes->sim.taxaHz[ SIM_TopicoAtitude ] , pOpcoes->sim.taxaHz[ SIM_TopicoSensor ] ,
+		         pOpcoes->sim.taxaHz[ SIM_TopicoPosicao ] , config.alinhamentoMs ) ;
+		fprintf( stderr , "leituras      : %lu alinhadas (%lu com grupo retido)\n" , leituras , retidos ) ;
+		imprimirLatencia( "custo (us)    :" , &custo ) ;
+		imprimirLatencia( "bruto: dispersao das origens (us)     :" , &dispersao ) ;
+		imprimirLatencia( "alinhado: idade do instante comum (us):" , &atraso ) ;
+
+		for ( g = 0 ; g < LER_NumGrupos ; g++ )
+		{
+			char rotulo[ 64 ] ;
+
+			snprintf( rotulo , sizeof( rotulo ) , "alinhado: erro %-12s (us)       :" , nomes[ g ] ) ;
+			imprimirLatencia( rotulo , &erro[ g ] ) ;
+		}
+
+		rmsBruto    = nBruto    > 0 ? sqrt( somaQBruto / nBruto )       : 0.0 ;
+		rmsAlinhado = nAlinhado > 0 ? sqrt( somaQAlinhado / nAlinhado ) : 0.0 ;
+
+		fprintf( stderr , "roll - SIM    : bruto %.4f, alinhado %.4f graus rms\n" , rmsBruto , rmsAlinhado ) ;
+
+		if ( leituras == 0 || nBruto == 0 || rmsAlinhado >= rmsBruto ||
+		     atraso.maximo > ( unsigned long long ) ( config.alinhamentoMs + 20 ) * 1000000ULL )
+		{
+			falhas ++ ;
+		}
+
+		fprintf( stderr , "conferencia   : %s\n" , falhas == 0 ? "OK" : "FALHOU" ) ;
+
+		LER_DestruirParam( bruto ) ;
+		LER_DestruirParam( alinhado ) ;
+
+		return falhas == 0 ? 0 : 1 ;
+	}
+
+	/***************************************************************************
+	*
+	*  Função: BNC  & Matriz de rotação e aceleração no mundo
+	*
+	*  Durante a aquisição confere a matriz do LER contra a montada pelos
+	*  ângulos e a média da aceleração no mundo (a gravidade deve sumir;
+	*  sobra a vibração de 80 Hz do SIM). Depois compara o custo de cada
+	*  consumidor montar a matriz e girar a aceleração com o de copiar o
+	*  que o LER já calculou.
+	*  ****/
+
+	static int benchRotacao( const tpOpcoes * pOpcoes )
+	{
+		const unsigned    consumidores = 4 , repeticoes = 250000 ;
+
+		LER_tpConfig      config = pOpcoes->ler ;
+		LER_tpParametros  param ;
+		LER_tpContexto    ctx ;
+		unsigned long     leituras = 0 , falhas = 0 ;
+		double            soma[ 3 ] = { 0 } , somaQ = 0.0 , difMax = 0.0 ;
+		double            inicio , fim , tCalculo , tCache ;
+		volatile float    sorvedouro = 0.0f ;
+		float             R[ 3 ][ 3 ] , M[ 3 ][ 3 ] , mundo[ 3 ] ;
+		unsigned          r , c , i , j ;
+
+		config.modo = LER_ModoThread ;
+
+		param = LER_CriarParam( ) ;
+
+		if ( param == NULL || LER_Iniciar( &ctx , &config ) != LER_CondRetOK || SIM_Iniciar( &pOpcoes->sim ) != SIM_CondRetOK )
+		{
+			fprintf( stderr , "falha ao iniciar\n" ) ;
+			return 1 ;
+		}
+
+		inicio = agoraSeg( ) ;
+		fim    = inicio + pOpcoes->segundos ;
+
+		while ( agoraSeg( ) < fim )
+		{
+			usleep( ( useconds_t ) ( pOpcoes->periodoUs > 0 ? pOpcoes->periodoUs : 4000 ) ) ;
+
+			if ( LER_FillParam( ctx , param ) == LER_CondRetError ||
+			     LER_MatrizRotacao( param , R ) != LER_CondRetOK || LER_AcelMundo( param , mundo ) != LER_CondRetOK )
+			{
+				continue ;
+			}
+
+			montarRotacao( param , M ) ;
+
+			for ( i = 0 ; i < 3 ; i++ )
+			{
+				for ( j = 0 ; j < 3 ; j++ )
+				{
+					double d = fabs( ( double ) R[ i ][ j ] - M[ i ][ j ] ) ;
+
+					difMax = d > difMax ? d : difMax ;
+				}
+
+				soma[ i ] += mundo[ i ] ;
+				somaQ     += ( double ) mundo[ i ] * mundo[ i ] ;
+			}
+
+			leituras ++ ;
+		}
+
+		SIM_Parar( ) ;
+		LER_Terminar( ctx ) ;
+
+		/* Custo: cada consumidor refaz a trigonometria x copia o resultado */
+
+		tCalculo = agoraSeg( ) ;
+
+		for ( r = 0 ; r < repeticoes ; r++ )
+		{
+			for ( c = 0 ; c < consumidores ; c++ )
+			{
+				montarRotacao( param , M ) ;
+
+				sorvedouro += M[ 2 ][ 0 ] * LER_AcelX( param ) + M[ 2 ][ 1 ] * LER_AcelY( param ) + M[ 2 ][ 2 ] * LER_AcelZ( param ) ;
+			}
+		}
+
+		tCalculo = agoraSeg( ) - tCalculo ;
+		tCache   = agoraSeg( ) ;
+
+		for ( r = 0 ; r < repeticoes ; r++ )
+		{
+			for ( c = 0 ; c < consumidores ; c++ )
+			{
+				LER_MatrizRotacao( param , R ) ;
+				LER_AcelMundo( param , mundo ) ;
+
+				sorvedouro += R[ 2 ][ 0 ] + mundo[ 2 ] ;
+			}
+		}
+
+		tCache = agoraSeg( ) - tCache ;
+
+		fprintf( stderr , "\n=== Rotacao (%.1f s, att %.0f Hz, sensor %.0f Hz) ===\n" , fim - inicio ,
+		         pOpcoes->sim.taxaHz[ SIM_TopicoAtitude ] , pOpcoes->sim.taxaHz[ SIM_TopicoSensor ] ) ;
+		fprintf( stderr , "leituras      : %lu\n" , leituras ) ;
+
+		if ( leituras > 0 )
+		{
+			fprintf( stderr , "matriz        : diferenca maxima para a dos angulos %.2e\n" , difMax ) ;
+			fprintf( stderr , "acel. mundo   : media N/E/D %+.4f %+.4f %+.4f m/s2, rms %.4f m/s2\n" ,
+			         soma[ 0 ] / leituras , soma[ 1 ] / leituras , soma[ 2 ] / leituras , sqrt( somaQ / leituras ) ) ;
+		}
+
+		fprintf( stderr , "%u consumidores: montando %.1f ns/ciclo, do LER %.1f ns/ciclo (%.1fx)\n" , consumidores ,
+		         tCalculo / repeticoes * 1e9 , tCache / repeticoes * 1e9 , tCalculo / ( tCache > 0 ? tCache : 1e-9 ) ) ;
+
+		if ( leituras == 0 || difMax > 1e-3 || fabs( soma[ 2 ] / leituras ) > 0.1 || sqrt( somaQ / leituras ) > 1.0 )
+		{
+			falhas ++ ;
+		}
+
+		fprintf( stderr , "conferencia   : %s\n" , falhas == 0 ? "OK" : "FALHOU" ) ;
+
+		LER_DestruirParam( param ) ;
+		( void ) sorvedouro ;
+
+		return falhas == 0 ? 0 : 1 ;
+	}
+
+	/***************************************************************************
+	*
+	*  Função: BNC  & Altitude barométrica e razão de subida
+	*
+	*  Confere a tabela de ALT contra a fórmula em double em toda a faixa
+	*  e compara o custo com o powf. Depois roda o LER sobre o SIM, cuja
+	*  altura é 30 + 20 sen( 2 pi 0,02 t ) m, e compara a altura e a razão
+	*  de subida estimadas com as exatas no instante de cada pressão.
+	*  ****/
+
+	static int benchVertical( const tpOpcoes * pOpcoes )
+	{
+		const unsigned    pontos = 1000000 ;
+		const float       PI2    = 6.2831853f ;
+
+		static ALT_tpEstimador est ;
+
+		LER_tpConfig      config = pOpcoes->ler ;
+		LER_tpParametros  param ;
+		LER_tpContexto    ctx ;
+		LER_tpDiagnostico diag ;
+		ALT_tpConfig      altCfg ;
+		ALT_tpEstimativa  e ;
+		uint64_t          ultimo = 0 ;
+		unsigned long     leituras = 0 , falhas = 0 ;
+		double            erroMax = 0.0 , somaH = 0.0 , somaV = 0.0 ;
+		double            inicio , fim , tTabela , tPowf ;
+		double            aquecimento = 10.0f * config.vertical.tauAlturaS ;
+		volatile float    sorvedouro = 0.0f ;
+		unsigned          i ;
+
+		/* O alfa-beta leva umas dez constantes de tempo para convergir; a
+		   medição precisa de pelo menos outro tanto depois disso */
+
+		if ( pOpcoes->segundos < 2.0 * aquecimento )
+		{
+			fprintf( stderr , "-t %.1f curto demais: o modo vertical descarta os primeiros %.1f s (minimo -t %.1f)\n" ,
+			         pOpcoes->segundos , aquecimento , 2.0 * aquecimento ) ;
+			return 1 ;
+		}
+
+		ALT_ConfigPadrao( &altCfg ) ;
+		ALT_Iniciar( &est , &altCfg ) ;
+
+		for ( i = 0 ; i <= pontos ; i++ )
+		{
+			double p = ALT_PRESSAO_MIN + ( ALT_PRESSAO_MAX - ALT_PRESSAO_MIN ) * i / pontos ;
+			double h = ( 1.0 - pow( p / 1013.25 , 1.0 / 5.25588 ) ) / 2.25577e-5 ;
+			float  t ;
+
+			ALT_AltitudeBaro( &est , ( float ) p , &t ) ;
+			erroMax = fabs( t - h ) > erroMax ? fabs( t - h ) : erroMax ;
+		}
+
+		tTabela = agoraSeg( ) ;
+
+		for ( i = 0 ; i < pontos ; i++ )
+		{
+			float t ;
+
+			ALT_AltitudeBaro( &est , 900.0f + ( float ) ( i & 1023 ) * 0.1f , &t ) ;
+			sorvedouro += t ;
+		}
+
+		tTabela = agoraSeg( ) - tTabela ;
+		tPowf   = agoraSeg( ) ;
+
+		for ( i = 0 ; i < pontos ; i++ )
+		{
+			float p = 900.0f + ( float ) ( i & 1023 ) * 0.1f ;
+
+			sorvedouro += ( 1.0f - powf( p / 1013.25f , 1.0f / 5.25588f ) ) / 2.25577e-5f ;
+		}
+
+		tPowf = agoraSeg( ) - tPowf ;
+
+		config.modo = LER_ModoThread ;
+
+		param = LER_CriarParam( ) ;
+
+		if ( param == NULL || LER_Iniciar( &ctx , &config ) != LER_CondRetOK || SIM_Iniciar( &pOpcoes->sim ) != SIM_CondRetOK )
+		{
+			fprintf( stderr , "falha ao iniciar\n" ) ;
+			return 1 ;
+		}
+
+		inicio = agoraSeg( ) ;
+		fim    = inicio + pOpcoes->segundos ;
+
+		while ( agoraSeg( ) < fim )
+		{
+			usleep( ( useconds_t ) ( pOpcoes->periodoUs > 0 ? pOpcoes->periodoUs : 4000 ) ) ;
+
+			if ( LER_FillParam( ctx , param ) == LER_CondRetError ||
+			     LER_EstimativaVertical( param , &e ) != LER_CondRetOK || e.timestamp == ultimo || ! e.referenciaZ )
+			{
+				continue ;
+			}
+
+			ultimo = e.timestamp ;
+
+			/* Descarta o início, em que o alfa-beta ainda converge */
+
+			if ( agoraSeg( ) - inicio > aquecimento )
+			{
+				float t = ( float ) ( ( double ) e.timestamp * 1e-6 ) ;
+				float h = 30.0f + 20.0f * sinf( PI2 * 0.02f * t ) ;
+				float v = 20.0f * PI2 * 0.02f * cosf( PI2 * 0.02f * t ) ;
+
+				somaH += ( double ) ( e.altura - h ) * ( e.altura - h ) ;
+				somaV += ( double ) ( e.velocidade - v ) * ( e.velocidade - v ) ;
+				leituras ++ ;
+			}
+		}
+
+		fim = agoraSeg( ) ;
+
+		LER_ObterDiagnostico( ctx , &diag ) ;
+
+		fprintf( stderr , "\n=== Vertical (%.1f s, sensor %.0f Hz, pos %.0f Hz) ===\n" , fim - inicio ,
+		         pOpcoes->sim.taxaHz[ SIM_TopicoSensor ] , pOpcoes->sim.taxaHz[ SIM_TopicoPosicao ] ) ;
+		fprintf( stderr , "tabela        : %u intervalos, erro maximo %.4f m em %.0f-%.0f mbar\n" ,
+		         ALT_TAM_TABELA , erroMax , ALT_PRESSAO_MIN , ALT_PRESSAO_MAX ) ;
+		fprintf( stderr , "custo         : tabela %.2f ns, powf %.2f ns por amostra\n" ,
+		         tTabela / pontos * 1e9 , tPowf / pontos * 1e9 ) ;
+		fprintf( stderr , "taxas LER     : pressao (sensor) %.1f Hz, z (posicao) %.1f Hz, %u de %u copias de posicao repetidas\n" ,
+		         LER_TaxaEfetiva( ctx , LER_TopicoSensor ) , LER_TaxaEfetiva( ctx , LER_TopicoPosicao ) ,
+		         diag.repetidos[ LER_TopicoPosicao ] , diag.copias[ LER_TopicoPosicao ] ) ;
+
+		SIM_Parar( ) ;
+		LER_Terminar( ctx ) ;
+
+		if ( leituras > 0 )
+		{
+			fprintf( stderr , "estimativa    : %lu pressoes, erro rms altura %.4f m, subida %.4f m/s\n" ,
+			         leituras , sqrt( somaH / leituras ) , sqrt( somaV / leituras ) ) ;
+		}
+
+		if ( leituras == 0 || erroMax > 0.05 || sqrt( somaH / leituras ) > 0.5 || sqrt( somaV / leituras ) > 0.5 )
+		{
+			falhas ++ ;
+		}
+
+		fprintf( stderr , "conferencia   : %s\n" , falhas == 0 ? "OK" : "FALHOU" ) ;
+
+		LER_DestruirParam( param ) ;
+		( void ) sorvedouro ;
+
+		return falhas == 0 ? 0 : 1 ;
+	}
+
+	/***************************************************************************
+	*
+	*  Função: BNC  & Cópia sob demanda para um consumidor só de arfagem
+	*
+	*  Metade do tempo em LER_ModoSincrono e metade em LER_ModoSobDemanda,
+	*  com um consumidor que só lê LER_PitchAngle. Compara os orb_copy e os
+	*  bytes copiados de cada tópico e o custo do ciclo, e confere a
+	*  arfagem com a do SIM no instante de origem. No fim o consumidor sob
+	*  demanda lê todos os grupos, que devem vir válidos, e a estrutura
+	*  dele, com tópicos pendentes, é lida depois de LER_Terminar e
+	*  reaproveitada num contexto síncrono, que tem de prevalecer.
+	*  ****/
+
+	static int benchDemanda( const tpOpcoes * pOpcoes )
+	{
+		static const char * nomes[ LER_NumTopicos ] = { "sensor_combined" , "vehicle_local_position" , "vehicle_attitude" } ;
+		static const LER_tpModo modos[ 2 ] = { LER_ModoSincrono , LER_ModoSobDemanda } ;
+		static tpHistograma custo[ 2 ] ;
+
+		const size_t tamanho[ LER_NumTopicos ] = { sizeof( struct sensor_combined_s ) ,
+		                                           sizeof( struct vehicle_local_position_s ) ,
+		                                           sizeof( struct vehicle_attitude_s ) } ;
+
+		LER_tpConfig      config = pOpcoes->ler ;
+		LER_tpDiagnostico diag[ 2 ] ;
+		unsigned long     leituras[ 2 ] = { 0 , 0 } , falhas = 0 ;
+		double            erroMax[ 2 ] = { 0.0 , 0.0 } , bytes[ 2 ] = { 0.0 , 0.0 } , duracao[ 2 ] ;
+		double            erroReuso = -1.0 ;
+		unsigned          gruposFinal = 0 ;
+		LER_tpParametros  sobra = NULL ;
+		LER_tpContexto    ctxReuso ;
+		int               m , t ;
+
+		config.alinhamentoMs = 0 ;
+
+		for ( m = 0 ; m < 2 ; m++ )
+		{
+			LER_tpParametros param = LER_CriarParam( ) ;
+			LER_tpContexto   ctx ;
+			uint64_t         ultimo = 0 ;
+			double           inicio , fim ;
+
+			config.modo = modos[ m ] ;
+			memset( &custo[ m ] , 0 , sizeof( custo[ m ] ) ) ;
+
+			if ( param == NULL || LER_Iniciar( &ctx , &config ) != LER_CondRetOK || SIM_Iniciar( &pOpcoes->sim ) != SIM_CondRetOK )
+			{
+				fprintf( stderr , "falha ao iniciar\n" ) ;
+				return 1 ;
+			}
+
+			inicio = agoraSeg( ) ;
+			fim    = inicio + pOpcoes->segundos / 2 ;
+
+			while ( agoraSeg( ) < fim )
+			{
+				double   t0 = agoraSeg( ) ;
+				float    pitch ;
+				uint64_t origem ;
+
+				if ( LER_FillParam( ctx , param ) == LER_CondRetError )
+				{
+					continue ;
+				}
+
+				pitch  = LER_PitchAngle( param ) ;
+				origem = LER_TimestampGrupo( param , LER_GrupoAtitude ) ;
+
+				registrarNs( &custo[ m ] , ( unsigned long long ) ( ( agoraSeg( ) - t0 ) * 1e9 ) ) ;
+
+				if ( origem != 0 && origem != ultimo )
+				{
+					float  ts   = ( float ) ( ( double ) origem * 1e-6 ) ;
+					double erro = fabs( pitch - 0.15f * sinf( 6.2831853f * 0.13f * ts + 0.5f ) * 57.29747f ) ;
+
+					erroMax[ m ] = erro > erroMax[ m ] ? erro : erroMax[ m ] ;
+					ultimo       = origem ;
+					leituras[ m ] ++ ;
+				}
+
+				if ( pOpcoes->periodoUs > 0 )
+				{
+					usleep( ( useconds_t ) pOpcoes->periodoUs ) ;
+				}
+			}
+
+			duracao[ m ] = agoraSeg( ) - inicio ;
+
+			LER_ObterDiagnostico( ctx , &diag[ m ] ) ;
+
+			if ( modos[ m ] == LER_ModoSobDemanda )
+			{
+				LER_FillParam( ctx , param ) ;
+				gruposFinal = LER_GruposValidos( param ) ;
+
+				/* Deixa todos os tópicos pendentes para depois de LER_Terminar */
+
+				for ( t = 0 ; t < 10 && LER_FillParam( ctx , param ) != LER_CondRetOK ; t++ ) ;
+
+				sobra = param ;
+				param = NULL ;
+			}
+
+			SIM_Parar( ) ;
+			LER_Terminar( ctx ) ;
+			LER_DestruirParam( param ) ;
+
+			for ( t = 0 ; t < LER_NumTopicos ; t++ )
+			{
+				bytes[ m ] += ( double ) diag[ m ].copias[ t ] * tamanho[ t ] ;
+			}
+		}
+
+		/* A estrutura sob demanda sobrevive ao contexto: lida depois de
+		   LER_Terminar não copia dele, e reaproveitada num contexto
+		   síncrono traz os valores deste */
+
+		LER_PitchAngle( sobra ) ;
+
+		config.modo = LER_ModoSincrono ;
+
+		if ( LER_Iniciar( &ctxReuso , &config ) != LER_CondRetOK || SIM_Iniciar( &pOpcoes->sim ) != SIM_CondRetOK )
+		{
+			fprintf( stderr , "falha ao iniciar\n" ) ;
+			return 1 ;
+		}
+
+		for ( m = 0 ; m < 50 && erroReuso < 0.0 ; m++ )
+		{
+			if ( LER_FillParam( ctxReuso , sobra ) != LER_CondRetError &&
+			     ( LER_GruposNovos( sobra ) & LER_MASCARA_GRUPO( LER_GrupoAtitude ) ) )
+			{
+				float ts = ( float ) ( ( double ) LER_TimestampGrupo( sobra , LER_GrupoAtitude ) * 1e-6 ) ;
+
+				erroReuso = fabs( LER_PitchAngle( sobra ) - 0.15f * sinf( 6.2831853f * 0.13f * ts + 0.5f ) * 57.29747f ) ;
+			}
+		}
+
+		SIM_Parar( ) ;
+		LER_Terminar( ctxReuso ) ;
+		LER_DestruirParam( sobra ) ;
+
+		fprintf( stderr , "\n=== Copia sob demanda, so arfagem (%.1f s por modo, att %.0f Hz, sensor %.0f Hz, pos %.0f Hz) ===\n" ,
+		         pOpcoes->segundos / 2 , pOpcoes->sim.taxaHz[ SIM_TopicoAtitude ] ,
+		         pOpcoes->sim.taxaHz[ SIM_TopicoSensor ] , pOpcoes->sim.taxaHz[ SIM_TopicoPosicao ] ) ;
+		fprintf( stderr , "%-24s %6s %14s %14s\n" , "topico" , "bytes" , "copias sinc." , "sob demanda" ) ;
+
+		for ( t = 0 ; t < LER_NumTopicos ; t++ )
+		{
+			fprintf( stderr , "%-24s %6zu %14u %14u\n" , nomes[ t ] , tamanho[ t ] , diag[ 0 ].copias[ t ] , diag[ 1 ].copias[ t ] ) ;
+		}
+
+		for ( m = 0 ; m < 2 ; m++ )
+		{
+			fprintf( stderr , "%-13s : %.0f bytes/s copiados, %lu arfagens novas, erro maximo %.5f graus\n" ,
+			         m == 0 ? "sincrono" : "sob demanda" , bytes[ m ] / duracao[ m ] , leituras[ m ] , erroMax[ m ] ) ;
+			imprimirLatencia( "ciclo (us)    :" , &custo[ m ] ) ;
+		}
+
+		fprintf( stderr , "grupos no fim : %02X (pedidos %02X)\n" , gruposFinal , config.grupos ) ;
+		fprintf( stderr , "reuso         : estrutura sob demanda num contexto sincrono, erro %.5f graus\n" , erroReuso ) ;
+
+		if ( leituras[ 1 ] == 0 || erroMax[ 0 ] > 1e-3 || erroMax[ 1 ] > 1e-3 || erroReuso < 0.0 || erroReuso > 1e-3 ||
+		     diag[ 1 ].copias[ LER_TopicoSensor ] != 0 || diag[ 1 ].copias[ LER_TopicoPosicao ] != 0 ||
+		     gruposFinal != ( config.grupos & LER_TODOS_GRUPOS ) )
+		{
+			falhas ++ ;
+		}
+
+		fprintf( stderr , "conferencia   : %s\n" , falhas == 0 ? "OK" : "FALHOU" ) ;
+
+		return falhas == 0 ? 0 : 1 ;
+	}
+
+	/***************************************************************************
+	*
+	*  Função: BNC  & Estruturas de parâmetros sem heap
+	*
+	*  Quatro consumidores sobre um contexto em LER_ModoThread criam uma
+	*  estrutura do conjunto e outra na própria pilha a cada ciclo, leem e
+	*  destroem as duas. Depois de 0,5 s de partida, nenhuma chamada ao
+	*  heap pode acontecer no processo. No fim esgota o conjunto: só a
+	*  estrutura a mais pode ir ao heap.
+	*  ****/
+
+	static int benchPool( const tpOpcoes * pOpcoes )
+	{
+		static tpConsumidorPool consumidores[ 4 ] ;
+
+		LER_tpConfig     config = pOpcoes->ler ;
+		LER_tpContexto   ctx ;
+		LER_tpParametros todas[ LER_TAM_POOL_PARAM + 1 ] ;
+		unsigned long    heapInicio , heapFim , heapExtra , ciclos = 0 , comDados = 0 , nulos = 0 , falhas = 0 ;
+		double           inicio , fim ;
+		unsigned         i ;
+
+		config.modo          = LER_ModoThread ;
+		config.alinhamentoMs = 0 ;
+
+		if ( LER_Iniciar( &ctx , &config ) != LER_CondRetOK || SIM_Iniciar( &pOpcoes->sim ) != SIM_CondRetOK )
+		{
+			fprintf( stderr , "falha ao iniciar\n" ) ;
+			return 1 ;
+		}
+
+		consumidoresAtivos = 1 ;
+
+		for ( i = 0 ; i < 4 ; i++ )
+		{
+			consumidores[ i ].ctx = ctx ;
+			pthread_create( &consumidores[ i ].thread , NULL , consumidorPool , &consumidores[ i ] ) ;
+		}
+
+		usleep( 500000 ) ;
+
+		heapInicio = __atomic_load_n( &chamadasHeap , __ATOMIC_RELAXED ) ;
+		inicio     = agoraSeg( ) ;
+
+		/* Os três contadores cobrem a mesma janela, sem a partida e o fim */
+
+		for ( i = 0 ; i < 4 ; i++ )
+		{
+			ciclos   -= __atomic_load_n( &consumidores[ i ].ciclos   , __ATOMIC_RELAXED ) ;
+			comDados -= __atomic_load_n( &consumidores[ i ].comDados , __ATOMIC_RELAXED ) ;
+			nulos    -= __atomic_load_n( &consumidores[ i ].nulos    , __ATOMIC_RELAXED ) ;
+		}
+
+		usleep( ( useconds_t ) ( pOpcoes->segundos * 1e6 ) ) ;
+
+		for ( i = 0 ; i < 4 ; i++ )
+		{
+			ciclos   += __atomic_load_n( &consumidores[ i ].ciclos   , __ATOMIC_RELAXED ) ;
+			comDados += __atomic_load_n( &consumidores[ i ].comDados , __ATOMIC_RELAXED ) ;
+			nulos    += __atomic_load_n( &consumidores[ i ].nulos    , __ATOMIC_RELAXED ) ;
+		}
+
+		fim     = agoraSeg( ) ;
+		heapFim = __atomic_load_n( &chamadasHeap , __ATOMIC_RELAXED ) ;
+
+		consumidoresAtivos = 0 ;
+
+		for ( i = 0 ; i < 4 ; i++ )
+		{
+			pthread_join( consumidores[ i ].thread , NULL ) ;
+		}
+
+		SIM_Parar( ) ;
+		LER_Terminar( ctx ) ;
+
+		/* Conjunto esgotado: a última vem do heap e volta para ele */
+
+		heapExtra = __atomic_load_n( &chamadasHeap , __ATOMIC_RELAXED ) ;
+
+		for ( i = 0 ; i <= LER_TAM_POOL_PARAM ; i++ )
+		{
+			todas[ i ] = LER_CriarParam( ) ;
+		}
+
+		for ( i = 0 ; i <= LER_TAM_POOL_PARAM ; i++ )
+		{
+			LER_DestruirParam( todas[ i ] ) ;
+		}
+
+		heapExtra = __atomic_load_n( &chamadasHeap , __ATOMIC_RELAXED ) - heapExtra ;
+
+		fprintf( stderr , "\n=== Estruturas de parametros sem heap (%.1f s, 4 consumidores, conjunto de %u) ===\n" ,
+		         fim - inicio , LER_TAM_POOL_PARAM ) ;
+		fprintf( stderr , "ciclos        : %lu (%.0f/s), %lu com dados, %lu sem estrutura\n" ,
+		         ciclos , ciclos / ( fim - inicio ) , comDados , nulos ) ;
+		fprintf( stderr , "heap          : %lu chamadas em regime, %lu ao criar %u estruturas\n" ,
+		         heapFim - heapInicio , heapExtra , LER_TAM_POOL_PARAM + 1 ) ;
+
+#ifndef __GLIBC__
+		fprintf( stderr , "heap          : sem glibc, chamadas nao contadas\n" ) ;
+#endif
+
+		if ( heapFim != heapInicio || ciclos == 0 || comDados == 0 || nulos != 0 )
+		{
+			falhas ++ ;
+		}
+
+#ifdef __GLIBC__
+		if ( heapExtra != 2 )                  /* Um calloc e um free */
+		{
+			falhas ++ ;
+		}
+#endif
+
+		fprintf( stderr , "conferencia   : %s\n" , falhas == 0 ? "OK" : "FALHOU" ) ;
+
+		return falhas == 0 ? 0 : 1 ;
+	}
+
+	/***************************************************************************
+	*
+	*  Função: BNC  & Consumidor do modo "pool"
+	*  ****/
+
+	static void * consumidorPool( void * arg )
+	{
+		tpConsumidorPool * pCons = ( tpConsumidorPool * ) arg ;
+		uint64_t           memoria[ LER_TAM_MEMORIA_PARAM / sizeof( uint64_t ) ] ;
+		LER_tpAmostra      amostra ;
+		LER_tpParametros   doPool , local ;
+
+		while ( consumidoresAtivos )
+		{
+			doPool = LER_CriarParam( ) ;
+
+			if ( doPool == NULL || LER_IniciarParam( memoria , sizeof( memoria ) , &local ) != LER_CondRetOK )
+			{
+				__atomic_store_n( &pCons->nulos , pCons->nulos + 1 , __ATOMIC_RELAXED ) ;
+				LER_DestruirParam( doPool ) ;
+				continue ;
+			}
+
+			if ( LER_FillParam( pCons->ctx , doPool ) != LER_CondRetError &&
+			     LER_FillParam( pCons->ctx , local ) != LER_CondRetError )
+			{
+				LER_ObterAmostra( doPool , &amostra ) ;
+
+				if ( amostra.validos != 0 && LER_PitchAngle( local ) == LER_PitchAngle( local ) )
+				{
+					__atomic_store_n( &pCons->comDados , pCons->comDados + 1 , __ATOMIC_RELAXED ) ;
+				}
+			}
+
+			LER_DestruirParam( local ) ;
+			LER_DestruirParam( doPool ) ;
+
+			__atomic_store_n( &pCons->ciclos , pCons->ciclos + 1 , __ATOMIC_RELAXED ) ;
+
+			usleep( 1000 ) ;
+		}
+
+		return NULL ;
+	}
+
+	/***************************************************************************
+	*
+	*  Função: BNC  & Telemetria compacta sobre um pty a 57600 baud
+	*
+	*  Confere o plano padrão e o de todos os campos a 250 Hz em 80% do
+	*  enlace. Depois transmite, com o de 250 Hz, amostras do LER
+	*  (LER_ModoThread) por um pty, com a escrita cadenciada como a UART de 57600 baud, e um
+	*  receptor decodifica: vazão, taxa de cada campo, latência da
+	*  leitura à decodificação e erro de quantização. Um quadro a cada
+	*  200 tem um byte trocado: o CRC tem de rejeitá-lo e só ele se perde.
+	*  ****/
+
+	static int benchTelemetria( const tpOpcoes * pOpcoes )
+	{
+		static const char * nomes[ LER_NumCampos ] = { "pressao" , "pitch speed" , "roll speed" , "yaw speed" ,
+		                                               "pitch" , "roll" , "yaw" , "ax" , "ay" , "az" , "altura" } ;
+		static TLM_tpCodificador cod ;
+		static tpEnlace          enlace ;
+
+		const double      BYTES_POR_SEGUNDO = 57600.0 / 10.0 ;
+		TLM_tpConfig      config ;
+		TLM_tpPlano       plano ;
+		LER_tpConfig      lerCfg = pOpcoes->ler ;
+		LER_tpContexto    ctx ;
+		LER_tpParametros  param ;
+		LER_tpAmostra     amostra ;
+		unsigned char     quadro[ TLM_MAX_QUADRO ] ;
+		unsigned long     enviados = 0 , bytesEnviados = 0 , injetados = 0 , falhas = 0 ;
+		double            inicio , fim , linhaLivre , envio ;
+		pthread_t         receptor ;
+		struct termios    modo ;
+		int               mestre , c ;
+
+		/* Planos: o padrão e o de 250 Hz, que fica no codificador */
+
+		TLM_ConfigPadrao( &config ) ;
+
+		if ( TLM_IniciarCodificador( &cod , &config ) != TLM_CondRetOK )
+		{
+			fprintf( stderr , "plano padrao recusado\n" ) ;
+			return 1 ;
+		}
+
+		TLM_ObterPlano( &cod , &plano ) ;
+		falhas += conferirPlano( &config , &plano ) ;
+
+		fprintf( stderr , "\n=== Telemetria compacta (%.1f s, enlace %.0f bytes/s) ===\n" , pOpcoes->segundos , BYTES_POR_SEGUNDO ) ;
+		fprintf( stderr , "plano padrao  : %.0f bytes/s, %.0f quadros/s, %u campos reduzidos\n" ,
+		         plano.bytesPorSegundo , plano.taxaQuadrosHz , ( unsigned ) __builtin_popcount( plano.reduzidos ) ) ;
+
+		for ( c = 0 ; c < LER_NumCampos ; c++ )
+		{
+			config.campo[ c ].taxaHz = 250.0f ;
+		}
+
+		config.bytesPorSegundo = ( float ) ( 0.8 * BYTES_POR_SEGUNDO ) ;
+
+		if ( TLM_IniciarCodificador( &cod , &config ) != TLM_CondRetOK )
+		{
+			fprintf( stderr , "plano de 250 Hz recusado\n" ) ;
+			return 1 ;
+		}
+
+		TLM_ObterPlano( &cod , &plano ) ;
+		falhas += conferirPlano( &config , &plano ) ;
+
+		fprintf( stderr , "plano 250 Hz  : pedido %.0f bytes/s, orcamento %.0f, plano %.0f bytes/s, %.0f quadros/s\n" ,
+		         TLM_SOBRECARGA * 250.0 + 2.0 * 250.0 * LER_NumCampos , config.bytesPorSegundo ,
+		         plano.bytesPorSegundo , plano.taxaQuadrosHz ) ;
+
+		for ( c = 0 ; c < LER_NumCampos ; c++ )
+		{
+			fprintf( stderr , "   %-12s prioridade %u: %6.2f Hz%s\n" , nomes[ c ] , config.campo[ c ].prioridade ,
+			         plano.taxaHz[ c ] , ( plano.desligados >> c ) & 1u ? " (desligado)" : "" ) ;
+		}
+
+		/* Enlace */
+
+		mestre = posix_openpt( O_RDWR | O_NOCTTY ) ;
+
+		if ( mestre < 0 || grantpt( mestre ) != 0 || unlockpt( mestre ) != 0 ||
+		     ( enlace.fd = open( ptsname( mestre ) , O_RDWR | O_NOCTTY ) ) < 0 )
+		{
+			fprintf( stderr , "sem pty\n" ) ;
+			return 1 ;
+		}
+
+		tcgetattr( enlace.fd , &modo ) ;
+		cfmakeraw( &modo ) ;
+		tcsetattr( enlace.fd , TCSANOW , &modo ) ;
+
+		enlace.config = config ;
+		enlace.ativo  = 1 ;
+
+		lerCfg.modo = LER_ModoThread ;
+		param       = LER_CriarParam( ) ;
+
+		for ( c = 0 ; c < LER_NumTopicos ; c++ )
+		{
+			lerCfg.intervaloMs[ c ] = 0 ;
+		}
+
+		if ( param == NULL || LER_Iniciar( &ctx , &lerCfg ) != LER_CondRetOK || SIM_Iniciar( &pOpcoes->sim ) != SIM_CondRetOK ||
+		     pthread_create( &receptor , NULL , receptorTelemetria , &enlace ) != 0 )
+		{
+			fprintf( stderr , "falha ao iniciar\n" ) ;
+			return 1 ;
+		}
+
+		usleep( 100000 ) ;
+
+		inicio     = agoraSeg( ) ;
+		fim        = inicio + pOpcoes->segundos ;
+		linhaLivre = inicio ;
+
+		while ( agoraSeg( ) < fim )
+		{
+			unsigned n ;
+
+			usleep( 250 ) ;
+
+			/* O plano é por tempo: sem dado novo vai a última amostra */
+
+			if ( LER_FillParam( ctx , param ) == LER_CondRetError && LER_GruposValidos( param ) == 0 )
+			{
+				continue ;
+			}
+
+			LER_ObterAmostra( param , &amostra ) ;
+
+			n = TLM_Escalonar( &cod , hrt_absolute_time( ) , &amostra , quadro ) ;
+
+			if ( n == 0 )
+			{
+				continue ;
+			}
+
+			envio                         = agoraSeg( ) ;
+			enlace.enviada[ quadro[ 2 ] ] = amostra ;
+			__atomic_store( &enlace.envio[ quadro[ 2 ] ] , &envio , __ATOMIC_RELEASE ) ;
+
+			if ( ++ enviados % 200 == 0 )
+			{
+				quadro[ n / 2 ] ^= 0x10 ;
+				injetados ++ ;
+			}
+
+			/* A UART leva n * 10 bits: o quadro só sai quando a linha está
+			   livre, como na fila do driver */
+
+			linhaLivre = ( linhaLivre > agoraSeg( ) ? linhaLivre : agoraSeg( ) ) + n / BYTES_POR_SEGUNDO ;
+
+			while ( agoraSeg( ) < linhaLivre )
+			{
+				usleep( 200 ) ;
+			}
+
+			if ( write( mestre , quadro , n ) != ( ssize_t ) n )
+			{
+				falhas ++ ;
+			}
+
+			bytesEnviados += n ;
+		}
+
+		fim = agoraSeg( ) ;
+
+		usleep( 100000 ) ;
+		enlace.ativo = 0 ;
+		pthread_join( receptor , NULL ) ;
+
+		SIM_Parar( ) ;
+		LER_Terminar( ctx ) ;
+		LER_DestruirParam( param ) ;
+		close( enlace.fd ) ;
+		close( mestre ) ;
+
+		fprintf( stderr , "enviados      : %lu quadros, %.0f bytes/s (%.0f%% do enlace), %lu corrompidos de proposito\n" ,
+		         enviados , bytesEnviados / ( fim - inicio ) , 100.0 * bytesEnviados / ( fim - inicio ) / BYTES_POR_SEGUNDO , injetados ) ;
+		fprintf( stderr , "recebidos     : %u quadros, %u erros de CRC, %u perdidos, %u bytes descartados\n" ,
+		         enlace.estatisticas.quadros , enlace.estatisticas.errosCrc , enlace.estatisticas.perdidos ,
+		         enlace.estatisticas.descartados ) ;
+		imprimirLatencia( "latencia (us) :" , &enlace.latencia ) ;
+
+		for ( c = 0 ; c < LER_NumCampos ; c++ )
+		{
+			fprintf( stderr , "   %-12s %6.2f Hz recebidos (plano %6.2f Hz)\n" , nomes[ c ] ,
+			         enlace.recebidosCampo[ c ] / ( fim - inicio ) , plano.taxaHz[ c ] ) ;
+		}
+
+		fprintf( stderr , "quantizacao   : %lu valores fora de meia resolucao\n" , enlace.errosValor ) ;
+
+		/* O último corrompido pode não ter sucessor que revele o salto */
+
+		if ( enlace.estatisticas.errosCrc != injetados || enlace.estatisticas.perdidos + 1 < injetados ||
+		     enlace.estatisticas.perdidos > injetados ||
+		     enlace.estatisticas.quadros + injetados != enviados || enlace.errosValor != 0 ||
+		     bytesEnviados / ( fim - inicio ) > BYTES_POR_SEGUNDO )
+		{
+			falhas ++ ;
+		}
+
+		fprintf( stderr , "conferencia   : %s\n" , falhas == 0 ? "OK" : "FALHOU" ) ;
+
+		return falhas == 0 ? 0 : 1 ;
+	}
+
+	/***************************************************************************
+	*
+	*  Função: BNC  & Receptor do enlace de telemetria
+	*  ****/
+
+	static void * receptorTelemetria( void * arg )
+	{
+		tpEnlace *          pEnlace = ( tpEnlace * ) arg ;
+		TLM_tpDecodificador dec ;
+		TLM_tpQuadro        q ;
+		unsigned char       buf[ 256 ] ;
+		int                 c ;
+
+		TLM_IniciarDecodificador( &dec , &pEnlace->config ) ;
+		fcntl( pEnlace->fd , F_SETFL , O_NONBLOCK ) ;
+
+		while ( pEnlace->ativo )
+		{
+			ssize_t n = read( pEnlace->fd , buf , sizeof( buf ) ) ;
+			ssize_t i ;
+
+			if ( n <= 0 )
+			{
+				usleep( 200 ) ;
+				continue ;
+			}
+
+			pEnlace->bytes += ( unsigned long ) n ;
+
+			for ( i = 0 ; i < n ; i++ )
+			{
+				const LER_tpAmostra * pEnviada ;
+				double                envio ;
+
+				if ( TLM_Receber( &dec , buf[ i ] , &q ) != TLM_CondRetOK )
+				{
+					continue ;
+				}
+
+				__atomic_load( &pEnlace->envio[ q.sequencia ] , &envio , __ATOMIC_ACQUIRE ) ;
+				registrarNs( &pEnlace->latencia , ( unsigned long long ) ( ( agoraSeg( ) - envio ) * 1e9 ) ) ;
+
+				pEnviada = &pEnlace->enviada[ q.sequencia ] ;
+
+				for ( c = 0 ; c < LER_NumCampos ; c++ )
+				{
+					if ( q.mascara & ( 1u << c ) )
+					{
+						pEnlace->recebidosCampo[ c ] ++ ;
+
+						if ( fabsf( q.valor[ c ] - pEnviada->valor[ c ] ) > pEnlace->config.campo[ c ].resolucao * 0.5001f +
+						     fabsf( pEnviada->valor[ c ] ) * 1e-6f )
+						{
+							pEnlace->errosValor ++ ;
+						}
+					}
+				}
+			}
+		}
+
+		TLM_ObterEstatisticas( &dec , &pEnlace->estatisticas ) ;
+
+		return NULL ;
+	}
+
+	/***************************************************************************
+	*
+	*  Função: BNC  & Conferir um plano de telemetria
+	*
+	*  Cabe no orçamento, nenhum campo passa da taxa pedida e nenhum é
+	*  reduzido enquanto um menos prioritário ainda pode ser reduzido.
+	*  ****/
+
+	static int conferirPlano( const TLM_tpConfig * pConfig , const TLM_tpPlano * pPlano )
+	{
+		int falhas = 0 ;
+		int i , j ;
+
+		if ( pPlano->bytesPorSegundo > pConfig->bytesPorSegundo )
+		{
+			falhas ++ ;
+		}
+
+		for ( i = 0 ; i < LER_NumCampos ; i++ )
+		{
+			if ( pPlano->taxaHz[ i ] > pConfig->campo[ i ].taxaHz * 1.0001f )
+			{
+				falhas ++ ;
+			}
+
+			if ( ! ( ( pPlano->reduzidos | pPlano->desligados ) & ( 1u << i ) ) )
+			{
+				continue ;
+			}
+
+			for ( j = 0 ; j < LER_NumCampos ; j++ )
+			{
+				if ( pConfig->campo[ j ].prioridade < pConfig->campo[ i ].prioridade && pPlano->divisor[ j ] != 0 &&
+				     pPlano->taxaHz[ j ] / 2 >= pConfig->campo[ j ].taxaMinHz && pPlano->divisor[ j ] < TLM_DIVISOR_MAX )
+				{
+					falhas ++ ;
+				}
+			}
+		}
+
+		if ( falhas != 0 )
+		{
+			fprintf( stderr , "plano inconsistente\n" ) ;
+		}
+
+		return falhas ;
+	}
+
+	/***************************************************************************
+	*
+	*  Função: BNC  & Retrato compartilhado entre processos
+	*
+	*  Um contexto em LER_ModoThread publica numa região de shm_open; quatro
+	*  processos leem dela sem parar, dois copiando a amostra e dois lendo
+	*  só o roll. Nenhuma leitura pode ser rasgada (roll diferente do da
+	*  atitude de origem publicada junto) e publicações e origens só podem
+	*  avançar.
+	*  ****/
+
+	static int benchCompartilhado( const tpOpcoes * pOpcoes )
+	{
+		const unsigned NUM_LEITORES = 4 ;
+
+		static tpHistograma leitura , idade ;
+
+		LER_tpConfig        config = pOpcoes->ler ;
+		LER_tpContexto      ctx ;
+		LER_tpDiagnostico   diag ;
+		tpAreaCompartilhada * pArea ;
+		char                nome[ 64 ] ;
+		pid_t               filhos[ BNC_MAX_LEITORES ] ;
+		unsigned long long  leituras = 0 , novas = 0 , rasgadas = 0 , regressoes = 0 ;
+		unsigned long       falhas = 0 ;
+		uint32_t            publicacoes = 0 ;
+		double              inicio = 0.0 , fim = 0.0 ;
+		unsigned            i , j ;
+		int                 fd , estado ;
+
+		snprintf( nome , sizeof( nome ) , "/bnc_ler_%d" , ( int ) getpid( ) ) ;
+
+		fd = shm_open( nome , O_CREAT | O_EXCL | O_RDWR , 0600 ) ;
+
+		if ( fd < 0 || ftruncate( fd , sizeof( tpAreaCompartilhada ) ) != 0 )
+		{
+			fprintf( stderr , "falha em shm_open\n" ) ;
+			return 1 ;
+		}
+
+		pArea = mmap( NULL , sizeof( tpAreaCompartilhada ) , PROT_READ | PROT_WRITE , MAP_SHARED , fd , 0 ) ;
+		close( fd ) ;
+
+		if ( pArea == MAP_FAILED )
+		{
+			shm_unlink( nome ) ;
+			fprintf( stderr , "falha em mmap\n" ) ;
+			return 1 ;
+		}
+
+		LER_IniciarCompartilhado( &pArea->regiao ) ;
+
+		/* Os leitores nascem antes das threads do LER e do SIM */
+
+		for ( i = 0 ; i < NUM_LEITORES ; i++ )
+		{
+			filhos[ i ] = fork( ) ;
+
+			if ( filhos[ i ] == 0 )
+			{
+				leitorCompartilhado( nome , i , i & 1u ) ;
+				_exit( 0 ) ;
+			}
+		}
+
+		config.modo          = LER_ModoThread ;
+		config.alinhamentoMs = 0 ;
+
+		for ( i = 0 ; i < LER_NumTopicos ; i++ )
+		{
+			config.intervaloMs[ i ] = 0 ;
+		}
+
+		if ( LER_Iniciar( &ctx , &config ) != LER_CondRetOK ||
+		     LER_AssociarCompartilhado( ctx , &pArea->regiao ) != LER_CondRetOK ||
+		     SIM_Iniciar( &pOpcoes->sim ) != SIM_CondRetOK )
+		{
+			fprintf( stderr , "falha ao iniciar\n" ) ;
+			pArea->estado = 2 ;
+			falhas ++ ;
+		}
+		else
+		{
+			for ( i = 0 ; i < NUM_LEITORES ; i++ )
+			{
+				while ( !__atomic_load_n( &pArea->leitor[ i ].pronto , __ATOMIC_ACQUIRE ) )
+				{
+					usleep( 1000 ) ;
+				}
+			}
+
+			usleep( 200000 ) ;
+
+			publicacoes = LER_PublicacaoCompartilhado( &pArea->regiao ) ;
+			inicio      = agoraSeg( ) ;
+			__atomic_store_n( &pArea->estado , 1 , __ATOMIC_RELEASE ) ;
+
+			usleep( ( useconds_t ) ( pOpcoes->segundos * 1e6 ) ) ;
+
+			__atomic_store_n( &pArea->estado , 2 , __ATOMIC_RELEASE ) ;
+			fim         = agoraSeg( ) ;
+			publicacoes = LER_PublicacaoCompartilhado( &pArea->regiao ) - publicacoes ;
+
+			LER_AssociarCompartilhado( ctx , NULL ) ;
+			SIM_Parar( ) ;
+			LER_ObterDiagnostico( ctx , &diag ) ;
+			LER_Terminar( ctx ) ;
+		}
+
+		for ( i = 0 ; i < NUM_LEITORES ; i++ )
+		{
+			if ( filhos[ i ] < 0 || waitpid( filhos[ i ] , &estado , 0 ) != filhos[ i ] ||
+			     !WIFEXITED( estado ) || WEXITSTATUS( estado ) != 0 )
+			{
+				falhas ++ ;
+			}
+		}
+
+		if ( falhas != 0 )
+		{
+			munmap( pArea , sizeof( tpAreaCompartilhada ) ) ;
+			shm_unlink( nome ) ;
+			fprintf( stderr , "conferencia   : FALHOU\n" ) ;
+			return 1 ;
+		}
+
+		fprintf( stderr , "\n=== Retrato compartilhado (%.1f s, %u processos leitores, %u publicacoes/s) ===\n" ,
+		         fim - inicio , NUM_LEITORES , ( unsigned ) ( publicacoes / ( fim - inicio ) ) ) ;
+
+		for ( i = 0 ; i < NUM_LEITORES ; i++ )
+		{
+			tpLeitorCompartilhado * pLeitor = &pArea->leitor[ i ] ;
+
+			fprintf( stderr , "leitor %u (%s): %.2f M leituras/s, %llu publicacoes vistas, p50 %.2f us, p99 %.2f us, max %.2f us\n" ,
+			         i , ( i & 1u ) ? "campo  " : "amostra" , pLeitor->leituras / ( fim - inicio ) * 1e-6 , pLeitor->novas ,
+			         percentilUs( &pLeitor->leitura , 0.5 ) , percentilUs( &pLeitor->leitura , 0.99 ) ,
+			         pLeitor->leitura.maximo * 1e-3 ) ;
+
+			leituras   += pLeitor->leituras   ;
+			novas      += pLeitor->novas      ;
+			rasgadas   += pLeitor->rasgadas   ;
+			regressoes += pLeitor->regressoes ;
+
+			for ( j = 0 ; j < BNC_FAIXAS ; j++ )
+			{
+				leitura.contagem[ j ] += pLeitor->leitura.contagem[ j ] ;
+				idade.contagem[ j ]   += pLeitor->idade.contagem[ j ]   ;
+			}
+
+			leitura.total += pLeitor->leitura.total ;
+			idade.total   += pLeitor->idade.total   ;
+
+			if ( pLeitor->leitura.maximo > leitura.maximo ) leitura.maximo = pLeitor->leitura.maximo ;
+			if ( pLeitor->idade.maximo   > idade.maximo   ) idade.maximo   = pLeitor->idade.maximo   ;
+		}
+
+		imprimirLatencia( "leitura" , &leitura ) ;
+		imprimirLatencia( "idade (publicado -> visto)" , &idade ) ;
+		fprintf( stderr , "leituras      : %llu, %llu rasgadas, %llu regressoes\n" , leituras , rasgadas , regressoes ) ;
+		fprintf( stderr , "escritor      : %u despertares do LER, %u publicacoes na medicao\n" ,
+		         ( unsigned ) diag.despertares , publicacoes ) ;
+
+		munmap( pArea , sizeof( tpAreaCompartilhada ) ) ;
+		shm_unlink( nome ) ;
+
+		if ( rasgadas != 0 || regressoes != 0 || publicacoes == 0 || novas == 0 )
+		{
+			falhas ++ ;
+		}
+
+		fprintf( stderr , "conferencia   : %s\n" , falhas == 0 ? "OK" : "FALHOU" ) ;
+
+		return falhas == 0 ? 0 : 1 ;
+	}
+
+	/***************************************************************************
+	*
+	*  Função: BNC  & Processo leitor do modo "compartilhado"
+	*  ****/
+
+	static void leitorCompartilhado( const char * nome , unsigned indice , int porCampo )
+	{
+		tpAreaCompartilhada   * pArea ;
+		tpLeitorCompartilhado * pLeitor ;
+		LER_tpCompartilhado   * pRegiao ;
+		LER_tpAmostra           amostra ;
+		uint64_t                origem[ LER_NumGrupos ] ;
+		uint64_t                ultimaOrigem = 0 ;
+		uint32_t                publicacao , ultima = 0 ;
+		struct timespec         t0 , t1 ;
+		float                   roll ;
+		int                     fd , estado ;
+
+		fd = shm_open( nome , O_RDWR , 0 ) ;
+
+		if ( fd < 0 )
+		{
+			_exit( 1 ) ;
+		}
+
+		pArea = mmap( NULL , sizeof( tpAreaCompartilhada ) , PROT_READ | PROT_WRITE , MAP_SHARED , fd , 0 ) ;
+		close( fd ) ;
+
+		if ( pArea == MAP_FAILED )
+		{
+			_exit( 1 ) ;
+		}
+
+		pRegiao = &pArea->regiao ;
+		pLeitor = &pArea->leitor[ indice ] ;
+
+		__atomic_store_n( &pLeitor->pronto , 1 , __ATOMIC_RELEASE ) ;
+
+		while ( ( estado = __atomic_load_n( &pArea->estado , __ATOMIC_ACQUIRE ) ) != 2 )
+		{
+			LER_tpCondRet condRet ;
+
+			clock_gettime( CLOCK_MONOTONIC , &t0 ) ;
+
+			if ( porCampo )
+			{
+				condRet = LER_LerCampoCompartilhado( pRegiao , LER_CampoRoll , &roll , &origem[ LER_GrupoAtitude ] , &publicacao ) ;
+			}
+			else
+			{
+				condRet = LER_LerCompartilhado( pRegiao , &amostra , origem , &publicacao ) ;
+				roll    = amostra.valor[ LER_CampoRoll ] ;
+
+				if ( !( amostra.validos & LER_MASCARA_GRUPO( LER_GrupoAtitude ) ) )
+				{
+					condRet = LER_CondRetAttError ;
+				}
+			}
+
+			clock_gettime( CLOCK_MONOTONIC , &t1 ) ;
+
+			if ( estado != 1 )
+			{
+				continue ;
+			}
+
+			pLeitor->leituras ++ ;
+			registrarNs( &pLeitor->leitura , ( unsigned long long ) ( t1.tv_sec - t0.tv_sec ) * 1000000000ULL +
+			                                 ( unsigned long long ) t1.tv_nsec - ( unsigned long long ) t0.tv_nsec ) ;
+
+			if ( condRet != LER_CondRetOK || publicacao == ultima )
+			{
+				continue ;
+			}
+
+			if ( publicacao < ultima || origem[ LER_GrupoAtitude ] < ultimaOrigem )
+			{
+				pLeitor->regressoes ++ ;
+			}
+
+			if ( fabsf( roll - rollSimulado( origem[ LER_GrupoAtitude ] ) ) > 1e-3f )
+			{
+				pLeitor->rasgadas ++ ;
+			}
+
+			if ( !porCampo )
+			{
+				registrarNs( &pLeitor->idade , ( hrt_absolute_time( ) - amostra.timestamp ) * 1000ULL ) ;
+			}
+
+			pLeitor->novas ++ ;
+			ultima       = publicacao ;
+			ultimaOrigem = origem[ LER_GrupoAtitude ] ;
+		}
+
+		munmap( pArea , sizeof( tpAreaCompartilhada ) ) ;
+	}
+
+	/***************************************************************************
+	*
+	*  Função: BNC  & Avisos de mudança por limiar e faixa morta
+	*
+	*  Primeiro o custo de AVS_Avaliar sobre amostras sintéticas dos onze
+	*  campos com 1 e com 256 condições (a que dispara mais 255 alarmes
+	*  que quase nunca disparam), e o de avaliar as 256 uma a uma. Depois
+	*  um contexto em LER_ModoThread avalia um conjunto real e uma thread
+	*  espera pelos disparos do roll (limiar de 10 graus, histerese de 1)
+	*  e da altura (faixa morta de 0,5 m).
+	*  ****/
+
+	static int benchAvisos( const tpOpcoes * pOpcoes )
+	{
+		enum { NUM_AMOSTRAS = 20000 , NUM_CONDICOES = 256 , REPETICOES = 20 } ;
+
+		static float        amostras[ NUM_AMOSTRAS ][ LER_NumCampos ] ;
+		static float        inferior[ NUM_CONDICOES ] , superior[ NUM_CONDICOES ] ;
+		static AVS_tpConjunto conj ;
+		static tpVigilante  vig ;
+
+		AVS_tpAssinante     assinantes[ NUM_CONDICOES / AVS_CONDICOES_POR_ASSINANTE ] ;
+		AVS_tpCondicao      cond ;
+		AVS_tpEstatisticas  est[ 2 ] ;
+		LER_tpConfig        config = pOpcoes->ler ;
+		LER_tpContexto      ctx ;
+		double              custo[ 3 ] , t0 , inicio , fim ;
+		unsigned long       disparosIngenuo = 0 , falhas = 0 , esperadosRoll ;
+		unsigned            k , c , n , r , i ;
+
+		/* Amostras sintéticas: senos de frequências diferentes por campo;
+		   o roll é o do SIM */
+
+		for ( k = 0 ; k < NUM_AMOSTRAS ; k++ )
+		{
+			for ( c = 0 ; c < LER_NumCampos ; c++ )
+			{
+				amostras[ k ][ c ] = 20.0f * sinf( 6.2831853f * ( 0.1f + 0.03f * c ) * k * 0.004f + c ) ;
+			}
+
+			amostras[ k ][ LER_CampoRoll ] = rollSimulado( ( hrt_abstime ) k * 4000ULL ) ;
+		}
+
+		for ( n = 0 ; n < 2 ; n++ )
+		{
+			unsigned total = n == 0 ? 1 : NUM_CONDICOES ;
+
+			AVS_Iniciar( &conj ) ;
+
+			for ( i = 0 ; i < total ; i++ )
+			{
+				if ( i % AVS_CONDICOES_POR_ASSINANTE == 0 )
+				{
+					AVS_IniciarAssinante( &assinantes[ i / AVS_CONDICOES_POR_ASSINANTE ] ) ;
+				}
+
+				cond.canal  = i == 0 ? LER_CampoRoll : i % LER_NumCampos ;
+				cond.tipo   = AVS_TipoLimiar ;
+				cond.limite = i == 0 ? 10.0f : 25.0f + ( float ) ( i % 7 ) ;
+				cond.faixa  = 1.0f ;
+
+				if ( AVS_Vigiar( &conj , &assinantes[ i / AVS_CONDICOES_POR_ASSINANTE ] , &cond , NULL ) != AVS_CondRetOK )
+				{
+					falhas ++ ;
+				}
+			}
+
+			t0 = agoraSeg( ) ;
+
+			for ( r = 0 ; r < REPETICOES ; r++ )
+			{
+				for ( k = 0 ; k < NUM_AMOSTRAS ; k++ )
+				{
+					AVS_Avaliar( &conj , amostras[ k ] , ( 1u << LER_NumCampos ) - 1 ) ;
+				}
+			}
+
+			custo[ n ] = ( agoraSeg( ) - t0 ) * 1e9 / ( ( double ) REPETICOES * NUM_AMOSTRAS ) ;
+
+			AVS_ObterEstatisticas( &conj , &est[ n ] ) ;
+
+			for ( i = 0 ; i < total ; i += AVS_CONDICOES_POR_ASSINANTE )
+			{
+				AVS_RemoverAssinante( &conj , &assinantes[ i / AVS_CONDICOES_POR_ASSINANTE ] ) ;
+			}
+
+			AVS_Terminar( &conj ) ;
+		}
+
+		/* As mesmas 256 condições, uma a uma a cada amostra: os disparos
+		   têm de ser exatamente os mesmos */
+
+		for ( i = 0 ; i < NUM_CONDICOES ; i++ )
+		{
+			inferior[ i ] =  INFINITY ;
+			superior[ i ] = -INFINITY ;
+		}
+
+		t0 = agoraSeg( ) ;
+
+		for ( r = 0 ; r < REPETICOES ; r++ )
+		{
+			for ( k = 0 ; k < NUM_AMOSTRAS ; k++ )
+			{
+				for ( i = 0 ; i < NUM_CONDICOES ; i++ )
+				{
+					unsigned canal  = i == 0 ? LER_CampoRoll : i % LER_NumCampos ;
+					float    limite = i == 0 ? 10.0f : 25.0f + ( float ) ( i % 7 ) ;
+					float    v      = amostras[ k ][ canal ] ;
+
+					if ( v < inferior[ i ] || v > superior[ i ] )
+					{
+						inferior[ i ] = v > limite ? limite - 1.0f : -INFINITY ;
+						superior[ i ] = v > limite ? INFINITY : limite ;
+						disparosIngenuo ++ ;
+					}
+				}
+			}
+		}
+
+		custo[ 2 ] = ( agoraSeg( ) - t0 ) * 1e9 / ( ( double ) REPETICOES * NUM_AMOSTRAS ) ;
+
+		fprintf( stderr , "\n=== Avisos (%u amostras x %u) ===\n" , NUM_AMOSTRAS , REPETICOES ) ;
+		fprintf( stderr , "1 condicao    : %.1f ns/amostra, %u disparos, %u varreduras\n" ,
+		         custo[ 0 ] , est[ 0 ].disparos , est[ 0 ].varreduras ) ;
+		fprintf( stderr , "%u condicoes : %.1f ns/amostra, %u disparos, %u varreduras\n" ,
+		         NUM_CONDICOES , custo[ 1 ] , est[ 1 ].disparos , est[ 1 ].varreduras ) ;
+		fprintf( stderr , "uma a uma     : %.1f ns/amostra, %lu disparos\n" , custo[ 2 ] , disparosIngenuo ) ;
+
+		if ( est[ 1 ].disparos != disparosIngenuo || falhas != 0 )
+		{
+			falhas ++ ;
+		}
+
+		/* Integrado ao LER */
+
+		config.modo          = LER_ModoThread ;
+		config.alinhamentoMs = 0 ;
+
+		for ( i = 0 ; i < LER_NumTopicos ; i++ )
+		{
+			config.intervaloMs[ i ] = 0 ;
+		}
+
+		vig.limiteRoll  = 10.0f ;
+		vig.histerese   = 1.0f ;
+		vig.faixaAltura = 0.5f ;
+
+		AVS_Iniciar( &conj ) ;
+		AVS_IniciarAssinante( &vig.ass ) ;
+
+		cond.canal  = LER_CampoRoll ;
+		cond.tipo   = AVS_TipoLimiar ;
+		cond.limite = vig.limiteRoll ;
+		cond.faixa  = vig.histerese ;
+		AVS_Vigiar( &conj , &vig.ass , &cond , &vig.bitRoll ) ;
+
+		cond.canal  = LER_CampoAltura ;
+		cond.tipo   = AVS_TipoFaixa ;
+		cond.faixa  = vig.faixaAltura ;
+		AVS_Vigiar( &conj , &vig.ass , &cond , &vig.bitAltura ) ;
+
+		if ( LER_Iniciar( &ctx , &config ) != LER_CondRetOK || LER_AssociarAvisos( ctx , &conj ) != LER_CondRetOK ||
+		     SIM_Iniciar( &pOpcoes->sim ) != SIM_CondRetOK )
+		{
+			fprintf( stderr , "falha ao iniciar\n" ) ;
+			return 1 ;
+		}
+
+		consumidoresAtivos = 1 ;
+		pthread_create( &vig.thread , NULL , vigilanteAvisos , &vig ) ;
+
+		inicio = agoraSeg( ) ;
+		usleep( ( useconds_t ) ( pOpcoes->segundos * 1e6 ) ) ;
+		fim    = agoraSeg( ) ;
+
+		LER_AssociarAvisos( ctx , NULL ) ;
+		SIM_Parar( ) ;
+		LER_Terminar( ctx ) ;
+
+		consumidoresAtivos = 0 ;
+		pthread_join( vig.thread , NULL ) ;
+
+		AVS_ObterEstatisticas( &conj , &est[ 0 ] ) ;
+		AVS_RemoverAssinante( &conj , &vig.ass ) ;
+		AVS_Terminar( &conj ) ;
+
+		/* O roll cruza o limiar duas vezes por período de 5 s */
+
+		esperadosRoll = ( unsigned long ) ( ( fim - inicio ) * 0.4 ) ;
+
+		fprintf( stderr , "LER           : %u avaliacoes, %u varreduras em %.1f s\n" ,
+		         est[ 0 ].avaliacoes , est[ 0 ].varreduras , fim - inicio ) ;
+		fprintf( stderr , "assinante     : %lu despertares, roll %lu disparos (cerca de %lu + 1 esperados), altura %lu\n" ,
+		         vig.despertares , vig.disparosRoll , esperadosRoll , vig.disparosAltura ) ;
+		fprintf( stderr , "erros         : %lu despertares sem bits, %lu disparos injustificados\n" , vig.vazios , vig.errados ) ;
+
+		if ( vig.vazios != 0 || vig.errados != 0 || vig.disparosAltura == 0 ||
+		     vig.disparosRoll + 1 < esperadosRoll || vig.disparosRoll > esperadosRoll + 3 ||
+		     est[ 0 ].varreduras * 4 > est[ 0 ].avaliacoes )
+		{
+			falhas ++ ;
+		}
+
+		fprintf( stderr , "conferencia   : %s\n" , falhas == 0 ? "OK" : "FALHOU" ) ;
+
+		return falhas == 0 ? 0 : 1 ;
+	}
+
+	/***************************************************************************
+	*
+	*  Função: BNC  & Assinante do modo "avisos"
+	*  ****/
+
+	static void * vigilanteAvisos( void * arg )
+	{
+		tpVigilante * pVig = ( tpVigilante * ) arg ;
+		uint32_t      disparadas ;
+		float         valor , alturaAnterior = NAN ;
+		int           acima = -1 ;
+
+		while ( consumidoresAtivos )
+		{
+			if ( AVS_Aguardar( &pVig->ass , 100 , &disparadas ) != AVS_CondRetOK )
+			{
+				continue ;
+			}
+
+			pVig->despertares ++ ;
+
+			if ( disparadas == 0 )
+			{
+				pVig->vazios ++ ;
+			}
+
+			if ( disparadas & ( 1u << pVig->bitRoll ) )
+			{
+				valor = AVS_ValorDisparo( &pVig->ass , pVig->bitRoll ) ;
+
+				/* Alterna entre acima do limite e abaixo da histerese; o
+				   primeiro disparo só informa o estado inicial */
+
+				if ( ( acima == 1 && valor >= pVig->limiteRoll - pVig->histerese ) ||
+				     ( acima == 0 && valor <= pVig->limiteRoll ) )
+				{
+					pVig->errados ++ ;
+				}
+
+				if ( acima >= 0 )
+				{
+					pVig->disparosRoll ++ ;
+				}
+
+				acima = valor > pVig->limiteRoll ;
+			}
+
+			if ( disparadas & ( 1u << pVig->bitAltura ) )
+			{
+				valor = AVS_ValorDisparo( &pVig->ass , pVig->bitAltura ) ;
+
+				if ( fabsf( valor - alturaAnterior ) <= pVig->faixaAltura )
+				{
+					pVig->errados ++ ;
+				}
+
+				alturaAnterior = valor ;
+				pVig->disparosAltura ++ ;
+			}
+		}
+
+		return NULL ;
+	}
+
+	/***************************************************************************
+	*
+	*  Função: BNC  & Saúde dos tópicos com falhas injetadas
+	*
+	*  Custo de SAU_AcrescentarValor; depois, um contexto LER sobre o SIM
+	*  em três fases: sadia, com atitude travada, posição muda e picos no
+	*  sensor ao mesmo tempo, e de novo sadia. No fim de cada fase o estado
+	*  de cada tópico tem de ser o esperado.
+	*  ****/
+
+	static int benchSaude( const tpOpcoes * pOpcoes )
+	{
+		enum { NUM_AMOSTRAS = 2000000 , NUM_VALORES = 4096 , NUM_FASES = 3 } ;
+
+		static const char * nomesEstado[ ] = { "ok" , "aquecendo" , "ruidoso" , "travado" , "mudo" } ;
+		static const char * nomesTopico[ ] = { "sensor" , "posicao" , "atitude" } ;
+
+		static const struct {
+			const char * rotulo ;
+			SIM_tpFalha  falha[ LER_NumTopicos ] ;
+			SAU_tpEstado esperado[ LER_NumTopicos ] ;
+		} fases[ NUM_FASES ] = {
+			{ "sadia"       , { SIM_FalhaNenhuma , SIM_FalhaNenhuma , SIM_FalhaNenhuma   } ,
+			                  { SAU_EstadoOK     , SAU_EstadoOK     , SAU_EstadoOK       } } ,
+			{ "com falhas"  , { SIM_FalhaPicos   , SIM_FalhaMudo    , SIM_FalhaTravado   } ,
+			                  { SAU_EstadoRuidoso, SAU_EstadoMudo   , SAU_EstadoTravado  } } ,
+			{ "recuperada"  , { SIM_FalhaNenhuma , SIM_FalhaNenhuma , SIM_FalhaNenhuma   } ,
+			                  { SAU_EstadoOK     , SAU_EstadoOK     , SAU_EstadoOK       } } ,
+		} ;
+
+		static float        valores[ NUM_VALORES ] ;
+
+		SAU_tpConfig        configSaude ;
+		SAU_tpCanal         canal ;
+		SAU_tpResumoCanal   resumo ;
+		LER_tpConfig        config = pOpcoes->ler ;
+		LER_tpContexto      ctx ;
+		LER_tpSaude         saude ;
+		double              t0 , custo , duracao ;
+		unsigned long       falhas = 0 ;
+		unsigned            k , f , t ;
+
+		/* Custo por amostra: um canal linear com ruído de 250 Hz */
+
+		for ( k = 0 ; k < NUM_VALORES ; k++ )
+		{
+			valores[ k ] = 9.80665f + 0.3f * sinf( 6.2831853f * 80.0f * k * 0.004f ) ;
+		}
+
+		SAU_ConfigPadrao( &configSaude ) ;
+		SAU_IniciarCanal( &canal , 0.05f , 0.0f ) ;
+
+		t0 = agoraSeg( ) ;
+
+		for ( k = 0 ; k < NUM_AMOSTRAS ; k++ )
+		{
+			SAU_AcrescentarValor( &canal , &configSaude , ( uint64_t ) ( k + 1 ) * 4000ULL , valores[ k % NUM_VALORES ] ) ;
+		}
+
+		custo = ( agoraSeg( ) - t0 ) * 1e9 / NUM_AMOSTRAS ;
+
+		SAU_ObterCanal( &canal , &resumo ) ;
+
+		fprintf( stderr , "\n=== Saude ===\n" ) ;
+		fprintf( stderr , "por amostra   : %.1f ns (%s, media %.3f, desvio %.3f, %u atipicas)\n" ,
+		         custo , nomesEstado[ resumo.estado ] , resumo.media , resumo.desvio , resumo.atipicas ) ;
+
+		if ( resumo.estado != SAU_EstadoOK )
+		{
+			falhas ++ ;
+		}
+
+		/* Integrado ao LER: cada fase dura um terço da medição, e ao menos
+		   o bastante para a fração de atípicas passar do limite */
+
+		config.modo          = LER_ModoThread ;
+		config.alinhamentoMs = 0 ;
+
+		for ( t = 0 ; t < LER_NumTopicos ; t++ )
+		{
+			config.intervaloMs[ t ] = 0 ;
+		}
+
+		if ( LER_Iniciar( &ctx , &config ) != LER_CondRetOK || SIM_Iniciar( &pOpcoes->sim ) != SIM_CondRetOK )
+		{
+			fprintf( stderr , "falha ao iniciar\n" ) ;
+			return 1 ;
+		}
+
+		duracao = pOpcoes->segundos / NUM_FASES > 3.0 ? pOpcoes->segundos / NUM_FASES : 3.0 ;
+
+		for ( f = 0 ; f < NUM_FASES ; f++ )
+		{
+			for ( t = 0 ; t < LER_NumTopicos ; t++ )
+			{
+				SIM_InjetarFalha( ( SIM_tpTopico ) t , fases[ f ].falha[ t ] ) ;
+			}
+
+			usleep( ( useconds_t ) ( duracao * 1e6 ) ) ;
+
+			fprintf( stderr , "%-14s:" , fases[ f ].rotulo ) ;
+
+			for ( t = 0 ; t < LER_NumTopicos ; t++ )
+			{
+				LER_ObterSaude( ctx , ( LER_tpTopico ) t , &saude ) ;
+
+				fprintf( stderr , " %s %s (%.0f Hz, %.3f s)" , nomesTopico[ t ] , nomesEstado[ saude.estado ] ,
+				         saude.taxaHz , saude.idadeS ) ;
+
+				if ( saude.estado != fases[ f ].esperado[ t ] )
+				{
+					falhas ++ ;
+				}
+			}
+
+			fprintf( stderr , "\n" ) ;
+		}
+
+		/* Estatísticas de cada campo, no fim */
+
+		for ( t = 0 ; t < LER_NumCampos ; t++ )
+		{
+			if ( LER_ObterSaudeCampo( ctx , ( LER_tpCampo ) t , &resumo ) == LER_CondRetOK )
+			{
+				fprintf( stderr , "campo %2u      : %-9s media %9.3f desvio %7.3f  %6u amostras %4u atipicas %u invalidas\n" ,
+				         t , nomesEstado[ resumo.estado ] , resumo.media , resumo.desvio ,
+				         resumo.amostras , resumo.atipicas , resumo.invalidas ) ;
+			}
+		}
+
+		SIM_Parar( ) ;
+		LER_Terminar( ctx ) ;
+
+		fprintf( stderr , "conferencia   : %s\n" , falhas == 0 ? "OK" : "FALHOU" ) ;
+
+		return falhas == 0 ? 0 : 1 ;
+	}
+
+	/***************************************************************************
+	*
+	*  Função: BNC  & Reprodução determinística de um registro de voo
+	*
+	*  Refaz o voo do arquivo -o pelo SIM com relógio virtual, alternando
+	*  SIM_Avancar e LER_FillParam (LER_ModoSincrono, todas as publicações):
+	*  duas passagens sem espera, que têm de dar o mesmo resultado bit a
+	*  bit e, sem filtro (-F), as amostras gravadas; uma cadenciada a -V
+	*  vezes o tempo real, limitada a -t segundos; uma com LER_ModoThread,
+	*  que não pode perder publicação; e duas com LER_FillParamAlinhado
+	*  (janela -A, padrão 50 ms) sobre as origens gravadas, que têm de
+	*  dar o mesmo resultado e levar todo grupo ao instante comum. Recusa
+	*  -F se o arquivo foi gravado com filtro.
+	*  ****/
+
+	static int benchReproducao( const tpOpcoes * pOpcoes )
+	{
+		static const char * rotulos[ ] = { "sem espera" , "de novo" , "cadenciada" , "thread" ,
+		                                   "alinhada" , "realinhada" } ;
+
+		LER_tpConfig       config = pOpcoes->ler ;
+		LER_tpContexto     ctx ;
+		LER_tpParametros   param ;
+		LER_tpAmostra      gravada , saida ;
+		LER_tpAlinhamento  info ;
+		REG_tpLeitor       leitor ;
+		SIM_tpReproducao   rep ;
+		SIM_tpContadores   cont ;
+		uint64_t *         hashes ;
+		uint64_t           hash , hashAlinhado = 0 , n , i , instante ;
+		unsigned long      diferencas , perdidos , alinhadas , foraDoInstante , falhas = 0 ;
+		unsigned           alinhamentoMs = pOpcoes->ler.alinhamentoMs != 0 ? pOpcoes->ler.alinhamentoMs : 50 ;
+		unsigned           grupos = 0 , t ;
+		double             t0 , fim , duracao , vezes ;
+		int                p ;
+
+		if ( REG_AbrirLeitura( pOpcoes->arquivo , &leitor ) != REG_CondRetOK )
+		{
+			fprintf( stderr , "falha ao ler %s (gravar antes com -m registro)\n" , pOpcoes->arquivo ) ;
+			return 1 ;
+		}
+
+		n      = REG_NumRegistros( leitor ) ;
+		hashes = ( uint64_t * ) malloc( ( size_t ) ( n + 1 ) * sizeof( uint64_t ) ) ;
+
+		if ( hashes == NULL || n == 0 )
+		{
+			fprintf( stderr , "registro vazio\n" ) ;
+			return 1 ;
+		}
+
+		/* O contexto pede os grupos que o voo tem (-G não vale aqui: um
+		   registro sem grupo pedido deixaria o poll esperar o prazo) */
+
+		for ( i = 0 ; i < n ; i++ )
+		{
+			REG_Ler( leitor , i , &gravada ) ;
+			grupos |= gravada.validos ;
+		}
+
+		config.modo          = LER_ModoSincrono ;
+		config.alinhamentoMs = 0 ;
+		config.grupos        = grupos ;
+
+		for ( t = 0 ; t < LER_NumTopicos ; t++ )
+		{
+			config.intervaloMs[ t ] = 0 ;
+		}
+
+		fprintf( stderr , "\n=== Reproducao %s (%llu registros, grupos %02X) ===\n" , pOpcoes->arquivo ,
+		         ( unsigned long long ) n , grupos ) ;
+
+		/* Um voo gravado com filtro já traz a saída dele: filtrar de novo
+		   os mesmos campos não reproduziria nada */
+
+		for ( t = 0 ; t < LER_NumCampos ; t++ )
+		{
+			if ( config.filtro[ t ].numEstagios != 0 && ( REG_CamposFiltrados( leitor ) & ( 1u << t ) ) )
+			{
+				fprintf( stderr , "campo %u gravado ja filtrado: reproduzir sem -F\n" , t ) ;
+				return 1 ;
+			}
+		}
+
+		for ( p = 0 ; p < 6 ; p++ )
+		{
+			config.modo          = p == 3 ? LER_ModoThread : LER_ModoSincrono ;
+			config.alinhamentoMs = p >= 4 ? alinhamentoMs : 0 ;
+
+			if ( SIM_AbrirReproducao( pOpcoes->arquivo , p == 2 ? pOpcoes->velocidade : 0.0f ) != SIM_CondRetOK ||
+			     LER_Iniciar( &ctx , &config ) != LER_CondRetOK || ( param = LER_CriarParam( ) ) == NULL )
+			{
+				fprintf( stderr , "falha ao iniciar\n" ) ;
+				return 1 ;
+			}
+
+			hash           = 14695981039346656037ULL ;
+			diferencas     = 0 ;
+			alinhadas      = 0 ;
+			foraDoInstante = 0 ;
+			instante       = 0 ;
+			t0             = agoraSeg( ) ;
+			fim        = t0 + pOpcoes->segundos ;
+
+			for ( i = 0 ; SIM_Avancar( ) == SIM_CondRetOK ; i++ )
+			{
+				if ( p == 3 )
+				{
+					continue ;
+				}
+
+				/* Alinhada: só conta quando o instante comum avança */
+
+				if ( p >= 4 )
+				{
+					if ( LER_FillParamAlinhado( ctx , param , &info ) == LER_CondRetError || info.instante == instante )
+					{
+						continue ;
+					}
+
+					instante = info.instante ;
+					alinhadas ++ ;
+
+					for ( t = 0 ; t < LER_NumGrupos ; t++ )
+					{
+						if ( ( LER_GruposValidos( param ) & LER_MASCARA_GRUPO( t ) ) &&
+						     ( LER_TimestampGrupo( param , ( LER_tpGrupo ) t ) != instante ||
+						       ( ! ( info.retidos & LER_MASCARA_GRUPO( t ) ) && info.erroUs[ t ] > alinhamentoMs * 1000u ) ) )
+						{
+							foraDoInstante ++ ;
+						}
+					}
+
+					LER_ObterAmostra( param , &saida ) ;
+					hash = acumularHash( hash , &saida ) ;
+					continue ;
+				}
+
+				LER_FillParam( ctx , param ) ;
+				LER_ObterAmostra( param , &saida ) ;
+
+				hash = acumularHash( hash , &saida ) ;
+
+				if ( p == 0 )
+				{
+					hashes[ i ] = hash ;
+				}
+
+				/* A passagem "de novo" só mede: sem leitura do arquivo */
+
+				if ( p != 1 )
+				{
+					REG_Ler( leitor , i , &gravada ) ;
+					diferencas += compararAmostra( &gravada , &saida , grupos , i == 0 ) ;
+				}
+
+				if ( p == 2 && agoraSeg( ) >= fim )
+				{
+					i ++ ;
+					break ;
+				}
+			}
+
+			duracao = agoraSeg( ) - t0 ;
+
+			SIM_ObterReproducao( &rep ) ;
+
+			for ( t = 0 , perdidos = 0 ; t < SIM_NumTopicos ; t++ )
+			{
+				SIM_ObterContadores( ( SIM_tpTopico ) t , &cont ) ;
+				perdidos += cont.perdidos ;
+			}
+
+			LER_DestruirParam( param ) ;
+			LER_Terminar( ctx ) ;
+			SIM_FecharReproducao( ) ;
+
+			vezes = ( double ) ( rep.instante - rep.inicio ) * 1e-6 / duracao ;
+
+			fprintf( stderr , "%-13s : %llu registros em %.3f s = %.0f amostras/s, %.1fx o tempo real\n" ,
+			         rotulos[ p ] , ( unsigned long long ) rep.reproduzidos , duracao , rep.reproduzidos / duracao , vezes ) ;
+			fprintf( stderr , "                publicacoes %lu/%lu/%lu, perdidas %lu, esperas %lu, abandonadas %lu" ,
+			         rep.publicacoes[ SIM_TopicoSensor ] , rep.publicacoes[ SIM_TopicoPosicao ] ,
+			         rep.publicacoes[ SIM_TopicoAtitude ] , perdidos , rep.esperas , rep.abandonadas ) ;
+
+			if ( p == 0 || p == 2 )
+			{
+				fprintf( stderr , ", %lu diferencas" , diferencas ) ;
+			}
+
+			if ( p >= 4 )
+			{
+				fprintf( stderr , ", %lu alinhadas, %lu fora do instante" , alinhadas , foraDoInstante ) ;
+			}
+
+			if ( p != 3 )
+			{
+				fprintf( stderr , ", hash %016llx" , ( unsigned long long ) hash ) ;
+			}
+
+			fprintf( stderr , "\n" ) ;
+
+			/* Sem filtro, o LER devolve o que gravou; com filtro, as
+			   diferenças são o efeito dele */
+
+			if ( ( diferencas != 0 && pOpcoes->filtroHz == 0.0f ) || perdidos != 0 || rep.abandonadas != 0 ||
+			     ( p != 2 && rep.reproduzidos != n ) || ( p < 3 && rep.reproduzidos != i ) ||
+			     ( p < 3 && hash != hashes[ i - 1 ] ) )
+			{
+				falhas ++ ;
+			}
+
+			if ( p == 2 && duracao > 0.5 && fabs( vezes - pOpcoes->velocidade ) > 0.1 * pOpcoes->velocidade )
+			{
+				falhas ++ ;
+			}
+
+			/* As duas passagens alinhadas veem as mesmas origens */
+
+			if ( p == 4 )
+			{
+				hashAlinhado = hash ;
+			}
+
+			if ( p >= 4 && ( alinhadas == 0 || foraDoInstante != 0 || hash != hashAlinhado ) )
+			{
+				falhas ++ ;
+			}
+		}
+
+		REG_FecharLeitura( leitor ) ;
+		free( hashes ) ;
+
+		fprintf( stderr , "conferencia   : %s\n" , falhas == 0 ? "OK" : "FALHOU" ) ;
+
+		return falhas == 0 ? 0 : 1 ;
+	}
+
+	/***************************************************************************
+	*
+	*  Função: BNC  & Diferenças entre uma amostra gravada e a reproduzida
+	*
+	*  Timestamps, grupos e origens exatos; os ângulos voltam do radiano
+	*  com um arredondamento. A origem só é conferida nos grupos novos da
+	*  gravada: num registro sem origens (versão 1 do REG) a dos demais
+	*  é a do próprio registro.
+	*  ****/
+
+	static unsigned long compararAmostra( const LER_tpAmostra * pGravada , const LER_tpAmostra * pSaida ,
+	                                      unsigned grupos , int primeira )
+	{
+		unsigned long diferencas = 0 ;
+		unsigned      c , g ;
+
+		if ( pGravada->timestamp != pSaida->timestamp || ( ( pGravada->validos ^ pSaida->validos ) & grupos ) != 0 )
+		{
+			diferencas ++ ;
+		}
+
+		/* No primeiro ciclo todo grupo válido é novo */
+
+		if ( ! primeira && ( ( pGravada->novos ^ pSaida->novos ) & grupos ) != 0 )
+		{
+			diferencas ++ ;
+		}
+
+		for ( g = 0 ; g < LER_NumGrupos ; g++ )
+		{
+			if ( ( pGravada->novos & grupos & LER_MASCARA_GRUPO( g ) ) && pGravada->origem[ g ] != pSaida->origem[ g ] )
+			{
+				diferencas ++ ;
+			}
+		}
+
+		for ( c = 0 ; c < LER_NumCampos ; c++ )
+		{
+			float v = pGravada->valor[ c ] ;
+
+			if ( ( pGravada->validos & LER_MASCARA_GRUPO( LER_GrupoDoCampo( ( LER_tpCampo ) c ) ) ) &&
+			     fabsf( pSaida->valor[ c ] - v ) > 1e-5f * fabsf( v ) + 1e-6f )
+			{
+				diferencas ++ ;
+			}
+		}
+
+		return diferencas ;
+	}
+
+	/***************************************************************************
+	*
+	*  Função: BNC  & FNV-1a dos membros de uma amostra
+	*  ****/
+
+	static uint64_t acumularHash( uint64_t hash , const LER_tpAmostra * pAmostra )
+	{
+		unsigned char bytes[ sizeof( uint64_t ) + sizeof( pAmostra->valor ) + 2 * sizeof( uint32_t ) + sizeof( pAmostra->origem ) ] ;
+		size_t        k ;
+
+		memcpy( bytes , &pAmostra->timestamp , sizeof( uint64_t ) ) ;
+		memcpy( bytes + sizeof( uint64_t ) , pAmostra->valor , sizeof( pAmostra->valor ) ) ;
+		memcpy( bytes + sizeof( uint64_t ) + sizeof( pAmostra->valor ) , &pAmostra->validos , sizeof( uint32_t ) ) ;
+		memcpy( bytes + sizeof( uint64_t ) + sizeof( pAmostra->valor ) + sizeof( uint32_t ) , &pAmostra->novos , sizeof( uint32_t ) ) ;
+		memcpy( bytes + sizeof( uint64_t ) + sizeof( pAmostra->valor ) + 2 * sizeof( uint32_t ) , pAmostra->origem ,
+		        sizeof( pAmostra->origem ) ) ;
+
+		for ( k = 0 ; k < sizeof( bytes ) ; k++ )
+		{
+			hash = ( hash ^ bytes[ k ] ) * 1099511628211ULL ;
+		}
+
+		return hash ;
+	}
+
+	/***************************************************************************
+	*
+	*  Função: BNC  & Relógio monotônico em segundos
+	*  ****/
+
+	static double agoraSeg( void )
+	{
+		struct timespec ts ;
+
+		clock_gettime( CLOCK_MONOTONIC , &ts ) ;
+
+		return ( double ) ts.tv_sec + ( double ) ts.tv_nsec * 1e-9 ;
+	}
+
+	/***************************************************************************
+	*
+	*  Função: BNC  & Registrar uma latência no histograma
+	*  ****/
+
+	static void registrarNs( tpHistograma * pHist , unsigned long long ns )
+	{
+		int msb = 63 - __builtin_clzll( ns | 1ULL ) ;
+		int sub = msb >= 4 ? ( int ) ( ( ns >> ( msb - 4 ) ) & ( BNC_SUBFAIXAS - 1 ) ) : ( int ) ( ns & ( BNC_SUBFAIXAS - 1 ) ) ;
+
+		pHist->contagem[ msb * BNC_SUBFAIXAS + sub ] ++ ;
+		pHist->total ++ ;
+
+		if ( ns > pHist->maximo )
+		{
+			pHist->maximo = ns ;
+		}
+	}
+
+	/***************************************************************************
+	*
+	*  Função: BNC  & Percentil p (0..1) do histograma, em us
+	*  ****/
+
+	static double percentilUs( const tpHistograma * pHist , double p )
+	{
+		unsigned long long alvo = ( unsigned long long ) ( p * ( double ) pHist->total ) ;
+		unsigned long long acumulado = 0 ;
+		int i ;
+
+		for ( i = 0 ; i < BNC_FAIXAS ; i++ )
+		{
+			acumulado += pHist->contagem[ i ] ;
+
+			if ( acumulado > alvo )
+			{
+				int msb = i / BNC_SUBFAIXAS , sub = i % BNC_SUBFAIXAS ;
+				double base = msb >= 4 ? ( double ) ( ( 16ULL + sub ) << ( msb - 4 ) ) : ( double ) sub ;
+
+				return base * 1e-3 ;
+			}
+		}
+
+		return ( double ) pHist->maximo * 1e-3 ;
+	}
+
+	/***************************************************************************
+	*
+	*  Função: BNC  & Imprimir percentis de latência
+	*  ****/
+
+	static void imprimirLatencia( const char * rotulo , const tpHistograma * pHist )
+	{
+		if ( pHist->total == 0 )
+		{
+			return ;
+		}
+
+		fprintf( stderr , "%s p50 %.2f  p90 %.2f  p99 %.2f  p99.9 %.2f  max %.2f\n" , rotulo ,
+		         percentilUs( pHist , 0.50 ) , percentilUs( pHist , 0.90 ) , percentilUs( pHist , 0.99 ) ,
+		         percentilUs( pHist , 0.999 ) , ( double ) pHist->maximo * 1e-3 ) ;
+	}
+
+	/***************************************************************************
+	*
+	*  Função: BNC  & Percentil p (0..1) de um histograma do LER: limite
+	*                 superior da faixa, em us
+	*  ****/
+
+	static unsigned percentilLerUs( const LER_tpHistograma * pHist , double p )
+	{
+		unsigned long long total = 0 , acumulado = 0 ;
+		int f ;
+
+		for ( f = 0 ; f < LER_FAIXAS_HIST ; f++ )
+		{
+			total += pHist->contagem[ f ] ;
+		}
+
+		for ( f = 0 ; f < LER_FAIXAS_HIST ; f++ )
+		{
+			acumulado += pHist->contagem[ f ] ;
+
+			if ( total > 0 && acumulado > ( unsigned long long ) ( p * ( double ) total ) )
+			{
+				return f == LER_FAIXAS_HIST - 1 ? pHist->maximoUs : ( 1u << f ) ;
+			}
+		}
+
+		return pHist->maximoUs ;
+	}
+
+	/***************************************************************************
+	*
+	*  Função: BNC  & Passa-baixa de -F na aceleração e nas velocidades angulares
+	*
+	*  A taxa vista pelo filtro é a de publicação do tópico limitada pelo
+	*  intervalo da assinatura.
+	*  ****/
+
+	static void configurarFiltro( tpOpcoes * pOpcoes )
+	{
+		static const struct {
+			LER_tpCampo  campo ;
+			SIM_tpTopico simTopico ;
+			LER_tpTopico lerTopico ;
+		} canais[ ] = {
+			{ LER_CampoAx         , SIM_TopicoSensor  , LER_TopicoSensor  } ,
+			{ LER_CampoAy         , SIM_TopicoSensor  , LER_TopicoSensor  } ,
+			{ LER_CampoAz         , SIM_TopicoSensor  , LER_TopicoSensor  } ,
+			{ LER_CampoRollSpeed  , SIM_TopicoAtitude , LER_TopicoAtitude } ,
+			{ LER_CampoPitchSpeed , SIM_TopicoAtitude , LER_TopicoAtitude } ,
+			{ LER_CampoYawSpeed   , SIM_TopicoAtitude , LER_TopicoAtitude } ,
+		} ;
+		unsigned i ;
+
+		if ( pOpcoes->filtroHz <= 0.0f )
+		{
+			return ;
+		}
+
+		for ( i = 0 ; i < sizeof( canais ) / sizeof( canais[ 0 ] ) ; i++ )
+		{
+			FLT_tpConfig * pFiltro   = &pOpcoes->ler.filtro[ canais[ i ].campo ] ;
+			float          taxa      = pOpcoes->sim.taxaHz[ canais[ i ].simTopico ] ;
+			unsigned       intervalo = pOpcoes->ler.intervaloMs[ canais[ i ].lerTopico ] ;
+
+			if ( intervalo != 0 && 1000.0f / intervalo < taxa )
+			{
+				taxa = 1000.0f / intervalo ;
+			}
+
+			pFiltro->taxaHz               = taxa ;
+			pFiltro->numEstagios          = 1 ;
+			pFiltro->estagio[ 0 ].tipo    = FLT_PassaBaixa ;
+			pFiltro->estagio[ 0 ].freqHz  = pOpcoes->filtroHz ;
+			pFiltro->estagio[ 0 ].q       = 0.7071f ;
+			pFiltro->estagio[ 0 ].janela  = 0 ;
+		}
+	}
+
+	/***************************************************************************
+	*
+	*  Função: BNC  & Acumular o quadrado da diferença para a amostra anterior
+	*  ****/
+
+	static void acumularDiferenca( float valor , unsigned long indice , double * pAnterior ,
+	                               double * pSomaQ , double * pNum )
+	{
+		if ( indice > 0 )
+		{
+			*pSomaQ += ( valor - *pAnterior ) * ( valor - *pAnterior ) ;
+			*pNum   += 1 ;
+		}
+
+		*pAnterior = valor ;
+	}
+
+	/***************************************************************************
+	*
+	*  Função: BNC  & Roll do voo simulado (como em SIM) no instante, em graus
+	*  ****/
+
+	static float rollSimulado( hrt_abstime instante )
+	{
+		float t = ( float ) ( ( double ) instante * 1e-6 ) ;
+
+		return 0.35f * sinf( 6.2831853f * 0.20f * t ) * 57.29747f ;
+	}
+
+	/***************************************************************************
+	*
+	*  Função: BNC  & Matriz corpo -> NED montada pelo consumidor a partir
+	*                 dos ângulos do LER, como se fazia antes
+	*  ****/
+
+	static void montarRotacao( LER_tpParametros param , float R[ 3 ][ 3 ] )
+	{
+		const float grau = 1.0f / 57.29747f ;
+		float roll  = LER_RollAngle( param )  * grau ;
+		float pitch = LER_PitchAngle( param ) * grau ;
+		float yaw   = LER_YawAngle( param )   * grau ;
+		float cr = cosf( roll  ) , sr = sinf( roll  ) ;
+		float cp = cosf( pitch ) , sp = sinf( pitch ) ;
+		float cy = cosf( yaw   ) , sy = sinf( yaw   ) ;
+
+		R[ 0 ][ 0 ] = cp * cy ;
+		R[ 0 ][ 1 ] = sr * sp * cy - cr * sy ;
+		R[ 0 ][ 2 ] = cr * sp * cy + sr * sy ;
+		R[ 1 ][ 0 ] = cp * sy ;
+		R[ 1 ][ 1 ] = sr * sp * sy + cr * cy ;
+		R[ 1 ][ 2 ] = cr * sp * sy - sr * cy ;
+		R[ 2 ][ 0 ] = -sp ;
+		R[ 2 ][ 1 ] = sr * cp ;
+		R[ 2 ][ 2 ] = cr * cp ;
+	}
@@ -0,0 +1,1236 @@
+/***************************************************************************
+*  $MCI Módulo de implementação: SIM Substituto do uORB para host Linux
+*
+*  Arquivo gerado:              SIM_UORB.c
+*  Letras identificadoras:      SIM
+*
+*
+*  Projeto: SAE AeroDesign Brasil 2014
+*  Gestor:  Alessandro Soares da Silva Junior
+*  Autores: Alessandro Soares da Silva Junior
+*
+*
+***************************************************************************/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/eventfd.h>
+
+#include <uORB/uORB.h>
+#include <drivers/drv_hrt.h>
+#include <uORB/topics/vehicle_attitude.h>
+#include <uORB/topics/sensor_combined.h>
+#include <uORB/topics/vehicle_local_position.h>
+
+#include "SIM_UORB.h"
+#include "../REG_REGISTRO.h"
+
+#define SIM_MAX_TOPICOS      16
+#define SIM_MAX_ASSINATURAS  64
+
+#define SIM_PRAZO_PASSO_MS   100        /* Espera máxima da reprodução por uma cópia         */
+#define SIM_RAD_EM_GRAU      57.29747f  /* O fator do LER, para que a volta dos ângulos seja exata */
+
+/***** Metadados dos tópicos (no PX4 ficam em objects_common.cpp) *****/
+
+ORB_DEFINE( vehicle_attitude       , struct vehicle_attitude_s       ) ;
+ORB_DEFINE( sensor_combined        , struct sensor_combined_s        ) ;
+ORB_DEFINE( vehicle_local_position , struct vehicle_local_position_s ) ;
+
+/***********************************************************************
+*
+*  $TC Tipo de dados: SIM - Nó de tópico
+*
+***********************************************************************/
+
+typedef struct {
+	const struct orb_metadata * meta ;         /* Tópico; NULL se o nó está livre           */
+	void *       dado                ;         /* Última publicação (o_size bytes)          */
+	unsigned     geracao             ;         /* Número de publicações feitas              */
+	hrt_abstime  ultimaPublicacao    ;         /* Instante da última publicação             */
+	unsigned long publicados         ;         /* Publicações desde SIM_Iniciar             */
+} tpNo ;
+
+/***********************************************************************
+*
+*  $TC Tipo de dados: SIM - Assinatura
+*
+***********************************************************************/
+
+typedef struct {
+	tpNo *       no                  ;         /* Tópico assinado; NULL se a entrada é livre */
+	int          fd                  ;         /* eventfd devolvido como handle              */
+	hrt_abstime  intervalo           ;         /* orb_set_interval em us                     */
+	unsigned     ultimaGeracao       ;         /* Geração da última cópia                    */
+	hrt_abstime  ultimaCopia         ;         /* Instante da última cópia                   */
+	unsigned long copiados           ;
+	unsigned long perdidos           ;
+	unsigned long repetidos          ;
+	int          abandonada          ;         /* Não copiou no prazo; a reprodução não a espera */
+} tpAssinatura ;
+
+/***********************************************************************
+*
+*  $TC Tipo de dados: SIM - Reprodução de um registro de voo
+*
+***********************************************************************/
+
+typedef struct {
+	REG_tpLeitor     leitor              ;
+	float            velocidade          ;         /* 0 = sem esperas                           */
+	struct timespec  inicioReal          ;         /* Instante real do primeiro registro        */
+	uint32_t         validos             ;         /* Grupos válidos do registro anterior       */
+	struct sensor_combined_s        sen  ;         /* Última publicação de cada tópico          */
+	struct vehicle_local_position_s pos  ;
+	struct vehicle_attitude_s       att  ;
+	orb_advert_t     pub[ SIM_NumTopicos ] ;
+	SIM_tpReproducao estatisticas        ;
+} tpReproducao ;
+
+/***** Variáveis Globais ******/
+
+static pthread_mutex_t mutexBroker = PTHREAD_MUTEX_INITIALIZER ;
+
+static tpNo nos[ SIM_MAX_TOPICOS ] ;
+
+static tpAssinatura assinaturas[ SIM_MAX_ASSINATURAS ] ;
+
+static pthread_t threadGerador ;
+
+static volatile int geradorAtivo = 0 ;
+
+static SIM_tpConfig configGerador ;
+
+static volatile SIM_tpFalha falhas[ SIM_NumTopicos ] ;
+
+static tpReproducao reproducao ;
+
+static volatile int reproducaoAtiva = 0 ;
+
+static hrt_abstime instanteVirtual ;           /* hrt_absolute_time durante a reprodução */
+
+static pthread_cond_t condCopia = PTHREAD_COND_INITIALIZER ;
+
+/***** Protótipos das funções encapuladas no módulo *****/
+
+	static tpNo *          obterNo          ( const struct orb_metadata * meta ) ;
+	static tpAssinatura *  obterAssinatura  ( int handle )                       ;
+	static void            sinalizar        ( tpAssinatura * pAss )              ;
+	static void            drenar           ( tpAssinatura * pAss )              ;
+	static void            sintetizar       ( SIM_tpTopico topico , hrt_abstime agora , void * pDado ) ;
+	static void *          gerador          ( void * arg )                       ;
+	static void            carimbar         ( SIM_tpTopico topico , hrt_abstime agora , void * pDado ) ;
+	static void            perturbar        ( SIM_tpTopico topico , void * pDado ) ;
+	static const struct orb_metadata * metaDoTopico ( SIM_tpTopico topico )       ;
+	static void            preencherAtitude ( struct vehicle_attitude_s * att , float roll , float pitch , float yaw ) ;
+	static void            aguardarCopias   ( void )                             ;
+	static int             pendente         ( const tpAssinatura * pAss , hrt_abstime agora ) ;
+	static void            publicarRegistro ( const LER_tpAmostra * pAmostra , int primeiro ) ;
+
+/*****  Código do relógio hrt  *****/
+
+	hrt_abstime hrt_absolute_time( void )
+	{
+		struct timespec ts ;
+
+		/* Na reprodução o relógio é o do voo gravado e só anda com ela */
+
+		if ( __atomic_load_n( &reproducaoAtiva , __ATOMIC_ACQUIRE ) )
+		{
+			return __atomic_load_n( &instanteVirtual , __ATOMIC_ACQUIRE ) ;
+		}
+
+		clock_gettime( CLOCK_MONOTONIC , &ts ) ;
+
+		return ( hrt_abstime ) ts.tv_sec * 1000000ULL + ( hrt_abstime ) ts.tv_nsec / 1000ULL ;
+	}
+
+	hrt_abstime hrt_elapsed_time( const volatile hrt_abstime * then )
+	{
+		return hrt_absolute_time( ) - *then ;
+	}
+
+/*****  Código das chamadas orb_*  *****/
+
+	orb_advert_t orb_advertise( const struct orb_metadata * meta , const void * data )
+	{
+		tpNo * pNo ;
+
+		pthread_mutex_lock( &mutexBroker ) ;
+		pNo = obterNo( meta ) ;
+		pthread_mutex_unlock( &mutexBroker ) ;
+
+		if ( pNo == NULL )
+		{
+			return ( orb_advert_t ) 0 ;
+		}
+
+		if ( data != NULL )
+		{
+			orb_publish( meta , ( orb_advert_t ) pNo , data ) ;
+		}
+
+		return ( orb_advert_t ) pNo ;
+	}
+
+	int orb_publish( const struct orb_metadata * meta , orb_advert_t handle , const void * data )
+	{
+		tpNo * pNo = ( tpNo * ) handle ;
+		hrt_abstime agora = hrt_absolute_time( ) ;
+		int i ;
+
+		if ( pNo == NULL || pNo->meta != meta )
+		{
+			errno = EINVAL ;
+			return -1 ;
+		}
+
+		pthread_mutex_lock( &mutexBroker ) ;
+
+		memcpy( pNo->dado , data , meta->o_size ) ;
+		pNo->geracao ++ ;
+		pNo->ultimaPublicacao = agora ;
+		pNo->publicados ++ ;
+
+		/* Mesma regra do driver do PX4: só acorda quem já cumpriu o intervalo */
+
+		for ( i = 0 ; i < SIM_MAX_ASSINATURAS ; i++ )
+		{
+			tpAssinatura * pAss = &assinaturas[ i ] ;
+
+			if ( pAss->no == pNo && agora - pAss->ultimaCopia >= pAss->intervalo )
+			{
+				sinalizar( pAss ) ;
+			}
+		}
+
+		pthread_mutex_unlock( &mutexBroker ) ;
+
+		return 0 ;
+	}
+
+	int orb_subscribe( const struct orb_metadata * meta )
+	{
+		tpAssinatura * pAss = NULL ;
+		int i ;
+
+		pthread_mutex_lock( &mutexBroker ) ;
+
+		for ( i = 0 ; i < SIM_MAX_ASSINATURAS ; i++ )
+		{
+			if ( assinaturas[ i ].no == NULL )
+			{
+				pAss = &assinaturas[ i ] ;
+				break ;
+			}
+		}
+
+		if ( pAss == NULL )
+		{
+			pthread_mutex_unlock( &mutexBroker ) ;
+			errno = ENFILE ;
+			return -1 ;
+		}
+
+		memset( pAss , 0 , sizeof( *pAss ) ) ;
+
+		pAss->no = obterNo( meta ) ;
+		pAss->fd = eventfd( 0 , EFD_NONBLOCK | EFD_CLOEXEC ) ;
+
+		if ( pAss->no == NULL || pAss->fd < 0 )
+		{
+			if ( pAss->fd >= 0 )
+			{
+				close( pAss->fd ) ;
+			}
+			pAss->no = NULL ;
+			pthread_mutex_unlock( &mutexBroker ) ;
+			return -1 ;
+		}
+
+		/* Um assinante novo enxerga o dado já publicado como novidade */
+
+		if ( pAss->no->geracao > 0 )
+		{
+			pAss->ultimaGeracao = pAss->no->geracao - 1 ;
+			sinalizar( pAss ) ;
+		}
+
+		pthread_mutex_unlock( &mutexBroker ) ;
+
+		return pAss->fd ;
+	}
+
+	int orb_unsubscribe( int handle )
+	{
+		tpAssinatura * pAss ;
+
+		pthread_mutex_lock( &mutexBroker ) ;
+
+		pAss = obterAssinatura( handle ) ;
+
+		if ( pAss == NULL )
+		{
+			pthread_mutex_unlock( &mutexBroker ) ;
+			errno = EBADF ;
+			return -1 ;
+		}
+
+		close( pAss->fd ) ;
+		pAss->no = NULL ;
+
+		pthread_mutex_unlock( &mutexBroker ) ;
+
+		return 0 ;
+	}
+
+	int orb_copy( const struct orb_metadata * meta , int handle , void * buffer )
+	{
+		tpAssinatura * pAss ;
+
+		pthread_mutex_lock( &mutexBroker ) ;
+
+		pAss = obterAssinatura( handle ) ;
+
+		if ( pAss == NULL || pAss->no->meta != meta )
+		{
+			pthread_mutex_unlock( &mutexBroker ) ;
+			errno = EBADF ;
+			return -1 ;
+		}
+
+		if ( pAss->no->geracao == 0 )
+		{
+			pthread_mutex_unlock( &mutexBroker ) ;
+			errno = EIO ;
+			return -1 ;
+		}
+
+		memcpy( buffer , pAss->no->dado , meta->o_size ) ;
+
+		if ( pAss->no->geracao == pAss->ultimaGeracao )
+		{
+			pAss->repetidos ++ ;
+		}
+		else
+		{
+			pAss->perdidos += pAss->no->geracao - pAss->ultimaGeracao - 1 ;
+		}
+
+		pAss->copiados ++ ;
+		pAss->ultimaGeracao = pAss->no->geracao ;
+		pAss->ultimaCopia   = hrt_absolute_time( ) ;
+
+		drenar( pAss ) ;
+
+		if ( reproducaoAtiva )
+		{
+			pthread_cond_broadcast( &condCopia ) ;
+		}
+
+		pthread_mutex_unlock( &mutexBroker ) ;
+
+		return 0 ;
+	}
+
+	int orb_check( int handle , bool * updated )
+	{
+		tpAssinatura * pAss ;
+
+		pthread_mutex_lock( &mutexBroker ) ;
+
+		pAss = obterAssinatura( handle ) ;
+
+		if ( pAss == NULL )
+		{
+			pthread_mutex_unlock( &mutexBroker ) ;
+			errno = EBADF ;
+			return -1 ;
+		}
+
+		*updated = ( pAss->no->geracao != pAss->ultimaGeracao ) &&
+		           ( hrt_absolute_time( ) - pAss->ultimaCopia >= pAss->intervalo ) ;
+
+		pthread_mutex_unlock( &mutexBroker ) ;
+
+		return 0 ;
+	}
+
+	int orb_stat( int handle , uint64_t * time )
+	{
+		tpAssinatura * pAss ;
+
+		pthread_mutex_lock( &mutexBroker ) ;
+
+		pAss = obterAssinatura( handle ) ;
+
+		if ( pAss == NULL )
+		{
+			pthread_mutex_unlock( &mutexBroker ) ;
+			errno = EBADF ;
+			return -1 ;
+		}
+
+		*time = pAss->no->ultimaPublicacao ;
+
+		pthread_mutex_unlock( &mutexBroker ) ;
+
+		return 0 ;
+	}
+
+	int orb_set_interval( int handle , unsigned interval )
+	{
+		tpAssinatura * pAss ;
+
+		pthread_mutex_lock( &mutexBroker ) ;
+
+		pAss = obterAssinatura( handle ) ;
+
+		if ( pAss == NULL )
+		{
+			pthread_mutex_unlock( &mutexBroker ) ;
+			errno = EBADF ;
+			return -1 ;
+		}
+
+		pAss->intervalo = ( hrt_abstime ) interval * 1000ULL ;
+
+		pthread_mutex_unlock( &mutexBroker ) ;
+
+		return 0 ;
+	}
+
+/*****  Código das funções exportadas pelo módulo  *****/
+
+/***************************************************************************
+*
+*  Função: SIM  &Iniciar gerador sintético
+*  ****/
+
+	SIM_tpCondRet SIM_Iniciar( const SIM_tpConfig * pConfig )
+	{
+		int i ;
+
+		if ( geradorAtivo || reproducaoAtiva )
+		{
+			return SIM_CondRetError ;
+		}
+
+		pthread_mutex_lock( &mutexBroker ) ;
+
+		for ( i = 0 ; i < SIM_MAX_TOPICOS ; i++ )
+		{
+			nos[ i ].publicados = 0 ;
+		}
+
+		for ( i = 0 ; i < SIM_MAX_ASSINATURAS ; i++ )
+		{
+			assinaturas[ i ].copiados  = 0 ;
+			assinaturas[ i ].perdidos  = 0 ;
+			assinaturas[ i ].repetidos = 0 ;
+		}
+
+		pthread_mutex_unlock( &mutexBroker ) ;
+
+		for ( i = 0 ; i < SIM_NumTopicos ; i++ )
+		{
+			falhas[ i ] = SIM_FalhaNenhuma ;
+		}
+
+		configGerador = *pConfig ;
+		geradorAtivo  = 1 ;
+
+		if ( pthread_create( &threadGerador , NULL , gerador , NULL ) != 0 )
+		{
+			geradorAtivo = 0 ;
+			return SIM_CondRetError ;
+		}
+
+		return SIM_CondRetOK ;
+	}
+
+/***************************************************************************
+*
+*  Função: SIM  &Parar gerador sintético
+*  ****/
+
+	void SIM_Parar( void )
+	{
+		if ( ! geradorAtivo )
+		{
+			return ;
+		}
+
+		geradorAtivo = 0 ;
+		pthread_join( threadGerador , NULL ) ;
+	}
+
+/***************************************************************************
+*
+*  Função: SIM  &Injetar falha num tópico
+*  ****/
+
+	void SIM_InjetarFalha( SIM_tpTopico topico , SIM_tpFalha falha )
+	{
+		if ( topico < SIM_NumTopicos )
+		{
+			falhas[ topico ] = falha ;
+		}
+	}
+
+/***************************************************************************
+*
+*  Função: SIM  &Abrir reprodução de um registro de voo
+*  ****/
+
+	SIM_tpCondRet SIM_AbrirReproducao( const char * caminho , float velocidade )
+	{
+		LER_tpAmostra primeira ;
+		REG_tpLeitor  leitor ;
+		int i ;
+
+		if ( geradorAtivo || reproducaoAtiva || ! ( velocidade >= 0.0f ) )
+		{
+			return SIM_CondRetError ;
+		}
+
+		if ( REG_AbrirLeitura( caminho , &leitor ) != REG_CondRetOK )
+		{
+			return SIM_CondRetError ;
+		}
+
+		if ( REG_NumRegistros( leitor ) == 0 || REG_Ler( leitor , 0 , &primeira ) != REG_CondRetOK )
+		{
+			REG_FecharLeitura( leitor ) ;
+			return SIM_CondRetError ;
+		}
+
+		memset( &reproducao , 0 , sizeof( reproducao ) ) ;
+
+		reproducao.leitor                 = leitor ;
+		reproducao.velocidade             = velocidade ;
+		reproducao.estatisticas.registros = REG_NumRegistros( leitor ) ;
+		reproducao.estatisticas.inicio    = primeira.timestamp ;
+		reproducao.estatisticas.instante  = primeira.timestamp ;
+		reproducao.estatisticas.filtrados = REG_CamposFiltrados( leitor ) ;
+
+		/* Os tópicos recomeçam vazios, para que duas reproduções do mesmo
+		   arquivo partam do mesmo estado */
+
+		pthread_mutex_lock( &mutexBroker ) ;
+
+		for ( i = 0 ; i < SIM_MAX_TOPICOS ; i++ )
+		{
+			if ( nos[ i ].meta != NULL )
+			{
+				memset( nos[ i ].dado , 0 , nos[ i ].meta->o_size ) ;
+				nos[ i ].geracao          = 0 ;
+				nos[ i ].ultimaPublicacao = 0 ;
+				nos[ i ].publicados       = 0 ;
+			}
+		}
+
+		for ( i = 0 ; i < SIM_MAX_ASSINATURAS ; i++ )
+		{
+			if ( assinaturas[ i ].no != NULL )
+			{
+				assinaturas[ i ].ultimaGeracao = 0 ;
+				assinaturas[ i ].ultimaCopia   = 0 ;
+				assinaturas[ i ].copiados      = 0 ;
+				assinaturas[ i ].perdidos      = 0 ;
+				assinaturas[ i ].repetidos     = 0 ;
+				assinaturas[ i ].abandonada    = 0 ;
+				drenar( &assinaturas[ i ] ) ;
+			}
+		}
+
+		pthread_mutex_unlock( &mutexBroker ) ;
+
+		__atomic_store_n( &instanteVirtual , primeira.timestamp , __ATOMIC_RELEASE ) ;
+		__atomic_store_n( &reproducaoAtiva , 1 , __ATOMIC_RELEASE ) ;
+
+		for ( i = 0 ; i < SIM_NumTopicos ; i++ )
+		{
+			reproducao.pub[ i ] = orb_advertise( metaDoTopico( ( SIM_tpTopico ) i ) , NULL ) ;
+		}
+
+		return SIM_CondRetOK ;
+	}
+
+/***************************************************************************
+*
+*  Função: SIM  &Avançar a reprodução
+*  ****/
+
+	SIM_tpCondRet SIM_Avancar( void )
+	{
+		SIM_tpReproducao * pEst = &reproducao.estatisticas ;
+		LER_tpAmostra      amostra ;
+
+		if ( ! reproducaoAtiva )
+		{
+			return SIM_CondRetError ;
+		}
+
+		aguardarCopias( ) ;
+
+		if ( pEst->reproduzidos >= pEst->registros ||
+		     REG_Ler( reproducao.leitor , pEst->reproduzidos , &amostra ) != REG_CondRetOK )
+		{
+			return SIM_CondRetFim ;
+		}
+
+		/* Cadência: o intervalo gravado dividido pela velocidade, medido
+		   desde o primeiro registro para que os atrasos não se acumulem */
+
+		if ( reproducao.velocidade > 0.0f )
+		{
+			if ( pEst->reproduzidos == 0 )
+			{
+				clock_gettime( CLOCK_MONOTONIC , &reproducao.inicioReal ) ;
+			}
+			else
+			{
+				double          atrasoNs = ( double ) ( amostra.timestamp - pEst->inicio ) * 1000.0 / reproducao.velocidade ;
+				long long       alvoNs   = ( long long ) reproducao.inicioReal.tv_nsec + ( long long ) atrasoNs ;
+				struct timespec alvo ;
+
+				alvo.tv_sec  = reproducao.inicioReal.tv_sec + ( time_t ) ( alvoNs / 1000000000LL ) ;
+				alvo.tv_nsec = ( long ) ( alvoNs % 1000000000LL ) ;
+				clock_nanosleep( CLOCK_MONOTONIC , TIMER_ABSTIME , &alvo , NULL ) ;
+			}
+		}
+
+		if ( amostra.timestamp > instanteVirtual )
+		{
+			__atomic_store_n( &instanteVirtual , amostra.timestamp , __ATOMIC_RELEASE ) ;
+		}
+
+		publicarRegistro( &amostra , pEst->reproduzidos == 0 ) ;
+
+		pEst->instante = amostra.timestamp ;
+		pEst->reproduzidos ++ ;
+
+		return SIM_CondRetOK ;
+	}
+
+/***************************************************************************
+*
+*  Função: SIM  &Obter estado da reprodução
+*  ****/
+
+	void SIM_ObterReproducao( SIM_tpReproducao * pRep )
+	{
+		pthread_mutex_lock( &mutexBroker ) ;
+		*pRep = reproducao.estatisticas ;
+		pthread_mutex_unlock( &mutexBroker ) ;
+	}
+
+/***************************************************************************
+*
+*  Função: SIM  &Fechar reprodução
+*  ****/
+
+	void SIM_FecharReproducao( void )
+	{
+		if ( ! reproducaoAtiva )
+		{
+			return ;
+		}
+
+		__atomic_store_n( &reproducaoAtiva , 0 , __ATOMIC_RELEASE ) ;
+
+		REG_FecharLeitura( reproducao.leitor ) ;
+		reproducao.leitor = NULL ;
+	}
+
+/***************************************************************************
+*
+*  Função: SIM  &Obter contadores de um tópico
+*  ****/
+
+	void SIM_ObterContadores( SIM_tpTopico topico , SIM_tpContadores * pContador )
+	{
+		const struct orb_metadata * meta = metaDoTopico( topico ) ;
+		int i ;
+
+		memset( pContador , 0 , sizeof( *pContador ) ) ;
+
+		pthread_mutex_lock( &mutexBroker ) ;
+
+		for ( i = 0 ; i < SIM_MAX_TOPICOS ; i++ )
+		{
+			if ( nos[ i ].meta == meta )
+			{
+				pContador->publicados = nos[ i ].publicados ;
+			}
+		}
+
+		for ( i = 0 ; i < SIM_MAX_ASSINATURAS ; i++ )
+		{
+			if ( assinaturas[ i ].no != NULL && assinaturas[ i ].no->meta == meta )
+			{
+				pContador->copiados  += assinaturas[ i ].copiados  ;
+				pContador->perdidos  += assinaturas[ i ].perdidos  ;
+				pContador->repetidos += assinaturas[ i ].repetidos ;
+			}
+		}
+
+		pthread_mutex_unlock( &mutexBroker ) ;
+	}
+
+/*****  Código das funções encapsuladas no módulo  *****/
+
+	/***************************************************************************
+	*
+	*  Função: SIM  & Obter (ou criar) o nó de um tópico. Chamar com o mutex.
+	*  ****/
+
+	static tpNo * obterNo( const struct orb_metadata * meta )
+	{
+		tpNo * pLivre = NULL ;
+		int i ;
+
+		for ( i = 0 ; i < SIM_MAX_TOPICOS ; i++ )
+		{
+			if ( nos[ i ].meta == meta )
+			{
+				return &nos[ i ] ;
+			}
+
+			if ( nos[ i ].meta == NULL && pLivre == NULL )
+			{
+				pLivre = &nos[ i ] ;
+			}
+		}
+
+		if ( pLivre == NULL )
+		{
+			return NULL ;
+		}
+
+		pLivre->dado = calloc( 1 , meta->o_size ) ;
+
+		if ( pLivre->dado == NULL )
+		{
+			return NULL ;
+		}
+
+		pLivre->meta = meta ;
+
+		return pLivre ;
+	}
+
+	/***************************************************************************
+	*
+	*  Função: SIM  & Procurar assinatura pelo handle. Chamar com o mutex.
+	*  ****/
+
+	static tpAssinatura * obterAssinatura( int handle )
+	{
+		int i ;
+
+		for ( i = 0 ; i < SIM_MAX_ASSINATURAS ; i++ )
+		{
+			if ( assinaturas[ i ].no != NULL && assinaturas[ i ].fd == handle )
+			{
+				return &assinaturas[ i ] ;
+			}
+		}
+
+		return NULL ;
+	}
+
+	/***************************************************************************
+	*
+	*  Função: SIM  & Tornar o handle legível para poll()
+	*  ****/
+
+	static void sinalizar( tpAssinatura * pAss )
+	{
+		uint64_t um = 1 ;
+
+		if ( write( pAss->fd , &um , sizeof( um ) ) < 0 )
+		{
+			/* Contador do eventfd saturado: já está legível */
+		}
+	}
+
+	/***************************************************************************
+	*
+	*  Função: SIM  & Consumir a sinalização pendente do handle
+	*  ****/
+
+	static void drenar( tpAssinatura * pAss )
+	{
+		uint64_t valor ;
+
+		if ( read( pAss->fd , &valor , sizeof( valor ) ) < 0 )
+		{
+			/* Nada pendente (EAGAIN) */
+		}
+	}
+
+	/***************************************************************************
+	*
+	*  Função: SIM  & Ângulos, matriz de rotação e quatérnio da atitude
+	*  ****/
+
+	static void preencherAtitude( struct vehicle_attitude_s * att , float roll , float pitch , float yaw )
+	{
+		float cr = cosf( roll  ) , sr = sinf( roll  ) ;
+		float cp = cosf( pitch ) , sp = sinf( pitch ) ;
+		float cy = cosf( yaw   ) , sy = sinf( yaw   ) ;
+
+		att->roll  = roll  ;
+		att->pitch = pitch ;
+		att->yaw   = yaw   ;
+
+		att->R[0][0] = cp * cy ;
+		att->R[0][1] = sr * sp * cy - cr * sy ;
+		att->R[0][2] = cr * sp * cy + sr * sy ;
+		att->R[1][0] = cp * sy ;
+		att->R[1][1] = sr * sp * sy + cr * cy ;
+		att->R[1][2] = cr * sp * sy - sr * cy ;
+		att->R[2][0] = -sp ;
+		att->R[2][1] = sr * cp ;
+		att->R[2][2] = cr * cp ;
+		att->R_valid = true ;
+
+		att->q[0] = cosf( roll / 2 ) * cosf( pitch / 2 ) * cosf( yaw / 2 ) + sinf( roll / 2 ) * sinf( pitch / 2 ) * sinf( yaw / 2 ) ;
+		att->q[1] = sinf( roll / 2 ) * cosf( pitch / 2 ) * cosf( yaw / 2 ) - cosf( roll / 2 ) * sinf( pitch / 2 ) * sinf( yaw / 2 ) ;
+		att->q[2] = cosf( roll / 2 ) * sinf( pitch / 2 ) * cosf( yaw / 2 ) + sinf( roll / 2 ) * cosf( pitch / 2 ) * sinf( yaw / 2 ) ;
+		att->q[3] = cosf( roll / 2 ) * cosf( pitch / 2 ) * sinf( yaw / 2 ) - sinf( roll / 2 ) * sinf( pitch / 2 ) * cosf( yaw / 2 ) ;
+		att->q_valid = true ;
+	}
+
+	/***************************************************************************
+	*
+	*  Função: SIM  & Esperar as cópias do passo anterior da reprodução
+	*
+	*  Passo a passo: o próximo registro só é publicado depois que cada
+	*  assinatura acordada pelo anterior o copiou, de modo que um consumidor
+	*  em outra thread não perde amostras em velocidade nenhuma. Quem não
+	*  copia em SIM_PRAZO_PASSO_MS deixa de ser esperado.
+	*  ****/
+
+	static void aguardarCopias( void )
+	{
+		hrt_abstime     agora = hrt_absolute_time( ) ;
+		struct timespec prazo ;
+		int             esperou = 0 ;
+		int             i , n ;
+
+		pthread_mutex_lock( &mutexBroker ) ;
+
+		for ( ; ; )
+		{
+			for ( i = 0 , n = 0 ; i < SIM_MAX_ASSINATURAS ; i++ )
+			{
+				n += pendente( &assinaturas[ i ] , agora ) ;
+			}
+
+			if ( n == 0 )
+			{
+				break ;
+			}
+
+			if ( ! esperou )
+			{
+				esperou = 1 ;
+				reproducao.estatisticas.esperas ++ ;
+
+				clock_gettime( CLOCK_REALTIME , &prazo ) ;
+				prazo.tv_nsec += SIM_PRAZO_PASSO_MS * 1000000L ;
+				prazo.tv_sec  += prazo.tv_nsec / 1000000000L ;
+				prazo.tv_nsec %= 1000000000L ;
+			}
+
+			if ( pthread_cond_timedwait( &condCopia , &mutexBroker , &prazo ) == ETIMEDOUT )
+			{
+				for ( i = 0 ; i < SIM_MAX_ASSINATURAS ; i++ )
+				{
+					if ( pendente( &assinaturas[ i ] , agora ) )
+					{
+						assinaturas[ i ].abandonada = 1 ;
+						reproducao.estatisticas.abandonadas ++ ;
+					}
+				}
+				break ;
+			}
+		}
+
+		pthread_mutex_unlock( &mutexBroker ) ;
+	}
+
+	/***************************************************************************
+	*
+	*  Função: SIM  & Assinatura acordada e ainda sem cópia
+	*  ****/
+
+	static int pendente( const tpAssinatura * pAss , hrt_abstime agora )
+	{
+		return pAss->no != NULL && ! pAss->abandonada && pAss->no->geracao != pAss->ultimaGeracao &&
+		       agora - pAss->ultimaCopia >= pAss->intervalo ;
+	}
+
+	/***************************************************************************
+	*
+	*  Função: SIM  & Publicar os tópicos de um registro de voo
+	*
+	*  Refaz, a partir dos campos do registro, os tópicos que o LER leu no
+	*  ciclo (os grupos novos), cada grupo novo com a sua origem gravada;
+	*  os demais membros ficam como na publicação anterior. A posição
+	*  também é publicada quando a validade da altura muda, e então, sem
+	*  altura nova, leva o timestamp do registro. No primeiro registro
+	*  todos os grupos válidos são publicados.
+	*  ****/
+
+	static void publicarRegistro( const LER_tpAmostra * pAmostra , int primeiro )
+	{
+		const float * v       = pAmostra->valor ;
+		hrt_abstime   origem[ LER_NumGrupos ] ;
+		uint32_t      novos   = primeiro ? pAmostra->validos | pAmostra->novos : pAmostra->novos ;
+		uint32_t      mudaram = pAmostra->validos ^ reproducao.validos ;
+		SIM_tpReproducao * pEst = &reproducao.estatisticas ;
+		int g ;
+
+		/* Registros da versão 1 do REG não têm origem: vale o do ciclo */
+
+		for ( g = 0 ; g < LER_NumGrupos ; g++ )
+		{
+			origem[ g ] = pAmostra->origem[ g ] != 0 ? pAmostra->origem[ g ] : pAmostra->timestamp ;
+		}
+
+		if ( novos & ( LER_MASCARA_GRUPO( LER_GrupoVelAngular ) | LER_MASCARA_GRUPO( LER_GrupoAtitude ) ) )
+		{
+			struct vehicle_attitude_s * att = &reproducao.att ;
+
+			/* Os dois grupos vêm do mesmo tópico e da mesma origem */
+
+			att->timestamp  = origem[ LER_GrupoAtitude ] > origem[ LER_GrupoVelAngular ] ?
+			                  origem[ LER_GrupoAtitude ] : origem[ LER_GrupoVelAngular ] ;
+			att->rollspeed  = v[ LER_CampoRollSpeed ]  / SIM_RAD_EM_GRAU ;
+			att->pitchspeed = v[ LER_CampoPitchSpeed ] / SIM_RAD_EM_GRAU ;
+			att->yawspeed   = v[ LER_CampoYawSpeed ]   / SIM_RAD_EM_GRAU ;
+
+			preencherAtitude( att , v[ LER_CampoRoll ] / SIM_RAD_EM_GRAU , v[ LER_CampoPitch ] / SIM_RAD_EM_GRAU ,
+			                  v[ LER_CampoYaw ] / SIM_RAD_EM_GRAU ) ;
+		}
+
+		if ( novos & ( LER_MASCARA_GRUPO( LER_GrupoPressao ) | LER_MASCARA_GRUPO( LER_GrupoAceleracao ) ) )
+		{
+			struct sensor_combined_s * sen = &reproducao.sen ;
+
+			sen->gyro_rad_s[0] = reproducao.att.rollspeed  ;
+			sen->gyro_rad_s[1] = reproducao.att.pitchspeed ;
+			sen->gyro_rad_s[2] = reproducao.att.yawspeed   ;
+
+			if ( novos & LER_MASCARA_GRUPO( LER_GrupoAceleracao ) )
+			{
+				sen->accelerometer_m_s2[0]   = v[ LER_CampoAx ] ;
+				sen->accelerometer_m_s2[1]   = v[ LER_CampoAy ] ;
+				sen->accelerometer_m_s2[2]   = v[ LER_CampoAz ] ;
+				sen->accelerometer_timestamp = origem[ LER_GrupoAceleracao ] ;
+			}
+
+			if ( novos & LER_MASCARA_GRUPO( LER_GrupoPressao ) )
+			{
+				sen->baro_pres_mbar = v[ LER_CampoPressao ] ;
+				sen->baro_alt_meter = 44330.8f * ( 1.0f - powf( v[ LER_CampoPressao ] / 1013.25f , 0.190263f ) ) ;
+				sen->baro_timestamp = origem[ LER_GrupoPressao ] ;
+			}
+
+			/* O tópico sai com o mais novo dos seus sensores */
+
+			sen->timestamp = sen->accelerometer_timestamp > sen->baro_timestamp ?
+			                 sen->accelerometer_timestamp : sen->baro_timestamp ;
+
+			orb_publish( ORB_ID( sensor_combined ) , reproducao.pub[ SIM_TopicoSensor ] , sen ) ;
+			pEst->publicacoes[ SIM_TopicoSensor ] ++ ;
+		}
+
+		if ( ( novos | mudaram ) & LER_MASCARA_GRUPO( LER_GrupoAltura ) )
+		{
+			struct vehicle_local_position_s * pos = &reproducao.pos ;
+
+			pos->timestamp = novos & LER_MASCARA_GRUPO( LER_GrupoAltura ) ? origem[ LER_GrupoAltura ] : pAmostra->timestamp ;
+			pos->z         = v[ LER_CampoAltura ] ;
+			pos->z_valid   = ( pAmostra->validos & LER_MASCARA_GRUPO( LER_GrupoAltura ) ) != 0 ;
+
+			orb_publish( ORB_ID( vehicle_local_position ) , reproducao.pub[ SIM_TopicoPosicao ] , pos ) ;
+			pEst->publicacoes[ SIM_TopicoPosicao ] ++ ;
+		}
+
+		if ( novos & ( LER_MASCARA_GRUPO( LER_GrupoVelAngular ) | LER_MASCARA_GRUPO( LER_GrupoAtitude ) ) )
+		{
+			orb_publish( ORB_ID( vehicle_attitude ) , reproducao.pub[ SIM_TopicoAtitude ] , &reproducao.att ) ;
+			pEst->publicacoes[ SIM_TopicoAtitude ] ++ ;
+		}
+
+		reproducao.validos = pAmostra->validos ;
+	}
+
+	/***************************************************************************
+	*
+	*  Função: SIM  & Timestamps de uma amostra republicada
+	*  ****/
+
+	static void carimbar( SIM_tpTopico topico , hrt_abstime agora , void * pDado )
+	{
+		switch ( topico )
+		{
+			case SIM_TopicoSensor :
+			{
+				struct sensor_combined_s * sen = pDado ;
+
+				sen->timestamp               = agora ;
+				sen->accelerometer_timestamp = agora ;
+				sen->baro_timestamp          = agora ;
+				break ;
+			}
+
+			case SIM_TopicoPosicao :
+				( ( struct vehicle_local_position_s * ) pDado )->timestamp = agora ;
+				break ;
+
+			case SIM_TopicoAtitude :
+				( ( struct vehicle_attitude_s * ) pDado )->timestamp = agora ;
+				break ;
+
+			default :
+				break ;
+		}
+	}
+
+	/***************************************************************************
+	*
+	*  Função: SIM  & Pico numa amostra
+	*  ****/
+
+	static void perturbar( SIM_tpTopico topico , void * pDado )
+	{
+		switch ( topico )
+		{
+			case SIM_TopicoSensor :
+				( ( struct sensor_combined_s * ) pDado )->accelerometer_m_s2[0] += 60.0f ;
+				break ;
+
+			case SIM_TopicoPosicao :
+				( ( struct vehicle_local_position_s * ) pDado )->z -= 40.0f ;
+				break ;
+
+			case SIM_TopicoAtitude :
+				( ( struct vehicle_attitude_s * ) pDado )->rollspeed += 6.0f ;
+				break ;
+
+			default :
+				break ;
+		}
+	}
+
+	/***************************************************************************
+	*
+	*  Função: SIM  & Metadados de um tópico simulado
+	*  ****/
+
+	static const struct orb_metadata * metaDoTopico( SIM_tpTopico topico )
+	{
+		switch ( topico )
+		{
+			case SIM_TopicoSensor  : return ORB_ID( sensor_combined )        ;
+			case SIM_TopicoPosicao : return ORB_ID( vehicle_local_position ) ;
+			case SIM_TopicoAtitude : return ORB_ID( vehicle_attitude )       ;
+			default                : return NULL                             ;
+		}
+	}
+
+	/***************************************************************************
+	*
+	*  Função: SIM  & Preencher uma amostra sintética do tópico no instante t
+	*
+	*  Voo simulado: rolagem e arfagem senoidais, guinada em rampa ondulada
+	*  (nenhum campo constante, como num sensor de verdade), altura
+	*  oscilando em torno de 30 m e vibração de 80 Hz no acelerômetro.
+	*  ****/
+
+	static void sintetizar( SIM_tpTopico topico , hrt_abstime agora , void * pDado )
+	{
+		const float PI2 = 6.2831853f ;
+		float t = ( float ) ( ( double ) agora * 1e-6 ) ;
+
+		float roll   = 0.35f * sinf( PI2 * 0.20f * t )           ;
+		float pitch  = 0.15f * sinf( PI2 * 0.13f * t + 0.5f )    ;
+		float yaw    = fmodf( 0.10f * t + 0.05f * sinf( PI2 * 0.05f * t ) , PI2 ) - 3.1415927f ;
+		float alt    = 30.0f + 20.0f * sinf( PI2 * 0.02f * t )   ;
+		float vAlt   = 20.0f * PI2 * 0.02f * cosf( PI2 * 0.02f * t ) ;
+
+		float rollSpeed  = 0.35f * PI2 * 0.20f * cosf( PI2 * 0.20f * t )        ;
+		float pitchSpeed = 0.15f * PI2 * 0.13f * cosf( PI2 * 0.13f * t + 0.5f ) ;
+		float yawSpeed   = 0.10f + 0.05f * PI2 * 0.05f * cosf( PI2 * 0.05f * t ) ;
+
+		switch ( topico )
+		{
+			case SIM_TopicoAtitude :
+			{
+				struct vehicle_attitude_s * att = pDado ;
+
+				memset( att , 0 , sizeof( *att ) ) ;
+				att->timestamp  = agora      ;
+				att->rollspeed  = rollSpeed  ;
+				att->pitchspeed = pitchSpeed ;
+				att->yawspeed   = yawSpeed   ;
+
+				preencherAtitude( att , roll , pitch , yaw ) ;
+				break ;
+			}
+
+			case SIM_TopicoSensor :
+			{
+				struct sensor_combined_s * sen = pDado ;
+				float vib = 0.3f * sinf( PI2 * 80.0f * t ) ;
+
+				memset( sen , 0 , sizeof( *sen ) ) ;
+				sen->timestamp = agora ;
+
+				sen->gyro_rad_s[0] = rollSpeed  ;
+				sen->gyro_rad_s[1] = pitchSpeed ;
+				sen->gyro_rad_s[2] = yawSpeed   ;
+
+				/* Gravidade no referencial do corpo (NED, z para baixo) */
+				sen->accelerometer_m_s2[0] =  9.80665f * sinf( pitch ) + vib ;
+				sen->accelerometer_m_s2[1] = -9.80665f * sinf( roll ) * cosf( pitch ) + vib ;
+				sen->accelerometer_m_s2[2] = -9.80665f * cosf( roll ) * cosf( pitch ) + vib ;
+				sen->accelerometer_timestamp = agora ;
+
+				sen->baro_alt_meter    = alt ;
+				sen->baro_pres_mbar    = 1013.25f * powf( 1.0f - 2.25577e-5f * alt , 5.25588f ) ;
+				sen->baro_temp_celcius = 25.0f ;
+				sen->baro_timestamp    = agora ;
+				break ;
+			}
+
+			case SIM_TopicoPosicao :
+			{
+				struct vehicle_local_position_s * pos = pDado ;
+
+				memset( pos , 0 , sizeof( *pos ) ) ;
+				pos->timestamp = agora ;
+				pos->xy_valid  = true  ;
+				pos->z_valid   = true  ;
+				pos->v_z_valid = true  ;
+				pos->x   = 10.0f * t ;
+				pos->z   = -alt  ;
+				pos->vz  = -vAlt ;
+				pos->yaw = yaw   ;
+				break ;
+			}
+
+			default :
+				break ;
+		}
+	}
+
+	/***************************************************************************
+	*
+	*  Função: SIM  & Thread que publica os tópicos nas taxas configuradas
+	*  ****/
+
+	static void * gerador( void * arg )
+	{
+		union {
+			struct vehicle_attitude_s       att ;
+			struct sensor_combined_s        sen ;
+			struct vehicle_local_position_s pos ;
+		} amostra ;
+
+		orb_advert_t     pub    [ SIM_NumTopicos ] ;
+		hrt_abstime      proxima[ SIM_NumTopicos ] ;
+		hrt_abstime      periodo[ SIM_NumTopicos ] ;
+		hrt_abstime      inicio = hrt_absolute_time( ) ;
+		hrt_abstime      congelado[ SIM_NumTopicos ] ;
+		unsigned long    contagem[ SIM_NumTopicos ] ;
+		int t ;
+
+		( void ) arg ;
+
+		for ( t = 0 ; t < SIM_NumTopicos ; t++ )
+		{
+			pub[ t ]     = orb_advertise( metaDoTopico( ( SIM_tpTopico ) t ) , NULL ) ;
+			periodo[ t ] = configGerador.taxaHz[ t ] > 0 ? ( hrt_abstime ) ( 1e6f / configGerador.taxaHz[ t ] ) : 0 ;
+			proxima[ t ] = inicio ;
+			congelado[ t ] = 0 ;
+			contagem[ t ]  = 0 ;
+		}
+
+		while ( geradorAtivo )
+		{
+			hrt_abstime alvo = 0 ;
+			unsigned escolhido = SIM_NumTopicos ;
+			struct timespec ts ;
+
+			for ( t = 0 ; t < SIM_NumTopicos ; t++ )
+			{
+				if ( periodo[ t ] != 0 && ( escolhido == SIM_NumTopicos || proxima[ t ] < alvo ) )
+				{
+					alvo = proxima[ t ] ;
+					escolhido = ( unsigned ) t ;
+				}
+			}
+
+			if ( escolhido >= SIM_NumTopicos )
+			{
+				break ;
+			}
+
+			ts.tv_sec  = ( time_t ) ( alvo / 1000000ULL ) ;
+			ts.tv_nsec = ( long ) ( alvo % 1000000ULL ) * 1000L ;
+			clock_nanosleep( CLOCK_MONOTONIC , TIMER_ABSTIME , &ts , NULL ) ;
+
+			proxima[ escolhido ] += periodo[ escolhido ] ;
+			contagem[ escolhido ] ++ ;
+
+			/* Falhas injetadas: mudo não publica; travado republica a
+			   amostra do instante da falha com timestamps novos, como um
+			   driver que parou de ler o sensor; picos desviam uma amostra
+			   em cada 25 */
+
+			switch ( falhas[ escolhido ] )
+			{
+				case SIM_FalhaMudo :
+					continue ;
+
+				case SIM_FalhaTravado :
+					if ( congelado[ escolhido ] == 0 )
+					{
+						congelado[ escolhido ] = alvo ;
+					}
+
+					sintetizar( ( SIM_tpTopico ) escolhido , congelado[ escolhido ] , &amostra ) ;
+					carimbar( ( SIM_tpTopico ) escolhido , alvo , &amostra ) ;
+					break ;
+
+				default :
+					congelado[ escolhido ] = 0 ;
+					sintetizar( ( SIM_tpTopico ) escolhido , alvo , &amostra ) ;
+
+					if ( falhas[ escolhido ] == SIM_FalhaPicos && contagem[ escolhido ] % 25 == 0 )
+					{
+						perturbar( ( SIM_tpTopico ) escolhido , &amostra ) ;
+					}
+					break ;
+			}
+
+			orb_publish( metaDoTopico( ( SIM_tpTopico ) escolhido ) , pub[ escolhido ] , &amostra ) ;
+		}
+
+		return NULL ;
+	}
@@ -0,0 +1,289 @@
+#ifndef SIM_UORB
+#define SIM_UORB
+
+/**************************************************************************************************************************
+*$MCD Módulo de definição
+*	  Nome : 	                Substituto (host Linux) do uORB e do relógio hrt
+*	  Proprietário :         	Equipe AeroRio
+*	  Projeto :		            SAE AeroDesign Brasil 2014
+*	  Gestor :	 	            Alessandro Soares da Silva Junior
+* 	  Arquivo : 	            SIM_UORB.H
+*	  Letras Identificadoras : 	SIM
+*	  Autor : 	                Alessandro Soares da Silva Junior
+*
+*$ED Descrição do módulo
+*	Implementa, para Linux, as chamadas orb_* e hrt_* usadas pelo módulo LER, permitindo compilar e medir o
+*   LER_PARAMETROS.c fora da placa. Os handles de assinatura são eventfd, logo o poll() do sistema funciona sobre eles
+*   com a mesma semântica de orb_set_interval do PX4.
+*
+*   O módulo também publica amostras sintéticas (determinísticas) de vehicle_attitude, sensor_combined e
+*   vehicle_local_position nas taxas configuradas, e contabiliza por tópico as amostras publicadas, copiadas,
+*   perdidas (publicações nunca copiadas) e repetidas (cópias sem dado novo).
+*   Por SIM_InjetarFalha, um tópico pode travar, emudecer ou receber picos, para exercitar a saúde do LER.
+*
+*   Em vez do gerador, o módulo pode reproduzir um voo gravado pelo REG (SIM_AbrirReproducao): cada SIM_Avancar
+*   publica os tópicos de um registro com o timestamp gravado e leva até ele o relógio hrt, que fica virtual
+*   enquanto a reprodução estiver aberta. Intervalos de assinatura, timestamps do LER e idades passam a ser os do
+*   voo, e a mesma sequência de SIM_Avancar e LER_FillParam dá sempre o mesmo resultado, em qualquer velocidade.
+*
+*   Compilar com -Ihost para que <uORB/uORB.h> e <drivers/drv_hrt.h> resolvam para os substitutos deste diretório.
+*
+***************************************************************************************************************************/
+
+#include <stdint.h>
+
+/***** Declarações exportadas pelo módulo *****/
+
+/***********************************************************************
+*
+*  $TC Tipo de dados: SIM Tópicos simulados
+*
+*  $ED Descrição do tipo
+*     Tópicos publicados pelo gerador sintético. A ordem segue os
+*     índices de fds[] do módulo LER.
+*
+***********************************************************************/
+
+   typedef enum {
+
+         SIM_TopicoSensor   ,
+              /* sensor_combined                           */
+         SIM_TopicoPosicao  ,
+              /* vehicle_local_position                    */
+         SIM_TopicoAtitude  ,
+              /* vehicle_attitude                          */
+         SIM_NumTopicos
+
+} SIM_tpTopico ;
+
+/***********************************************************************
+*
+*  $TC Tipo de dados: SIM Condições de retorno
+*
+***********************************************************************/
+
+   typedef enum {
+
+         SIM_CondRetOK      ,
+              /* Executou corretamente                     */
+         SIM_CondRetError   ,
+              /* Falha ao criar o gerador ou ao abrir a    */
+              /* reprodução                                */
+         SIM_CondRetFim     ,
+              /* Não há mais registros a reproduzir        */
+
+} SIM_tpCondRet ;
+
+/***********************************************************************
+*
+*  $TC Tipo de dados: SIM Configuração do gerador
+*
+*  $ED Descrição do tipo
+*     Taxa de publicação de cada tópico em Hz. Taxa 0 desliga o tópico.
+*
+***********************************************************************/
+
+   typedef struct {
+
+         float taxaHz[ SIM_NumTopicos ] ;
+
+} SIM_tpConfig ;
+
+/***********************************************************************
+*
+*  $TC Tipo de dados: SIM Falha injetada num tópico
+*
+***********************************************************************/
+
+   typedef enum {
+
+         SIM_FalhaNenhuma   ,
+         SIM_FalhaTravado   ,
+              /* Repete a amostra do instante da falha     */
+              /* com timestamps novos                      */
+         SIM_FalhaMudo      ,
+              /* Deixa de publicar                         */
+         SIM_FalhaPicos     ,
+              /* Uma amostra em cada 25 com um desvio      */
+              /* grosseiro                                 */
+
+} SIM_tpFalha ;
+
+/***********************************************************************
+*
+*  $TC Tipo de dados: SIM Contadores por tópico
+*
+*  $ED Descrição do tipo
+*     Soma de todas as assinaturas do tópico.
+*
+***********************************************************************/
+
+   typedef struct {
+
+         unsigned long publicados ;
+              /* Publicações feitas pelo gerador                  */
+         unsigned long copiados   ;
+              /* Chamadas de orb_copy com sucesso                 */
+         unsigned long perdidos   ;
+              /* Publicações sobrescritas antes de serem copiadas */
+         unsigned long repetidos  ;
+              /* Cópias que não traziam dado novo (dado velho)    */
+
+} SIM_tpContadores ;
+
+/***********************************************************************
+*
+*  $TC Tipo de dados: SIM Estado da reprodução
+*
+***********************************************************************/
+
+   typedef struct {
+
+         uint64_t      registros                       ;
+              /* Registros no arquivo                             */
+         uint64_t      reproduzidos                    ;
+              /* Registros já publicados                          */
+         uint64_t      inicio                          ;
+              /* Timestamp do primeiro registro                   */
+         uint64_t      instante                        ;
+              /* Timestamp do último registro publicado           */
+         uint32_t      filtrados                       ;
+              /* Campos gravados já filtrados (REG_CamposFiltrados) */
+         unsigned long publicacoes[ SIM_NumTopicos ]   ;
+         unsigned long esperas                         ;
+              /* Passos que esperaram a cópia de um assinante     */
+         unsigned long abandonadas                     ;
+              /* Assinaturas que não copiaram no prazo            */
+
+} SIM_tpReproducao ;
+
+/***********************************************************************
+*
+*  $FC Função: SIM  &Iniciar gerador sintético
+*
+*  $ED Descrição da função
+*     Zera os contadores e dispara a thread que publica os três
+*     tópicos nas taxas de pConfig.
+*
+*  $FV Valor retornado
+*     SIM_CondRetOK ou SIM_CondRetError se a thread não pôde ser criada
+*     ou o gerador já está rodando.
+*
+***********************************************************************/
+
+SIM_tpCondRet SIM_Iniciar( const SIM_tpConfig * pConfig ) ;
+
+/***********************************************************************
+*
+*  $FC Função: SIM  &Parar gerador sintético
+*
+*  $ED Descrição da função
+*     Para a thread de publicação e aguarda seu término. As assinaturas
+*     e os últimos dados publicados continuam disponíveis.
+*
+***********************************************************************/
+
+void SIM_Parar( void ) ;
+
+/***********************************************************************
+*
+*  $FC Função: SIM  &Obter contadores de um tópico
+*
+*  $EP Parâmetros
+*    topico     - Tópico desejado
+*    pContador  - Recebe os contadores acumulados desde SIM_Iniciar
+*
+***********************************************************************/
+
+void SIM_ObterContadores( SIM_tpTopico topico , SIM_tpContadores * pContador ) ;
+
+/***********************************************************************
+*
+*  $FC Função: SIM  &Injetar falha num tópico
+*
+*  $ED Descrição da função
+*     Vale a partir da próxima publicação do tópico, até ser trocada;
+*     SIM_FalhaNenhuma restabelece o tópico.
+*
+***********************************************************************/
+
+void SIM_InjetarFalha( SIM_tpTopico topico , SIM_tpFalha falha ) ;
+
+/***********************************************************************
+*
+*  $FC Função: SIM  &Abrir reprodução de um registro de voo
+*
+*  $ED Descrição da função
+*     Abre um arquivo do REG (comprimido ou não), esvazia os tópicos e
+*     passa o relógio hrt para o timestamp do primeiro registro. Nada é
+*     publicado até SIM_Avancar. Não pode ser usada com o gerador.
+*
+*     O registro traz os valores de saída do LER que o gravou: os campos
+*     de SIM_tpReproducao.filtrados já passaram pelo filtro. O contexto
+*     que lê a reprodução não deve ligar filtro nesses campos, ou eles
+*     seriam filtrados duas vezes.
+*
+*  $EP Parâmetros
+*    velocidade  - Múltiplo do tempo real (1 = tempo real); 0 publica
+*                  sem esperar, o mais rápido possível
+*
+*  $FV Valor retornado
+*     SIM_CondRetOK ou SIM_CondRetError se o arquivo não é um registro
+*     válido e não vazio, o gerador está rodando ou já há reprodução.
+*
+***********************************************************************/
+
+SIM_tpCondRet SIM_AbrirReproducao( const char * caminho , float velocidade ) ;
+
+/***********************************************************************
+*
+*  $FC Função: SIM  &Avançar a reprodução
+*
+*  $ED Descrição da função
+*     Espera que as assinaturas acordadas pelo registro anterior o tenham
+*     copiado (no máximo 100 ms cada; quem não copia deixa de ser
+*     esperado), aguarda o instante do próximo registro na velocidade
+*     pedida, leva o relógio hrt até o timestamp dele e publica os
+*     tópicos dos grupos novos do registro. Cada grupo é publicado com
+*     a sua origem gravada (LER_tpAmostra::origem), e não com o instante
+*     do ciclo do LER que o gravou, de modo que a idade de cada grupo e o
+*     alinhamento (LER_FillParamAlinhado) se refazem como no voo. Um
+*     registro da versão 1 do REG, sem origens, publica tudo com o
+*     timestamp do registro.
+*
+*     Com o LER em LER_ModoSincrono na mesma thread, alternar
+*     SIM_Avancar e LER_FillParam refaz o voo ciclo a ciclo: sem filtros,
+*     cada amostra sai como a gravada, origens incluídas (exceto os grupos
+*     novos do primeiro ciclo, que são todos os válidos). Com LER_ModoThread nenhuma
+*     publicação é perdida, mas a divisão em ciclos depende da ordem em
+*     que as threads rodam.
+*
+*  $FV Valor retornado
+*     SIM_CondRetOK, SIM_CondRetFim depois do último registro ou
+*     SIM_CondRetError se não há reprodução aberta.
+*
+***********************************************************************/
+
+SIM_tpCondRet SIM_Avancar( void ) ;
+
+/***********************************************************************
+*
+*  $FC Função: SIM  &Obter estado da reprodução
+*
+***********************************************************************/
+
+void SIM_ObterReproducao( SIM_tpReproducao * pRep ) ;
+
+/***********************************************************************
+*
+*  $FC Função: SIM  &Fechar reprodução
+*
+*  $ED Descrição da função
+*     Fecha o arquivo e devolve o relógio hrt ao tempo real. Os tópicos
+*     ficam com a última publicação.
+*
+***********************************************************************/
+
+void SIM_FecharReproducao( void ) ;
+
+#endif
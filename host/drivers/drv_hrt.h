@@ -0,0 +1,30 @@
+/****************************************************************************
+ *
+ *   Substituto para Linux do drivers/drv_hrt.h do PX4.
+ *
+ *   O relogio e implementado em SIM_UORB.c sobre CLOCK_MONOTONIC.
+ *
+ ****************************************************************************/
+
+#ifndef _DRV_HRT_H
+#define _DRV_HRT_H
+
+#include <stdint.h>
+
+/*
+ * Absolute time, in microsecond units.
+ */
+typedef uint64_t	hrt_abstime;
+
+/*
+ * Get absolute time.
+ */
+extern hrt_abstime	hrt_absolute_time(void);
+
+/*
+ * Compute the delta between a timestamp taken in the past
+ * and now.
+ */
+extern hrt_abstime	hrt_elapsed_time(const volatile hrt_abstime *then);
+
+#endif /* _DRV_HRT_H */
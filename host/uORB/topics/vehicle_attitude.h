@@ -0,0 +1,44 @@
+/****************************************************************************
+ *
+ *   Substituto para Linux de uORB/topics/vehicle_attitude.h (PX4 2014).
+ *
+ ****************************************************************************/
+
+#ifndef TOPIC_VEHICLE_ATTITUDE_H_
+#define TOPIC_VEHICLE_ATTITUDE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "../uORB.h"
+
+/**
+ * attitude in NED body frame in SI units.
+ */
+struct vehicle_attitude_s {
+
+	uint64_t timestamp;	/**< in microseconds since system start          */
+
+	/* This is similar to the mavlink message ATTITUDE, but for onboard use */
+
+	float roll;		/**< Roll angle (rad, Tait-Bryan, NED)				*/
+	float pitch;		/**< Pitch angle (rad, Tait-Bryan, NED)				*/
+	float yaw;		/**< Yaw angle (rad, Tait-Bryan, NED)				*/
+	float rollspeed;	/**< Roll angular speed (rad/s, Tait-Bryan, NED)		*/
+	float pitchspeed;	/**< Pitch angular speed (rad/s, Tait-Bryan, NED)		*/
+	float yawspeed;		/**< Yaw angular speed (rad/s, Tait-Bryan, NED)			*/
+	float rollacc;		/**< Roll angular accelration (rad/s, Tait-Bryan, NED)		*/
+	float pitchacc;		/**< Pitch angular acceleration (rad/s, Tait-Bryan, NED)	*/
+	float yawacc;		/**< Yaw angular acceleration (rad/s, Tait-Bryan, NED)		*/
+	float rate_offsets[3];	/**< Offsets of the body angular rates from zero		*/
+	float R[3][3];		/**< Rotation matrix body to world, (Tait-Bryan, NED)		*/
+	float q[4];		/**< Quaternion (NED)						*/
+	float g_comp[3];	/**< Compensated gravity vector					*/
+	bool R_valid;		/**< Rotation matrix valid					*/
+	bool q_valid;		/**< Quaternion valid						*/
+
+};
+
+/* register this as object request broker structure */
+ORB_DECLARE(vehicle_attitude);
+
+#endif
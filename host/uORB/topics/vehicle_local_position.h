@@ -0,0 +1,51 @@
+/****************************************************************************
+ *
+ *   Substituto para Linux de uORB/topics/vehicle_local_position.h (PX4 2014).
+ *
+ ****************************************************************************/
+
+#ifndef TOPIC_VEHICLE_LOCAL_POSITION_H_
+#define TOPIC_VEHICLE_LOCAL_POSITION_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "../uORB.h"
+
+/**
+ * Fused local position in NED.
+ */
+struct vehicle_local_position_s {
+	uint64_t timestamp;		/**< Time of this estimate, in microseconds since system start */
+	bool xy_valid;			/**< true if x and y are valid */
+	bool z_valid;			/**< true if z is valid */
+	bool v_xy_valid;		/**< true if vy and vy are valid */
+	bool v_z_valid;			/**< true if vz is valid */
+	/* Position in local NED frame */
+	float x;			/**< X position in meters in NED earth-fixed frame */
+	float y;			/**< X position in meters in NED earth-fixed frame */
+	float z;			/**< Z position in meters in NED earth-fixed frame (negative altitude) */
+	/* Velocity in NED frame */
+	float vx; 			/**< Ground X Speed (Latitude), m/s in NED */
+	float vy;			/**< Ground Y Speed (Longitude), m/s in NED */
+	float vz;			/**< Ground Z Speed (Altitude), m/s	in NED */
+	/* Heading */
+	float yaw;
+	/* Reference position in GPS / WGS84 frame */
+	bool xy_global;			/**< true if position (x, y) is valid and has valid global reference (ref_lat, ref_lon) */
+	bool z_global;			/**< true if z is valid and has valid global reference (ref_alt) */
+	uint64_t ref_timestamp;		/**< Time when reference position was set */
+	double ref_lat;			/**< Reference point latitude in degrees */
+	double ref_lon;			/**< Reference point longitude in degrees */
+	float ref_alt;			/**< Reference altitude AMSL in meters, MUST be set to current (not at reference point!) ground level */
+	/* Distance to surface */
+	float dist_bottom;		/**< Distance to bottom surface (ground) */
+	float dist_bottom_rate;		/**< Distance to bottom surface (ground) change rate */
+	uint64_t surface_bottom_timestamp;	/**< Time when new bottom surface found */
+	bool dist_bottom_valid;		/**< true if distance to bottom surface is valid */
+	float eph;
+	float epv;
+};
+
+ORB_DECLARE(vehicle_local_position);
+
+#endif
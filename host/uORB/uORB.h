@@ -0,0 +1,63 @@
+/****************************************************************************
+ *
+ *   Substituto para Linux do uORB do PX4 (apenas para testes fora da placa).
+ *
+ *   Mantem a mesma interface do uORB/uORB.h do firmware, de modo que o
+ *   LER_PARAMETROS.c compila sem alteracoes no host. Os handles retornados
+ *   por orb_subscribe sao descritores reais (eventfd), portanto poll()
+ *   funciona normalmente sobre eles.
+ *
+ ****************************************************************************/
+
+#ifndef _UORB_UORB_H
+#define _UORB_UORB_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * Object metadata.
+ */
+struct orb_metadata {
+	const char *o_name;		/**< unique object name */
+	const size_t o_size;		/**< object size */
+};
+
+typedef const struct orb_metadata *orb_id_t;
+
+/**
+ * Generates a pointer to the uORB metadata structure for
+ * a given topic.
+ */
+#define ORB_ID(_name)		&__orb_##_name
+
+/**
+ * Declare (prototype) the uORB metadata for a topic.
+ */
+#define ORB_DECLARE(_name)	extern const struct orb_metadata __orb_##_name
+
+/**
+ * Define (instantiate) the uORB metadata for a topic.
+ */
+#define ORB_DEFINE(_name, _struct)			\
+	const struct orb_metadata __orb_##_name = {	\
+		#_name,					\
+		sizeof(_struct)				\
+	}
+
+/**
+ * ORB topic advertiser handle.
+ */
+typedef intptr_t	orb_advert_t;
+
+extern orb_advert_t	orb_advertise(const struct orb_metadata *meta, const void *data);
+extern int		orb_publish(const struct orb_metadata *meta, orb_advert_t handle, const void *data);
+extern int		orb_subscribe(const struct orb_metadata *meta);
+extern int		orb_unsubscribe(int handle);
+extern int		orb_copy(const struct orb_metadata *meta, int handle, void *buffer);
+extern int		orb_check(int handle, bool *updated);
+extern int		orb_stat(int handle, uint64_t *time);
+extern int		orb_set_interval(int handle, unsigned interval);
+
+#endif /* _UORB_UORB_H */